@@ -0,0 +1,103 @@
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <vector>
+
+#include <ext/matrix.h>
+
+using mat_t = matrix::dense_matrix<double>;
+
+/**
+ * Fill a random symmetric positive definite n*n matrix
+ * with a dominant diagonal.
+ */
+mat_t
+random_spd_matrix(std::size_t n)
+{
+  std::mt19937 gen(12345);
+  std::uniform_real_distribution<double> dist(-1.0, 1.0);
+  mat_t a(n, n);
+  for (std::size_t i = 0; i < n; ++i)
+    {
+      for (std::size_t j = 0; j < i; ++j)
+	a(i, j) = a(j, i) = dist(gen);
+      a(i, i) = n;
+    }
+  return a;
+}
+
+/**
+ * Time one Cholesky decomposition of a copy of a and return the seconds taken.
+ */
+template<typename _Decomp>
+  double
+  time_cholesky(const mat_t& a, mat_t& a_chol, std::vector<double>& d,
+		_Decomp decomp)
+  {
+    a_chol = a.clone();
+    const auto start = std::chrono::steady_clock::now();
+    decomp(a_chol, d);
+    const auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(stop - start).count();
+  }
+
+int
+main(int n_args, char** args)
+{
+  std::vector<std::size_t> sizes;
+  for (int i = 1; i < n_args; ++i)
+    sizes.push_back(std::strtoul(args[i], nullptr, 10));
+  if (sizes.empty())
+    sizes = {256, 512, 1024, 2048, 4096};
+
+  std::cout << std::setw(6) << "n"
+	    << std::setw(12) << "unblock s" << std::setw(12) << "GFLOP/s"
+	    << std::setw(12) << "blocked s" << std::setw(12) << "GFLOP/s"
+	    << std::setw(12) << "parallel s" << std::setw(12) << "GFLOP/s"
+	    << std::setw(14) << "max |diff|" << '\n';
+
+  for (auto n : sizes)
+    {
+      const auto a = random_spd_matrix(n);
+      const auto flops = 1.0 * n * n * n / 3.0;
+
+      mat_t a_unbl, a_block, a_par;
+      std::vector<double> d_unbl(n), d_block(n), d_par(n);
+
+      const auto t_unbl = time_cholesky(a, a_unbl, d_unbl,
+	[n](mat_t& m, std::vector<double>& d)
+	{ matrix::cholesky_decomp(n, m, d, matrix::cholesky_algorithm::unblocked); });
+
+      const auto t_block = time_cholesky(a, a_block, d_block,
+	[n](mat_t& m, std::vector<double>& d)
+	{ matrix::cholesky_decomp(n, m, d, matrix::cholesky_algorithm::blocked); });
+
+      const auto t_par = time_cholesky(a, a_par, d_par,
+	[n](mat_t& m, std::vector<double>& d)
+	{ matrix::cholesky_decomp(n, m, d, matrix::cholesky_algorithm::parallel); });
+
+      auto diff = 0.0;
+      for (std::size_t i = 0; i < n; ++i)
+	{
+	  diff = std::max({diff, std::abs(d_unbl[i] - d_block[i]),
+			   std::abs(d_unbl[i] - d_par[i])});
+	  for (std::size_t j = 0; j < i; ++j)
+	    diff = std::max({diff, std::abs(a_unbl(i, j) - a_block(i, j)),
+			     std::abs(a_unbl(i, j) - a_par(i, j))});
+	}
+
+      std::cout << std::setw(6) << n
+		<< std::setw(12) << t_unbl
+		<< std::setw(12) << flops / t_unbl / 1.0e9
+		<< std::setw(12) << t_block
+		<< std::setw(12) << flops / t_block / 1.0e9
+		<< std::setw(12) << t_par
+		<< std::setw(12) << flops / t_par / 1.0e9
+		<< std::setw(14) << diff << '\n';
+    }
+}
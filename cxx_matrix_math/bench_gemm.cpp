@@ -0,0 +1,78 @@
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <vector>
+
+#include <ext/matrix_gemm.h>
+
+/**
+ * Return the seconds taken by a call of func.
+ */
+template<typename _Func>
+  double
+  time_it(_Func func)
+  {
+    const auto start = std::chrono::steady_clock::now();
+    func();
+    const auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(stop - start).count();
+  }
+
+int
+main(int n_args, char** args)
+{
+  std::vector<std::size_t> sizes;
+  for (int i = 1; i < n_args; ++i)
+    sizes.push_back(std::strtoul(args[i], nullptr, 10));
+  if (sizes.empty())
+    sizes = {64, 128, 256, 512, 1024};
+
+  std::cout << std::setw(6) << "n"
+	    << std::setw(12) << "loop s" << std::setw(12) << "GFLOP/s"
+	    << std::setw(12) << "gemm s" << std::setw(12) << "GFLOP/s"
+	    << std::setw(14) << "max |diff|" << '\n';
+
+  std::mt19937 gen(12345);
+  std::uniform_real_distribution<double> dist(-1.0, 1.0);
+  for (auto n : sizes)
+    {
+      std::vector<double> a(n * n), b(n * n), c_loop(n * n), c_gemm(n * n);
+      for (auto& x : a)
+	x = dist(gen);
+      for (auto& x : b)
+	x = dist(gen);
+      const auto flops = 2.0 * n * n * n;
+
+      const auto t_loop = time_it([&]()
+	{
+	  for (std::size_t i = 0; i < n; ++i)
+	    for (std::size_t j = 0; j < n; ++j)
+	      {
+		auto sum = 0.0;
+		for (std::size_t k = 0; k < n; ++k)
+		  sum += a[i * n + k] * b[k * n + j];
+		c_loop[i * n + j] = sum;
+	      }
+	});
+
+      const auto t_gemm = time_it([&]()
+	{
+	  matrix::gemm<double>(n, n, n, 1.0, a.data(), n, b.data(), n,
+			       0.0, c_gemm.data(), n);
+	});
+
+      auto diff = 0.0;
+      for (std::size_t i = 0; i < n * n; ++i)
+	diff = std::max(diff, std::abs(c_loop[i] - c_gemm[i]));
+
+      std::cout << std::setw(6) << n
+		<< std::setw(12) << t_loop
+		<< std::setw(12) << flops / t_loop / 1.0e9
+		<< std::setw(12) << t_gemm
+		<< std::setw(12) << flops / t_gemm / 1.0e9
+		<< std::setw(14) << diff << '\n';
+    }
+}
@@ -0,0 +1,106 @@
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <vector>
+
+#include <ext/matrix.h>
+
+using mat_t = std::vector<std::vector<double>>;
+
+/**
+ * Fill a random, diagonally weighted n*n matrix.
+ */
+mat_t
+random_matrix(std::size_t n)
+{
+  std::mt19937 gen(12345);
+  std::uniform_real_distribution<double> dist(-1.0, 1.0);
+  mat_t a(n, std::vector<double>(n));
+  for (std::size_t i = 0; i < n; ++i)
+    for (std::size_t j = 0; j < n; ++j)
+      a[i][j] = dist(gen);
+  return a;
+}
+
+/**
+ * Time one LU decomposition of a copy of a and return the seconds taken.
+ */
+template<typename _Decomp>
+  double
+  time_lu(const mat_t& a, mat_t& a_lu, std::vector<std::size_t>& index,
+	  _Decomp decomp)
+  {
+    a_lu = a;
+    const auto start = std::chrono::steady_clock::now();
+    decomp(a_lu, index);
+    const auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(stop - start).count();
+  }
+
+int
+main(int n_args, char** args)
+{
+  std::vector<std::size_t> sizes;
+  for (int i = 1; i < n_args; ++i)
+    sizes.push_back(std::strtoul(args[i], nullptr, 10));
+  if (sizes.empty())
+    sizes = {128, 256, 512, 1024, 2048};
+
+  std::cout << std::setw(6) << "n"
+	    << std::setw(12) << "crout s" << std::setw(12) << "GFLOP/s"
+	    << std::setw(12) << "blocked s" << std::setw(12) << "GFLOP/s"
+	    << std::setw(12) << "parallel s" << std::setw(12) << "GFLOP/s"
+	    << std::setw(14) << "max |diff|" << '\n';
+
+  for (auto n : sizes)
+    {
+      const auto a = random_matrix(n);
+      const auto flops = 2.0 * n * n * n / 3.0;
+
+      mat_t a_crout, a_block, a_par;
+      std::vector<std::size_t> index_crout(n), index_block(n), index_par(n);
+
+      const auto t_crout = time_lu(a, a_crout, index_crout,
+	[n](mat_t& m, std::vector<std::size_t>& index)
+	{
+	  double parity;
+	  matrix::lu_decomp(n, m, index, parity, matrix::lu_algorithm::crout);
+	});
+
+      const auto t_block = time_lu(a, a_block, index_block,
+	[n](mat_t& m, std::vector<std::size_t>& index)
+	{
+	  double parity;
+	  matrix::lu_decomp(n, m, index, parity, matrix::lu_algorithm::blocked);
+	});
+
+      const auto t_par = time_lu(a, a_par, index_par,
+	[n](mat_t& m, std::vector<std::size_t>& index)
+	{
+	  double parity;
+	  matrix::lu_decomp(n, m, index, parity, matrix::lu_algorithm::parallel);
+	});
+
+      auto diff = 0.0;
+      for (std::size_t i = 0; i < n; ++i)
+	for (std::size_t j = 0; j < n; ++j)
+	  diff = std::max({diff, std::abs(a_crout[i][j] - a_block[i][j]),
+			   std::abs(a_crout[i][j] - a_par[i][j])});
+      if (index_crout != index_block || index_crout != index_par)
+	std::cout << " pivot sequences differ for n = " << n << '\n';
+
+      std::cout << std::setw(6) << n
+		<< std::setw(12) << t_crout
+		<< std::setw(12) << flops / t_crout / 1.0e9
+		<< std::setw(12) << t_block
+		<< std::setw(12) << flops / t_block / 1.0e9
+		<< std::setw(12) << t_par
+		<< std::setw(12) << flops / t_par / 1.0e9
+		<< std::setw(14) << diff << '\n';
+    }
+}
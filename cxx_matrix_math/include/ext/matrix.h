@@ -49,84 +49,329 @@ template<class _Matrix>
 #include <vector>
 #include <array>
 
+#include "matrix_layout.h"
+
 namespace matrix
 {
 
-template<typename Tp>
-  class matrix
-  {
-    //operator[](size_t);
-  };
+/**
+ * Non-owning matrix views over the containers the decompositions accept.
+ * Each view exposes rows(), cols(), mdspan-style extent(r) and stride(r),
+ * element access through m[i][j] and m(i, j), and, when the storage is
+ * a single block, data() and a layout_type of layout_right (row-major)
+ * or layout_left (column-major).  Views of jagged storage have a void
+ * layout_type and no data().  The views hold only pointers and extents
+ * and are cheap to copy.
+ */
+template<typename Tp, typename Layout = layout_right>
+  class matrix;
 
+/**
+ * View of a built-in array Tp[M][N].
+ */
 template<typename Tp, size_t M, size_t N>
-  class matrix<Tp (&)[M][N]>
+  class matrix<Tp (&)[M][N], layout_right>
   {
-    matrix(Tp (&mat)[M][N]);
-    matrix<Tp[N]> operator[](size_t);
-    Tp (&_M_mat)[M][N];
+  public:
+
+    using value_type = std::remove_cv_t<Tp>;
+    using layout_type = layout_right;
+
+    constexpr matrix(Tp (&mat)[M][N]) noexcept
+    : _M_mat(mat)
+    { }
+
+    static constexpr std::size_t rows() noexcept { return M; }
+    static constexpr std::size_t cols() noexcept { return N; }
+    static constexpr std::size_t extent(std::size_t r) noexcept
+    { return r == 0 ? M : N; }
+    static constexpr std::size_t stride(std::size_t r) noexcept
+    { return r == 0 ? N : 1; }
+
+    constexpr Tp* data() const noexcept { return &_M_mat[0][0]; }
+
+    constexpr Tp* operator[](std::size_t i) const noexcept
+    { return _M_mat[i]; }
+
+    constexpr Tp& operator()(std::size_t i, std::size_t j) const noexcept
+    { return _M_mat[i][j]; }
+
+  private:
+
+    Tp (*_M_mat)[N];
   };
 
-template<typename Tp>
-  class matrix<Tp*>
+/**
+ * View of a flat block of memory with a leading dimension
+ * in row-major (layout_right) or column-major (layout_left) order.
+ */
+template<typename Tp, typename Layout>
+  class matrix<Tp*, Layout>
   {
-    Tp*& _M_mat;
+  public:
+
+    using value_type = std::remove_cv_t<Tp>;
+    using layout_type = Layout;
+
+    constexpr matrix(Tp* mat, std::size_t rows, std::size_t cols) noexcept
+    : matrix(mat, rows, cols,
+	     std::is_same_v<Layout, layout_left> ? rows : cols)
+    { }
+
+    constexpr matrix(Tp* mat, std::size_t rows, std::size_t cols,
+		     std::size_t ld) noexcept
+    : _M_mat(mat), _M_rows(rows), _M_cols(cols), _M_ld(ld)
+    { }
+
+    constexpr std::size_t rows() const noexcept { return _M_rows; }
+    constexpr std::size_t cols() const noexcept { return _M_cols; }
+    constexpr std::size_t extent(std::size_t r) const noexcept
+    { return r == 0 ? _M_rows : _M_cols; }
+    constexpr std::size_t stride(std::size_t r) const noexcept
+    {
+      if constexpr (std::is_same_v<Layout, layout_left>)
+	return r == 0 ? 1 : _M_ld;
+      else
+	return r == 0 ? _M_ld : 1;
+    }
+
+    constexpr Tp* data() const noexcept { return _M_mat; }
+
+    constexpr auto operator[](std::size_t i) const noexcept
+    {
+      if constexpr (std::is_same_v<Layout, layout_left>)
+	return strided_row<Tp>(_M_mat + i, _M_ld);
+      else
+	return _M_mat + i * _M_ld;
+    }
+
+    constexpr Tp& operator()(std::size_t i, std::size_t j) const noexcept
+    {
+      if constexpr (std::is_same_v<Layout, layout_left>)
+	return _M_mat[i + j * _M_ld];
+      else
+	return _M_mat[i * _M_ld + j];
+    }
+
+  private:
+
+    Tp* _M_mat;
+    std::size_t _M_rows;
+    std::size_t _M_cols;
+    std::size_t _M_ld;
   };
 
+/**
+ * View of an array of row pointers.  The rows are not contiguous.
+ */
 template<typename Tp>
-  class matrix<Tp**>
+  class matrix<Tp**, layout_right>
   {
-    Tp **& _M_mat;
+  public:
+
+    using value_type = std::remove_cv_t<Tp>;
+    using layout_type = void;
+
+    constexpr matrix(Tp** mat, std::size_t rows, std::size_t cols) noexcept
+    : _M_mat(mat), _M_rows(rows), _M_cols(cols)
+    { }
+
+    constexpr std::size_t rows() const noexcept { return _M_rows; }
+    constexpr std::size_t cols() const noexcept { return _M_cols; }
+    constexpr std::size_t extent(std::size_t r) const noexcept
+    { return r == 0 ? _M_rows : _M_cols; }
+
+    constexpr Tp* operator[](std::size_t i) const noexcept
+    { return _M_mat[i]; }
+
+    constexpr Tp& operator()(std::size_t i, std::size_t j) const noexcept
+    { return _M_mat[i][j]; }
+
+  private:
+
+    Tp** _M_mat;
+    std::size_t _M_rows;
+    std::size_t _M_cols;
   };
 
+/**
+ * View of a pointer to rows of M elements.
+ */
 template<typename Tp, size_t M>
-  class matrix<Tp(*)[M]>
+  class matrix<Tp(*)[M], layout_right>
   {
-    Tp (*&_M_mat)[M];
+  public:
+
+    using value_type = std::remove_cv_t<Tp>;
+    using layout_type = layout_right;
+
+    constexpr matrix(Tp (*mat)[M], std::size_t rows) noexcept
+    : _M_mat(mat), _M_rows(rows)
+    { }
+
+    constexpr std::size_t rows() const noexcept { return _M_rows; }
+    static constexpr std::size_t cols() noexcept { return M; }
+    constexpr std::size_t extent(std::size_t r) const noexcept
+    { return r == 0 ? _M_rows : M; }
+    static constexpr std::size_t stride(std::size_t r) noexcept
+    { return r == 0 ? M : 1; }
+
+    constexpr Tp* data() const noexcept { return &_M_mat[0][0]; }
+
+    constexpr Tp* operator[](std::size_t i) const noexcept
+    { return _M_mat[i]; }
+
+    constexpr Tp& operator()(std::size_t i, std::size_t j) const noexcept
+    { return _M_mat[i][j]; }
+
+  private:
+
+    Tp (*_M_mat)[M];
+    std::size_t _M_rows;
   };
 
-template<typename Tp, size_t M, size_t N>
-  class matrix<std::array<Tp, M * N>>
+/**
+ * View of a flat std::array of rows * cols elements
+ * in row-major (layout_right) or column-major (layout_left) order.
+ * A view with no rows is 0 * 0.
+ */
+template<typename Tp, size_t MN, typename Layout>
+  class matrix<std::array<Tp, MN>, Layout>
+  : public matrix<Tp*, Layout>
   {
-    std::array<Tp, M * N> & _M_mat;
+  public:
+
+    constexpr matrix(std::array<Tp, MN>& mat, std::size_t rows) noexcept
+    : matrix<Tp*, Layout>(mat.data(), rows, rows == 0 ? 0 : MN / rows)
+    { }
   };
 
+/**
+ * View of a nested std::array.
+ */
 template<typename Tp, size_t M, size_t N>
-  class matrix<std::array<std::array<Tp, N>, M>>
+  class matrix<std::array<std::array<Tp, N>, M>, layout_right>
   {
-    std::array<std::array<Tp, N>, M> & _M_mat;
+  public:
+
+    using value_type = Tp;
+    using layout_type = layout_right;
+
+    constexpr matrix(std::array<std::array<Tp, N>, M>& mat) noexcept
+    : _M_mat(&mat)
+    { }
+
+    static constexpr std::size_t rows() noexcept { return M; }
+    static constexpr std::size_t cols() noexcept { return N; }
+    static constexpr std::size_t extent(std::size_t r) noexcept
+    { return r == 0 ? M : N; }
+    static constexpr std::size_t stride(std::size_t r) noexcept
+    { return r == 0 ? N : 1; }
+
+    constexpr Tp* data() const noexcept { return (*_M_mat)[0].data(); }
+
+    constexpr Tp* operator[](std::size_t i) const noexcept
+    { return (*_M_mat)[i].data(); }
+
+    constexpr Tp& operator()(std::size_t i, std::size_t j) const noexcept
+    { return (*_M_mat)[i][j]; }
+
+  private:
+
+    std::array<std::array<Tp, N>, M>* _M_mat;
   };
 
+/**
+ * View of a std::vector of row vectors.  The rows are not contiguous.
+ */
 template<typename Tp>
-  class matrix<std::vector<std::vector<Tp>>>
+  class matrix<std::vector<std::vector<Tp>>, layout_right>
   {
-    std::vector<std::vector<Tp>> & _M_mat;
+  public:
+
+    using value_type = Tp;
+    using layout_type = void;
+
+    matrix(std::vector<std::vector<Tp>>& mat) noexcept
+    : _M_mat(&mat)
+    { }
+
+    std::size_t rows() const noexcept { return _M_mat->size(); }
+    std::size_t cols() const noexcept
+    { return _M_mat->empty() ? 0 : _M_mat->front().size(); }
+    std::size_t extent(std::size_t r) const noexcept
+    { return r == 0 ? this->rows() : this->cols(); }
+
+    Tp* operator[](std::size_t i) const noexcept
+    { return (*_M_mat)[i].data(); }
+
+    Tp& operator()(std::size_t i, std::size_t j) const noexcept
+    { return (*_M_mat)[i][j]; }
+
+  private:
+
+    std::vector<std::vector<Tp>>* _M_mat;
   };
 
-template<typename Tp>
-  class matrix<std::valarray<Tp>>
+/**
+ * View of a flat std::valarray of rows * cols elements
+ * in row-major (layout_right) or column-major (layout_left) order.
+ * A view with no rows is 0 * 0.
+ */
+template<typename Tp, typename Layout>
+  class matrix<std::valarray<Tp>, Layout>
+  : public matrix<Tp*, Layout>
   {
-    std::valarray<Tp> & _M_mat;
+  public:
+
+    matrix(std::valarray<Tp>& mat, std::size_t rows) noexcept
+    : matrix<Tp*, Layout>(std::begin(mat), rows,
+			  rows == 0 ? 0 : mat.size() / rows)
+    { }
   };
 
+template<typename Tp, size_t M, size_t N>
+  matrix(Tp (&)[M][N]) -> matrix<Tp (&)[M][N]>;
 
+template<typename Tp>
+  matrix(Tp*, std::size_t, std::size_t) -> matrix<Tp*>;
 
-///
-///
-///
 template<typename Tp>
-  class banded_diagonal_matrix
-  {
-    size_t start_col;
-    size_t width;
-    std::vector<std::vector<Tp>> & stuff;
-  };
+  matrix(Tp*, std::size_t, std::size_t, std::size_t) -> matrix<Tp*>;
+
+template<typename Tp>
+  matrix(Tp**, std::size_t, std::size_t) -> matrix<Tp**>;
+
+template<typename Tp, size_t M>
+  matrix(Tp (*)[M], std::size_t) -> matrix<Tp(*)[M]>;
+
+template<typename Tp, size_t MN>
+  matrix(std::array<Tp, MN>&, std::size_t) -> matrix<std::array<Tp, MN>>;
+
+template<typename Tp, size_t M, size_t N>
+  matrix(std::array<std::array<Tp, N>, M>&)
+    -> matrix<std::array<std::array<Tp, N>, M>>;
+
+template<typename Tp>
+  matrix(std::vector<std::vector<Tp>>&)
+    -> matrix<std::vector<std::vector<Tp>>>;
+
+template<typename Tp>
+  matrix(std::valarray<Tp>&, std::size_t) -> matrix<std::valarray<Tp>>;
 
 }  //  namespace matrix
 
+#include "matrix_gemm.h"
 #include "matrix_lu_decomp.h"
 #include "matrix_qr_decomp.h"
 #include "matrix_sv_decomp.h"
 #include "matrix_cholesky_decomp.h"
 #include "matrix_gauss_jordan.h"
 #include "matrix_tridiag.h"
+#include "matrix_banded.h"
+#include "matrix_tridiag_eigen.h"
+#include "matrix_sym_eigen.h"
 #include "matrix_vandermonde.h"
+#include "matrix_batched.h"
+#include "matrix_sparse.h"
+#include "matrix_sparse_direct.h"
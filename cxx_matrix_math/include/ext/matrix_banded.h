@@ -0,0 +1,335 @@
+#ifndef MATRIX_BANDED_H
+#define MATRIX_BANDED_H 1
+
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+namespace matrix
+{
+
+/**
+ * An owning n * n band matrix with kl subdiagonals and ku superdiagonals
+ * in the compact column-major storage of LAPACK's general band routines.
+ * Element (i, j) of the band is kept at data()[kl + ku + i - j + j * ld]
+ * with a leading dimension ld = 2 kl + ku + 1: the first kl rows of each
+ * column hold no elements of the matrix but make room for the fill-in
+ * of banded_lu_decomp() so that the matrix can be factored in place.
+ * Element access through (i, j) is valid for j - kl - ku <= i <= j + kl;
+ * elements outside the band of the matrix must be left zero.
+ * The storage is O(n (kl + ku)).  The matrix is move-only;
+ * use clone() for an explicit deep copy.
+ */
+template<typename _Tp>
+  class banded_matrix
+  {
+  public:
+
+    using value_type = _Tp;
+
+    banded_matrix() noexcept = default;
+
+    /**
+     * Construct a zero n * n band matrix.
+     */
+    banded_matrix(std::size_t n, std::size_t kl, std::size_t ku)
+    : m_n(n), m_kl(kl), m_ku(ku), m_ld(2 * kl + ku + 1),
+      m_data(m_ld * n)
+    { }
+
+    /**
+     * Construct the band matrix from the elements a[i][j]
+     * within the band of any n * n matrix type.
+     */
+    template<typename _Matrix>
+      banded_matrix(std::size_t n, std::size_t kl, std::size_t ku,
+		    const _Matrix& a)
+      : banded_matrix(n, kl, ku)
+      {
+	for (std::size_t j = 0; j < n; ++j)
+	  for (std::size_t i = j > ku ? j - ku : 0;
+	       i < n && i <= j + kl; ++i)
+	    (*this)(i, j) = a[i][j];
+      }
+
+    banded_matrix(const banded_matrix&) = delete;
+    banded_matrix& operator=(const banded_matrix&) = delete;
+
+    banded_matrix(banded_matrix&& other) noexcept
+    : m_n(std::exchange(other.m_n, 0)),
+      m_kl(std::exchange(other.m_kl, 0)),
+      m_ku(std::exchange(other.m_ku, 0)),
+      m_ld(std::exchange(other.m_ld, 0)),
+      m_data(std::move(other.m_data))
+    { }
+
+    banded_matrix&
+    operator=(banded_matrix&& other) noexcept
+    {
+      m_n = std::exchange(other.m_n, 0);
+      m_kl = std::exchange(other.m_kl, 0);
+      m_ku = std::exchange(other.m_ku, 0);
+      m_ld = std::exchange(other.m_ld, 0);
+      m_data = std::move(other.m_data);
+      return *this;
+    }
+
+    /**
+     * Return a deep copy.
+     */
+    banded_matrix
+    clone() const
+    {
+      banded_matrix b;
+      b.m_n = m_n;
+      b.m_kl = m_kl;
+      b.m_ku = m_ku;
+      b.m_ld = m_ld;
+      b.m_data = m_data;
+      return b;
+    }
+
+    std::size_t rows() const noexcept { return m_n; }
+    std::size_t cols() const noexcept { return m_n; }
+
+    /// The number of subdiagonals.
+    std::size_t lower_bandwidth() const noexcept { return m_kl; }
+
+    /// The number of superdiagonals.
+    std::size_t upper_bandwidth() const noexcept { return m_ku; }
+
+    /**
+     * Return the leading dimension 2 kl + ku + 1 of the band storage.
+     */
+    std::size_t leading_dim() const noexcept { return m_ld; }
+
+    _Tp* data() noexcept { return m_data.data(); }
+    const _Tp* data() const noexcept { return m_data.data(); }
+
+    _Tp&
+    operator()(std::size_t i, std::size_t j) noexcept
+    { return m_data[m_kl + m_ku + i - j + j * m_ld]; }
+
+    const _Tp&
+    operator()(std::size_t i, std::size_t j) const noexcept
+    { return m_data[m_kl + m_ku + i - j + j * m_ld]; }
+
+  private:
+
+    std::size_t m_n = 0;
+    std::size_t m_kl = 0;
+    std::size_t m_ku = 0;
+    std::size_t m_ld = 0;
+    std::vector<_Tp> m_data;
+  };
+
+/**
+ * An owning n * n symmetric band matrix with kd subdiagonals
+ * in the compact column-major storage of LAPACK's lower symmetric band
+ * routines: element (i, j) of the lower triangle, j <= i <= j + kd,
+ * is kept at data()[i - j + j * (kd + 1)].  Only the lower triangle
+ * is stored and element access through (i, j) is valid there alone.
+ * The matrix is move-only; use clone() for an explicit deep copy.
+ */
+template<typename _Tp>
+  class symmetric_banded_matrix
+  {
+  public:
+
+    using value_type = _Tp;
+
+    symmetric_banded_matrix() noexcept = default;
+
+    /**
+     * Construct a zero n * n symmetric band matrix.
+     */
+    symmetric_banded_matrix(std::size_t n, std::size_t kd)
+    : m_n(n), m_kd(kd), m_data((kd + 1) * n)
+    { }
+
+    /**
+     * Construct the band matrix from the elements a[i][j]
+     * within the lower band of any n * n matrix type.
+     */
+    template<typename _Matrix>
+      symmetric_banded_matrix(std::size_t n, std::size_t kd,
+			      const _Matrix& a)
+      : symmetric_banded_matrix(n, kd)
+      {
+	for (std::size_t j = 0; j < n; ++j)
+	  for (std::size_t i = j; i < n && i <= j + kd; ++i)
+	    (*this)(i, j) = a[i][j];
+      }
+
+    symmetric_banded_matrix(const symmetric_banded_matrix&) = delete;
+    symmetric_banded_matrix&
+    operator=(const symmetric_banded_matrix&) = delete;
+
+    symmetric_banded_matrix(symmetric_banded_matrix&& other) noexcept
+    : m_n(std::exchange(other.m_n, 0)),
+      m_kd(std::exchange(other.m_kd, 0)),
+      m_data(std::move(other.m_data))
+    { }
+
+    symmetric_banded_matrix&
+    operator=(symmetric_banded_matrix&& other) noexcept
+    {
+      m_n = std::exchange(other.m_n, 0);
+      m_kd = std::exchange(other.m_kd, 0);
+      m_data = std::move(other.m_data);
+      return *this;
+    }
+
+    /**
+     * Return a deep copy.
+     */
+    symmetric_banded_matrix
+    clone() const
+    {
+      symmetric_banded_matrix b;
+      b.m_n = m_n;
+      b.m_kd = m_kd;
+      b.m_data = m_data;
+      return b;
+    }
+
+    std::size_t rows() const noexcept { return m_n; }
+    std::size_t cols() const noexcept { return m_n; }
+
+    /// The number of subdiagonals (and superdiagonals).
+    std::size_t bandwidth() const noexcept { return m_kd; }
+
+    /**
+     * Return the leading dimension kd + 1 of the band storage.
+     */
+    std::size_t leading_dim() const noexcept { return m_kd + 1; }
+
+    _Tp* data() noexcept { return m_data.data(); }
+    const _Tp* data() const noexcept { return m_data.data(); }
+
+    _Tp&
+    operator()(std::size_t i, std::size_t j) noexcept
+    { return m_data[i - j + j * (m_kd + 1)]; }
+
+    const _Tp&
+    operator()(std::size_t i, std::size_t j) const noexcept
+    { return m_data[i - j + j * (m_kd + 1)]; }
+
+  private:
+
+    std::size_t m_n = 0;
+    std::size_t m_kd = 0;
+    std::vector<_Tp> m_data;
+  };
+
+/**
+ * This class represents the LU decomposition of a band matrix
+ * with partial pivoting.
+ */
+template<typename _Tp>
+  class banded_lu_decomposition
+  {
+
+  public:
+
+    using value_type = _Tp;
+
+    banded_lu_decomposition(const banded_matrix<_Tp>& a);
+
+    banded_lu_decomposition(banded_matrix<_Tp>&& a);
+
+    template<typename _Vector, typename _VectorOut>
+      void backsubstitute(const _Vector& b, _VectorOut& x) const;
+
+    template<typename InVecIter, typename OutVecIter>
+      void
+      backsubstitution(InVecIter b_begin, InVecIter b_end,
+		       OutVecIter x_begin) const;
+
+    _Tp determinant() const;
+
+  private:
+
+    banded_matrix<_Tp> m_a;
+
+    std::vector<std::size_t> m_index;
+
+    _Tp m_parity;
+  };
+
+/**
+ * This class represents the Cholesky decomposition
+ * of a symmetric positive definite band matrix.
+ */
+template<typename _Tp>
+  class banded_cholesky_decomposition
+  {
+
+  public:
+
+    using value_type = _Tp;
+
+    banded_cholesky_decomposition(const symmetric_banded_matrix<_Tp>& a);
+
+    banded_cholesky_decomposition(symmetric_banded_matrix<_Tp>&& a);
+
+    template<typename _Vector, typename _VectorOut>
+      void backsubstitute(const _Vector& b, _VectorOut& x) const;
+
+    template<typename InVecIter, typename OutVecIter>
+      void
+      backsubstitution(InVecIter b_begin, InVecIter b_end,
+		       OutVecIter x_begin) const;
+
+  private:
+
+    symmetric_banded_matrix<_Tp> m_a;
+  };
+
+/**
+ * Replace the band matrix a by the LU decomposition of a rowwise permutation
+ * of itself with partial pivoting, as LAPACK's dgbtf2 computes it.
+ * The multipliers of L, at most kl per column, are left below the diagonal
+ * and U, with its bandwidth grown to kl + ku by the row interchanges,
+ * on and above it.  index[j] receives the row interchanged with row j
+ * and parity the parity of the permutation.  Only the columns reached
+ * by the band are touched so the work is O(n kl (kl + ku)).
+ * Throw std::logic_error if a zero pivot is met.
+ */
+template<typename _Tp, typename _VectorInt>
+  void
+  banded_lu_decomp(banded_matrix<_Tp>& a, _VectorInt& index, _Tp& parity);
+
+/**
+ * Solve a.x = b given the band LU decomposition from banded_lu_decomp().
+ * b is replaced by the solution.  The work is O(n (2 kl + ku)).
+ */
+template<typename _Tp, typename _VectorInt, typename _Vector>
+  void
+  banded_lu_backsub(const banded_matrix<_Tp>& a, const _VectorInt& index,
+		    _Vector& b);
+
+/**
+ * Replace the symmetric positive definite band matrix a by its Cholesky
+ * factor L, a = L.L~, as LAPACK's dpbtf2 computes it.  L has the same
+ * bandwidth as a so the factorization needs no extra storage;
+ * the work is O(n kd^2).
+ * Throw std::logic_error if a is not positive definite.
+ */
+template<typename _Tp>
+  void
+  banded_cholesky_decomp(symmetric_banded_matrix<_Tp>& a);
+
+/**
+ * Solve a.x = b given the band Cholesky factor from banded_cholesky_decomp().
+ * b is replaced by the solution.  The work is O(n kd).
+ */
+template<typename _Tp, typename _Vector>
+  void
+  banded_cholesky_backsub(const symmetric_banded_matrix<_Tp>& a, _Vector& b);
+
+} // namespace matrix
+
+#include "matrix_banded.tcc"
+
+#endif // MATRIX_BANDED_H
@@ -0,0 +1,305 @@
+#ifndef MATRIX_BANDED_TCC
+#define MATRIX_BANDED_TCC 1
+
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+namespace matrix
+{
+
+/**
+ * Replace the band matrix a by its LU decomposition with partial pivoting.
+ * Column j of the band storage holds rows j - kl - ku .. j + kl
+ * contiguously, so the pivot search, the scaling of the multipliers
+ * and the rank-one update of each trailing column all run down
+ * unit-stride columns.
+ */
+template<typename _Tp, typename _VectorInt>
+  void
+  banded_lu_decomp(banded_matrix<_Tp>& a, _VectorInt& index, _Tp& parity)
+  {
+    const auto n = a.rows();
+    const auto kl = a.lower_bandwidth();
+    const auto ku = a.upper_bandwidth();
+    const auto ld = a.leading_dim();
+    const auto kv = kl + ku;
+
+    // The element (j + i, c) of the matrix.
+    auto col = [&a, ld, kv](std::size_t j, std::size_t c)
+		{ return a.data() + kv + j - c + c * ld; };
+
+    parity = _Tp{1};
+
+    // The last column touched by the interchanges so far.
+    std::size_t ju = 0;
+    for (std::size_t j = 0; j < n; ++j)
+      {
+	const auto km = std::min(kl, n - 1 - j);
+	auto ajj = col(j, j);
+
+	// Find the pivot in the km + 1 rows of the band.
+	std::size_t jp = 0;
+	auto big = std::abs(ajj[0]);
+	for (std::size_t i = 1; i <= km; ++i)
+	  if (const auto temp = std::abs(ajj[i]); temp > big)
+	    {
+	      big = temp;
+	      jp = i;
+	    }
+	index[j] = j + jp;
+	if (ajj[jp] == _Tp{0})
+	  std::__throw_logic_error("banded_lu_decomp: singular matrix");
+
+	ju = std::max(ju, std::min(j + ku + jp, n - 1));
+
+	// Interchange rows j and j + jp in columns j..ju.
+	if (jp != 0)
+	  {
+	    parity = -parity;
+	    for (std::size_t c = j; c <= ju; ++c)
+	      {
+		auto ac = col(j, c);
+		std::swap(ac[0], ac[jp]);
+	      }
+	  }
+
+	// Form the multipliers and update the trailing columns of the band.
+	if (km > 0)
+	  {
+	    const auto scale = _Tp{1} / ajj[0];
+	    for (std::size_t i = 1; i <= km; ++i)
+	      ajj[i] *= scale;
+	    for (std::size_t c = j + 1; c <= ju; ++c)
+	      {
+		auto ac = col(j, c);
+		if (const auto t = ac[0]; t != _Tp{0})
+		  for (std::size_t i = 1; i <= km; ++i)
+		    ac[i] -= ajj[i] * t;
+	      }
+	  }
+      }
+  }
+
+
+/**
+ * Solve a.x = b given the band LU decomposition from banded_lu_decomp().
+ * The forward substitution applies the interchanges and the multipliers
+ * column by column as they were formed; the backsubstitution
+ * runs up the columns of U.
+ */
+template<typename _Tp, typename _VectorInt, typename _Vector>
+  void
+  banded_lu_backsub(const banded_matrix<_Tp>& a, const _VectorInt& index,
+		    _Vector& b)
+  {
+    const auto n = a.rows();
+    const auto kl = a.lower_bandwidth();
+    const auto ku = a.upper_bandwidth();
+    const auto ld = a.leading_dim();
+    const auto kv = kl + ku;
+
+    if (n == 0)
+      return;
+
+    // Solve L.y = P.b.
+    for (std::size_t j = 0; j + 1 < n; ++j)
+      {
+	if (const std::size_t l = index[j]; l != j)
+	  std::swap(b[l], b[j]);
+	if (const auto bj = b[j]; bj != _Tp{0})
+	  {
+	    const auto lm = std::min(kl, n - 1 - j);
+	    const auto lj = a.data() + kv + j * ld;
+	    for (std::size_t i = 1; i <= lm; ++i)
+	      b[j + i] -= lj[i] * bj;
+	  }
+      }
+
+    // Solve U.x = y.
+    for (std::size_t j = n; j-- > 0; )
+      {
+	const auto uj = a.data() + kv + j * ld;
+	const auto bj = b[j] /= uj[0];
+	const auto i0 = j > kv ? j - kv : 0;
+	for (std::size_t i = i0; i < j; ++i)
+	  b[i] -= uj[std::ptrdiff_t(i) - std::ptrdiff_t(j)] * bj;
+      }
+  }
+
+
+/**
+ * Replace the symmetric positive definite band matrix a by its Cholesky
+ * factor.  Each column is scaled by the square root of its pivot and
+ * its outer product is subtracted from the kd columns that follow,
+ * each of them updated down its unit-stride length.
+ */
+template<typename _Tp>
+  void
+  banded_cholesky_decomp(symmetric_banded_matrix<_Tp>& a)
+  {
+    const auto n = a.rows();
+    const auto kd = a.bandwidth();
+    const auto ld = a.leading_dim();
+
+    for (std::size_t j = 0; j < n; ++j)
+      {
+	auto lj = a.data() + j * ld;
+	if (lj[0] <= _Tp{0})
+	  std::__throw_logic_error("banded_cholesky_decomp: "
+				   "Matrix must be positive definite");
+	lj[0] = std::sqrt(lj[0]);
+
+	const auto kn = std::min(kd, n - 1 - j);
+	const auto scale = _Tp{1} / lj[0];
+	for (std::size_t i = 1; i <= kn; ++i)
+	  lj[i] *= scale;
+
+	for (std::size_t c = 1; c <= kn; ++c)
+	  {
+	    auto lc = a.data() + (j + c) * ld;
+	    const auto t = lj[c];
+	    for (std::size_t i = c; i <= kn; ++i)
+	      lc[i - c] -= lj[i] * t;
+	  }
+      }
+  }
+
+
+/**
+ * Solve a.x = b given the band Cholesky factor from banded_cholesky_decomp()
+ * by a forward substitution down the columns of L
+ * and a backsubstitution with L~ as dot products along them.
+ */
+template<typename _Tp, typename _Vector>
+  void
+  banded_cholesky_backsub(const symmetric_banded_matrix<_Tp>& a, _Vector& b)
+  {
+    const auto n = a.rows();
+    const auto kd = a.bandwidth();
+    const auto ld = a.leading_dim();
+
+    // Solve L.y = b.
+    for (std::size_t j = 0; j < n; ++j)
+      {
+	const auto lj = a.data() + j * ld;
+	const auto bj = b[j] /= lj[0];
+	const auto kn = std::min(kd, n - 1 - j);
+	for (std::size_t i = 1; i <= kn; ++i)
+	  b[j + i] -= lj[i] * bj;
+      }
+
+    // Solve L~.x = y.
+    for (std::size_t j = n; j-- > 0; )
+      {
+	const auto lj = a.data() + j * ld;
+	const auto kn = std::min(kd, n - 1 - j);
+	auto sum = b[j];
+	for (std::size_t i = 1; i <= kn; ++i)
+	  sum -= lj[i] * b[j + i];
+	b[j] = sum / lj[0];
+      }
+  }
+
+
+template<typename _Tp>
+  banded_lu_decomposition<_Tp>::
+  banded_lu_decomposition(const banded_matrix<_Tp>& a)
+  : banded_lu_decomposition(a.clone())
+  { }
+
+
+template<typename _Tp>
+  banded_lu_decomposition<_Tp>::
+  banded_lu_decomposition(banded_matrix<_Tp>&& a)
+  : m_a(std::move(a)),
+    m_index(m_a.rows()),
+    m_parity{1}
+  {
+    banded_lu_decomp(m_a, m_index, m_parity);
+  }
+
+
+template<typename _Tp>
+  template<typename _Vector, typename _VectorOut>
+    void
+    banded_lu_decomposition<_Tp>::
+    backsubstitute(const _Vector& b, _VectorOut& x) const
+    {
+      for (std::size_t i = 0; i < m_a.rows(); ++i)
+	x[i] = b[i];
+      banded_lu_backsub(m_a, m_index, x);
+    }
+
+
+template<typename _Tp>
+  template<typename InVecIter, typename OutVecIter>
+    void
+    banded_lu_decomposition<_Tp>::
+    backsubstitution(InVecIter b_begin, InVecIter b_end,
+		     OutVecIter x_begin) const
+    {
+      std::vector<_Tp> x(b_begin, b_end);
+      banded_lu_backsub(m_a, m_index, x);
+      std::copy(x.begin(), x.end(), x_begin);
+    }
+
+
+/**
+ * Return the determinant as the signed product of the diagonal of U.
+ */
+template<typename _Tp>
+  _Tp
+  banded_lu_decomposition<_Tp>::determinant() const
+  {
+    auto det = m_parity;
+    for (std::size_t j = 0; j < m_a.rows(); ++j)
+      det *= m_a(j, j);
+    return det;
+  }
+
+
+template<typename _Tp>
+  banded_cholesky_decomposition<_Tp>::
+  banded_cholesky_decomposition(const symmetric_banded_matrix<_Tp>& a)
+  : banded_cholesky_decomposition(a.clone())
+  { }
+
+
+template<typename _Tp>
+  banded_cholesky_decomposition<_Tp>::
+  banded_cholesky_decomposition(symmetric_banded_matrix<_Tp>&& a)
+  : m_a(std::move(a))
+  {
+    banded_cholesky_decomp(m_a);
+  }
+
+
+template<typename _Tp>
+  template<typename _Vector, typename _VectorOut>
+    void
+    banded_cholesky_decomposition<_Tp>::
+    backsubstitute(const _Vector& b, _VectorOut& x) const
+    {
+      for (std::size_t i = 0; i < m_a.rows(); ++i)
+	x[i] = b[i];
+      banded_cholesky_backsub(m_a, x);
+    }
+
+
+template<typename _Tp>
+  template<typename InVecIter, typename OutVecIter>
+    void
+    banded_cholesky_decomposition<_Tp>::
+    backsubstitution(InVecIter b_begin, InVecIter b_end,
+		     OutVecIter x_begin) const
+    {
+      std::vector<_Tp> x(b_begin, b_end);
+      banded_cholesky_backsub(m_a, x);
+      std::copy(x.begin(), x.end(), x_begin);
+    }
+
+} // namespace matrix
+
+#endif // MATRIX_BANDED_TCC
@@ -0,0 +1,137 @@
+#ifndef MATRIX_BATCHED_H
+#define MATRIX_BATCHED_H 1
+
+#include <cstdlib>
+
+#include "matrix_layout.h"
+#include "matrix_thread_pool.h"
+#include "matrix_workspace.h"
+
+namespace matrix
+{
+
+/**
+ * Batched solvers for many independent small systems.
+ *
+ * A batch of count n*n matrices is stored interleaved (structure of arrays):
+ * element (i, j) of matrix m is at a[(i * n + j) * count + m].
+ * Vectors are interleaved the same way: element i of vector m is at
+ * b[i * count + m].  The matrices of a batch are processed in lockstep so
+ * that the innermost loops run across the batch and vectorize.
+ *
+ * The routines with a compile-time size _Dim have all their loop trip
+ * counts fixed; the routines taking a run-time n dispatch to them
+ * for n <= 16.
+ */
+
+/**
+ * Replace each matrix of the batch a by the LU decomposition of a rowwise
+ * permutation of itself with the scaled partial pivoting of lu_decomp().
+ * index[i * count + m] receives the row interchanged with row i of matrix m
+ * and parity[m] its permutation parity.  The factors, the interchanges and
+ * the parities are identical to those lu_decomp() computes for each matrix
+ * in turn.
+ */
+template<std::size_t _Dim, typename _Tp>
+  void
+  lu_decomp_batch(std::size_t count, _Tp* a,
+		  std::size_t* index, _Tp* parity);
+
+template<typename _Tp>
+  void
+  lu_decomp_batch(std::size_t n, std::size_t count, _Tp* a,
+		  std::size_t* index, _Tp* parity);
+
+/**
+ * Solve a.x = b for each system of the batch given the LU decomposition
+ * from lu_decomp_batch().  b is replaced by the solution.
+ */
+template<std::size_t _Dim, typename _Tp>
+  void
+  lu_backsub_batch(std::size_t count, const _Tp* a,
+		   const std::size_t* index, _Tp* b);
+
+template<typename _Tp>
+  void
+  lu_backsub_batch(std::size_t n, std::size_t count, const _Tp* a,
+		   const std::size_t* index, _Tp* b);
+
+/**
+ * Replace each symmetric positive definite matrix of the batch a by its
+ * Cholesky factor as cholesky_decomp() does: the strict lower triangle
+ * holds L, the diagonal of L goes to d and the upper triangle is zeroed.
+ * Throw std::logic_error if any matrix is not positive definite.
+ */
+template<std::size_t _Dim, typename _Tp>
+  void
+  cholesky_decomp_batch(std::size_t count, _Tp* a, _Tp* d);
+
+template<typename _Tp>
+  void
+  cholesky_decomp_batch(std::size_t n, std::size_t count, _Tp* a, _Tp* d);
+
+/**
+ * Solve a.x = b for each system of the batch given the Cholesky
+ * decomposition from cholesky_decomp_batch().  b is replaced by the solution.
+ */
+template<std::size_t _Dim, typename _Tp>
+  void
+  cholesky_backsub_batch(std::size_t count, const _Tp* a, const _Tp* d,
+			 _Tp* b);
+
+template<typename _Tp>
+  void
+  cholesky_backsub_batch(std::size_t n, std::size_t count,
+			 const _Tp* a, const _Tp* d, _Tp* b);
+
+/**
+ * Solve the batch of count tridiagonal systems of size n by the Thomas
+ * algorithm of tridiagonal().  Element i of the subdiagonal a, diagonal b,
+ * superdiagonal c, right-hand side r and solution u of system m is at
+ * [i * count + m]; a[0 * count + m] and c[(n - 1) * count + m] are not used.
+ * The systems are taken in chunks of consecutive lanes, each solved to the
+ * end while its decomposition is in cache, with the inner loops running
+ * across the lanes of a chunk.  a, b, c and r are not modified.
+ * Throw std::runtime_error if a zero pivot is met in any system.
+ */
+template<typename _Tp>
+  void
+  tridiagonal_batch(std::size_t n, std::size_t count,
+		    const _Tp* a, const _Tp* b, const _Tp* c,
+		    const _Tp* r, _Tp* u);
+
+/**
+ * Return the number of elements of workspace needed
+ * by tridiagonal_batch().
+ */
+constexpr std::size_t
+tridiagonal_batch_workspace_size(std::size_t n, std::size_t count) noexcept
+{ return n * count; }
+
+/**
+ * Solve the batch of tridiagonal systems as above without allocating.
+ * work must hold at least tridiagonal_batch_workspace_size(n, count)
+ * elements.
+ */
+template<typename _Tp>
+  void
+  tridiagonal_batch(std::size_t n, std::size_t count,
+		    const _Tp* a, const _Tp* b, const _Tp* c,
+		    const _Tp* r, _Tp* u,
+		    workspace_span<__nondeduced_t<_Tp>> work);
+
+/**
+ * Solve the batch of tridiagonal systems as above with the chunks
+ * of lanes run as tasks on pool.
+ */
+template<typename _Tp>
+  void
+  tridiagonal_batch(std::size_t n, std::size_t count,
+		    const _Tp* a, const _Tp* b, const _Tp* c,
+		    const _Tp* r, _Tp* u, thread_pool& pool);
+
+} // namespace matrix
+
+#include "matrix_batched.tcc"
+
+#endif // MATRIX_BATCHED_H
@@ -0,0 +1,701 @@
+#ifndef MATRIX_BATCHED_TCC
+#define MATRIX_BATCHED_TCC 1
+
+#include <cstdlib>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace matrix
+{
+
+/**
+ * The size in bytes of the widest vector register of the target.
+ */
+#if defined(__AVX512F__)
+  inline constexpr std::size_t __batch_simd_bytes = 64;
+#elif defined(__AVX__)
+  inline constexpr std::size_t __batch_simd_bytes = 32;
+#else
+  inline constexpr std::size_t __batch_simd_bytes = 16;
+#endif
+
+/**
+ * The lanes of a batch processed together: a GCC vector filling
+ * a register for float and double, a single element for other types.
+ * One batch vector holds the same element of __batch_width<_Tp> matrices.
+ */
+template<typename _Tp>
+  struct __batch_simd
+  {
+    using type = _Tp;
+    static constexpr std::size_t width = 1;
+  };
+
+template<>
+  struct __batch_simd<double>
+  {
+    typedef double type __attribute__((vector_size(__batch_simd_bytes)));
+    static constexpr std::size_t width = __batch_simd_bytes / sizeof(double);
+  };
+
+template<>
+  struct __batch_simd<float>
+  {
+    typedef float type __attribute__((vector_size(__batch_simd_bytes)));
+    static constexpr std::size_t width = __batch_simd_bytes / sizeof(float);
+  };
+
+template<typename _Tp>
+  using __batch_vec_t = typename __batch_simd<_Tp>::type;
+
+template<typename _Tp>
+  constexpr std::size_t __batch_width = __batch_simd<_Tp>::width;
+
+/**
+ * Return lane l of a batch vector.
+ */
+template<typename _Tp, typename _Vec>
+  inline _Tp
+  __batch_lane(const _Vec& v, std::size_t l)
+  {
+    if constexpr (__batch_width<_Tp> == 1)
+      return v;
+    else
+      return v[l];
+  }
+
+template<typename _Tp, typename _Vec>
+  inline void
+  __batch_set_lane(_Vec& v, std::size_t l, _Tp x)
+  {
+    if constexpr (__batch_width<_Tp> == 1)
+      v = x;
+    else
+      v[l] = x;
+  }
+
+/**
+ * Return a batch vector with all lanes equal to x.
+ */
+template<typename _Tp>
+  inline __batch_vec_t<_Tp>
+  __batch_splat(_Tp x)
+  {
+    __batch_vec_t<_Tp> v;
+    for (std::size_t l = 0; l < __batch_width<_Tp>; ++l)
+      __batch_set_lane<_Tp>(v, l, x);
+    return v;
+  }
+
+/**
+ * Return true if any lane of the comparison result m is set.
+ */
+template<typename _Tp, typename _Mask>
+  inline bool
+  __batch_any(const _Mask& m)
+  {
+    if constexpr (__batch_width<_Tp> == 1)
+      return m;
+    else
+      {
+	bool any = false;
+	for (std::size_t l = 0; l < __batch_width<_Tp>; ++l)
+	  any |= (m[l] != 0);
+	return any;
+      }
+  }
+
+template<typename _Tp, typename _Vec>
+  inline _Vec
+  __batch_abs(const _Vec& v)
+  {
+    const auto zero = __batch_splat<_Tp>(_Tp{0});
+    return v < zero ? zero - v : v;
+  }
+
+/**
+ * Copy the lanes [m0, m0+w) of a batch of count n*n matrices into tile,
+ * where tile[i * n + j] holds element (i, j) of all the lanes.
+ * The lanes past w are filled with the identity so that a partial chunk
+ * is processed like a full one.
+ * Working on a packed tile keeps the elements of a chunk on consecutive
+ * cache lines; in the batch itself they are count elements apart, which
+ * for count a multiple of a page maps them all to the same cache sets.
+ */
+template<typename _Tp>
+  void
+  __batch_pack(std::size_t n, std::size_t count, std::size_t m0,
+	       std::size_t w, const _Tp* a, __batch_vec_t<_Tp>* tile)
+  {
+    for (std::size_t e = 0; e < n * n; ++e)
+      {
+	if (w < __batch_width<_Tp>)
+	  tile[e] = __batch_splat<_Tp>(e % (n + 1) == 0 ? _Tp{1} : _Tp{0});
+	std::memcpy(&tile[e], a + e * count + m0, w * sizeof(_Tp));
+      }
+  }
+
+/**
+ * Copy the lanes [m0, m0+w) of tile back to the batch a.
+ */
+template<typename _Tp>
+  void
+  __batch_unpack(std::size_t n, std::size_t count, std::size_t m0,
+		 std::size_t w, const __batch_vec_t<_Tp>* tile, _Tp* a)
+  {
+    for (std::size_t e = 0; e < n * n; ++e)
+      std::memcpy(a + e * count + m0, &tile[e], w * sizeof(_Tp));
+  }
+
+/**
+ * Call func(n_ext) with n_ext a std::integral_constant equal to n
+ * for n = 1..16 and with n itself otherwise.
+ */
+template<typename _Func, std::size_t _Dim = 1>
+  void
+  __batch_dispatch(std::size_t n, _Func&& func)
+  {
+    if constexpr (_Dim <= 16)
+      {
+	if (n == _Dim)
+	  func(std::integral_constant<std::size_t, _Dim>{});
+	else
+	  __batch_dispatch<_Func, _Dim + 1>(n, std::forward<_Func>(func));
+      }
+    else
+      func(n);
+  }
+
+/**
+ * Factor the lanes [m0, m0+w) of a batch of LU decompositions.
+ * The extent n_ext is either std::size_t or a std::integral_constant
+ * so that the fixed-size routines have constant trip counts.
+ * work holds (n + 1) * n batch vectors.
+ */
+template<typename _Ext, typename _Tp>
+  void
+  __lu_decomp_batch(_Ext n_ext, std::size_t count, std::size_t m0,
+		    std::size_t w, _Tp* a, std::size_t* index, _Tp* parity,
+		    __batch_vec_t<_Tp>* work)
+  {
+    using _Vec = __batch_vec_t<_Tp>;
+    const std::size_t n = n_ext;
+
+    const auto zero = __batch_splat<_Tp>(_Tp{0});
+    const auto one = __batch_splat<_Tp>(_Tp{1});
+    const auto tiny = __batch_splat<_Tp>(_Tp(1.0e-20L));
+
+    _Vec* tile = work;
+    _Vec* scale = work + n * n;
+    __batch_pack(n, count, m0, w, a, tile);
+
+    auto A = [tile, n](std::size_t i, std::size_t j) -> _Vec&
+	     { return tile[i * n + j]; };
+
+    // Loop over rows to get the implicit scaling information.
+    for (std::size_t i = 0; i < n; ++i)
+      {
+	auto big = zero;
+	for (std::size_t j = 0; j < n; ++j)
+	  {
+	    const auto temp = __batch_abs<_Tp>(A(i, j));
+	    big = temp > big ? temp : big;
+	  }
+	if (__batch_any<_Tp>(big == zero))
+	  std::__throw_logic_error("lu_decomp_batch: singular matrix");
+
+	// Save the scaling for the row.
+	scale[i] = one / big;
+      }
+
+    auto sign = one;
+
+    // This is the loop over columns of Crout's method.
+    for (std::size_t j = 0; j < n; ++j)
+      {
+	// Upper triangle.
+	for (std::size_t i = 0; i < j; ++i)
+	  {
+	    auto sum = A(i, j);
+	    for (std::size_t k = 0; k < i; ++k)
+	      sum -= A(i, k) * A(k, j);
+	    A(i, j) = sum;
+	  }
+
+	// Lower triangle and the search for the largest scaled pivot.
+	// The pivot row is kept as _Tp so that the selects stay in lanes.
+	auto big = zero;
+	auto piv = __batch_splat<_Tp>(_Tp(j));
+	for (std::size_t i = j; i < n; ++i)
+	  {
+	    auto sum = A(i, j);
+	    for (std::size_t k = 0; k < j; ++k)
+	      sum -= A(i, k) * A(k, j);
+	    A(i, j) = sum;
+	    const auto dum = scale[i] * __batch_abs<_Tp>(sum);
+	    const auto take = dum >= big;
+	    big = take ? dum : big;
+	    piv = take ? __batch_splat<_Tp>(_Tp(i)) : piv;
+	  }
+
+	// Interchange rows in the lanes that chose row i,
+	// skipping the rows no lane chose.
+	for (std::size_t i = j + 1; i < n; ++i)
+	  {
+	    const auto swap = piv == __batch_splat<_Tp>(_Tp(i));
+	    if (!__batch_any<_Tp>(swap))
+	      continue;
+	    for (std::size_t k = 0; k < n; ++k)
+	      {
+		const auto tmp = A(j, k);
+		A(j, k) = swap ? A(i, k) : tmp;
+		A(i, k) = swap ? tmp : A(i, k);
+	      }
+	    const auto tmp = scale[j];
+	    scale[j] = swap ? scale[i] : tmp;
+	    scale[i] = swap ? tmp : scale[i];
+	    sign = swap ? zero - sign : sign;
+	  }
+	for (std::size_t l = 0; l < w; ++l)
+	  index[j * count + m0 + l] = std::size_t(__batch_lane<_Tp>(piv, l));
+
+	A(j, j) = A(j, j) == zero ? tiny : A(j, j);
+
+	// Now finally divide by the pivot element.
+	const auto inv = one / A(j, j);
+	for (std::size_t i = j + 1; i < n; ++i)
+	  A(i, j) *= inv;
+      }
+
+    for (std::size_t l = 0; l < w; ++l)
+      parity[m0 + l] = __batch_lane<_Tp>(sign, l);
+    __batch_unpack(n, count, m0, w, tile, a);
+  }
+
+/**
+ * Solve the lanes [m0, m0+w) of a batch of LU systems.
+ * The lanes of a and b are read in place; each element is used once
+ * per system so there is nothing to gain from packing.
+ */
+template<typename _Ext, typename _Tp>
+  void
+  __lu_backsub_batch(_Ext n_ext, std::size_t count, std::size_t m0,
+		     std::size_t w, const _Tp* a, const std::size_t* index,
+		     _Tp* b)
+  {
+    const std::size_t n = n_ext;
+
+    auto A = [a, n, count, m0](std::size_t i, std::size_t j)
+	     { return a + (i * n + j) * count + m0; };
+    auto B = [b, count, m0](std::size_t i)
+	     { return b + i * count + m0; };
+
+    // Forward substitution, unscrambling the permutation as we go.
+    for (std::size_t i = 0; i < n; ++i)
+      {
+	const auto ip = index + i * count + m0;
+	auto bi = B(i);
+	for (std::size_t l = 0; l < w; ++l)
+	  {
+	    const auto sum = b[ip[l] * count + m0 + l];
+	    b[ip[l] * count + m0 + l] = bi[l];
+	    bi[l] = sum;
+	  }
+	for (std::size_t j = 0; j < i; ++j)
+	  {
+	    const auto aij = A(i, j);
+	    const auto bj = B(j);
+	    for (std::size_t l = 0; l < w; ++l)
+	      bi[l] -= aij[l] * bj[l];
+	  }
+      }
+
+    // Backsubstitution.
+    for (std::size_t i = n; i-- > 0;)
+      {
+	auto bi = B(i);
+	for (std::size_t j = i + 1; j < n; ++j)
+	  {
+	    const auto aij = A(i, j);
+	    const auto bj = B(j);
+	    for (std::size_t l = 0; l < w; ++l)
+	      bi[l] -= aij[l] * bj[l];
+	  }
+	const auto aii = A(i, i);
+	for (std::size_t l = 0; l < w; ++l)
+	  bi[l] /= aii[l];
+      }
+  }
+
+/**
+ * Factor the lanes [m0, m0+w) of a batch of Cholesky decompositions.
+ * work holds n * n batch vectors.
+ */
+template<typename _Ext, typename _Tp>
+  void
+  __cholesky_decomp_batch(_Ext n_ext, std::size_t count, std::size_t m0,
+			  std::size_t w, _Tp* a, _Tp* d,
+			  __batch_vec_t<_Tp>* work)
+  {
+    using _Vec = __batch_vec_t<_Tp>;
+    const std::size_t n = n_ext;
+
+    const auto zero = __batch_splat<_Tp>(_Tp{0});
+
+    _Vec* tile = work;
+    __batch_pack(n, count, m0, w, a, tile);
+
+    auto A = [tile, n](std::size_t i, std::size_t j) -> _Vec&
+	     { return tile[i * n + j]; };
+
+    for (std::size_t i = 0; i < n; ++i)
+      {
+	// The diagonal element; a[i][i] itself is left alone.
+	auto sum = A(i, i);
+	for (std::size_t k = i; k-- > 0;)
+	  sum -= A(i, k) * A(i, k);
+	if (__batch_any<_Tp>(sum <= zero))
+	  std::__throw_logic_error("cholesky_decomp_batch: "
+				   "Matrix must be positive definite");
+	auto di = sum;
+	for (std::size_t l = 0; l < __batch_width<_Tp>; ++l)
+	  __batch_set_lane<_Tp>(di, l, std::sqrt(__batch_lane<_Tp>(sum, l)));
+	for (std::size_t l = 0; l < w; ++l)
+	  d[i * count + m0 + l] = __batch_lane<_Tp>(di, l);
+
+	// The column of L below it, formed from the upper triangle.
+	for (std::size_t j = i + 1; j < n; ++j)
+	  {
+	    auto sum = A(i, j);
+	    for (std::size_t k = i; k-- > 0;)
+	      sum -= A(i, k) * A(j, k);
+	    A(j, i) = sum / di;
+	  }
+      }
+
+    for (std::size_t j = 0; j < n; ++j)
+      for (std::size_t i = 0; i < j; ++i)
+	A(i, j) = zero;
+
+    __batch_unpack(n, count, m0, w, tile, a);
+  }
+
+/**
+ * Solve the lanes [m0, m0+w) of a batch of Cholesky systems.
+ */
+template<typename _Ext, typename _Tp>
+  void
+  __cholesky_backsub_batch(_Ext n_ext, std::size_t count, std::size_t m0,
+			   std::size_t w, const _Tp* a, const _Tp* d, _Tp* b)
+  {
+    const std::size_t n = n_ext;
+
+    auto A = [a, n, count, m0](std::size_t i, std::size_t j)
+	     { return a + (i * n + j) * count + m0; };
+    auto D = [d, count, m0](std::size_t i)
+	     { return d + i * count + m0; };
+    auto B = [b, count, m0](std::size_t i)
+	     { return b + i * count + m0; };
+
+    for (std::size_t i = 0; i < n; ++i)
+      {
+	auto bi = B(i);
+	for (std::size_t k = i; k-- > 0;)
+	  {
+	    const auto aik = A(i, k);
+	    const auto bk = B(k);
+	    for (std::size_t l = 0; l < w; ++l)
+	      bi[l] -= aik[l] * bk[l];
+	  }
+	const auto di = D(i);
+	for (std::size_t l = 0; l < w; ++l)
+	  bi[l] /= di[l];
+      }
+    for (std::size_t i = n; i-- > 0;)
+      {
+	auto bi = B(i);
+	for (std::size_t k = i + 1; k < n; ++k)
+	  {
+	    const auto aki = A(k, i);
+	    const auto bk = B(k);
+	    for (std::size_t l = 0; l < w; ++l)
+	      bi[l] -= aki[l] * bk[l];
+	  }
+	const auto di = D(i);
+	for (std::size_t l = 0; l < w; ++l)
+	  bi[l] /= di[l];
+      }
+  }
+
+
+template<std::size_t _Dim, typename _Tp>
+  void
+  lu_decomp_batch(std::size_t count, _Tp* a,
+		  std::size_t* index, _Tp* parity)
+  {
+    constexpr std::size_t W = __batch_width<_Tp>;
+    __batch_vec_t<_Tp> work[(_Dim + 1) * _Dim];
+    for (std::size_t m0 = 0; m0 < count; m0 += W)
+      __lu_decomp_batch(std::integral_constant<std::size_t, _Dim>{},
+			count, m0, std::min(W, count - m0),
+			a, index, parity, work);
+  }
+
+template<typename _Tp>
+  void
+  lu_decomp_batch(std::size_t n, std::size_t count, _Tp* a,
+		  std::size_t* index, _Tp* parity)
+  {
+    __batch_dispatch(n,
+      [=](auto n_ext)
+      {
+	if constexpr (std::is_same_v<decltype(n_ext), std::size_t>)
+	  {
+	    constexpr std::size_t W = __batch_width<_Tp>;
+	    std::vector<__batch_vec_t<_Tp>> work((n + 1) * n);
+	    for (std::size_t m0 = 0; m0 < count; m0 += W)
+	      __lu_decomp_batch(n, count, m0, std::min(W, count - m0),
+				a, index, parity, work.data());
+	  }
+	else
+	  lu_decomp_batch<decltype(n_ext)::value>(count, a, index, parity);
+      });
+  }
+
+template<std::size_t _Dim, typename _Tp>
+  void
+  lu_backsub_batch(std::size_t count, const _Tp* a,
+		   const std::size_t* index, _Tp* b)
+  {
+    constexpr std::size_t W = __batch_width<_Tp>;
+    for (std::size_t m0 = 0; m0 < count; m0 += W)
+      __lu_backsub_batch(std::integral_constant<std::size_t, _Dim>{},
+			 count, m0, std::min(W, count - m0), a, index, b);
+  }
+
+template<typename _Tp>
+  void
+  lu_backsub_batch(std::size_t n, std::size_t count, const _Tp* a,
+		   const std::size_t* index, _Tp* b)
+  {
+    constexpr std::size_t W = __batch_width<_Tp>;
+    __batch_dispatch(n,
+      [=](auto n_ext)
+      {
+	for (std::size_t m0 = 0; m0 < count; m0 += W)
+	  __lu_backsub_batch(n_ext, count, m0, std::min(W, count - m0),
+			     a, index, b);
+      });
+  }
+
+template<std::size_t _Dim, typename _Tp>
+  void
+  cholesky_decomp_batch(std::size_t count, _Tp* a, _Tp* d)
+  {
+    constexpr std::size_t W = __batch_width<_Tp>;
+    __batch_vec_t<_Tp> work[_Dim * _Dim];
+    for (std::size_t m0 = 0; m0 < count; m0 += W)
+      __cholesky_decomp_batch(std::integral_constant<std::size_t, _Dim>{},
+			      count, m0, std::min(W, count - m0), a, d, work);
+  }
+
+template<typename _Tp>
+  void
+  cholesky_decomp_batch(std::size_t n, std::size_t count, _Tp* a, _Tp* d)
+  {
+    __batch_dispatch(n,
+      [=](auto n_ext)
+      {
+	if constexpr (std::is_same_v<decltype(n_ext), std::size_t>)
+	  {
+	    constexpr std::size_t W = __batch_width<_Tp>;
+	    std::vector<__batch_vec_t<_Tp>> work(n * n);
+	    for (std::size_t m0 = 0; m0 < count; m0 += W)
+	      __cholesky_decomp_batch(n, count, m0, std::min(W, count - m0),
+				      a, d, work.data());
+	  }
+	else
+	  cholesky_decomp_batch<decltype(n_ext)::value>(count, a, d);
+      });
+  }
+
+template<std::size_t _Dim, typename _Tp>
+  void
+  cholesky_backsub_batch(std::size_t count, const _Tp* a, const _Tp* d,
+			 _Tp* b)
+  {
+    constexpr std::size_t W = __batch_width<_Tp>;
+    for (std::size_t m0 = 0; m0 < count; m0 += W)
+      __cholesky_backsub_batch(std::integral_constant<std::size_t, _Dim>{},
+			       count, m0, std::min(W, count - m0), a, d, b);
+  }
+
+template<typename _Tp>
+  void
+  cholesky_backsub_batch(std::size_t n, std::size_t count,
+			 const _Tp* a, const _Tp* d, _Tp* b)
+  {
+    constexpr std::size_t W = __batch_width<_Tp>;
+    __batch_dispatch(n,
+      [=](auto n_ext)
+      {
+	for (std::size_t m0 = 0; m0 < count; m0 += W)
+	  __cholesky_backsub_batch(n_ext, count, m0, std::min(W, count - m0),
+				   a, d, b);
+      });
+  }
+
+/**
+ * The number of systems of a batch of tridiagonal systems
+ * solved together by one pass of the Thomas algorithm.
+ */
+inline constexpr std::size_t __tridiag_batch_chunk = 256;
+
+/**
+ * Solve the lanes [m0, m0+w) of a batch of tridiagonal systems.
+ * gam[j * count + m] receives c[j] / bet[j] for the back substitution.
+ * Return true if a zero pivot was met; the lanes are still run to the end
+ * so that the loops carry no early exit and vectorize.
+ */
+template<typename _Tp>
+  bool
+  __tridiagonal_batch(std::size_t n, std::size_t count,
+		      std::size_t m0, std::size_t w,
+		      const _Tp* a, const _Tp* b, const _Tp* c,
+		      const _Tp* r, _Tp* u, _Tp* gam)
+  {
+    int zero = 0;
+
+    {
+      const auto b0 = b + m0;
+      const auto c0 = c + m0;
+      const auto r0 = r + m0;
+      auto u0 = u + m0;
+      auto g0 = gam + m0;
+      for (std::size_t l = 0; l < w; ++l)
+	{
+	  zero |= (b0[l] == _Tp{0});
+	  if (n > 1)
+	    g0[l] = c0[l] / b0[l];
+	  u0[l] = r0[l] / b0[l];
+	}
+    }
+
+    // Decomposition and forward substitution.
+    for (std::size_t j = 1; j < n; ++j)
+      {
+	const auto aj = a + j * count + m0;
+	const auto bj = b + j * count + m0;
+	const auto rj = r + j * count + m0;
+	const auto gp = gam + (j - 1) * count + m0;
+	const auto up = u + (j - 1) * count + m0;
+	auto uj = u + j * count + m0;
+	if (j + 1 < n)
+	  {
+	    const auto cj = c + j * count + m0;
+	    auto gj = gam + j * count + m0;
+	    for (std::size_t l = 0; l < w; ++l)
+	      {
+		const auto bet = bj[l] - aj[l] * gp[l];
+		zero |= (bet == _Tp{0});
+		gj[l] = cj[l] / bet;
+		uj[l] = (rj[l] - aj[l] * up[l]) / bet;
+	      }
+	  }
+	else
+	  for (std::size_t l = 0; l < w; ++l)
+	    {
+	      const auto bet = bj[l] - aj[l] * gp[l];
+	      zero |= (bet == _Tp{0});
+	      uj[l] = (rj[l] - aj[l] * up[l]) / bet;
+	    }
+      }
+
+    // Backsubstitution.
+    for (std::size_t j = n - 1; j-- > 0; )
+      {
+	const auto gj = gam + j * count + m0;
+	const auto un = u + (j + 1) * count + m0;
+	auto uj = u + j * count + m0;
+	for (std::size_t l = 0; l < w; ++l)
+	  uj[l] -= gj[l] * un[l];
+      }
+
+    return zero != 0;
+  }
+
+template<typename _Tp>
+  void
+  tridiagonal_batch(std::size_t n, std::size_t count,
+		    const _Tp* a, const _Tp* b, const _Tp* c,
+		    const _Tp* r, _Tp* u)
+  {
+    std::vector<_Tp> work(tridiagonal_batch_workspace_size(n, count));
+    tridiagonal_batch(n, count, a, b, c, r, u, workspace_span<_Tp>(work));
+  }
+
+template<typename _Tp>
+  void
+  tridiagonal_batch(std::size_t n, std::size_t count,
+		    const _Tp* a, const _Tp* b, const _Tp* c,
+		    const _Tp* r, _Tp* u,
+		    workspace_span<__nondeduced_t<_Tp>> work)
+  {
+    constexpr std::size_t W = __tridiag_batch_chunk;
+
+    if (n == 0)
+      return;
+    auto gam = work.take(n * count);
+    bool zero = false;
+    for (std::size_t m0 = 0; m0 < count; m0 += W)
+      zero |= __tridiagonal_batch(n, count, m0, std::min(W, count - m0),
+				  a, b, c, r, u, gam);
+    if (zero)
+      std::__throw_runtime_error("Zero pivot in tridiagonal_batch.");
+  }
+
+template<typename _Tp>
+  void
+  tridiagonal_batch(std::size_t n, std::size_t count,
+		    const _Tp* a, const _Tp* b, const _Tp* c,
+		    const _Tp* r, _Tp* u, thread_pool& pool)
+  {
+    constexpr std::size_t W = __tridiag_batch_chunk;
+
+    if (n == 0)
+      return;
+    std::vector<_Tp> gam(tridiagonal_batch_workspace_size(n, count));
+    const auto n_chunks = (count + W - 1) / W;
+    const auto n_tasks = std::max<std::size_t>(1,
+				std::min(n_chunks, pool.size() + 1));
+    std::vector<char> zero(n_tasks);
+    auto chunks = [&](std::size_t t)
+      {
+	bool z = false;
+	for (std::size_t k = t * n_chunks / n_tasks;
+	     k < (t + 1) * n_chunks / n_tasks; ++k)
+	  z |= __tridiagonal_batch(n, count, k * W,
+				   std::min(W, count - k * W),
+				   a, b, c, r, u, gam.data());
+	zero[t] = z;
+      };
+
+    {
+      task_group tasks(pool);
+      for (std::size_t t = 1; t < n_tasks; ++t)
+	tasks.run([&chunks, t]{ chunks(t); });
+      chunks(0);
+      tasks.wait();
+    }
+    for (auto z : zero)
+      if (z)
+	std::__throw_runtime_error("Zero pivot in tridiagonal_batch.");
+  }
+
+} // namespace matrix
+
+#endif // MATRIX_BATCHED_TCC
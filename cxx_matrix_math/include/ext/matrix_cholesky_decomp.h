@@ -1,25 +1,53 @@
 #ifndef MATRIX_CHOLESKY_DECOMP_H
 #define MATRIX_CHOLESKY_DECOMP_H 1
 
+#include <vector>
+
+#include "matrix_dense.h"
+#include "matrix_layout.h"
+#include "matrix_thread_pool.h"
+
 namespace matrix
 {
 
+/**
+ * The algorithms available for computing the Cholesky decomposition.
+ */
+enum class cholesky_algorithm
+{
+  /// The unblocked row-by-row loop.
+  unblocked,
+  /// The blocked right-looking loop with the trailing update done by gemm.
+  blocked,
+  /// The blocked loop with the trailing tiles updated on a thread pool.
+  parallel
+};
+
 /**
  * This class represents a Cholesky decomposition of a square matrix.
+ * The factor is held in a matrix of type _Storage,
+ * by default an aligned, contiguous dense_matrix.
  */
-template<typename _HermitianMatrix, typename _Vector>
+template<typename _HermitianMatrix, typename _Vector,
+	 typename _Storage = dense_matrix<__matrix_value_t<_HermitianMatrix>>>
   class cholesky_decomposition
   {
 
   public:
 
-    using value_type = decltype(_HermitianMatrix{}[0][0]);
+    using value_type = __matrix_value_t<_HermitianMatrix>;
+
+    template<typename _HermitianMatrix2>
+      cholesky_decomposition(std::size_t n, const _HermitianMatrix2& a,
+			     cholesky_algorithm alg
+				 = cholesky_algorithm::unblocked);
 
-    template<typename _HermitianMatrix2, typename _Vector2>
-      cholesky_decomposition(std::size_t n, const _HermitianMatrix2& a, _Vector2& d);
+    template<typename _HermitianMatrix2>
+      cholesky_decomposition(std::size_t n, const _HermitianMatrix2& a,
+			     thread_pool& pool);
 
     template<typename _Vector2, typename _VectorOut>
-      void backsubstitute(const _Vector2  b, _VectorOut& x) const;
+      void backsubstitute(const _Vector2& b, _VectorOut& x) const;
 
     template<typename InVecIter, typename OutVecIter>
       void
@@ -29,11 +57,25 @@ template<typename _HermitianMatrix, typename _Vector>
     template<typename _HermitianMatrix2>
       void inverse(_HermitianMatrix2& a_inv) const;
 
+    /**
+     * Update the decomposition to that of a + u.u~ in O(n^2).
+     */
+    template<typename _Vector2>
+      void update(const _Vector2& u);
+
+    /**
+     * Update the decomposition to that of a - u.u~ in O(n^2).
+     * Throw std::logic_error, leaving the decomposition unchanged,
+     * if a - u.u~ is not positive definite.
+     */
+    template<typename _Vector2>
+      void downdate(const _Vector2& u);
+
   private:
 
     std::size_t m_n;
 
-    _HermitianMatrix m_a;
+    _Storage m_a;
 
     std::vector<value_type> m_d;
   };
@@ -45,6 +87,45 @@ template<typename _HermitianMatrix, typename _Vector>
   void
   cholesky_decomp(std::size_t n, _HermitianMatrix& a, _Vector& d);
 
+/**
+ * Compute the Cholesky decomposition of a[0..n-1][0..n-1] with
+ * the algorithm alg.  The factor L is returned in the strict lower
+ * triangle of a and its diagonal in d, as cholesky_decomp() does;
+ * the blocked algorithms differ only in what they leave elsewhere in a.
+ */
+template<typename _HermitianMatrix, typename _Vector>
+  void
+  cholesky_decomp(std::size_t n, _HermitianMatrix& a, _Vector& d,
+		  cholesky_algorithm alg);
+
+/**
+ * Compute the Cholesky decomposition of a[0..n-1][0..n-1] by a blocked
+ * right-looking loop.  Each diagonal tile of block_size columns is factored,
+ * the tiles below it are solved against it and the trailing lower triangle
+ * is updated with the packed gemm kernel.
+ * Only the lower triangle of a is read or written: on output it holds L
+ * including its diagonal, which is also returned in d, and the strict upper
+ * triangle is left untouched.
+ */
+template<typename _HermitianMatrix, typename _Vector>
+  void
+  cholesky_decomp_blocked(std::size_t n, _HermitianMatrix& a, _Vector& d,
+			  std::size_t block_size = 128);
+
+/**
+ * Compute the Cholesky decomposition of a[0..n-1][0..n-1] by the blocked
+ * loop of cholesky_decomp_blocked() with the trailing update split into
+ * block_size square tiles that run as tasks on pool.
+ * The next column panel is updated and factored on the calling thread
+ * while the remaining tiles are being updated.
+ * The output is the same as for cholesky_decomp_blocked().
+ */
+template<typename _HermitianMatrix, typename _Vector>
+  void
+  cholesky_decomp_parallel(std::size_t n, _HermitianMatrix& a, _Vector& d,
+			   thread_pool& pool = default_thread_pool(),
+			   std::size_t block_size = 128);
+
 /**
  * Solve the system @f$ Ax = b @f$ with a Cholesky decomposition.
  */
@@ -53,13 +134,40 @@ template<typename _HermitianMatrix, typename _Vector>
   cholesky_backsub(std::size_t n, const _HermitianMatrix& a,
 		   const _Vector& d, const _Vector& b, _Vector& x);
 
+/**
+ * Given the Cholesky decomposition of a in the strict lower triangle of
+ * a[0..n-1][0..n-1] and in d, as cholesky_decomp() leaves it, replace it by
+ * that of a + u.u~.  Each row of L in turn is rotated against u by the
+ * rotations of the rows above, as in LINPACK's dchud, so that L is read
+ * along its rows.  The work is O(n^2).
+ */
+template<typename _HermitianMatrix, typename _Vector, typename _VectorU>
+  void
+  cholesky_update(std::size_t n, _HermitianMatrix& a, _Vector& d,
+		  const _VectorU& u);
+
+/**
+ * Given the Cholesky decomposition of a as for cholesky_update(),
+ * replace it by that of a - u.u~.  The solution p of L.p = u is formed
+ * first: a - u.u~ is positive definite if and only if p.p < 1, and if not
+ * std::logic_error is thrown with a and d unchanged.  Otherwise the
+ * rotations that carry (sqrt(1 - p.p), p) into a multiple of e_0
+ * are applied to the rows of L, as in LINPACK's dchdd.
+ * The work is O(n^2).
+ */
+template<typename _HermitianMatrix, typename _Vector, typename _VectorU>
+  void
+  cholesky_downdate(std::size_t n, _HermitianMatrix& a, _Vector& d,
+		    const _VectorU& u);
+
 /**
  * 
  */
-template<typename _HermitianMatrix, typename _Vector>
+template<typename _HermitianMatrix, typename _Vector,
+	 typename _HermitianMatrixInv>
   void
   cholesky_invert(std::size_t n, const _HermitianMatrix& a, const _Vector& d,
-		  _HermitianMatrix& a_inv);
+		  _HermitianMatrixInv& a_inv);
 
 } // namespace matrix
 
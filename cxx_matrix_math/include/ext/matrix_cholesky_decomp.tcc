@@ -3,10 +3,15 @@
 
 
 #include <cstdlib>
+#include <algorithm>
 #include <cmath>
 #include <stdexcept>
+#include <type_traits>
 #include <vector>
 
+#include "matrix_gemm.h"
+#include "matrix_layout.h"
+
 
 namespace matrix
 {
@@ -19,13 +24,15 @@ template<typename _HermitianMatrix, typename _Vector>
   void
   cholesky_decomp(std::size_t n, _HermitianMatrix& a, _Vector& d)
   {
+    auto A = __elem_access(a);
+
     for (std::size_t i = 0; i < n; ++i)
       {
 	for (std::size_t j = 0; j < n; ++j)
 	  {
-	    auto sum = a[i][j];
+	    auto sum = A(i, j);
 	    for (std::ptrdiff_t k = i - 1; k >= 0; --k)
-	      sum -= a[i][k] * a[j][k];
+	      sum -= A(i, k) * A(j, k);
 	    if (i == j)
 	      {
 		if (sum <= 0)
@@ -34,12 +41,185 @@ template<typename _HermitianMatrix, typename _Vector>
 		d[i] = std::sqrt(sum);
 	      }
 	    else
-	      a[j][i] = sum / d[i];
+	      A(j, i) = sum / d[i];
 	  }
       }
     for (std::size_t j = 0; j < n; ++j)
       for (std::size_t i = 0; i < j; ++i)
-	a[i][j] = 0;
+	A(i, j) = 0;
+  }
+
+
+/**
+ * Compute the Cholesky decomposition of a[0..n-1][0..n-1]
+ * with the algorithm alg.
+ */
+template<typename _HermitianMatrix, typename _Vector>
+  void
+  cholesky_decomp(std::size_t n, _HermitianMatrix& a, _Vector& d,
+		  cholesky_algorithm alg)
+  {
+    switch (alg)
+      {
+      case cholesky_algorithm::blocked:
+	cholesky_decomp_blocked(n, a, d);
+	break;
+      case cholesky_algorithm::parallel:
+	cholesky_decomp_parallel(n, a, d);
+	break;
+      case cholesky_algorithm::unblocked:
+      default:
+	cholesky_decomp(n, a, d);
+	break;
+      }
+  }
+
+
+/**
+ * Factor the diagonal tile at rows and columns [k0, k1) and solve
+ * the rows [k1, i_end) below it against it, the updates from
+ * the columns left of k0 having been applied already.
+ * The diagonal of L is stored both in the tile and in d.
+ */
+template<typename _ElemA, typename _Vector>
+  void
+  __cholesky_factor_panel(_ElemA A, _Vector& d,
+			  std::size_t k0, std::size_t k1, std::size_t i_end,
+			  const char* msg)
+  {
+    for (std::size_t j = k0; j < k1; ++j)
+      {
+	auto sum = A(j, j);
+	for (std::size_t k = k0; k < j; ++k)
+	  sum -= A(j, k) * A(j, k);
+	if (sum <= 0)
+	  std::__throw_logic_error(msg);
+	d[j] = std::sqrt(sum);
+	A(j, j) = d[j];
+	for (std::size_t i = j + 1; i < k1; ++i)
+	  {
+	    auto sum = A(i, j);
+	    for (std::size_t k = k0; k < j; ++k)
+	      sum -= A(i, k) * A(j, k);
+	    A(i, j) = sum / d[j];
+	  }
+      }
+
+    for (std::size_t i = k1; i < i_end; ++i)
+      for (std::size_t j = k0; j < k1; ++j)
+	{
+	  auto sum = A(i, j);
+	  for (std::size_t k = k0; k < j; ++k)
+	    sum -= A(i, k) * A(j, k);
+	  A(i, j) = sum / d[j];
+	}
+  }
+
+
+/**
+ * Subtract L[i0..i1-1][k0..k1-1].L[j0..j1-1][k0..k1-1]^T from the block
+ * of rows [i0, i1) and columns [j0, j1) of the lower triangle.
+ * Where the block crosses the diagonal the products falling in
+ * the upper triangle go to a scratch element so that it is never written.
+ */
+template<typename _ElemA>
+  void
+  __cholesky_update_tile(_ElemA A,
+			 std::size_t i0, std::size_t i1,
+			 std::size_t j0, std::size_t j1,
+			 std::size_t k0, std::size_t k1)
+  {
+    using _NumTp = std::decay_t<decltype(A(0, 0))>;
+
+    _NumTp upper{};
+    __gemm(i1 - i0, j1 - j0, k1 - k0, _NumTp{-1},
+	   [A, i0, k0](std::size_t i, std::size_t k) -> const _NumTp&
+	   { return A(i0 + i, k0 + k); },
+	   [A, j0, k0](std::size_t k, std::size_t j) -> const _NumTp&
+	   { return A(j0 + j, k0 + k); },
+	   _NumTp{1},
+	   [A, i0, j0, &upper](std::size_t i, std::size_t j) -> _NumTp&
+	   { return j0 + j > i0 + i ? upper : A(i0 + i, j0 + j); });
+  }
+
+
+/**
+ * Compute the Cholesky decomposition of a[0..n-1][0..n-1] by a blocked
+ * right-looking loop touching only the lower triangle.
+ */
+template<typename _HermitianMatrix, typename _Vector>
+  void
+  cholesky_decomp_blocked(std::size_t n, _HermitianMatrix& a, _Vector& d,
+			  std::size_t block_size)
+  {
+    if (block_size == 0)
+      block_size = 1;
+
+    auto A = __elem_access(a);
+
+    for (std::size_t k0 = 0; k0 < n; k0 += block_size)
+      {
+	const auto k1 = std::min(k0 + block_size, n);
+
+	__cholesky_factor_panel(A, d, k0, k1, n, "cholesky_decomp_blocked: "
+				"Matrix must be positive definite");
+
+	// Update the trailing lower triangle a block column at a time.
+	for (std::size_t j0 = k1; j0 < n; j0 += block_size)
+	  {
+	    const auto j1 = std::min(j0 + block_size, n);
+	    __cholesky_update_tile(A, j0, n, j0, j1, k0, k1);
+	  }
+      }
+  }
+
+
+/**
+ * Compute the Cholesky decomposition of a[0..n-1][0..n-1] by the blocked
+ * right-looking loop with the trailing tiles updated as tasks on pool.
+ */
+template<typename _HermitianMatrix, typename _Vector>
+  void
+  cholesky_decomp_parallel(std::size_t n, _HermitianMatrix& a, _Vector& d,
+			   thread_pool& pool, std::size_t block_size)
+  {
+    if (block_size == 0)
+      block_size = 1;
+
+    if (n == 0)
+      return;
+
+    auto A = __elem_access(a);
+    const auto msg = "cholesky_decomp_parallel: "
+		     "Matrix must be positive definite";
+
+    __cholesky_factor_panel(A, d, 0, std::min(block_size, n), n, msg);
+    for (std::size_t k0 = 0; k0 < n; k0 += block_size)
+      {
+	const auto k1 = std::min(k0 + block_size, n);
+	if (k1 == n)
+	  break;
+
+	// The tiles right of the next panel are independent tasks...
+	const auto k2 = std::min(k1 + block_size, n);
+	task_group tiles(pool);
+	for (std::size_t j0 = k2; j0 < n; j0 += block_size)
+	  {
+	    const auto j1 = std::min(j0 + block_size, n);
+	    for (std::size_t i0 = j0; i0 < n; i0 += block_size)
+	      {
+		const auto i1 = std::min(i0 + block_size, n);
+		tiles.run([A, i0, i1, j0, j1, k0, k1]()
+			  { __cholesky_update_tile(A, i0, i1, j0, j1, k0, k1); });
+	      }
+	  }
+
+	// ... while the next panel is updated and factored here.
+	__cholesky_update_tile(A, k1, n, k1, k2, k0, k1);
+	__cholesky_factor_panel(A, d, k1, k2, n, msg);
+
+	tiles.wait();
+      }
   }
 
 
@@ -51,52 +231,228 @@ template<typename _HermitianMatrix, typename _Vector>
   cholesky_backsub(std::size_t n, const _HermitianMatrix& a,
 		   const _Vector& d, const _Vector& b, _Vector& x)
   {
+    auto A = __elem_access(a);
+
     for (std::size_t i = 0; i < n; ++i)
       {
 	auto sum = b[i];
 	for (std::ptrdiff_t k = i - 1; k >= 0; --k)
-	  sum -= a[i][k] * x[k];
+	  sum -= A(i, k) * x[k];
 	x[i] = sum / d[i];
       }
     for (std::ptrdiff_t i = n - 1; i >= 0; --i)
       {
 	auto sum = x[i];
 	for (std::size_t k = i + 1; k < n; ++k)
-	  sum -= a[k][i] * x[k];
+	  sum -= A(k, i) * x[k];
 	x[i] = sum / d[i];
       }
   }
 
 
+/**
+ * Replace the Cholesky decomposition of a by that of a + u.u~.
+ */
+template<typename _HermitianMatrix, typename _Vector, typename _VectorU>
+  void
+  cholesky_update(std::size_t n, _HermitianMatrix& a, _Vector& d,
+		  const _VectorU& u)
+  {
+    using _NumTp = __matrix_value_t<_HermitianMatrix>;
+
+    auto A = __elem_access(a);
+
+    std::vector<_NumTp> c(n), s(n);
+    for (std::size_t j = 0; j < n; ++j)
+      {
+	//  Apply the rotations of the rows above to row j and u[j].
+	_NumTp x = u[j];
+	for (std::size_t i = 0; i < j; ++i)
+	  {
+	    const auto l = A(j, i);
+	    A(j, i) = c[i] * l + s[i] * x;
+	    x = c[i] * x - s[i] * l;
+	  }
+	const auto r = std::hypot(d[j], x);
+	c[j] = d[j] / r;
+	s[j] = x / r;
+	d[j] = r;
+      }
+  }
+
+
+/**
+ * Replace the Cholesky decomposition of a by that of a - u.u~.
+ */
+template<typename _HermitianMatrix, typename _Vector, typename _VectorU>
+  void
+  cholesky_downdate(std::size_t n, _HermitianMatrix& a, _Vector& d,
+		    const _VectorU& u)
+  {
+    using _NumTp = __matrix_value_t<_HermitianMatrix>;
+
+    auto A = __elem_access(a);
+
+    //  Solve L.p = u.
+    std::vector<_NumTp> p(n);
+    _NumTp norm2 = _NumTp{0};
+    for (std::size_t i = 0; i < n; ++i)
+      {
+	auto sum = _NumTp(u[i]);
+	for (std::size_t k = 0; k < i; ++k)
+	  sum -= A(i, k) * p[k];
+	p[i] = sum / d[i];
+	norm2 += p[i] * p[i];
+      }
+    if (!(norm2 < _NumTp{1}))
+      std::__throw_logic_error("cholesky_downdate: "
+			       "Matrix must remain positive definite");
+
+    //  The rotations carrying (alpha, p) into (1, 0).
+    std::vector<_NumTp> c(n), s(n);
+    auto alpha = std::sqrt(_NumTp{1} - norm2);
+    for (std::size_t i = n; i-- > 0; )
+      {
+	const auto scale = alpha + std::abs(p[i]);
+	const auto aa = alpha / scale;
+	const auto bb = p[i] / scale;
+	const auto norm = std::hypot(aa, bb);
+	c[i] = aa / norm;
+	s[i] = bb / norm;
+	alpha = scale * norm;
+      }
+
+    //  Apply them to each row of L from the diagonal back.
+    for (std::size_t j = 0; j < n; ++j)
+      {
+	_NumTp x = _NumTp{0};
+	for (std::size_t i = j + 1; i-- > 0; )
+	  {
+	    auto& l = (i == j ? d[j] : A(j, i));
+	    const auto t = c[i] * x + s[i] * l;
+	    l = c[i] * l - s[i] * x;
+	    x = t;
+	  }
+      }
+
+    //  Keep the diagonal positive; roundoff could flip a tiny one.
+    for (std::size_t j = 0; j < n; ++j)
+      if (d[j] < _NumTp{0})
+	{
+	  d[j] = -d[j];
+	  for (std::size_t i = j + 1; i < n; ++i)
+	    A(i, j) = -A(i, j);
+	}
+  }
+
+
 /**
  * 
  */
-template<typename _HermitianMatrix, typename _Vector>
+template<typename _HermitianMatrix, typename _Vector,
+	 typename _HermitianMatrixInv>
   void
   cholesky_invert(std::size_t n, const _HermitianMatrix& a, const _Vector& d,
-		  _HermitianMatrix& a_inv)
+		  _HermitianMatrixInv& a_inv)
   {
     using NumTp = std::decay_t<decltype(a[0][0])>;
 
+    auto A = __elem_access(a);
+    auto A_inv = __elem_access(a_inv);
+
     for (std::ptrdiff_t i = 0; i < std::ptrdiff_t(n); ++i)
       for (std::ptrdiff_t j = 0; j <= i; ++j)
 	{
 	  auto sum = (j == i ? NumTp{1} : NumTp{0});
 	  for (std::ptrdiff_t k = i - 1; k >= j; --k)
-	    sum -= a[i][k] * a_inv[j][k];
-	  a_inv[j][i] = sum / d[i];
+	    sum -= A(i, k) * A_inv(j, k);
+	  A_inv(j, i) = sum / d[i];
 	}
 
     for (std::ptrdiff_t i = n - 1; i >= 0; --i)
       for (std::ptrdiff_t j = 0; j <= i; ++j)
 	{
-	  auto sum = (i < j ? NumTp{0} : a_inv[j][i]);
+	  auto sum = (i < j ? NumTp{0} : A_inv(j, i));
 	  for (std::ptrdiff_t k = i + 1; k < std::ptrdiff_t(n); ++k)
-	    sum -= a[k][i] * a_inv[j][k];
-	  a_inv[i][j] = a_inv[j][i] = sum / d[i];
+	    sum -= A(k, i) * A_inv(j, k);
+	  A_inv(i, j) = A_inv(j, i) = sum / d[i];
 	}
   }
 
+
+template<typename _HermitianMatrix, typename _Vector, typename _Storage>
+  template<typename _HermitianMatrix2>
+    cholesky_decomposition<_HermitianMatrix, _Vector, _Storage>::
+    cholesky_decomposition(std::size_t n, const _HermitianMatrix2& a,
+			   cholesky_algorithm alg)
+    : m_n(n), m_a(__make_storage<_Storage>(n, n, a)), m_d(n)
+    {
+      cholesky_decomp(m_n, m_a, m_d, alg);
+    }
+
+template<typename _HermitianMatrix, typename _Vector, typename _Storage>
+  template<typename _HermitianMatrix2>
+    cholesky_decomposition<_HermitianMatrix, _Vector, _Storage>::
+    cholesky_decomposition(std::size_t n, const _HermitianMatrix2& a,
+			   thread_pool& pool)
+    : m_n(n), m_a(__make_storage<_Storage>(n, n, a)), m_d(n)
+    {
+      cholesky_decomp_parallel(m_n, m_a, m_d, pool);
+    }
+
+template<typename _HermitianMatrix, typename _Vector, typename _Storage>
+  template<typename _Vector2, typename _VectorOut>
+    void
+    cholesky_decomposition<_HermitianMatrix, _Vector, _Storage>::
+    backsubstitute(const _Vector2& b, _VectorOut& x) const
+    {
+      std::vector<value_type> bb(m_n), xx(m_n);
+      for (std::size_t i = 0; i < m_n; ++i)
+	bb[i] = b[i];
+      cholesky_backsub(m_n, m_a, m_d, bb, xx);
+      for (std::size_t i = 0; i < m_n; ++i)
+	x[i] = xx[i];
+    }
+
+template<typename _HermitianMatrix, typename _Vector, typename _Storage>
+  template<typename InVecIter, typename OutVecIter>
+    void
+    cholesky_decomposition<_HermitianMatrix, _Vector, _Storage>::
+    backsubstitution(InVecIter b_begin, InVecIter b_end,
+		     OutVecIter x_begin) const
+    {
+      std::vector<value_type> bb(b_begin, b_end), xx(m_n);
+      cholesky_backsub(m_n, m_a, m_d, bb, xx);
+      std::copy(xx.begin(), xx.end(), x_begin);
+    }
+
+template<typename _HermitianMatrix, typename _Vector, typename _Storage>
+  template<typename _HermitianMatrix2>
+    void
+    cholesky_decomposition<_HermitianMatrix, _Vector, _Storage>::
+    inverse(_HermitianMatrix2& a_inv) const
+    {
+      cholesky_invert(m_n, m_a, m_d, a_inv);
+    }
+
+template<typename _HermitianMatrix, typename _Vector, typename _Storage>
+  template<typename _Vector2>
+    void
+    cholesky_decomposition<_HermitianMatrix, _Vector, _Storage>::
+    update(const _Vector2& u)
+    {
+      cholesky_update(m_n, m_a, m_d, u);
+    }
+
+template<typename _HermitianMatrix, typename _Vector, typename _Storage>
+  template<typename _Vector2>
+    void
+    cholesky_decomposition<_HermitianMatrix, _Vector, _Storage>::
+    downdate(const _Vector2& u)
+    {
+      cholesky_downdate(m_n, m_a, m_d, u);
+    }
+
 } // namespace matrix
 
 #endif // MATRIX_CHOLESKY_DECOMP_TCC
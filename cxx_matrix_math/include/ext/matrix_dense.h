@@ -0,0 +1,234 @@
+#ifndef MATRIX_DENSE_H
+#define MATRIX_DENSE_H 1
+
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "matrix_layout.h"
+
+namespace matrix
+{
+
+/**
+ * An owning dense matrix in the spirit of mdarray (P1684).
+ * The elements live in a single block aligned to a 64-byte cache line.
+ * The leading dimension is padded to a whole number of cache lines
+ * and kept off multiples of 4096 bytes so that consecutive rows
+ * (or columns) do not map to the same cache sets.
+ * The matrix is move-only; use clone() for an explicit deep copy.
+ */
+template<typename _Tp, typename _Layout = layout_right>
+  class dense_matrix
+  {
+  public:
+
+    using value_type = _Tp;
+    using layout_type = _Layout;
+
+    static constexpr std::size_t alignment = 64;
+
+    dense_matrix() noexcept = default;
+
+    /**
+     * Construct a value-initialized n_rows * n_cols matrix.
+     */
+    dense_matrix(std::size_t n_rows, std::size_t n_cols)
+    : m_rows(n_rows), m_cols(n_cols),
+      m_ld(padded_leading_dim(std::is_same_v<_Layout, layout_left>
+			      ? n_rows : n_cols))
+    {
+      const auto n_elem = this->storage_size();
+      if (n_elem == 0)
+	return;
+      m_data = static_cast<_Tp*>(::operator new(n_elem * sizeof(_Tp),
+						std::align_val_t{alignment}));
+      std::uninitialized_value_construct_n(m_data, n_elem);
+    }
+
+    /**
+     * Construct an n_rows * n_cols matrix from the elements a[i][j]
+     * of any matrix type.
+     */
+    template<typename _Matrix>
+      dense_matrix(std::size_t n_rows, std::size_t n_cols, const _Matrix& a)
+      : dense_matrix(n_rows, n_cols)
+      {
+	for (std::size_t i = 0; i < n_rows; ++i)
+	  for (std::size_t j = 0; j < n_cols; ++j)
+	    (*this)(i, j) = a[i][j];
+      }
+
+    dense_matrix(const dense_matrix&) = delete;
+    dense_matrix& operator=(const dense_matrix&) = delete;
+
+    dense_matrix(dense_matrix&& other) noexcept
+    : m_data(std::exchange(other.m_data, nullptr)),
+      m_rows(std::exchange(other.m_rows, 0)),
+      m_cols(std::exchange(other.m_cols, 0)),
+      m_ld(std::exchange(other.m_ld, 0))
+    { }
+
+    dense_matrix&
+    operator=(dense_matrix&& other) noexcept
+    {
+      if (this != &other)
+	{
+	  this->release();
+	  m_data = std::exchange(other.m_data, nullptr);
+	  m_rows = std::exchange(other.m_rows, 0);
+	  m_cols = std::exchange(other.m_cols, 0);
+	  m_ld = std::exchange(other.m_ld, 0);
+	}
+      return *this;
+    }
+
+    ~dense_matrix()
+    { this->release(); }
+
+    /**
+     * Return a deep copy.
+     */
+    dense_matrix
+    clone() const
+    { return dense_matrix(m_rows, m_cols, *this); }
+
+    std::size_t rows() const noexcept { return m_rows; }
+    std::size_t cols() const noexcept { return m_cols; }
+    std::size_t extent(std::size_t r) const noexcept
+    { return r == 0 ? m_rows : m_cols; }
+
+    /**
+     * Return the distance between elements along dimension r.
+     */
+    std::size_t
+    stride(std::size_t r) const noexcept
+    {
+      if constexpr (std::is_same_v<_Layout, layout_left>)
+	return r == 0 ? 1 : m_ld;
+      else
+	return r == 0 ? m_ld : 1;
+    }
+
+    /**
+     * Return the padded leading dimension.
+     */
+    std::size_t leading_dim() const noexcept { return m_ld; }
+
+    _Tp* data() noexcept { return m_data; }
+    const _Tp* data() const noexcept { return m_data; }
+
+    _Tp&
+    operator()(std::size_t i, std::size_t j) noexcept
+    { return m_data[this->offset(i, j)]; }
+
+    const _Tp&
+    operator()(std::size_t i, std::size_t j) const noexcept
+    { return m_data[this->offset(i, j)]; }
+
+    auto
+    operator[](std::size_t i) noexcept
+    {
+      if constexpr (std::is_same_v<_Layout, layout_left>)
+	return strided_row<_Tp>(m_data + i, m_ld);
+      else
+	return m_data + i * m_ld;
+    }
+
+    auto
+    operator[](std::size_t i) const noexcept
+    {
+      if constexpr (std::is_same_v<_Layout, layout_left>)
+	return strided_row<const _Tp>(m_data + i, m_ld);
+      else
+	return static_cast<const _Tp*>(m_data + i * m_ld);
+    }
+
+    /**
+     * Return the leading dimension used for a row (or column)
+     * of n elements: a whole number of cache lines that is not
+     * a multiple of the 4096-byte critical stride.
+     */
+    static constexpr std::size_t
+    padded_leading_dim(std::size_t n) noexcept
+    {
+      constexpr std::size_t line = alignment / sizeof(_Tp) > 0
+				 ? alignment / sizeof(_Tp) : 1;
+      auto ld = (n + line - 1) / line * line;
+      if (ld > line && (ld * sizeof(_Tp)) % 4096 == 0)
+	ld += line;
+      return ld;
+    }
+
+  private:
+
+    std::size_t
+    offset(std::size_t i, std::size_t j) const noexcept
+    {
+      if constexpr (std::is_same_v<_Layout, layout_left>)
+	return i + j * m_ld;
+      else
+	return i * m_ld + j;
+    }
+
+    std::size_t
+    storage_size() const noexcept
+    {
+      return std::is_same_v<_Layout, layout_left>
+	   ? m_ld * m_cols : m_rows * m_ld;
+    }
+
+    void
+    release() noexcept
+    {
+      if (m_data)
+	{
+	  std::destroy_n(m_data, this->storage_size());
+	  ::operator delete(m_data, std::align_val_t{alignment});
+	  m_data = nullptr;
+	}
+    }
+
+    _Tp* m_data = nullptr;
+    std::size_t m_rows = 0;
+    std::size_t m_cols = 0;
+    std::size_t m_ld = 0;
+  };
+
+template<typename _Tp>
+  struct __is_dense_matrix
+  : std::false_type
+  { };
+
+template<typename _Tp, typename _Layout>
+  struct __is_dense_matrix<dense_matrix<_Tp, _Layout>>
+  : std::true_type
+  { };
+
+/**
+ * Return a _Storage matrix of n_rows * n_cols holding a copy of a.
+ * This is how the decomposition classes fill their internal storage.
+ */
+template<typename _Storage, typename _Matrix>
+  _Storage
+  __make_storage(std::size_t n_rows, std::size_t n_cols, const _Matrix& a)
+  {
+    if constexpr (__is_dense_matrix<_Storage>::value)
+      return _Storage(n_rows, n_cols, a);
+    else if constexpr (std::is_constructible_v<_Storage, const _Matrix&>)
+      return _Storage(a);
+    else
+      {
+	_Storage s(n_rows, typename _Storage::value_type(n_cols));
+	for (std::size_t i = 0; i < n_rows; ++i)
+	  for (std::size_t j = 0; j < n_cols; ++j)
+	    s[i][j] = a[i][j];
+	return s;
+      }
+  }
+
+} // namespace matrix
+
+#endif // MATRIX_DENSE_H
@@ -1,6 +1,8 @@
 #ifndef MATRIX_GAUSS_JORDAN_H
 #define MATRIX_GAUSS_JORDAN_H 1
 
+#include "matrix_workspace.h"
+
 namespace matrix
 {
 
@@ -14,6 +16,24 @@ template<typename NumTp, typename _SquareMatrix, typename _Matrix>
   void
   gauss_jordan(_SquareMatrix& a, std::size_t n, _Matrix& b, std::size_t m);
 
+/**
+ * Return the number of index elements of workspace needed by gauss_jordan()
+ * for an n*n matrix.
+ */
+constexpr std::size_t
+gauss_jordan_workspace_size(std::size_t n) noexcept
+{ return 3 * n; }
+
+/**
+ * Gauss-Jordan elimination as above without allocating:
+ * the pivot bookkeeping is kept in work, which must hold at least
+ * gauss_jordan_workspace_size(n) elements.
+ */
+template<typename NumTp, typename _SquareMatrix, typename _Matrix>
+  void
+  gauss_jordan(_SquareMatrix& a, std::size_t n, _Matrix& b, std::size_t m,
+	       workspace_span<std::size_t> work);
+
 } // namespace matrix
 
 #include "matrix_gauss_jordan.tcc"
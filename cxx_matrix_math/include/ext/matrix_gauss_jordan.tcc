@@ -5,6 +5,7 @@
 #include <vector>
 #include <cmath>
 #include <limits>
+#include <algorithm>
 
 namespace matrix
 {
@@ -18,12 +19,29 @@ namespace matrix
 template<typename NumTp, typename _SquareMatrix, typename _Matrix>
   void
   gauss_jordan(_SquareMatrix& a, std::size_t n, _Matrix& b, std::size_t m)
+  {
+    std::vector<std::size_t> work(gauss_jordan_workspace_size(n));
+    gauss_jordan<NumTp>(a, n, b, m, workspace_span<std::size_t>(work));
+  }
+
+
+/**
+ * Linear equation solution by Gauss-Jordan elimination as gauss_jordan()
+ * taking the pivot bookkeeping from the caller-supplied workspace.
+ */
+template<typename NumTp, typename _SquareMatrix, typename _Matrix>
+  void
+  gauss_jordan(_SquareMatrix& a, std::size_t n, _Matrix& b, std::size_t m,
+	       workspace_span<std::size_t> work)
   {
     const auto imax = std::numeric_limits<std::size_t>::max();
 
-    std::vector<std::size_t> index_col(n, imax);
-    std::vector<std::size_t> index_row(n, imax);
-    std::vector<std::size_t> index_pivot(n, imax);
+    auto index_col = work.take(n);
+    auto index_row = work.take(n);
+    auto index_pivot = work.take(n);
+    std::fill_n(index_col, n, imax);
+    std::fill_n(index_row, n, imax);
+    std::fill_n(index_pivot, n, imax);
 
     for (std::size_t i = 0; i < n; ++i)
       {
@@ -60,7 +78,7 @@ template<typename NumTp, typename _SquareMatrix, typename _Matrix>
 	//   index_row[i] is the row in which that pivot element
 	//                was originally located.
 	// If index_row[i] != index_col[i] a column interchange is implied.
-        if (irow != icol)
+	if (irow != icol)
 	  {
 	    for (auto l = 0u; l < n; ++l)
 	      std::swap(a[irow][l], a[icol][l]);
@@ -92,7 +110,7 @@ template<typename NumTp, typename _SquareMatrix, typename _Matrix>
       }
     for (int l = n - 1; l >= 0; --l)
       if (index_row[l] != index_col[l])
-        for (auto k = 0u; k < n; ++k)
+	for (auto k = 0u; k < n; ++k)
 	  std::swap(a[k][index_row[l]], a[k][index_col[l]]);
   }
 
@@ -0,0 +1,85 @@
+#ifndef MATRIX_GEMM_H
+#define MATRIX_GEMM_H 1
+
+#include <array>
+#include <vector>
+
+#include "matrix_layout.h"
+
+namespace matrix
+{
+
+/**
+ * Compute C <- alpha A.B + beta C for the m*k matrix A, the k*n matrix B
+ * and the m*n matrix C stored row-major at a, b and c with leading
+ * dimensions lda, ldb and ldc.
+ * The operands are packed into cache-sized panels and multiplied with
+ * a register-blocked micro-kernel; AVX2 and AVX-512 kernels are used for
+ * float and double when the target supports them.
+ * If beta is zero C is not read.
+ */
+template<typename _NumTp>
+  void
+  gemm(std::size_t m, std::size_t n, std::size_t k,
+       __nondeduced_t<_NumTp> alpha,
+       const _NumTp* a, std::size_t lda,
+       const _NumTp* b, std::size_t ldb,
+       __nondeduced_t<_NumTp> beta,
+       _NumTp* c, std::size_t ldc);
+
+/**
+ * Compute C <- alpha A.B + beta C for the m*k matrix a[0..m-1][0..k-1],
+ * the k*n matrix b[0..k-1][0..n-1] and the m*n matrix c[0..m-1][0..n-1]
+ * with any of the layouts that support a[i][j] access:
+ * built-in arrays, nested std::array, std::vector<std::vector>,
+ * Tp** and Tp(*)[N].  The arithmetic is done in the element type
+ * of c, to which alpha and beta are converted.
+ */
+template<typename _MatrixA, typename _MatrixB, typename _MatrixC,
+	 typename _NumTp = __matrix_value_t<_MatrixC>>
+  void
+  gemm(std::size_t m, std::size_t n, std::size_t k,
+       __nondeduced_t<_NumTp> alpha, const _MatrixA& a, const _MatrixB& b,
+       __nondeduced_t<_NumTp> beta, _MatrixC& c);
+
+/**
+ * Compute C <- alpha A.B + beta C for built-in arrays.
+ * Small matrices are multiplied with fixed-trip-count loops that
+ * the compiler unrolls completely.
+ */
+template<typename _NumTp, std::size_t M, std::size_t K, std::size_t N>
+  void
+  gemm(__nondeduced_t<_NumTp> alpha,
+       const _NumTp (&a)[M][K], const _NumTp (&b)[K][N],
+       __nondeduced_t<_NumTp> beta, _NumTp (&c)[M][N]);
+
+/**
+ * Compute C <- alpha A.B + beta C for nested std::array.
+ * Small matrices are multiplied with fixed-trip-count loops that
+ * the compiler unrolls completely.
+ */
+template<typename _NumTp, std::size_t M, std::size_t K, std::size_t N>
+  void
+  gemm(__nondeduced_t<_NumTp> alpha,
+       const std::array<std::array<_NumTp, K>, M>& a,
+       const std::array<std::array<_NumTp, N>, K>& b,
+       __nondeduced_t<_NumTp> beta,
+       std::array<std::array<_NumTp, N>, M>& c);
+
+/**
+ * Compute C <- alpha A.B + beta C for std::vector<std::vector>.
+ * The extents are taken from the sizes of a and b.
+ */
+template<typename _NumTp>
+  void
+  gemm(__nondeduced_t<_NumTp> alpha,
+       const std::vector<std::vector<_NumTp>>& a,
+       const std::vector<std::vector<_NumTp>>& b,
+       __nondeduced_t<_NumTp> beta,
+       std::vector<std::vector<_NumTp>>& c);
+
+} // namespace matrix
+
+#include "matrix_gemm.tcc"
+
+#endif // MATRIX_GEMM_H
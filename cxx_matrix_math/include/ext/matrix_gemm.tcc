@@ -0,0 +1,451 @@
+#ifndef MATRIX_GEMM_TCC
+#define MATRIX_GEMM_TCC 1
+
+#include <cstdlib>
+#include <algorithm>
+#include <vector>
+
+#if defined(__AVX512F__) || (defined(__AVX2__) && defined(__FMA__))
+#  include <immintrin.h>
+#endif
+
+namespace matrix
+{
+
+/**
+ * Register and cache blocking parameters of the GEMM micro-kernel.
+ * The micro-kernel computes an mr*nr block of C from a packed mr-row panel
+ * of A and a packed nr-column panel of B.  Blocks of mc*kc of A and kc*nc
+ * of B are packed at a time so that they stay in the L2 and L3 caches.
+ */
+template<typename _NumTp>
+  struct __gemm_blocking
+  {
+    static constexpr std::size_t mr = 4;
+    static constexpr std::size_t nr = 4;
+    static constexpr std::size_t mc = 96;
+    static constexpr std::size_t kc = 256;
+    static constexpr std::size_t nc = 2048;
+  };
+
+/**
+ * Matrices with no more than this many multiply-adds and compile-time
+ * extents are multiplied with plain fixed-size loops.
+ */
+constexpr std::size_t __gemm_small_size = 16 * 16 * 16;
+
+/**
+ * The portable micro-kernel: ct[0..mr-1][0..nr-1] = ap.bp
+ * for kc steps of the packed panels ap and bp.
+ */
+template<typename _NumTp>
+  void
+  __gemm_micro_kernel(std::size_t kc, const _NumTp* __restrict__ ap,
+		      const _NumTp* __restrict__ bp, _NumTp* __restrict__ ct)
+  {
+    constexpr auto mr = __gemm_blocking<_NumTp>::mr;
+    constexpr auto nr = __gemm_blocking<_NumTp>::nr;
+
+    _NumTp acc[mr][nr]{};
+    for (std::size_t p = 0; p < kc; ++p, ap += mr, bp += nr)
+      for (std::size_t r = 0; r < mr; ++r)
+	{
+	  const auto a_r = ap[r];
+	  for (std::size_t j = 0; j < nr; ++j)
+	    acc[r][j] += a_r * bp[j];
+	}
+
+    for (std::size_t r = 0; r < mr; ++r)
+      for (std::size_t j = 0; j < nr; ++j)
+	ct[r * nr + j] = acc[r][j];
+  }
+
+#if defined(__AVX512F__) || (defined(__AVX2__) && defined(__FMA__))
+
+/**
+ * The SIMD micro-kernel: each row of the mr*nr block of C is held in
+ * two vector registers of the instruction set described by _Simd.
+ */
+template<typename _Simd, std::size_t _Mr>
+  inline void
+  __gemm_simd_micro_kernel(std::size_t kc,
+			   const typename _Simd::value_type* __restrict__ ap,
+			   const typename _Simd::value_type* __restrict__ bp,
+			   typename _Simd::value_type* __restrict__ ct)
+  {
+    using _Vec = typename _Simd::vector_type;
+    constexpr auto lanes = _Simd::lanes;
+    constexpr auto nr = 2 * lanes;
+
+    _Vec acc[_Mr][2];
+    for (std::size_t r = 0; r < _Mr; ++r)
+      acc[r][0] = acc[r][1] = _Simd::zero();
+
+    for (std::size_t p = 0; p < kc; ++p, ap += _Mr, bp += nr)
+      {
+	const _Vec b0 = _Simd::load(bp);
+	const _Vec b1 = _Simd::load(bp + lanes);
+	for (std::size_t r = 0; r < _Mr; ++r)
+	  {
+	    const _Vec a_r = _Simd::broadcast(ap + r);
+	    acc[r][0] = _Simd::fma(a_r, b0, acc[r][0]);
+	    acc[r][1] = _Simd::fma(a_r, b1, acc[r][1]);
+	  }
+      }
+
+    for (std::size_t r = 0; r < _Mr; ++r)
+      {
+	_Simd::store(ct + r * nr, acc[r][0]);
+	_Simd::store(ct + r * nr + lanes, acc[r][1]);
+      }
+  }
+
+#endif
+
+#if defined(__AVX512F__)
+
+struct __simd_avx512_pd
+{
+  using value_type = double;
+  using vector_type = __m512d;
+  static constexpr std::size_t lanes = 8;
+  static __m512d zero() { return _mm512_setzero_pd(); }
+  static __m512d load(const double* p) { return _mm512_loadu_pd(p); }
+  static void store(double* p, __m512d v) { _mm512_storeu_pd(p, v); }
+  static __m512d broadcast(const double* p) { return _mm512_set1_pd(*p); }
+  static __m512d fma(__m512d a, __m512d b, __m512d c)
+  { return _mm512_fmadd_pd(a, b, c); }
+};
+
+struct __simd_avx512_ps
+{
+  using value_type = float;
+  using vector_type = __m512;
+  static constexpr std::size_t lanes = 16;
+  static __m512 zero() { return _mm512_setzero_ps(); }
+  static __m512 load(const float* p) { return _mm512_loadu_ps(p); }
+  static void store(float* p, __m512 v) { _mm512_storeu_ps(p, v); }
+  static __m512 broadcast(const float* p) { return _mm512_set1_ps(*p); }
+  static __m512 fma(__m512 a, __m512 b, __m512 c)
+  { return _mm512_fmadd_ps(a, b, c); }
+};
+
+template<>
+  struct __gemm_blocking<double>
+  {
+    static constexpr std::size_t mr = 8;
+    static constexpr std::size_t nr = 16;
+    static constexpr std::size_t mc = 128;
+    static constexpr std::size_t kc = 256;
+    static constexpr std::size_t nc = 4096;
+  };
+
+template<>
+  struct __gemm_blocking<float>
+  {
+    static constexpr std::size_t mr = 8;
+    static constexpr std::size_t nr = 32;
+    static constexpr std::size_t mc = 128;
+    static constexpr std::size_t kc = 384;
+    static constexpr std::size_t nc = 4096;
+  };
+
+inline void
+__gemm_micro_kernel(std::size_t kc, const double* __restrict__ ap,
+		    const double* __restrict__ bp, double* __restrict__ ct)
+{ __gemm_simd_micro_kernel<__simd_avx512_pd, 8>(kc, ap, bp, ct); }
+
+inline void
+__gemm_micro_kernel(std::size_t kc, const float* __restrict__ ap,
+		    const float* __restrict__ bp, float* __restrict__ ct)
+{ __gemm_simd_micro_kernel<__simd_avx512_ps, 8>(kc, ap, bp, ct); }
+
+#elif defined(__AVX2__) && defined(__FMA__)
+
+struct __simd_avx2_pd
+{
+  using value_type = double;
+  using vector_type = __m256d;
+  static constexpr std::size_t lanes = 4;
+  static __m256d zero() { return _mm256_setzero_pd(); }
+  static __m256d load(const double* p) { return _mm256_loadu_pd(p); }
+  static void store(double* p, __m256d v) { _mm256_storeu_pd(p, v); }
+  static __m256d broadcast(const double* p) { return _mm256_broadcast_sd(p); }
+  static __m256d fma(__m256d a, __m256d b, __m256d c)
+  { return _mm256_fmadd_pd(a, b, c); }
+};
+
+struct __simd_avx2_ps
+{
+  using value_type = float;
+  using vector_type = __m256;
+  static constexpr std::size_t lanes = 8;
+  static __m256 zero() { return _mm256_setzero_ps(); }
+  static __m256 load(const float* p) { return _mm256_loadu_ps(p); }
+  static void store(float* p, __m256 v) { _mm256_storeu_ps(p, v); }
+  static __m256 broadcast(const float* p) { return _mm256_broadcast_ss(p); }
+  static __m256 fma(__m256 a, __m256 b, __m256 c)
+  { return _mm256_fmadd_ps(a, b, c); }
+};
+
+template<>
+  struct __gemm_blocking<double>
+  {
+    static constexpr std::size_t mr = 6;
+    static constexpr std::size_t nr = 8;
+    static constexpr std::size_t mc = 96;
+    static constexpr std::size_t kc = 256;
+    static constexpr std::size_t nc = 4096;
+  };
+
+template<>
+  struct __gemm_blocking<float>
+  {
+    static constexpr std::size_t mr = 6;
+    static constexpr std::size_t nr = 16;
+    static constexpr std::size_t mc = 144;
+    static constexpr std::size_t kc = 256;
+    static constexpr std::size_t nc = 4096;
+  };
+
+inline void
+__gemm_micro_kernel(std::size_t kc, const double* __restrict__ ap,
+		    const double* __restrict__ bp, double* __restrict__ ct)
+{ __gemm_simd_micro_kernel<__simd_avx2_pd, 6>(kc, ap, bp, ct); }
+
+inline void
+__gemm_micro_kernel(std::size_t kc, const float* __restrict__ ap,
+		    const float* __restrict__ bp, float* __restrict__ ct)
+{ __gemm_simd_micro_kernel<__simd_avx2_ps, 6>(kc, ap, bp, ct); }
+
+#endif
+
+/**
+ * Pack the mc*kc block of A at (i0, p0) into panels of mr rows,
+ * each stored with the mr elements of a column contiguous.
+ * Rows past the edge of the matrix are padded with zeros.
+ */
+template<typename _NumTp, typename _ElemA>
+  void
+  __gemm_pack_a(std::size_t mc, std::size_t kc, _ElemA a,
+		std::size_t i0, std::size_t p0, _NumTp* a_pack)
+  {
+    constexpr auto mr = __gemm_blocking<_NumTp>::mr;
+
+    for (std::size_t ir = 0; ir < mc; ir += mr)
+      {
+	const auto mr_ = std::min(mr, mc - ir);
+	for (std::size_t p = 0; p < kc; ++p, a_pack += mr)
+	  {
+	    for (std::size_t r = 0; r < mr_; ++r)
+	      a_pack[r] = a(i0 + ir + r, p0 + p);
+	    for (std::size_t r = mr_; r < mr; ++r)
+	      a_pack[r] = _NumTp{0};
+	  }
+      }
+  }
+
+/**
+ * Pack the kc*nc block of B at (p0, j0) into panels of nr columns,
+ * each stored with the nr elements of a row contiguous.
+ * Columns past the edge of the matrix are padded with zeros.
+ */
+template<typename _NumTp, typename _ElemB>
+  void
+  __gemm_pack_b(std::size_t kc, std::size_t nc, _ElemB b,
+		std::size_t p0, std::size_t j0, _NumTp* b_pack)
+  {
+    constexpr auto nr = __gemm_blocking<_NumTp>::nr;
+
+    for (std::size_t jr = 0; jr < nc; jr += nr)
+      {
+	const auto nr_ = std::min(nr, nc - jr);
+	for (std::size_t p = 0; p < kc; ++p, b_pack += nr)
+	  {
+	    for (std::size_t j = 0; j < nr_; ++j)
+	      b_pack[j] = b(p0 + p, j0 + jr + j);
+	    for (std::size_t j = nr_; j < nr; ++j)
+	      b_pack[j] = _NumTp{0};
+	  }
+      }
+  }
+
+/**
+ * The blocked GEMM driver on the element accessors a(i, p), b(p, j)
+ * and c(i, j).
+ */
+template<typename _NumTp, typename _ElemA, typename _ElemB, typename _ElemC>
+  void
+  __gemm(std::size_t m, std::size_t n, std::size_t k,
+	 _NumTp alpha, _ElemA a, _ElemB b, _NumTp beta, _ElemC c)
+  {
+    using _Blk = __gemm_blocking<_NumTp>;
+    constexpr auto mr = _Blk::mr;
+    constexpr auto nr = _Blk::nr;
+
+    if (beta == _NumTp{0})
+      {
+	for (std::size_t i = 0; i < m; ++i)
+	  for (std::size_t j = 0; j < n; ++j)
+	    c(i, j) = _NumTp{0};
+      }
+    else if (beta != _NumTp{1})
+      {
+	for (std::size_t i = 0; i < m; ++i)
+	  for (std::size_t j = 0; j < n; ++j)
+	    c(i, j) *= beta;
+      }
+
+    if (alpha == _NumTp{0} || k == 0)
+      return;
+
+    // The packing buffers are reused across calls on each thread and
+    // grow to the largest blocks seen, padded to whole panels.
+    thread_local std::vector<_NumTp> a_pack;
+    thread_local std::vector<_NumTp> b_pack;
+    const auto k_blk = std::min(_Blk::kc, k);
+    const auto a_size = (std::min(_Blk::mc, m) + mr - 1) / mr * mr * k_blk;
+    const auto b_size = (std::min(_Blk::nc, n) + nr - 1) / nr * nr * k_blk;
+    if (a_pack.size() < a_size)
+      a_pack.resize(a_size);
+    if (b_pack.size() < b_size)
+      b_pack.resize(b_size);
+
+    _NumTp ct[mr * nr];
+
+    for (std::size_t jc = 0; jc < n; jc += _Blk::nc)
+      {
+	const auto nc_ = std::min(_Blk::nc, n - jc);
+	for (std::size_t pc = 0; pc < k; pc += _Blk::kc)
+	  {
+	    const auto kc_ = std::min(_Blk::kc, k - pc);
+	    __gemm_pack_b(kc_, nc_, b, pc, jc, b_pack.data());
+	    for (std::size_t ic = 0; ic < m; ic += _Blk::mc)
+	      {
+		const auto mc_ = std::min(_Blk::mc, m - ic);
+		__gemm_pack_a(mc_, kc_, a, ic, pc, a_pack.data());
+		for (std::size_t jr = 0; jr < nc_; jr += nr)
+		  {
+		    const auto nr_ = std::min(nr, nc_ - jr);
+		    for (std::size_t ir = 0; ir < mc_; ir += mr)
+		      {
+			const auto mr_ = std::min(mr, mc_ - ir);
+			__gemm_micro_kernel(kc_, a_pack.data() + ir * kc_,
+					    b_pack.data() + jr * kc_, ct);
+			for (std::size_t r = 0; r < mr_; ++r)
+			  for (std::size_t j = 0; j < nr_; ++j)
+			    c(ic + ir + r, jc + jr + j) += alpha * ct[r * nr + j];
+		      }
+		  }
+	      }
+	  }
+      }
+  }
+
+/**
+ * Multiply small matrices with compile-time extents using loops of
+ * fixed trip count in i-k-j order.
+ */
+template<std::size_t M, std::size_t K, std::size_t N,
+	 typename _NumTp, typename _MatrixA, typename _MatrixB,
+	 typename _MatrixC>
+  void
+  __gemm_fixed(_NumTp alpha, const _MatrixA& a, const _MatrixB& b,
+	       _NumTp beta, _MatrixC& c)
+  {
+    for (std::size_t i = 0; i < M; ++i)
+      {
+	_NumTp row[N]{};
+	for (std::size_t p = 0; p < K; ++p)
+	  {
+	    const auto a_ip = a[i][p];
+	    for (std::size_t j = 0; j < N; ++j)
+	      row[j] += a_ip * b[p][j];
+	  }
+	for (std::size_t j = 0; j < N; ++j)
+	  c[i][j] = (beta == _NumTp{0}
+		    ? alpha * row[j]
+		    : alpha * row[j] + beta * c[i][j]);
+      }
+  }
+
+template<typename _NumTp>
+  void
+  gemm(std::size_t m, std::size_t n, std::size_t k,
+       __nondeduced_t<_NumTp> alpha,
+       const _NumTp* a, std::size_t lda,
+       const _NumTp* b, std::size_t ldb,
+       __nondeduced_t<_NumTp> beta,
+       _NumTp* c, std::size_t ldc)
+  {
+    __gemm(m, n, k, alpha,
+	   [a, lda](std::size_t i, std::size_t j) -> const _NumTp&
+	   { return a[i * lda + j]; },
+	   [b, ldb](std::size_t i, std::size_t j) -> const _NumTp&
+	   { return b[i * ldb + j]; },
+	   beta,
+	   [c, ldc](std::size_t i, std::size_t j) -> _NumTp&
+	   { return c[i * ldc + j]; });
+  }
+
+template<typename _MatrixA, typename _MatrixB, typename _MatrixC,
+	 typename _NumTp>
+  void
+  gemm(std::size_t m, std::size_t n, std::size_t k,
+       __nondeduced_t<_NumTp> alpha, const _MatrixA& a, const _MatrixB& b,
+       __nondeduced_t<_NumTp> beta, _MatrixC& c)
+  {
+    __gemm(m, n, k, alpha,
+	   [&a](std::size_t i, std::size_t j) -> decltype(auto)
+	   { return a[i][j]; },
+	   [&b](std::size_t i, std::size_t j) -> decltype(auto)
+	   { return b[i][j]; },
+	   beta,
+	   [&c](std::size_t i, std::size_t j) -> decltype(auto)
+	   { return c[i][j]; });
+  }
+
+template<typename _NumTp, std::size_t M, std::size_t K, std::size_t N>
+  void
+  gemm(__nondeduced_t<_NumTp> alpha,
+       const _NumTp (&a)[M][K], const _NumTp (&b)[K][N],
+       __nondeduced_t<_NumTp> beta, _NumTp (&c)[M][N])
+  {
+    if constexpr (M * N * K <= __gemm_small_size)
+      __gemm_fixed<M, K, N, _NumTp>(alpha, a, b, beta, c);
+    else
+      gemm<_NumTp>(M, N, K, alpha, &a[0][0], K, &b[0][0], N,
+		   beta, &c[0][0], N);
+  }
+
+template<typename _NumTp, std::size_t M, std::size_t K, std::size_t N>
+  void
+  gemm(__nondeduced_t<_NumTp> alpha,
+       const std::array<std::array<_NumTp, K>, M>& a,
+       const std::array<std::array<_NumTp, N>, K>& b,
+       __nondeduced_t<_NumTp> beta,
+       std::array<std::array<_NumTp, N>, M>& c)
+  {
+    if constexpr (M * N * K <= __gemm_small_size)
+      __gemm_fixed<M, K, N, _NumTp>(alpha, a, b, beta, c);
+    else
+      gemm(M, N, K, _NumTp(alpha), a, b, _NumTp(beta), c);
+  }
+
+template<typename _NumTp>
+  void
+  gemm(__nondeduced_t<_NumTp> alpha,
+       const std::vector<std::vector<_NumTp>>& a,
+       const std::vector<std::vector<_NumTp>>& b,
+       __nondeduced_t<_NumTp> beta,
+       std::vector<std::vector<_NumTp>>& c)
+  {
+    const auto m = a.size();
+    const auto k = b.size();
+    const auto n = k == 0 ? std::size_t{0} : b[0].size();
+    gemm(m, n, k, _NumTp(alpha), a, b, _NumTp(beta), c);
+  }
+
+} // namespace matrix
+
+#endif // MATRIX_GEMM_TCC
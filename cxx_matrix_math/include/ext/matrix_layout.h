@@ -0,0 +1,185 @@
+#ifndef MATRIX_LAYOUT_H
+#define MATRIX_LAYOUT_H 1
+
+#include <array>
+#include <cstdlib>
+#include <type_traits>
+#include <utility>
+
+namespace matrix
+{
+
+/**
+ * Keep a parameter out of template argument deduction.
+ */
+template<typename _Tp>
+  struct __nondeduced
+  { using type = _Tp; };
+
+template<typename _Tp>
+  using __nondeduced_t = typename __nondeduced<_Tp>::type;
+
+/**
+ * Layout tag for row-major storage: the rightmost index varies fastest.
+ * Element (i, j) of a matrix with leading dimension ld is at i * ld + j.
+ */
+struct layout_right
+{ };
+
+/**
+ * Layout tag for column-major storage: the leftmost index varies fastest.
+ * Element (i, j) of a matrix with leading dimension ld is at i + j * ld.
+ */
+struct layout_left
+{ };
+
+/**
+ * A row of a column-major matrix: element j is at stride * j.
+ */
+template<typename Tp>
+  class strided_row
+  {
+  public:
+
+    constexpr strided_row(Tp* row, std::size_t stride) noexcept
+    : _M_row(row), _M_stride(stride)
+    { }
+
+    constexpr Tp&
+    operator[](std::size_t j) const noexcept
+    { return _M_row[j * _M_stride]; }
+
+  private:
+
+    Tp* _M_row;
+    std::size_t _M_stride;
+  };
+
+/**
+ * The element type of a matrix accessed as a[i][j].
+ */
+template<typename _Matrix>
+  using __matrix_value_t
+    = std::decay_t<decltype(std::declval<_Matrix&>()[0][0])>;
+
+/**
+ * Describes how the elements of a matrix type are stored.
+ * The layout_type is layout_right or layout_left for matrices stored
+ * in a single block with unit stride along the rows or the columns,
+ * and void for anything else, such as jagged rows.
+ * Contiguous matrices also provide data(a) and leading_dim(a).
+ */
+template<typename _Matrix, typename = void>
+  struct matrix_storage_traits
+  {
+    using layout_type = void;
+  };
+
+/**
+ * Matrix types that describe themselves with a layout_type,
+ * data() and mdspan-style stride(r).
+ */
+template<typename _Matrix>
+  struct matrix_storage_traits<_Matrix,
+	   std::void_t<typename _Matrix::layout_type,
+		       decltype(std::declval<_Matrix&>().data()),
+		       decltype(std::declval<_Matrix&>().stride(0))>>
+  {
+    using layout_type = typename _Matrix::layout_type;
+
+    template<typename _Mat>
+      static auto
+      data(_Mat& a)
+      { return a.data(); }
+
+    template<typename _Mat>
+      static std::size_t
+      leading_dim(const _Mat& a)
+      {
+	if constexpr (std::is_same_v<layout_type, layout_left>)
+	  return a.stride(1);
+	else
+	  return a.stride(0);
+      }
+  };
+
+/**
+ * Built-in two-dimensional arrays are contiguous and row-major.
+ */
+template<typename _Tp, std::size_t _Rows, std::size_t _Cols>
+  struct matrix_storage_traits<_Tp[_Rows][_Cols], void>
+  {
+    using layout_type = layout_right;
+
+    template<typename _Mat>
+      static auto
+      data(_Mat& a)
+      { return &a[0][0]; }
+
+    template<typename _Mat>
+      static constexpr std::size_t
+      leading_dim(const _Mat&)
+      { return _Cols; }
+  };
+
+/**
+ * Nested std::array is contiguous and row-major.
+ */
+template<typename _Tp, std::size_t _Rows, std::size_t _Cols>
+  struct matrix_storage_traits<std::array<std::array<_Tp, _Cols>, _Rows>, void>
+  {
+    using layout_type = layout_right;
+
+    template<typename _Mat>
+      static auto
+      data(_Mat& a)
+      { return a[0].data(); }
+
+    template<typename _Mat>
+      static constexpr std::size_t
+      leading_dim(const _Mat&)
+      { return _Cols; }
+  };
+
+/**
+ * The layout of the storage of _Matrix: layout_right, layout_left or void.
+ */
+template<typename _Matrix>
+  using matrix_layout_t
+    = typename matrix_storage_traits<std::remove_cv_t<_Matrix>>::layout_type;
+
+/**
+ * True if _Matrix is stored contiguously in row- or column-major order.
+ */
+template<typename _Matrix>
+  constexpr bool is_contiguous_matrix_v
+    = !std::is_void_v<matrix_layout_t<_Matrix>>;
+
+/**
+ * Return an accessor f(i, j) for element (i, j) of a.
+ * Contiguous storage is indexed directly from data() with the leading
+ * dimension, avoiding the row indirection of a[i][j] and giving unit
+ * stride along the contiguous direction.  Anything else uses a[i][j].
+ */
+template<typename _Matrix>
+  auto
+  __elem_access(_Matrix& a)
+  {
+    using _Traits = matrix_storage_traits<std::remove_cv_t<_Matrix>>;
+    using _Layout = typename _Traits::layout_type;
+    if constexpr (std::is_same_v<_Layout, layout_right>)
+      return [p = _Traits::data(a), ld = _Traits::leading_dim(a)]
+	     (std::size_t i, std::size_t j) -> auto&
+	     { return p[i * ld + j]; };
+    else if constexpr (std::is_same_v<_Layout, layout_left>)
+      return [p = _Traits::data(a), ld = _Traits::leading_dim(a)]
+	     (std::size_t i, std::size_t j) -> auto&
+	     { return p[i + j * ld]; };
+    else
+      return [&a](std::size_t i, std::size_t j) -> decltype(auto)
+	     { return a[i][j]; };
+  }
+
+} // namespace matrix
+
+#endif // MATRIX_LAYOUT_H
@@ -3,26 +3,55 @@
 
 #include <vector>
 
+#include "matrix_dense.h"
+#include "matrix_layout.h"
+#include "matrix_thread_pool.h"
+#include "matrix_workspace.h"
+
 namespace matrix
 {
 
+/**
+ * The algorithms available for computing the LU decomposition.
+ */
+enum class lu_algorithm
+{
+  /// The unblocked Crout loop.
+  crout,
+  /// The blocked right-looking loop with a tiled trailing update.
+  blocked,
+  /// The blocked loop with the trailing update spread over a thread pool.
+  parallel
+};
+
 /**
  * This class represents an lower-upper decomposition of a square matrix.
+ * The factors are held in a copy of the input of type _Storage,
+ * by default an aligned, contiguous dense_matrix.
  */
-template<typename _NumTp, typename _SquareMatrix>
+template<typename _NumTp, typename _SquareMatrix,
+	 typename _Storage = dense_matrix<__matrix_value_t<_SquareMatrix>>>
   class lu_decomposition
   {
 
   public:
 
-    using value_type = std::decay_t<decltype(_SquareMatrix{}[0][0])>;
+    using value_type = __matrix_value_t<_SquareMatrix>;
 
     template<typename _SquareMatrix2>
-      lu_decomposition(std::size_t n, const _SquareMatrix2& a);
+      lu_decomposition(std::size_t n, const _SquareMatrix2& a,
+		       lu_algorithm alg = lu_algorithm::crout);
+
+    template<typename _SquareMatrix2>
+      lu_decomposition(std::size_t n, const _SquareMatrix2& a,
+		       thread_pool& pool);
 
     template<typename _Vector, typename _VectorOut>
       void backsubstitute(const _Vector& b, _VectorOut& x) const;
 
+    template<typename _Matrix>
+      void backsubstitute(_Matrix& b, std::size_t k) const;
+
     template<typename InVecIter, typename OutVecIter>
       void
       backsubstitution(InVecIter b_begin, InVecIter b_end,
@@ -43,19 +72,75 @@ template<typename _NumTp, typename _SquareMatrix>
       void
       inverse(_SquareMatrix2& a_inv) const;
 
+    /**
+     * Update the decomposition to that of the matrix with column j
+     * replaced by a_col in O(n^2) operations (Bartels-Golub).
+     * The spike L^{-1}.P.a_col is moved to the last column of U,
+     * the columns after j shifted left, and the resulting upper Hessenberg
+     * block is restored to triangular form by eliminations between
+     * adjacent rows with partial pivoting.  L is not touched;
+     * the eliminations are kept and applied to each right-hand side.
+     */
+    template<typename _Vector>
+      void
+      replace_column(std::size_t j, const _Vector& a_col);
+
+    /**
+     * Update the decomposition to that of a + u.v~ in O(n^2) operations.
+     * w = L^{-1}.P.u is reduced to a multiple of e_0 by pivoted eliminations
+     * between adjacent rows from the bottom up, which leave U upper
+     * Hessenberg, the update is added to the first row and
+     * the subdiagonal is eliminated again.
+     */
+    template<typename _Vector, typename _Vector2>
+      void
+      update(const _Vector& u, const _Vector2& v);
+
+    /// The number of row eliminations stored by updates since
+    /// the factorization; each costs one multiply-add per solve.
+    /// Refactor when this grows to a sizable multiple of n.
+    std::size_t
+    num_row_ops() const
+    { return m_ops.size(); }
+
     _NumTp determinant() const;
 
+    /// The trace of the factored matrix, kept up to date by
+    /// replace_column() and update().
     _NumTp trace() const;
 
   private:
 
+    /// An elimination between rows k and k + 1 left by an update:
+    /// an optional interchange followed by row k+1 -= mult row k.
+    struct row_op
+    {
+      std::size_t k;
+      bool swap;
+      value_type mult;
+    };
+
+    void begin_update();
+
+    void eliminate_subdiagonal(std::size_t k0, std::vector<value_type>& h);
+
+    void solve_updated(std::vector<value_type>& x) const;
+
     std::size_t m_n;
 
-    _SquareMatrix m_a;
+    _Storage m_a;
 
     std::vector<std::size_t> m_index;
 
-    int m_parity;
+    _NumTp m_parity;
+
+    /// The diagonal of a, updated in O(n) with the factors.
+    std::vector<value_type> m_diag;
+
+    /// The column of a in each column of U; empty until the first update.
+    std::vector<std::size_t> m_col;
+
+    std::vector<row_op> m_ops;
   };
 
 /**
@@ -71,6 +156,74 @@ template<typename _NumTp, typename _SquareMatrix, typename _Vector>
   lu_decomp(std::size_t n, _SquareMatrix& a,
 	    _Vector& index, _NumTp& parity);
 
+/**
+ * Return the number of elements of workspace needed by lu_decomp()
+ * and lu_decomp_blocked() for an n*n matrix.
+ */
+constexpr std::size_t
+lu_decomp_workspace_size(std::size_t n) noexcept
+{ return n; }
+
+/**
+ * Compute the LU decomposition of a[0..n-1][0..n-1] as above
+ * without allocating: the row scale factors are kept in work,
+ * which must hold at least lu_decomp_workspace_size(n) elements.
+ */
+template<typename _NumTp, typename _SquareMatrix, typename _Vector>
+  void
+  lu_decomp(std::size_t n, _SquareMatrix& a,
+	    _Vector& index, _NumTp& parity,
+	    workspace_span<__nondeduced_t<_NumTp>> work);
+
+/**
+ * Compute the LU decomposition of a[0..n-1][0..n-1] with the algorithm alg.
+ * The output is identical in layout to that of the Crout lu_decomp().
+ */
+template<typename _NumTp, typename _SquareMatrix, typename _Vector>
+  void
+  lu_decomp(std::size_t n, _SquareMatrix& a,
+	    _Vector& index, _NumTp& parity, lu_algorithm alg);
+
+/**
+ * Compute the LU decomposition of a[0..n-1][0..n-1] by a blocked
+ * right-looking loop.  Panels of block_size columns are factored
+ * with the same scaled partial pivoting as lu_decomp() and the trailing
+ * submatrix is then updated with a cache-tiled matrix multiply.
+ * The output a, index and parity are laid out exactly as in lu_decomp().
+ */
+template<typename _NumTp, typename _SquareMatrix, typename _Vector>
+  void
+  lu_decomp_blocked(std::size_t n, _SquareMatrix& a,
+		    _Vector& index, _NumTp& parity,
+		    std::size_t block_size = 64);
+
+/**
+ * Compute the blocked LU decomposition of a[0..n-1][0..n-1]
+ * without allocating, with the row scale factors kept in work
+ * of at least lu_decomp_workspace_size(n) elements.
+ */
+template<typename _NumTp, typename _SquareMatrix, typename _Vector>
+  void
+  lu_decomp_blocked(std::size_t n, _SquareMatrix& a,
+		    _Vector& index, _NumTp& parity,
+		    workspace_span<__nondeduced_t<_NumTp>> work,
+		    std::size_t block_size = 64);
+
+/**
+ * Compute the LU decomposition of a[0..n-1][0..n-1] by the blocked
+ * right-looking loop of lu_decomp_blocked() with the trailing update
+ * of each panel split into column tiles that run as tasks on pool.
+ * The next panel is updated first and factored on the calling thread
+ * while the remaining tiles are being updated.
+ * The pivot sequence and the output are the same as for lu_decomp().
+ */
+template<typename _NumTp, typename _SquareMatrix, typename _Vector>
+  void
+  lu_decomp_parallel(std::size_t n, _SquareMatrix& a,
+		     _Vector& index, _NumTp& parity,
+		     thread_pool& pool = default_thread_pool(),
+		     std::size_t block_size = 64);
+
 /**
  * Solve the set of n linear equations a.x = b.  Here a[0..n-1][0..n-1] is input, not as the original matrix a but as 
  * its LU decomposition, determined by the routine lu_decomp().  b[0..n-1] is input as the right hand side vector b 
@@ -85,26 +238,112 @@ template<typename _SquareMatrix, typename _VectorInt, typename _Vector>
 	     const _VectorInt& index,
 	     _Vector& b);
 
+/**
+ * Solve the set of n linear equations a.X = B for the k right-hand sides
+ * in the columns of b[0..n-1][0..k-1].  Here a[0..n-1][0..n-1] and index
+ * are the LU decomposition from lu_decomp().  B is overwritten with
+ * the solution X.  Each element of the L and U factors is read once
+ * for all k right-hand sides and no memory is allocated.
+ */
+template<typename _SquareMatrix, typename _VectorInt, typename _Matrix>
+  void
+  lu_backsub(const std::size_t n,
+	     const _SquareMatrix& a,
+	     const _VectorInt& index,
+	     _Matrix& b, std::size_t k);
+
+/**
+ * Solve the set of n linear equations a.X = B for the k right-hand sides
+ * stored contiguously at b with leading dimension ldb
+ * in row-major (layout_right) or column-major (layout_left) order.
+ * B is overwritten with the solution X.
+ */
+template<typename _SquareMatrix, typename _VectorInt, typename _NumTp,
+	 typename _Layout>
+  void
+  lu_backsub(const std::size_t n,
+	     const _SquareMatrix& a,
+	     const _VectorInt& index,
+	     _NumTp* b, std::size_t k, std::size_t ldb, _Layout);
+
 /**
  * Improves a solution vector x of the linear set A.x = b.  The matrix a and the
  * LU decomposition of a a_lu (with its row permutation vector index) and the
  * right-hand side vector are input along with the solution vector x.  
  * The solution vector x is improved and modified on output.
  */
-template<typename _SquareMatrix, typename _VectorInt, typename _Vector>
+template<typename _SquareMatrix, typename _SquareMatrixLU,
+	 typename _VectorInt, typename _Vector>
   void
   lu_improve(const std::size_t n, const _SquareMatrix& a,
-	     const _SquareMatrix& a_lu,
+	     const _SquareMatrixLU& a_lu,
 	     const _VectorInt& index, const _Vector& b, _Vector& x);
 
+/**
+ * Return the number of elements of workspace needed by lu_improve()
+ * for an n*n matrix.
+ */
+constexpr std::size_t
+lu_improve_workspace_size(std::size_t n) noexcept
+{ return n; }
+
+/**
+ * Improve the solution vector x as above without allocating:
+ * the residual is formed in work, which must hold at least
+ * lu_improve_workspace_size(n) elements.
+ */
+template<typename _SquareMatrix, typename _SquareMatrixLU,
+	 typename _VectorInt, typename _Vector>
+  void
+  lu_improve(const std::size_t n, const _SquareMatrix& a,
+	     const _SquareMatrixLU& a_lu,
+	     const _VectorInt& index, const _Vector& b, _Vector& x,
+	     workspace_span<__matrix_value_t<_SquareMatrix>> work);
+
+/**
+ * The outcome of a mixed precision solve by lu_solve_mixed().
+ */
+struct lu_mixed_info
+{
+  /// The number of refinement steps taken.
+  std::size_t iterations = 0;
+  /// True if the system was solved in the working precision instead
+  /// because the low precision factorization or the refinement failed.
+  bool fallback = false;
+};
+
+/**
+ * Solve the set of n linear equations a.x = b by factoring a copy of a
+ * rounded to the lower precision _LowTp with the algorithm alg and
+ * refining the low precision solution in the precision of a,
+ * with the residuals accumulated in promote_t of that precision.
+ * The factorization moves half the data of one in the working precision
+ * and its inner loops have twice the vector width.
+ * Refinement stops, as in LAPACK's dsgesv, once
+ * ||b - a.x|| <= sqrt(n) eps ||a|| ||x|| in the infinity norm.
+ * If a does not fit in _LowTp, its low precision factor is singular,
+ * a refinement step fails to halve the residual or max_iter steps are
+ * taken without convergence, the system is solved by an LU decomposition
+ * in the working precision and one step of refinement instead.
+ * Throw std::logic_error, as lu_decomp() does, if a row of a is zero.
+ */
+template<typename _LowTp = float, typename _SquareMatrix, typename _Vector>
+  lu_mixed_info
+  lu_solve_mixed(std::size_t n, const _SquareMatrix& a,
+		 const _Vector& b, _Vector& x,
+		 lu_algorithm alg = lu_algorithm::blocked,
+		 std::size_t max_iter = 30);
+
 /**
  * Inverts a matrix given the LU decomposed matrix.
+ * The inverse is formed in place from the identity as U^{-1}.L^{-1}.P
+ * without any temporary storage.
  *
  * The inverse matrix is NOT in LU form.
  */
-template<typename _SquareMatrix, typename _VectorInt>
+template<typename _SquareMatrixLU, typename _VectorInt, typename _SquareMatrix>
   void
-  lu_invert(const std::size_t n, const _SquareMatrix& a_lu,
+  lu_invert(const std::size_t n, const _SquareMatrixLU& a_lu,
 	    const _VectorInt& index, _SquareMatrix& a_inv);
 
 /**
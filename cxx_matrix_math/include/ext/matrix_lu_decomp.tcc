@@ -5,6 +5,10 @@
 #include <vector>
 #include <cmath>
 #include <limits>
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <type_traits>
 
 #include "matrix_util.h"
 
@@ -24,9 +28,27 @@ template<typename _NumTp, typename _SquareMatrix, typename _Vector>
   lu_decomp(std::size_t n, _SquareMatrix& a,
 	    _Vector& index, _NumTp& parity)
   {
+    std::vector<_NumTp> work(lu_decomp_workspace_size(n));
+    lu_decomp(n, a, index, parity, workspace_span<_NumTp>(work));
+  }
+
+
+/**
+ * Compute the Crout LU decomposition of a[0..n-1][0..n-1] as lu_decomp()
+ * taking the row scale factors from the caller-supplied workspace
+ * of lu_decomp_workspace_size(n) elements.
+ */
+template<typename _NumTp, typename _SquareMatrix, typename _Vector>
+  void
+  lu_decomp(std::size_t n, _SquareMatrix& a,
+	    _Vector& index, _NumTp& parity,
+	    workspace_span<__nondeduced_t<_NumTp>> work)
+  {
+    auto A = __elem_access(a);
+
     const _NumTp TINY = _NumTp(1.0e-20L);
 
-    std::vector<_NumTp> scale(n);
+    auto scale = work.take(n);
     parity = _NumTp{1};
 
     // Loop over rows to get the implicit scaling information.    
@@ -34,7 +56,7 @@ template<typename _NumTp, typename _SquareMatrix, typename _Vector>
       {
 	_NumTp big{0};
 	for (std::size_t j = 0; j < n; ++j)
-	  if (const auto temp = std::abs(a[i][j]); temp > big)
+	  if (const auto temp = std::abs(A(i, j)); temp > big)
 	    big = temp;
 	if (big == _NumTp{0})
 	  std::__throw_logic_error("lu_decomp: singular matrix");
@@ -49,10 +71,10 @@ template<typename _NumTp, typename _SquareMatrix, typename _Vector>
 	// Lower triangle.
 	for (std::size_t i = 0; i < j; ++i)
 	  {
-	    auto sum = a[i][j];
+	    auto sum = A(i, j);
 	    for (std::size_t k = 0; k < i; ++k)
-	      sum -= a[i][k] * a[k][j];
-	    a[i][j] = sum;
+	      sum -= A(i, k) * A(k, j);
+	    A(i, j) = sum;
 	  }
 
 	// Initialize for the search for the largest pivot point.
@@ -60,10 +82,10 @@ template<typename _NumTp, typename _SquareMatrix, typename _Vector>
 	auto big = _NumTp{0};
 	for (std::size_t i = j; i < n; ++i)
 	  {
-	    auto sum = a[i][j];
+	    auto sum = A(i, j);
 	    for (std::size_t k = 0; k < j; ++k)
-	      sum -= a[i][k] * a[k][j];
-	    a[i][j] = sum;
+	      sum -= A(i, k) * A(k, j);
+	    A(i, j) = sum;
 	    if (const auto dum = scale[i] * std::abs(sum); dum >= big)
 	      {
 		big = dum;
@@ -74,7 +96,7 @@ template<typename _NumTp, typename _SquareMatrix, typename _Vector>
 	if (j != imax)
 	  {
 	    for (std::size_t k = 0; k < n; ++k)
-	      std::swap(a[imax][k], a[j][k]);
+	      std::swap(A(imax, k), A(j, k));
 
 	    // Change parity.
 	    parity = -parity;
@@ -83,20 +105,336 @@ template<typename _NumTp, typename _SquareMatrix, typename _Vector>
 	    std::swap(scale[imax], scale[j]);
 	  }
 	index[j] = imax;
-	if (a[j][j] == _NumTp{0})
-	  a[j][j] = TINY;
+	if (A(j, j) == _NumTp{0})
+	  A(j, j) = TINY;
 
 	// Now finally divide by the pivot element
 	if (j != n - 1)
 	  {
-	    const auto scale = _NumTp{1} / a[j][j];
+	    const auto scale = _NumTp{1} / A(j, j);
 	    for (std::size_t i = j + 1; i < n; ++i)
-	      a[i][j] *= scale;
+	      A(i, j) *= scale;
 	  }
       } // Go back for the next column in the reduction.
   }
 
 
+/**
+ * Compute the LU decomposition of a[0..n-1][0..n-1] with the algorithm alg.
+ * The output is identical in layout to that of the Crout lu_decomp().
+ */
+template<typename _NumTp, typename _SquareMatrix, typename _Vector>
+  void
+  lu_decomp(std::size_t n, _SquareMatrix& a,
+	    _Vector& index, _NumTp& parity, lu_algorithm alg)
+  {
+    switch (alg)
+      {
+      case lu_algorithm::blocked:
+	lu_decomp_blocked(n, a, index, parity);
+	break;
+      case lu_algorithm::parallel:
+	lu_decomp_parallel(n, a, index, parity);
+	break;
+      case lu_algorithm::crout:
+      default:
+	lu_decomp(n, a, index, parity);
+	break;
+      }
+  }
+
+
+/**
+ * Store the reciprocal of the largest absolute element of each row of
+ * a[0..n-1][0..n-1] in scale[0..n-1] for implicit pivot scaling.
+ */
+template<typename _NumTp, typename _SquareMatrix>
+  void
+  __lu_row_scale(std::size_t n, const _SquareMatrix& a,
+		 _NumTp* scale, const char* msg)
+  {
+    for (std::size_t i = 0; i < n; ++i)
+      {
+	_NumTp big{0};
+	for (std::size_t j = 0; j < n; ++j)
+	  if (const auto temp = std::abs(a[i][j]); temp > big)
+	    big = temp;
+	if (big == _NumTp{0})
+	  std::__throw_logic_error(msg);
+
+	// Save the scaling for the row.
+	scale[i] = _NumTp{1} / big;
+      }
+  }
+
+
+/**
+ * Swap rows j and index[j] for j in [j_begin, j_end) of the columns
+ * [col_begin, col_end) of a.
+ */
+template<typename _SquareMatrix, typename _Vector>
+  void
+  __lu_swap_rows(_SquareMatrix& a, const _Vector& index,
+		 std::size_t j_begin, std::size_t j_end,
+		 std::size_t col_begin, std::size_t col_end)
+  {
+    for (std::size_t j = j_begin; j < j_end; ++j)
+      if (const std::size_t imax = index[j]; imax != j)
+	for (std::size_t k = col_begin; k < col_end; ++k)
+	  std::swap(a[imax][k], a[j][k]);
+  }
+
+
+/**
+ * Factor the panel a[j0..n-1][j0..j0+jb-1] in place with the scaled
+ * partial pivoting of lu_decomp().  Rows are interchanged within the panel
+ * columns only; the interchanges are recorded in index[j0..j0+jb-1].
+ */
+template<typename _NumTp, typename _SquareMatrix, typename _Vector>
+  void
+  __lu_factor_panel(std::size_t n, _SquareMatrix& a,
+		    _Vector& index, _NumTp& parity,
+		    _NumTp* scale,
+		    std::size_t j0, std::size_t jb)
+  {
+    const _NumTp TINY = _NumTp(1.0e-20L);
+
+    const auto j_end = j0 + jb;
+    for (std::size_t j = j0; j < j_end; ++j)
+      {
+	// Search for the largest scaled pivot in column j.
+	auto imax = std::numeric_limits<std::size_t>::max();
+	auto big = _NumTp{0};
+	for (std::size_t i = j; i < n; ++i)
+	  if (const auto dum = scale[i] * std::abs(a[i][j]); dum >= big)
+	    {
+	      big = dum;
+	      imax = i;
+	    }
+
+	// Interchange rows within the panel if required.
+	if (j != imax)
+	  {
+	    for (std::size_t k = j0; k < j_end; ++k)
+	      std::swap(a[imax][k], a[j][k]);
+	    parity = -parity;
+	    std::swap(scale[imax], scale[j]);
+	  }
+	index[j] = imax;
+	if (a[j][j] == _NumTp{0})
+	  a[j][j] = TINY;
+
+	if (j != n - 1)
+	  {
+	    // Divide by the pivot element and update the rest of the panel.
+	    const auto rpiv = _NumTp{1} / a[j][j];
+	    for (std::size_t i = j + 1; i < n; ++i)
+	      {
+		auto&& a_i = a[i];
+		const auto l_ij = a_i[j] *= rpiv;
+		const auto& a_j = a[j];
+		for (std::size_t k = j + 1; k < j_end; ++k)
+		  a_i[k] -= l_ij * a_j[k];
+	      }
+	  }
+      }
+  }
+
+
+/**
+ * Overwrite the block row a[j0..j0+jb-1][col_begin..col_end-1]
+ * with L11^{-1} times itself where L11 is the unit lower triangle
+ * of the diagonal block at (j0, j0).
+ */
+template<typename _SquareMatrix>
+  void
+  __lu_solve_block_row(_SquareMatrix& a, std::size_t j0, std::size_t jb,
+		       std::size_t col_begin, std::size_t col_end)
+  {
+    for (std::size_t i = j0 + 1; i < j0 + jb; ++i)
+      {
+	auto&& a_i = a[i];
+	for (std::size_t k = j0; k < i; ++k)
+	  {
+	    const auto l_ik = a_i[k];
+	    const auto& a_k = a[k];
+	    for (std::size_t j = col_begin; j < col_end; ++j)
+	      a_i[j] -= l_ik * a_k[j];
+	  }
+      }
+  }
+
+
+/**
+ * Perform the Schur complement update
+ *   a[i][j] -= sum_k a[i][k] * a[k][j]
+ * for rows [row_begin, row_end), k in [k_begin, k_end)
+ * and columns [col_begin, col_end).
+ * The rows and columns are tiled so that the block rows of the multiplier
+ * stay in cache while they are streamed across the trailing submatrix.
+ */
+template<typename _SquareMatrix>
+  void
+  __lu_schur_update(_SquareMatrix& a,
+		    std::size_t row_begin, std::size_t row_end,
+		    std::size_t k_begin, std::size_t k_end,
+		    std::size_t col_begin, std::size_t col_end)
+  {
+    constexpr std::size_t row_tile = 64;
+    constexpr std::size_t col_tile = 256;
+
+    for (std::size_t jj = col_begin; jj < col_end; jj += col_tile)
+      {
+	const auto j_end = std::min(jj + col_tile, col_end);
+	for (std::size_t ii = row_begin; ii < row_end; ii += row_tile)
+	  {
+	    const auto i_end = std::min(ii + row_tile, row_end);
+	    for (std::size_t i = ii; i < i_end; ++i)
+	      {
+		auto&& a_i = a[i];
+		for (std::size_t k = k_begin; k < k_end; ++k)
+		  {
+		    const auto l_ik = a_i[k];
+		    const auto& a_k = a[k];
+		    for (std::size_t j = jj; j < j_end; ++j)
+		      a_i[j] -= l_ik * a_k[j];
+		  }
+	      }
+	  }
+      }
+  }
+
+
+/**
+ * Compute the LU decomposition of a[0..n-1][0..n-1] by a blocked
+ * right-looking loop.  Panels of block_size columns are factored
+ * with the same scaled partial pivoting as lu_decomp() and the trailing
+ * submatrix is then updated with a cache-tiled matrix multiply.
+ * The output a, index and parity are laid out exactly as in lu_decomp().
+ */
+template<typename _NumTp, typename _SquareMatrix, typename _Vector>
+  void
+  lu_decomp_blocked(std::size_t n, _SquareMatrix& a,
+		    _Vector& index, _NumTp& parity,
+		    std::size_t block_size)
+  {
+    std::vector<_NumTp> work(lu_decomp_workspace_size(n));
+    lu_decomp_blocked(n, a, index, parity, workspace_span<_NumTp>(work),
+		      block_size);
+  }
+
+
+/**
+ * Compute the blocked LU decomposition of a[0..n-1][0..n-1] as
+ * lu_decomp_blocked() taking the row scale factors from the
+ * caller-supplied workspace of lu_decomp_workspace_size(n) elements.
+ */
+template<typename _NumTp, typename _SquareMatrix, typename _Vector>
+  void
+  lu_decomp_blocked(std::size_t n, _SquareMatrix& a,
+		    _Vector& index, _NumTp& parity,
+		    workspace_span<__nondeduced_t<_NumTp>> work,
+		    std::size_t block_size)
+  {
+    if (block_size == 0)
+      block_size = 1;
+
+    auto scale = work.take(n);
+    parity = _NumTp{1};
+    __lu_row_scale(n, a, scale, "lu_decomp_blocked: singular matrix");
+
+    for (std::size_t j0 = 0; j0 < n; j0 += block_size)
+      {
+	const auto jb = std::min(block_size, n - j0);
+	const auto j1 = j0 + jb;
+
+	__lu_factor_panel(n, a, index, parity, scale, j0, jb);
+
+	// Apply the panel interchanges to the left and right of the panel.
+	__lu_swap_rows(a, index, j0, j1, 0, j0);
+	__lu_swap_rows(a, index, j0, j1, j1, n);
+
+	if (j1 < n)
+	  {
+	    // Block row of U and the trailing update.
+	    __lu_solve_block_row(a, j0, jb, j1, n);
+	    __lu_schur_update(a, j1, n, j0, j1, j1, n);
+	  }
+      }
+  }
+
+
+/**
+ * Bring the column tile a[..][col_begin..col_end-1] up to date with
+ * the factored panel at columns [j0, j1): apply the panel interchanges,
+ * form the block row of U and perform the Schur complement update.
+ */
+template<typename _SquareMatrix, typename _Vector>
+  void
+  __lu_update_tile(std::size_t n, _SquareMatrix& a, const _Vector& index,
+		   std::size_t j0, std::size_t j1,
+		   std::size_t col_begin, std::size_t col_end)
+  {
+    __lu_swap_rows(a, index, j0, j1, col_begin, col_end);
+    __lu_solve_block_row(a, j0, j1 - j0, col_begin, col_end);
+    __lu_schur_update(a, j1, n, j0, j1, col_begin, col_end);
+  }
+
+
+/**
+ * Compute the LU decomposition of a[0..n-1][0..n-1] by the blocked
+ * right-looking loop of lu_decomp_blocked() with the trailing update
+ * of each panel split into column tiles that run as tasks on pool.
+ * The next panel is updated first and factored on the calling thread
+ * while the remaining tiles are being updated.
+ * The pivot sequence and the output are the same as for lu_decomp().
+ */
+template<typename _NumTp, typename _SquareMatrix, typename _Vector>
+  void
+  lu_decomp_parallel(std::size_t n, _SquareMatrix& a,
+		     _Vector& index, _NumTp& parity,
+		     thread_pool& pool, std::size_t block_size)
+  {
+    if (block_size == 0)
+      block_size = 1;
+
+    std::vector<_NumTp> scale(n);
+    parity = _NumTp{1};
+    __lu_row_scale(n, a, scale.data(), "lu_decomp_parallel: singular matrix");
+
+    if (n == 0)
+      return;
+
+    __lu_factor_panel(n, a, index, parity, scale.data(),
+		      0, std::min(block_size, n));
+    for (std::size_t j0 = 0; j0 < n; j0 += block_size)
+      {
+	const auto j1 = std::min(j0 + block_size, n);
+
+	// Only this thread touches the columns left of the panel.
+	__lu_swap_rows(a, index, j0, j1, 0, j0);
+	if (j1 == n)
+	  break;
+
+	// Tiles right of the next panel are independent tasks...
+	const auto j2 = std::min(j1 + block_size, n);
+	task_group tiles(pool);
+	for (std::size_t c0 = j2; c0 < n; c0 += block_size)
+	  {
+	    const auto c1 = std::min(c0 + block_size, n);
+	    tiles.run([&a, &index, n, j0, j1, c0, c1]()
+		      { __lu_update_tile(n, a, index, j0, j1, c0, c1); });
+	  }
+
+	// ... while the next panel is updated and factored here.
+	__lu_update_tile(n, a, index, j0, j1, j1, j2);
+	__lu_factor_panel(n, a, index, parity, scale.data(), j1, j2 - j1);
+
+	tiles.wait();
+      }
+  }
+
+
 /**
  * Solve the set of n linear equations a.x = b.  Here a[0..n-1][0..n-1] is input, not as the original matrix a but as 
  * its LU decomposition, determined by the routine lu_decomp().  b[0..n-1] is input as the right hand side vector b 
@@ -111,7 +449,9 @@ template<typename _SquareMatrix, typename _VectorInt, typename _Vector>
 	     const _VectorInt& index,
 	     _Vector& b)
   {
-    using _NumTp = std::remove_reference_t<decltype(a[0][0])>;
+    using _NumTp = std::decay_t<decltype(a[0][0])>;
+
+    auto A = __elem_access(a);
 
     //  When i_start is set to a non-negative value, it will become the index
     //  of the first nonvanishing element of b[0..n-1].
@@ -124,7 +464,7 @@ template<typename _SquareMatrix, typename _VectorInt, typename _Vector>
 	b[i_perm] = b[i];
 	if (i_start > -1)
 	  for (std::size_t j = i_start; j <= i - 1; ++j)
-	    sum -= a[i][j] * b[j];
+	    sum -= A(i, j) * b[j];
 	else if (sum != _NumTp{0})
 	  i_start = i;
 	b[i] = sum;
@@ -135,29 +475,135 @@ template<typename _SquareMatrix, typename _VectorInt, typename _Vector>
       {
 	auto sum = b[i];
 	for (std::size_t j = i + 1; j < n; ++j)
-	  sum -= a[i][j] * b[j];
-	b[i] = sum / a[i][i];
+	  sum -= A(i, j) * b[j];
+	b[i] = sum / A(i, i);
       }
 
     return;
   }
 
 
+/**
+ * Solve a.X = B for the k right-hand sides of B accessed through elem(i, j)
+ * by streaming the rows of the factors once for all the right-hand sides.
+ */
+template<typename _SquareMatrix, typename _VectorInt, typename _Elem>
+  void
+  __lu_backsub_block(const std::size_t n,
+		     const _SquareMatrix& a,
+		     const _VectorInt& index,
+		     std::size_t k, _Elem elem)
+  {
+    // Unscramble the permutation.
+    for (std::size_t i = 0; i < n; ++i)
+      if (const std::size_t i_perm = index[i]; i_perm != i)
+	for (std::size_t j = 0; j < k; ++j)
+	  std::swap(elem(i_perm, j), elem(i, j));
+
+    // Forward substitution with the unit lower triangle.
+    for (std::size_t i = 1; i < n; ++i)
+      for (std::size_t m = 0; m < i; ++m)
+	{
+	  const auto l_im = a[i][m];
+	  for (std::size_t j = 0; j < k; ++j)
+	    elem(i, j) -= l_im * elem(m, j);
+	}
+
+    // Backsubstitution with the upper triangle.
+    for (std::ptrdiff_t i = n - 1; i >= 0; --i)
+      {
+	for (std::size_t m = i + 1; m < n; ++m)
+	  {
+	    const auto u_im = a[i][m];
+	    for (std::size_t j = 0; j < k; ++j)
+	      elem(i, j) -= u_im * elem(m, j);
+	  }
+	const auto u_ii = a[i][i];
+	for (std::size_t j = 0; j < k; ++j)
+	  elem(i, j) /= u_ii;
+      }
+  }
+
+
+/**
+ * Solve the set of n linear equations a.X = B for the k right-hand sides
+ * in the columns of b[0..n-1][0..k-1].  Here a[0..n-1][0..n-1] and index
+ * are the LU decomposition from lu_decomp().  B is overwritten with
+ * the solution X.  Each element of the L and U factors is read once
+ * for all k right-hand sides and no memory is allocated.
+ */
+template<typename _SquareMatrix, typename _VectorInt, typename _Matrix>
+  void
+  lu_backsub(const std::size_t n,
+	     const _SquareMatrix& a,
+	     const _VectorInt& index,
+	     _Matrix& b, std::size_t k)
+  {
+    __lu_backsub_block(n, a, index, k,
+		       [&b](std::size_t i, std::size_t j) -> auto&
+		       { return b[i][j]; });
+  }
+
+
+/**
+ * Solve the set of n linear equations a.X = B for the k right-hand sides
+ * stored contiguously at b with leading dimension ldb
+ * in row-major (layout_right) or column-major (layout_left) order.
+ * B is overwritten with the solution X.
+ */
+template<typename _SquareMatrix, typename _VectorInt, typename _NumTp,
+	 typename _Layout>
+  void
+  lu_backsub(const std::size_t n,
+	     const _SquareMatrix& a,
+	     const _VectorInt& index,
+	     _NumTp* b, std::size_t k, std::size_t ldb, _Layout)
+  {
+    if constexpr (std::is_same_v<_Layout, layout_left>)
+      __lu_backsub_block(n, a, index, k,
+			 [b, ldb](std::size_t i, std::size_t j) -> _NumTp&
+			 { return b[i + j * ldb]; });
+    else
+      __lu_backsub_block(n, a, index, k,
+			 [b, ldb](std::size_t i, std::size_t j) -> _NumTp&
+			 { return b[i * ldb + j]; });
+  }
+
+
 /**
  * Improves a solution vector x of the linear set A.x = b.  The matrix a and the
  * LU decomposition of a a_lu (with its row permutation vector index) and the
  * right-hand side vector are input along with the solution vector x.  
  * The solution vector x is improved and modified on output.
  */
-template<typename _SquareMatrix, typename _VectorInt, typename _Vector>
+template<typename _SquareMatrix, typename _SquareMatrixLU,
+	 typename _VectorInt, typename _Vector>
   void
   lu_improve(const std::size_t n, const _SquareMatrix& a,
-	     const _SquareMatrix& a_lu,
+	     const _SquareMatrixLU& a_lu,
 	     const _VectorInt& index, const _Vector& b, _Vector& x)
   {
-    using _NumTp = std::remove_reference_t<decltype(a[0][0])>;
+    using _NumTp = std::decay_t<decltype(a[0][0])>;
 
-    std::vector<_NumTp> r(n);
+    std::vector<_NumTp> work(lu_improve_workspace_size(n));
+    lu_improve(n, a, a_lu, index, b, x, workspace_span<_NumTp>(work));
+  }
+
+
+/**
+ * Improve a solution vector x of the linear set A.x = b as lu_improve()
+ * taking the residual vector from the caller-supplied workspace
+ * of lu_improve_workspace_size(n) elements.
+ */
+template<typename _SquareMatrix, typename _SquareMatrixLU,
+	 typename _VectorInt, typename _Vector>
+  void
+  lu_improve(const std::size_t n, const _SquareMatrix& a,
+	     const _SquareMatrixLU& a_lu,
+	     const _VectorInt& index, const _Vector& b, _Vector& x,
+	     workspace_span<__matrix_value_t<_SquareMatrix>> work)
+  {
+    auto r = work.take(n);
 
     for (std::size_t i = 0; i < n; ++i)
       {
@@ -166,7 +612,7 @@ template<typename _SquareMatrix, typename _VectorInt, typename _Vector>
 	  r[i] += a[i][j] * x[j];
       }
 
-    lu_backsub(a_lu, n, index, r);
+    lu_backsub(n, a_lu, index, r);
 
     for (std::size_t i = 0; i < n; ++i)
       x[i] -= r[i];
@@ -175,28 +621,184 @@ template<typename _SquareMatrix, typename _VectorInt, typename _Vector>
   }
 
 
+/**
+ * Solve a.x = b with a low precision LU decomposition
+ * and refinement in the working precision.
+ */
+template<typename _LowTp, typename _SquareMatrix, typename _Vector>
+  lu_mixed_info
+  lu_solve_mixed(std::size_t n, const _SquareMatrix& a,
+		 const _Vector& b, _Vector& x,
+		 lu_algorithm alg, std::size_t max_iter)
+  {
+    using _NumTp = __matrix_value_t<_SquareMatrix>;
+    using _AccTp = promote_t<_NumTp>;
+
+    lu_mixed_info info;
+    if (n == 0)
+      return info;
+
+    auto A = __elem_access(a);
+
+    _NumTp a_norm = _NumTp{0};
+    for (std::size_t i = 0; i < n; ++i)
+      {
+	_NumTp s = _NumTp{0};
+	for (std::size_t j = 0; j < n; ++j)
+	  s += std::abs(A(i, j));
+	a_norm = std::max(a_norm, s);
+      }
+    const auto tol = std::sqrt(_NumTp(n))
+		   * std::numeric_limits<_NumTp>::epsilon() * a_norm;
+
+    std::vector<std::size_t> index(n);
+    std::vector<_NumTp> r(n);
+    std::vector<_LowTp> d(n);
+
+    //  Return the infinity norm of b - a.x left in r.
+    auto residual = [&]()
+      {
+	_NumTp r_norm = _NumTp{0};
+	for (std::size_t i = 0; i < n; ++i)
+	  {
+	    _AccTp s = b[i];
+	    for (std::size_t j = 0; j < n; ++j)
+	      s -= _AccTp(A(i, j)) * _AccTp(x[j]);
+	    r[i] = _NumTp(s);
+	    r_norm = std::max(r_norm, std::abs(r[i]));
+	  }
+	return r_norm;
+      };
+
+    bool low_ok = (a_norm <= _NumTp(std::numeric_limits<_LowTp>::max()));
+    if (low_ok)
+      {
+	dense_matrix<_LowTp> a_low(n, n);
+	for (std::size_t i = 0; i < n; ++i)
+	  for (std::size_t j = 0; j < n; ++j)
+	    a_low(i, j) = _LowTp(A(i, j));
+
+	_LowTp parity;
+	try
+	  {
+	    lu_decomp(n, a_low, index, parity, alg);
+	  }
+	catch (const std::logic_error&)
+	  {
+	    low_ok = false;
+	  }
+
+	if (low_ok)
+	  {
+	    for (std::size_t i = 0; i < n; ++i)
+	      d[i] = _LowTp(b[i]);
+	    lu_backsub(n, a_low, index, d);
+	    for (std::size_t i = 0; i < n; ++i)
+	      x[i] = d[i];
+
+	    auto r_norm = residual();
+	    low_ok = false;
+	    while (std::isfinite(r_norm))
+	      {
+		_NumTp x_norm = _NumTp{0};
+		for (std::size_t i = 0; i < n; ++i)
+		  x_norm = std::max(x_norm, std::abs(_NumTp(x[i])));
+		if (r_norm <= tol * x_norm)
+		  {
+		    low_ok = true;
+		    break;
+		  }
+		if (info.iterations == max_iter)
+		  break;
+
+		for (std::size_t i = 0; i < n; ++i)
+		  d[i] = _LowTp(r[i]);
+		lu_backsub(n, a_low, index, d);
+		for (std::size_t i = 0; i < n; ++i)
+		  x[i] += d[i];
+		++info.iterations;
+
+		const auto r_norm_prev = r_norm;
+		r_norm = residual();
+		if (!(r_norm <= r_norm_prev / _NumTp{2})
+		    && !(r_norm <= tol * x_norm))
+		  break;
+	      }
+	  }
+      }
+
+    if (!low_ok)
+      {
+	info.fallback = true;
+	dense_matrix<_NumTp> a_lu(n, n);
+	for (std::size_t i = 0; i < n; ++i)
+	  for (std::size_t j = 0; j < n; ++j)
+	    a_lu(i, j) = A(i, j);
+	_NumTp parity;
+	lu_decomp(n, a_lu, index, parity, alg);
+	for (std::size_t i = 0; i < n; ++i)
+	  x[i] = b[i];
+	lu_backsub(n, a_lu, index, x);
+	residual();
+	lu_backsub(n, a_lu, index, r);
+	for (std::size_t i = 0; i < n; ++i)
+	  x[i] += r[i];
+      }
+
+    return info;
+  }
+
+
 /**
  * Inverts a matrix given the LU decomposed matrix.
+ * The inverse is formed in place from the identity as U^{-1}.L^{-1}.P
+ * without any temporary storage.
  *
  * The inverse matrix is NOT in LU form.
  */
-template<typename _SquareMatrix, typename _VectorInt>
+template<typename _SquareMatrixLU, typename _VectorInt, typename _SquareMatrix>
   void
-  lu_invert(const std::size_t n, const _SquareMatrix& a_lu,
+  lu_invert(const std::size_t n, const _SquareMatrixLU& a_lu,
 	    const _VectorInt& index, _SquareMatrix& a_inv)
   {
-    using _NumTp = std::remove_reference_t<decltype(a_inv[0][0])>;
+    using _NumTp = std::decay_t<decltype(a_inv[0][0])>;
 
-    for (std::size_t j = 0; j < n; ++j)
+    // Form L^{-1} in the lower triangle; row m of it vanishes past column m.
+    for (std::size_t i = 0; i < n; ++i)
       {
-	std::vector<_NumTp> col(n);
-	col[j] = _NumTp{1};
+	auto&& a_inv_i = a_inv[i];
+	for (std::size_t j = 0; j < n; ++j)
+	  a_inv_i[j] = (i == j ? _NumTp{1} : _NumTp{0});
+	for (std::size_t m = 0; m < i; ++m)
+	  {
+	    const auto l_im = a_lu[i][m];
+	    const auto& a_inv_m = a_inv[m];
+	    for (std::size_t j = 0; j <= m; ++j)
+	      a_inv_i[j] -= l_im * a_inv_m[j];
+	  }
+      }
 
-	lu_backsub(n, a_lu, index, col);
+    // Backsubstitute with U for all the columns at once.
+    for (std::ptrdiff_t i = n - 1; i >= 0; --i)
+      {
+	auto&& a_inv_i = a_inv[i];
+	for (std::size_t m = i + 1; m < n; ++m)
+	  {
+	    const auto u_im = a_lu[i][m];
+	    const auto& a_inv_m = a_inv[m];
+	    for (std::size_t j = 0; j < n; ++j)
+	      a_inv_i[j] -= u_im * a_inv_m[j];
+	  }
+	const auto u_ii = a_lu[i][i];
+	for (std::size_t j = 0; j < n; ++j)
+	  a_inv_i[j] /= u_ii;
+      }
 
+    // Undo the row permutation as column interchanges in reverse order.
+    for (std::ptrdiff_t j = n - 1; j >= 0; --j)
+      if (const std::size_t j_perm = index[j]; j_perm != std::size_t(j))
 	for (std::size_t i = 0; i < n; ++i)
-	  a_inv[i][j] = col[i];
-      }
+	  std::swap(a_inv[i][j], a_inv[i][j_perm]);
 
     return;
   }
@@ -225,7 +827,7 @@ template<typename _SquareMatrix>
   auto
   lu_trace(const std::size_t n, const _SquareMatrix& a_lu)
   {
-    using _NumTp = std::remove_reference_t<decltype(a_lu[0][0])>;
+    using _NumTp = std::decay_t<decltype(a_lu[0][0])>;
 
     auto trace = _NumTp{0};
 
@@ -239,6 +841,374 @@ template<typename _SquareMatrix>
     return trace;
   }
 
+
+template<typename _NumTp, typename _SquareMatrix, typename _Storage>
+  template<typename _SquareMatrix2>
+    lu_decomposition<_NumTp, _SquareMatrix, _Storage>::
+    lu_decomposition(std::size_t n, const _SquareMatrix2& a,
+		     lu_algorithm alg)
+    : m_n(n), m_a(__make_storage<_Storage>(n, n, a)),
+      m_index(n), m_parity(1), m_diag(n)
+    {
+      for (std::size_t i = 0; i < m_n; ++i)
+	m_diag[i] = a[i][i];
+      lu_decomp(m_n, m_a, m_index, m_parity, alg);
+    }
+
+template<typename _NumTp, typename _SquareMatrix, typename _Storage>
+  template<typename _SquareMatrix2>
+    lu_decomposition<_NumTp, _SquareMatrix, _Storage>::
+    lu_decomposition(std::size_t n, const _SquareMatrix2& a,
+		     thread_pool& pool)
+    : m_n(n), m_a(__make_storage<_Storage>(n, n, a)),
+      m_index(n), m_parity(1), m_diag(n)
+    {
+      for (std::size_t i = 0; i < m_n; ++i)
+	m_diag[i] = a[i][i];
+      lu_decomp_parallel(m_n, m_a, m_index, m_parity, pool);
+    }
+
+template<typename _NumTp, typename _SquareMatrix, typename _Storage>
+  template<typename _Vector, typename _VectorOut>
+    void
+    lu_decomposition<_NumTp, _SquareMatrix, _Storage>::
+    backsubstitute(const _Vector& b, _VectorOut& x) const
+    {
+      if (!m_col.empty())
+	{
+	  std::vector<value_type> y(m_n);
+	  for (std::size_t i = 0; i < m_n; ++i)
+	    y[i] = b[i];
+	  solve_updated(y);
+	  for (std::size_t i = 0; i < m_n; ++i)
+	    x[i] = y[i];
+	  return;
+	}
+      for (std::size_t i = 0; i < m_n; ++i)
+	x[i] = b[i];
+      lu_backsub(m_n, m_a, m_index, x);
+    }
+
+template<typename _NumTp, typename _SquareMatrix, typename _Storage>
+  template<typename _Matrix>
+    void
+    lu_decomposition<_NumTp, _SquareMatrix, _Storage>::
+    backsubstitute(_Matrix& b, std::size_t k) const
+    {
+      if (!m_col.empty())
+	{
+	  std::vector<value_type> y(m_n);
+	  for (std::size_t j = 0; j < k; ++j)
+	    {
+	      for (std::size_t i = 0; i < m_n; ++i)
+		y[i] = b[i][j];
+	      solve_updated(y);
+	      for (std::size_t i = 0; i < m_n; ++i)
+		b[i][j] = y[i];
+	    }
+	  return;
+	}
+      lu_backsub(m_n, m_a, m_index, b, k);
+    }
+
+template<typename _NumTp, typename _SquareMatrix, typename _Storage>
+  template<typename InVecIter, typename OutVecIter>
+    void
+    lu_decomposition<_NumTp, _SquareMatrix, _Storage>::
+    backsubstitution(InVecIter b_begin, InVecIter b_end,
+		     OutVecIter x_begin) const
+    {
+      std::vector<value_type> x(b_begin, b_end);
+      if (!m_col.empty())
+	solve_updated(x);
+      else
+	lu_backsub(m_n, m_a, m_index, x);
+      std::copy(x.begin(), x.end(), x_begin);
+    }
+
+template<typename _NumTp, typename _SquareMatrix, typename _Storage>
+  template<typename _SquareMatrix2, typename _Vector, typename _VectorOut>
+    void
+    lu_decomposition<_NumTp, _SquareMatrix, _Storage>::
+    improve(const _SquareMatrix2& a_orig,
+	    const _Vector& b, _VectorOut& x) const
+    {
+      if (!m_col.empty())
+	{
+	  std::vector<value_type> r(m_n);
+	  for (std::size_t i = 0; i < m_n; ++i)
+	    {
+	      r[i] = -b[i];
+	      for (std::size_t j = 0; j < m_n; ++j)
+		r[i] += a_orig[i][j] * x[j];
+	    }
+	  solve_updated(r);
+	  for (std::size_t i = 0; i < m_n; ++i)
+	    x[i] -= r[i];
+	  return;
+	}
+      lu_improve(m_n, a_orig, m_a, m_index, b, x);
+    }
+
+template<typename _NumTp, typename _SquareMatrix, typename _Storage>
+  template<typename _SquareMatrix2, typename InVecIter, typename OutVecIter>
+    void
+    lu_decomposition<_NumTp, _SquareMatrix, _Storage>::
+    improve(const _SquareMatrix2& a_orig,
+	    InVecIter b_begin, InVecIter b_end,
+	    OutVecIter x_begin) const
+    {
+      std::vector<value_type> b(b_begin, b_end);
+      std::vector<value_type> x(x_begin, x_begin + m_n);
+      improve(a_orig, b, x);
+      std::copy(x.begin(), x.end(), x_begin);
+    }
+
+template<typename _NumTp, typename _SquareMatrix, typename _Storage>
+  template<typename _SquareMatrix2>
+    void
+    lu_decomposition<_NumTp, _SquareMatrix, _Storage>::
+    inverse(_SquareMatrix2& a_inv) const
+    {
+      if (!m_col.empty())
+	{
+	  std::vector<value_type> y(m_n);
+	  for (std::size_t j = 0; j < m_n; ++j)
+	    {
+	      for (std::size_t i = 0; i < m_n; ++i)
+		y[i] = (i == j ? value_type{1} : value_type{0});
+	      solve_updated(y);
+	      for (std::size_t i = 0; i < m_n; ++i)
+		a_inv[i][j] = y[i];
+	    }
+	  return;
+	}
+      lu_invert(m_n, m_a, m_index, a_inv);
+    }
+
+/**
+ * Start the column order of U at the identity before the first update.
+ */
+template<typename _NumTp, typename _SquareMatrix, typename _Storage>
+  void
+  lu_decomposition<_NumTp, _SquareMatrix, _Storage>::
+  begin_update()
+  {
+    if (m_col.empty())
+      {
+	m_col.resize(m_n);
+	std::iota(m_col.begin(), m_col.end(), std::size_t{0});
+      }
+  }
+
+/**
+ * Restore the upper Hessenberg U with subdiagonal h[k0..n-2] to triangular
+ * form by eliminating each h[k] against the diagonal above it,
+ * interchanging the two rows first if h[k] is the larger,
+ * and record the eliminations.  Zero pivots are replaced by
+ * a tiny value as lu_decomp() does.
+ */
+template<typename _NumTp, typename _SquareMatrix, typename _Storage>
+  void
+  lu_decomposition<_NumTp, _SquareMatrix, _Storage>::
+  eliminate_subdiagonal(std::size_t k0, std::vector<value_type>& h)
+  {
+    const value_type TINY = value_type(1.0e-20L);
+
+    auto A = __elem_access(m_a);
+    for (std::size_t k = k0; k + 1 < m_n; ++k)
+      {
+	if (h[k] == value_type{0})
+	  continue;
+	const bool swap = std::abs(h[k]) > std::abs(A(k, k));
+	if (swap)
+	  {
+	    std::swap(A(k, k), h[k]);
+	    for (std::size_t c = k + 1; c < m_n; ++c)
+	      std::swap(A(k, c), A(k + 1, c));
+	    m_parity = -m_parity;
+	  }
+	const auto mult = h[k] / A(k, k);
+	for (std::size_t c = k + 1; c < m_n; ++c)
+	  A(k + 1, c) -= mult * A(k, c);
+	h[k] = value_type{0};
+	m_ops.push_back({k, swap, mult});
+      }
+    for (std::size_t k = k0; k < m_n; ++k)
+      if (A(k, k) == value_type{0})
+	A(k, k) = TINY;
+  }
+
+/**
+ * Solve a.x = b with an updated decomposition, b being replaced by x:
+ * the interchanges and L, then the row eliminations of the updates,
+ * then U, and finally the column order of U.
+ */
+template<typename _NumTp, typename _SquareMatrix, typename _Storage>
+  void
+  lu_decomposition<_NumTp, _SquareMatrix, _Storage>::
+  solve_updated(std::vector<value_type>& x) const
+  {
+    auto A = __elem_access(m_a);
+    for (std::size_t i = 0; i < m_n; ++i)
+      {
+	const auto i_perm = m_index[i];
+	auto sum = x[i_perm];
+	x[i_perm] = x[i];
+	for (std::size_t j = 0; j < i; ++j)
+	  sum -= A(i, j) * x[j];
+	x[i] = sum;
+      }
+    for (const auto& op : m_ops)
+      {
+	if (op.swap)
+	  std::swap(x[op.k], x[op.k + 1]);
+	x[op.k + 1] -= op.mult * x[op.k];
+      }
+    for (std::size_t i = m_n; i-- > 0; )
+      {
+	auto sum = x[i];
+	for (std::size_t j = i + 1; j < m_n; ++j)
+	  sum -= A(i, j) * x[j];
+	x[i] = sum / A(i, i);
+      }
+    std::vector<value_type> y(x);
+    for (std::size_t c = 0; c < m_n; ++c)
+      x[m_col[c]] = y[c];
+  }
+
+template<typename _NumTp, typename _SquareMatrix, typename _Storage>
+  template<typename _Vector>
+    void
+    lu_decomposition<_NumTp, _SquareMatrix, _Storage>::
+    replace_column(std::size_t j, const _Vector& a_col)
+    {
+      if (j >= m_n)
+	std::__throw_out_of_range("lu_decomposition::replace_column: "
+				  "column index out of range");
+      begin_update();
+      m_diag[j] = a_col[j];
+
+      const auto p = static_cast<std::size_t>(std::find(m_col.begin(),
+							m_col.end(), j)
+					      - m_col.begin());
+
+      //  The spike is a_col brought to the basis of the factors so far.
+      std::vector<value_type> y(m_n);
+      for (std::size_t i = 0; i < m_n; ++i)
+	y[i] = a_col[i];
+      auto A = __elem_access(m_a);
+      for (std::size_t i = 0; i < m_n; ++i)
+	{
+	  const auto i_perm = m_index[i];
+	  auto sum = y[i_perm];
+	  y[i_perm] = y[i];
+	  for (std::size_t k = 0; k < i; ++k)
+	    sum -= A(i, k) * y[k];
+	  y[i] = sum;
+	}
+      for (const auto& op : m_ops)
+	{
+	  if (op.swap)
+	    std::swap(y[op.k], y[op.k + 1]);
+	  y[op.k + 1] -= op.mult * y[op.k];
+	}
+
+      //  Shift the columns after p left, their diagonals dropping
+      //  to the subdiagonal, and put the spike last.
+      std::vector<value_type> h(m_n);
+      for (std::size_t c = p; c + 1 < m_n; ++c)
+	{
+	  for (std::size_t i = 0; i <= c; ++i)
+	    A(i, c) = A(i, c + 1);
+	  h[c] = A(c + 1, c + 1);
+	}
+      for (std::size_t i = 0; i < m_n; ++i)
+	A(i, m_n - 1) = y[i];
+      std::rotate(m_col.begin() + p, m_col.begin() + p + 1, m_col.end());
+      if ((m_n - 1 - p) % 2 == 1)
+	m_parity = -m_parity;
+
+      eliminate_subdiagonal(p, h);
+    }
+
+template<typename _NumTp, typename _SquareMatrix, typename _Storage>
+  template<typename _Vector, typename _Vector2>
+    void
+    lu_decomposition<_NumTp, _SquareMatrix, _Storage>::
+    update(const _Vector& u, const _Vector2& v)
+    {
+      begin_update();
+      for (std::size_t i = 0; i < m_n; ++i)
+	m_diag[i] += u[i] * v[i];
+
+      std::vector<value_type> w(m_n);
+      for (std::size_t i = 0; i < m_n; ++i)
+	w[i] = u[i];
+      auto A = __elem_access(m_a);
+      for (std::size_t i = 0; i < m_n; ++i)
+	{
+	  const auto i_perm = m_index[i];
+	  auto sum = w[i_perm];
+	  w[i_perm] = w[i];
+	  for (std::size_t k = 0; k < i; ++k)
+	    sum -= A(i, k) * w[k];
+	  w[i] = sum;
+	}
+      for (const auto& op : m_ops)
+	{
+	  if (op.swap)
+	    std::swap(w[op.k], w[op.k + 1]);
+	  w[op.k + 1] -= op.mult * w[op.k];
+	}
+
+      //  Reduce w to w[0] e_0 from the bottom up; each elimination puts
+      //  an entry on the subdiagonal of U.
+      std::vector<value_type> h(m_n);
+      for (std::size_t k = m_n - 1; k-- > 0; )
+	{
+	  if (w[k + 1] == value_type{0})
+	    continue;
+	  const bool swap = std::abs(w[k + 1]) > std::abs(w[k]);
+	  if (swap)
+	    {
+	      std::swap(w[k], w[k + 1]);
+	      std::swap(A(k, k), h[k]);
+	      for (std::size_t c = k + 1; c < m_n; ++c)
+		std::swap(A(k, c), A(k + 1, c));
+	      m_parity = -m_parity;
+	    }
+	  const auto mult = w[k + 1] / w[k];
+	  w[k + 1] = value_type{0};
+	  h[k] -= mult * A(k, k);
+	  for (std::size_t c = k + 1; c < m_n; ++c)
+	    A(k + 1, c) -= mult * A(k, c);
+	  m_ops.push_back({k, swap, mult});
+	}
+
+      for (std::size_t c = 0; c < m_n; ++c)
+	A(0, c) += w[0] * v[m_col[c]];
+
+      eliminate_subdiagonal(0, h);
+    }
+
+template<typename _NumTp, typename _SquareMatrix, typename _Storage>
+  _NumTp
+  lu_decomposition<_NumTp, _SquareMatrix, _Storage>::
+  determinant() const
+  { return lu_determinant(m_n, m_a, m_parity); }
+
+template<typename _NumTp, typename _SquareMatrix, typename _Storage>
+  _NumTp
+  lu_decomposition<_NumTp, _SquareMatrix, _Storage>::
+  trace() const
+  {
+    auto trace = _NumTp{0};
+    for (const auto& d : m_diag)
+      trace += d;
+    return trace;
+  }
+
 } // namespace matrix
 
 #endif // MATRIX_LU_DECOMP_TCC
@@ -3,26 +3,75 @@
 
 #include <vector>
 
+#include "matrix_dense.h"
+#include "matrix_layout.h"
+#include "matrix_thread_pool.h"
+#include "matrix_workspace.h"
+
 namespace matrix
 {
 
+/**
+ * The algorithms available for computing the QR decomposition.
+ */
+enum class qr_algorithm
+{
+  /// One Householder reflection applied at a time.
+  householder,
+  /// Panels of reflections applied together in compact WY form.
+  blocked,
+  /// Blocked factorizations of row blocks on a thread pool
+  /// whose R factors are combined pairwise up a binary tree.
+  tsqr
+};
+
+/**
+ * One combining step of a TSQR tree: the QR decomposition of the two
+ * stacked n_cols*n_cols R factors left and right, numbered with the leaves
+ * first and then the nodes in the order they were formed.
+ */
+template<typename _Tp>
+  struct __qr_tsqr_node
+  {
+    std::size_t left;
+    std::size_t right;
+    dense_matrix<_Tp> a;
+    std::vector<_Tp> c;
+    std::vector<_Tp> d;
+    bool singular;
+  };
+
 /**
  *  This class represents an QR decomposition.
+ *  The factors are held in a copy of the input of type _Storage,
+ *  by default an aligned, contiguous dense_matrix.
+ *  For n_rows > n_cols backsubstitution() returns the least-squares
+ *  solution in x[0..n_cols - 1].
  */
-template<typename _NumTp, typename _Matrix>
+template<typename _NumTp, typename _Matrix,
+	 typename _Storage = dense_matrix<__matrix_value_t<_Matrix>>>
   class qr_decomposition
   {
 
   public:
 
-    using value_type = std::decay_t<decltype(_Matrix{}[0][0])>;
+    using value_type = __matrix_value_t<_Matrix>;
 
     template<typename _Matrix2>
-      qr_decomposition(std::size_t m_n_rows, std::size_t n_cols,
-		       _Matrix2& a);
+      qr_decomposition(std::size_t n_rows, std::size_t n_cols,
+		       const _Matrix2& a,
+		       qr_algorithm alg = qr_algorithm::householder);
+
+    /**
+     * Construct the TSQR decomposition with one row block
+     * for each thread of pool and the calling thread.
+     */
+    template<typename _Matrix2>
+      qr_decomposition(std::size_t n_rows, std::size_t n_cols,
+		       const _Matrix2& a, thread_pool& pool);
 
     template<typename _Vector2, typename _VectorOut>
-      void backsubstitution(_Vector2& b, _VectorOut& x);
+      void backsubstitution(const _Vector2& b, _VectorOut& x) const;
 
     template<typename _InVecIter, typename _OutVecIter>
       void
@@ -30,25 +79,38 @@ template<typename _NumTp, typename _Matrix>
 		       _OutVecIter x_begin) const;
 
     template<typename _Matrix2>
-      void inverse(_Matrix2& a_inv);
+      void inverse(_Matrix2& a_inv) const;
 
     template<typename _Matrix2, typename _Vector2>
       void update(_Matrix2& r, _Matrix2& qt,
-		  _Vector2& u, _Vector2& v);
+		  _Vector2& u, _Vector2& v) const;
+
+    bool singular() const
+    { return m_singular; }
 
   private:
 
+    void factor_tsqr(thread_pool& pool);
+
+    void solve_tsqr(std::vector<value_type>& y) const;
+
     std::size_t m_n_rows;
 
     std::size_t m_n_cols;
 
-    _Matrix m_a;
+    _Storage m_a;
 
-    std::vector<std::size_t> m_c;
+    std::vector<value_type> m_c;
 
-    std::vector<std::size_t> m_d;
+    std::vector<value_type> m_d;
 
     bool m_singular;
+
+    /// The first row of each TSQR row block and n_rows;
+    /// empty unless there is more than one block.
+    std::vector<std::size_t> m_tsqr_rows;
+
+    std::vector<__qr_tsqr_node<value_type>> m_tsqr_nodes;
   };
 
 /**
@@ -56,7 +118,8 @@ template<typename _NumTp, typename _Matrix>
  * is returned in the upper triangle of a except the diagonal elements of R which are returned
  * in d[0..n_cols - 1].  The orthogonal matrix Q is represented as a product of n - 1 Householder
  * matrices Q_0...Q_n-2 where Q_j = 1 - u_j x u_j/c_j.  The ith component of u_j is zero for
- * i = 
+ * i = 0..j-1 and the remaining components are stored in a[j..n_rows-1][j].
+ * For n_rows > n_cols every column has a reflection, n_cols in all.
  */
 template<typename _Matrix, typename _Vector>
   void
@@ -64,6 +127,21 @@ template<typename _Matrix, typename _Vector>
 	    _Matrix& a,
 	    _Vector& c, _Vector& d, bool& singular);
 
+/**
+ * Constructs the QR decomposition of a[0..n_rows - 1][0..n_cols - 1]
+ * as qr_decomp() does, a panel of block_size columns at a time.
+ * The reflections of a panel are accumulated in the compact WY form
+ * I - V.T.V^T and applied to the columns right of the panel
+ * with three matrix multiplies.
+ * The output a, c and d are laid out exactly as those of qr_decomp().
+ */
+template<typename _Matrix, typename _Vector>
+  void
+  qr_decomp_blocked(std::size_t n_rows, std::size_t n_cols,
+		    _Matrix& a,
+		    _Vector& c, _Vector& d, bool& singular,
+		    std::size_t block_size = 32);
+
 /**
  * This routine solves the set of equations Rx = b where R is the upper triangular
  * matrix stored in a[0..n_rows - 1][0..n_cols - 1] and d[0..n_cols - 1].
@@ -94,12 +172,30 @@ template<typename _Matrix, typename _Vector, typename _VectorB>
  *
  * The inverse matrix is NOT in QR form.
  */
-template<typename _Matrix, typename _Vector>
+template<typename _MatrixQR, typename _Vector, typename _Matrix>
   void
   qr_invert(std::size_t n_rows, std::size_t n_cols,
-	    const _Matrix& a_qr, const _Vector& c, const _Vector& d,
+	    const _MatrixQR& a_qr, const _Vector& c, const _Vector& d,
 	    _Matrix& a_inv);
 
+/**
+ * Return the number of elements of workspace needed by qr_invert()
+ * for an n_rows*n_cols matrix.
+ */
+constexpr std::size_t
+qr_invert_workspace_size(std::size_t n_rows, std::size_t /*n_cols*/) noexcept
+{ return n_rows; }
+
+/**
+ * Invert a matrix given its QR decomposition as above without allocating.
+ * work must hold at least qr_invert_workspace_size(n_rows, n_cols) elements.
+ */
+template<typename _MatrixQR, typename _Vector, typename _Matrix>
+  void
+  qr_invert(std::size_t n_rows, std::size_t n_cols,
+	    const _MatrixQR& a_qr, const _Vector& c, const _Vector& d,
+	    _Matrix& a_inv, workspace_span<__matrix_value_t<_MatrixQR>> work);
+
 /**
  *  Update the QR decomposition.
  */
@@ -116,7 +212,7 @@ template<typename _Matrix, typename _Vector>
  *    cos(theta) = a/sqrt(a^2 + b^2)
  *    sin(theta) = b/sqrt(a^2 + b^2).
  */
-template<typename _NumTp, typename _Matrix, typename _Vector>
+template<typename _NumTp, typename _Matrix>
   void
   jacobi_rotate(const int i, const int n_rows, const int n_cols,
 		_Matrix& r, _Matrix& qt,
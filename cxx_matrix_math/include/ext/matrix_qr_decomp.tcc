@@ -3,9 +3,14 @@
 
 
 #include <cstdlib>
+#include <algorithm>
 #include <iostream>
 #include <vector>
 #include <cmath>
+#include <type_traits>
+
+#include "matrix_gemm.h"
+#include "matrix_layout.h"
 
 
 namespace matrix
@@ -14,34 +19,36 @@ namespace matrix
 
 
 /**
- * Constructs the QR decomposition of a[0..n_rows - 1][0..n_cols - 1].  The upper triangular matrix R
- * is returned in the upper triangle of a except the diagonal elements of R which are returned
- * in d[0..n_cols - 1].  The orthogonal matrix Q is represented as a product of n - 1 Householder
- * matrices Q_0...Q_n-2 where Q_j = 1 - u_j x u_j/c_j.  The ith component of u_j is zero for
- * i = 
+ * Return the number of Householder reflections in the QR decomposition
+ * of an n_rows*n_cols matrix: a square matrix needs none for its last column.
  */
-template<typename _Matrix, typename _Vector>
+constexpr std::size_t
+__qr_num_reflections(std::size_t n_rows, std::size_t n_cols) noexcept
+{ return n_rows > n_cols ? n_cols : (n_cols > 0 ? n_cols - 1 : 0); }
+
+
+/**
+ * Compute the Householder reflections for the columns [k0, k1)
+ * of the matrix accessed by A(i, j) and apply each of them to the columns
+ * to its right up to j_end.
+ */
+template<typename _ElemA, typename _Vector>
   void
-  qr_decomp(std::size_t n_rows, std::size_t n_cols,
-	    _Matrix& a,
-	    _Vector& c, _Vector& d, bool& singular)
+  __qr_factor_panel(_ElemA A, std::size_t n_rows,
+		    std::size_t k0, std::size_t k1, std::size_t j_end,
+		    _Vector& c, _Vector& d, bool& singular)
   {
-    using _NumTp = std::remove_reference_t<decltype(a[0][0])>;
+    using _NumTp = std::decay_t<decltype(A(0, 0))>;
 
     _NumTp sigma, sum, tau;
 
-    //  Allocate the two vectors.
-    //c.resize(n);
-    //d.resize(n);
-
-    singular = false;
-    for (std::size_t k = 0; k < n_cols - 1; ++k)
+    for (std::size_t k = k0; k < k1; ++k)
       {
 	//  See if the matrix is singular in this column.
 	_NumTp scale = _NumTp{0};
 	for (std::size_t i = k; i < n_rows; ++i)
-	  if (scale < std::abs(a[i][k]))
-	    scale = std::abs(a[i][k]);
+	  if (scale < std::abs(A(i, k)))
+	    scale = std::abs(A(i, k));
 
 	if (scale == _NumTp{0})
 	  {
@@ -53,57 +60,335 @@ template<typename _Matrix, typename _Vector>
 	    sum = _NumTp{0};
 	    for (std::size_t i = k; i < n_rows; ++i)
 	      {
-		a[i][k] /= scale;
-		sum += a[i][k] * a[i][k];
+		A(i, k) /= scale;
+		sum += A(i, k) * A(i, k);
 	      }
 	    sigma = std::sqrt(sum);
-	    if (a[k][k] < _NumTp{0})
+	    if (A(k, k) < _NumTp{0})
 	      sigma = -sigma;
-	    a[k][k] += sigma;
-	    c[k] = sigma * a[k][k];
+	    A(k, k) += sigma;
+	    c[k] = sigma * A(k, k);
 	    d[k] = -scale * sigma;
-	    for (std::size_t j = k + 1; j < n_cols; ++j)
+	    for (std::size_t j = k + 1; j < j_end; ++j)
 	      {
 		sum = _NumTp{0};
 		for (std::size_t i = k; i < n_rows; ++i)
-		  sum += a[i][k] * a[i][j];
+		  sum += A(i, k) * A(i, j);
 		tau = sum/c[k];
 		for (std::size_t i = k; i < n_rows; ++i)
-		  a[i][j] -= tau * a[i][k];
+		  A(i, j) -= tau * A(i, k);
 	      }
 	  }
       }
+  }
+
+
+/**
+ * Set the diagonal element of the last column of a square matrix,
+ * which needs no reflection.
+ */
+template<typename _ElemA, typename _Vector>
+  void
+  __qr_finish(_ElemA A, std::size_t n_rows, std::size_t n_cols,
+	      _Vector& c, _Vector& d, bool& singular)
+  {
+    using _NumTp = std::decay_t<decltype(A(0, 0))>;
+
+    if (__qr_num_reflections(n_rows, n_cols) == n_cols)
+      return;
+
     c[n_cols - 1] = _NumTp{0};
-    d[n_cols - 1] = a[n_cols - 1][n_cols - 1];
+    d[n_cols - 1] = A(n_cols - 1, n_cols - 1);
 
     if (d[n_cols - 1] == _NumTp{0})
       singular = true;
+  }
+
+
+/**
+ * Constructs the QR decomposition of a[0..n_rows - 1][0..n_cols - 1].  The upper triangular matrix R
+ * is returned in the upper triangle of a except the diagonal elements of R which are returned
+ * in d[0..n_cols - 1].  The orthogonal matrix Q is represented as a product of n - 1 Householder
+ * matrices Q_0...Q_n-2 where Q_j = 1 - u_j x u_j/c_j.  The ith component of u_j is zero for
+ * i = 0..j-1 and the remaining components are stored in a[j..n_rows-1][j].
+ */
+template<typename _Matrix, typename _Vector>
+  void
+  qr_decomp(std::size_t n_rows, std::size_t n_cols,
+	    _Matrix& a,
+	    _Vector& c, _Vector& d, bool& singular)
+  {
+    auto A = __elem_access(a);
+
+    singular = false;
+    if (n_cols == 0)
+      return;
+
+    const auto n_refl = __qr_num_reflections(n_rows, n_cols);
+    __qr_factor_panel(A, n_rows, 0, n_refl, n_cols, c, d, singular);
+    __qr_finish(A, n_rows, n_cols, c, d, singular);
 
     return;
   }
 
 
 /**
- * This routine solves the set of equations Rx = b where R is the upper triangular
- * matrix stored in a[0..n_rows - 1][0..n_cols - 1] and d[0..n_cols - 1].
- * Here n_rows >= n_cols.
+ * Apply the reflections of the columns [k0, k1) to the columns
+ * [j0, j1) at once in the compact WY form Q = I - V.T.V^T
+ * with the triangular factor T formed in t and the intermediate
+ * product in w, of at least (k1 - k0) * (k1 - k0) and (k1 - k0) * (j1 - j0)
+ * elements.  Q^T is applied, as in the factorization, unless
+ * transpose is false.
  */
-template<typename _Matrix, typename _Vector, typename _VectorB>
+template<typename _ElemA, typename _Vector, typename _NumTp>
   void
-  r_backsub(std::size_t n_rows, std::size_t n_cols,
-	    const _Matrix& a, const _Vector& d,
-	    _VectorB& b)
+  __qr_apply_block(_ElemA A, std::size_t n_rows,
+		   std::size_t k0, std::size_t k1, const _Vector& c,
+		   std::size_t j0, std::size_t j1,
+		   _NumTp* t, _NumTp* w, bool transpose = true)
+  {
+    const auto kb = k1 - k0;
+    const auto nb = j1 - j0;
+    const auto mb = n_rows - k0;
+
+    // The Householder vectors with their implicit zeros above the diagonal.
+    auto V = [A, k0](std::size_t r, std::size_t p) -> _NumTp
+	     { return r >= p ? A(k0 + r, k0 + p) : _NumTp{0}; };
+
+    // The strict upper triangle of t receives V^T.V ...
+    __gemm(kb, kb, mb, _NumTp{1},
+	   [V](std::size_t p, std::size_t r) { return V(r, p); }, V,
+	   _NumTp{0},
+	   [t, kb](std::size_t i, std::size_t j) -> _NumTp&
+	   { return t[i * kb + j]; });
+
+    // ... which is turned into T column by column.
+    for (std::size_t j = 0; j < kb; ++j)
+      {
+	const auto tau = c[k0 + j] == _NumTp{0}
+		       ? _NumTp{0} : _NumTp{1} / c[k0 + j];
+	for (std::size_t i = 0; i < j; ++i)
+	  {
+	    auto sum = _NumTp{0};
+	    for (std::size_t p = i; p < j; ++p)
+	      sum += t[i * kb + p] * t[p * kb + j];
+	    w[i] = -tau * sum;
+	  }
+	for (std::size_t i = 0; i < j; ++i)
+	  t[i * kb + j] = w[i];
+	t[j * kb + j] = tau;
+      }
+
+    auto W = [w, nb](std::size_t i, std::size_t j) -> _NumTp&
+	     { return w[i * nb + j]; };
+    auto C = [A, k0, j0](std::size_t i, std::size_t j) -> _NumTp&
+	     { return A(k0 + i, j0 + j); };
+
+    // W = V^T.C
+    __gemm(kb, nb, mb, _NumTp{1},
+	   [V](std::size_t p, std::size_t r) { return V(r, p); },
+	   [C](std::size_t i, std::size_t j) -> const _NumTp&
+	   { return C(i, j); },
+	   _NumTp{0}, W);
+
+    // W = T^T.W
+    if (transpose)
+      for (std::size_t i = kb; i-- > 0;)
+	for (std::size_t j = 0; j < nb; ++j)
+	  {
+	    auto sum = t[i * kb + i] * W(i, j);
+	    for (std::size_t p = 0; p < i; ++p)
+	      sum += t[p * kb + i] * W(p, j);
+	    W(i, j) = sum;
+	  }
+    // or W = T.W
+    else
+      for (std::size_t i = 0; i < kb; ++i)
+	for (std::size_t j = 0; j < nb; ++j)
+	  {
+	    auto sum = t[i * kb + i] * W(i, j);
+	    for (std::size_t p = i + 1; p < kb; ++p)
+	      sum += t[i * kb + p] * W(p, j);
+	    W(i, j) = sum;
+	  }
+
+    // C = C - V.W
+    __gemm(mb, nb, kb, _NumTp{-1}, V,
+	   [W](std::size_t i, std::size_t j) -> const _NumTp&
+	   { return W(i, j); },
+	   _NumTp{1}, C);
+  }
+
+
+/**
+ * Factor the panel of columns [k0, k1) by splitting it in halves:
+ * the reflections of the left half are applied to the right half
+ * in compact WY form, so that little of the work is done
+ * a column at a time.
+ */
+template<typename _ElemA, typename _Vector, typename _NumTp>
+  void
+  __qr_factor_panel_recursive(_ElemA A, std::size_t n_rows,
+			      std::size_t k0, std::size_t k1,
+			      _Vector& c, _Vector& d, bool& singular,
+			      _NumTp* t, _NumTp* w)
+  {
+    constexpr std::size_t min_cols = 8;
+    if (k1 - k0 <= min_cols)
+      {
+	__qr_factor_panel(A, n_rows, k0, k1, k1, c, d, singular);
+	return;
+      }
+
+    const auto k_mid = k0 + (k1 - k0) / 2;
+    __qr_factor_panel_recursive(A, n_rows, k0, k_mid, c, d, singular, t, w);
+    __qr_apply_block(A, n_rows, k0, k_mid, c, k_mid, k1, t, w);
+    __qr_factor_panel_recursive(A, n_rows, k_mid, k1, c, d, singular, t, w);
+  }
+
+
+/**
+ * The blocked QR decomposition on the matrix accessed by A(i, j).
+ */
+template<typename _ElemA, typename _Vector>
+  void
+  __qr_decomp_blocked(_ElemA A, std::size_t n_rows, std::size_t n_cols,
+		      _Vector& c, _Vector& d, bool& singular,
+		      std::size_t block_size)
   {
-    using _NumTp = std::decay_t<decltype(a[0][0])>;
+    using _NumTp = std::decay_t<decltype(A(0, 0))>;
+
+    singular = false;
+    if (n_cols == 0)
+      return;
+    if (block_size == 0)
+      block_size = 1;
+
+    const auto n_refl = __qr_num_reflections(n_rows, n_cols);
+    std::vector<_NumTp> t(block_size * block_size);
+    std::vector<_NumTp> w(block_size * std::max(n_cols, block_size));
+    for (std::size_t k0 = 0; k0 < n_refl; k0 += block_size)
+      {
+	const auto k1 = std::min(k0 + block_size, n_refl);
+	__qr_factor_panel_recursive(A, n_rows, k0, k1, c, d, singular,
+				    t.data(), w.data());
+	if (k1 < n_cols)
+	  __qr_apply_block(A, n_rows, k0, k1, c, k1, n_cols,
+			   t.data(), w.data());
+      }
+    __qr_finish(A, n_rows, n_cols, c, d, singular);
+  }
+
+
+/**
+ * Form the n_rows*n_cols matrix Q(i, j) with orthonormal columns,
+ * the first n_cols columns of the product of the reflections left
+ * in the matrix accessed by A(i, j) by a QR decomposition.
+ * The panels of reflections are applied in reverse order to the leading
+ * columns of the identity in compact WY form.
+ */
+template<typename _ElemA, typename _Vector, typename _ElemQ>
+  void
+  __qr_form_q(_ElemA A, std::size_t n_rows, std::size_t n_cols,
+	      const _Vector& c, _ElemQ Q, std::size_t block_size = 32)
+  {
+    using _NumTp = std::decay_t<decltype(A(0, 0))>;
+
+    for (std::size_t i = 0; i < n_rows; ++i)
+      for (std::size_t j = 0; j < n_cols; ++j)
+	Q(i, j) = i == j ? _NumTp{1} : _NumTp{0};
+
+    // The reflections and Q side by side, so that __qr_apply_block
+    // can take its vectors from the left and update the right.
+    auto AQ = [A, Q, n_cols](std::size_t i, std::size_t j) -> _NumTp&
+	      { return j < n_cols ? A(i, j) : Q(i, j - n_cols); };
+
+    const auto n_refl = __qr_num_reflections(n_rows, n_cols);
+    std::vector<_NumTp> t(block_size * block_size);
+    std::vector<_NumTp> w(block_size * std::max(n_cols, block_size));
+    for (std::size_t k0 = (n_refl + block_size - 1) / block_size * block_size;
+	 k0 > 0;)
+      {
+	k0 -= block_size;
+	const auto k1 = std::min(k0 + block_size, n_refl);
+	__qr_apply_block(AQ, n_rows, k0, k1, c, n_cols + k0, 2 * n_cols,
+			 t.data(), w.data(), false);
+      }
+  }
+
+
+/**
+ * Constructs the QR decomposition of a[0..n_rows - 1][0..n_cols - 1]
+ * by the blocked loop.
+ */
+template<typename _Matrix, typename _Vector>
+  void
+  qr_decomp_blocked(std::size_t n_rows, std::size_t n_cols,
+		    _Matrix& a,
+		    _Vector& c, _Vector& d, bool& singular,
+		    std::size_t block_size)
+  {
+    __qr_decomp_blocked(__elem_access(a), n_rows, n_cols, c, d, singular,
+			block_size);
+  }
+
+
+/**
+ * Solve R.x = b on the matrix accessed by A(i, j).
+ */
+template<typename _ElemA, typename _Vector, typename _VectorB>
+  void
+  __r_backsub(_ElemA A, std::size_t n_cols, const _Vector& d, _VectorB& b)
+  {
+    using _NumTp = std::decay_t<decltype(A(0, 0))>;
 
     b[n_cols - 1] /= d[n_cols - 1];
-    for (int i = n_cols - 2; i >= 0; --i)
+    for (std::ptrdiff_t i = n_cols - 2; i >= 0; --i)
       {
 	_NumTp sum = _NumTp{0};
-	for (std::size_t j = i + 1; j < n_rows; ++j)
-	  sum += a[i][j] * b[j];
+	for (std::size_t j = i + 1; j < n_cols; ++j)
+	  sum += A(i, j) * b[j];
 	b[i] = (b[i] - sum) / d[i];
       }
+  }
+
+
+/**
+ * Form Q^T.b on the matrix accessed by A(i, j).
+ */
+template<typename _ElemA, typename _Vector, typename _VectorB>
+  void
+  __qr_apply_qt(_ElemA A, std::size_t n_rows, std::size_t n_cols,
+		const _Vector& c, _VectorB& b)
+  {
+    using _NumTp = std::decay_t<decltype(A(0, 0))>;
+
+    for (std::size_t j = 0; j < __qr_num_reflections(n_rows, n_cols); ++j)
+      {
+	if (c[j] == _NumTp{0})
+	  continue;
+	_NumTp sum = _NumTp{0};
+	for (std::size_t i = j; i < n_rows; ++i)
+	  sum += A(i, j) * b[i];
+	_NumTp tau = sum/c[j];
+	for (std::size_t i = j; i < n_rows; ++i)
+	  b[i] -= tau * A(i, j);
+      }
+  }
+
+
+/**
+ * This routine solves the set of equations Rx = b where R is the upper triangular
+ * matrix stored in a[0..n_rows - 1][0..n_cols - 1] and d[0..n_cols - 1].
+ * Here n_rows >= n_cols.
+ */
+template<typename _Matrix, typename _Vector, typename _VectorB>
+  void
+  r_backsub(std::size_t /*n_rows*/, std::size_t n_cols,
+	    const _Matrix& a, const _Vector& d,
+	    _VectorB& b)
+  {
+    __r_backsub(__elem_access(a), n_cols, d, b);
 
     return;
   }
@@ -122,21 +407,13 @@ template<typename _Matrix, typename _Vector, typename _VectorB>
 	     const _Matrix& a, const _Vector& c, const _Vector& d,
 	     _VectorB& b)
   {
-    using _NumTp = std::decay_t<decltype(a[0][0])>;
+    auto A = __elem_access(a);
 
     //  Form Qt.b.
-    for (std::size_t j = 0; j < n_cols - 1; ++j)
-      {
-	_NumTp sum = _NumTp{0};
-	for (std::size_t i = j; i < n_rows; ++i)
-	  sum += a[i][j] * b[i];
-	_NumTp tau = sum/c[j];
-	for (std::size_t i = j; i < n_rows; ++i)
-	  b[i] -= tau * a[i][j];
-      }
+    __qr_apply_qt(A, n_rows, n_cols, c, b);
 
     //  Solve R.x = Qt.b
-    r_backsub(n_rows, n_cols, a, d, b);
+    __r_backsub(A, n_cols, d, b);
 
     return;
   }
@@ -148,15 +425,32 @@ template<typename _Matrix, typename _Vector, typename _VectorB>
  *
  * The inverse matrix is NOT in QR form.
  */
-template<typename _Matrix, typename _Vector>
+template<typename _MatrixQR, typename _Vector, typename _Matrix>
   void
   qr_invert(std::size_t n_rows, std::size_t n_cols,
-	    const _Matrix& a_qr, const _Vector& c, const _Vector& d,
+	    const _MatrixQR& a_qr, const _Vector& c, const _Vector& d,
 	    _Matrix& a_inv)
   {
-    using _NumTp = std::decay_t<decltype(a_qr[0][0])>;
+    using _NumTp = __matrix_value_t<_MatrixQR>;
+
+    std::vector<_NumTp> work(qr_invert_workspace_size(n_rows, n_cols));
+    qr_invert(n_rows, n_cols, a_qr, c, d, a_inv, workspace_span<_NumTp>(work));
+  }
+
+
+/**
+ * Inverts a matrix given the QR decomposed matrix as qr_invert()
+ * taking the column vector from the caller-supplied workspace.
+ */
+template<typename _MatrixQR, typename _Vector, typename _Matrix>
+  void
+  qr_invert(std::size_t n_rows, std::size_t n_cols,
+	    const _MatrixQR& a_qr, const _Vector& c, const _Vector& d,
+	    _Matrix& a_inv, workspace_span<__matrix_value_t<_MatrixQR>> work)
+  {
+    using _NumTp = __matrix_value_t<_MatrixQR>;
 
-    std::vector<_NumTp> col(n_rows);
+    auto col = work.take(n_rows);
 
     for (std::size_t j = 0; j < n_rows; ++j)
       {
@@ -188,7 +482,7 @@ template<typename _Matrix, typename _Vector>
 
     //  Find largest k such that uk != 0.
     std::ptrdiff_t k;
-    for (std::ptrdiff_t k = n_cols - 1; k >= 0; --k)
+    for (k = n_cols - 1; k > 0; --k)
       if (u[k] != _NumTp{0})
 	break;
 
@@ -221,7 +515,7 @@ template<typename _Matrix, typename _Vector>
  *    cos(theta) = a/sqrt(a^2 + b^2)
  *    sin(theta) = b/sqrt(a^2 + b^2).
  */
-template<typename _NumTp, typename _Matrix, typename _Vector>
+template<typename _NumTp, typename _Matrix>
   void
   jacobi_rotate(const int i, const int n_rows, const int n_cols,
 		_Matrix& r, _Matrix& qt,
@@ -264,6 +558,248 @@ template<typename _NumTp, typename _Matrix, typename _Vector>
     return;
   }
 
+
+template<typename _NumTp, typename _Matrix, typename _Storage>
+  template<typename _Matrix2>
+    qr_decomposition<_NumTp, _Matrix, _Storage>::
+    qr_decomposition(std::size_t n_rows, std::size_t n_cols,
+		     const _Matrix2& a, qr_algorithm alg)
+    : m_n_rows(n_rows), m_n_cols(n_cols),
+      m_a(__make_storage<_Storage>(n_rows, n_cols, a)),
+      m_c(n_cols), m_d(n_cols), m_singular(false)
+    {
+      switch (alg)
+	{
+	case qr_algorithm::blocked:
+	  qr_decomp_blocked(m_n_rows, m_n_cols, m_a, m_c, m_d, m_singular);
+	  break;
+	case qr_algorithm::tsqr:
+	  this->factor_tsqr(default_thread_pool());
+	  break;
+	case qr_algorithm::householder:
+	default:
+	  qr_decomp(m_n_rows, m_n_cols, m_a, m_c, m_d, m_singular);
+	  break;
+	}
+    }
+
+template<typename _NumTp, typename _Matrix, typename _Storage>
+  template<typename _Matrix2>
+    qr_decomposition<_NumTp, _Matrix, _Storage>::
+    qr_decomposition(std::size_t n_rows, std::size_t n_cols,
+		     const _Matrix2& a, thread_pool& pool)
+    : m_n_rows(n_rows), m_n_cols(n_cols),
+      m_a(__make_storage<_Storage>(n_rows, n_cols, a)),
+      m_c(n_cols), m_d(n_cols), m_singular(false)
+    {
+      this->factor_tsqr(pool);
+    }
+
+/**
+ * Split the rows into blocks of at least n_cols rows, factor the blocks
+ * in place as tasks on pool and then combine their R factors pairwise,
+ * the pairs of each level of the tree again as tasks.
+ * The reflections of block b are in its rows of m_a and in
+ * m_c[b * n_cols..] and m_d[b * n_cols..].
+ */
+template<typename _NumTp, typename _Matrix, typename _Storage>
+  void
+  qr_decomposition<_NumTp, _Matrix, _Storage>::
+  factor_tsqr(thread_pool& pool)
+  {
+    const auto n = m_n_cols;
+    const auto n_blocks = n == 0 ? std::size_t{1}
+			: std::max(std::size_t{1},
+				   std::min(pool.size() + 1, m_n_rows / n));
+    if (n_blocks == 1)
+      {
+	qr_decomp_blocked(m_n_rows, n, m_a, m_c, m_d, m_singular);
+	return;
+      }
+
+    m_tsqr_rows.resize(n_blocks + 1);
+    for (std::size_t b = 0; b <= n_blocks; ++b)
+      m_tsqr_rows[b] = b * m_n_rows / n_blocks;
+    m_c.resize(n_blocks * n);
+    m_d.resize(n_blocks * n);
+
+    // Factor the row blocks.
+    {
+      task_group blocks(pool);
+      for (std::size_t b = 0; b < n_blocks; ++b)
+	blocks.run([this, b, n]()
+		   {
+		     const auto r0 = m_tsqr_rows[b];
+		     auto A = __elem_access(m_a);
+		     auto A_b = [A, r0](std::size_t i, std::size_t j) -> auto&
+				{ return A(r0 + i, j); };
+		     auto c = m_c.data() + b * n;
+		     auto d = m_d.data() + b * n;
+		     bool singular;
+		     __qr_decomp_blocked(A_b, m_tsqr_rows[b + 1] - r0, n,
+					 c, d, singular, 32);
+		   });
+      blocks.wait();
+    }
+
+    // Element (i, j) of the upper triangular factor number r.
+    auto R = [this, n, n_blocks](std::size_t r, std::size_t i,
+				 std::size_t j) -> value_type
+	     {
+	       if (r < n_blocks)
+		 return i == j ? m_d[r * n + i]
+		      : m_a[m_tsqr_rows[r] + i][j];
+	       const auto& node = m_tsqr_nodes[r - n_blocks];
+	       return i == j ? node.d[i] : node.a(i, j);
+	     };
+
+    // Combine the factors pairwise up the tree.
+    m_tsqr_nodes.reserve(n_blocks - 1);
+    std::vector<std::size_t> level(n_blocks);
+    for (std::size_t b = 0; b < n_blocks; ++b)
+      level[b] = b;
+    while (level.size() > 1)
+      {
+	std::vector<std::size_t> next;
+	const auto first = m_tsqr_nodes.size();
+	for (std::size_t p = 0; p + 1 < level.size(); p += 2)
+	  {
+	    next.push_back(n_blocks + m_tsqr_nodes.size());
+	    m_tsqr_nodes.push_back({level[p], level[p + 1],
+				    dense_matrix<value_type>(2 * n, n),
+				    std::vector<value_type>(n),
+				    std::vector<value_type>(n), false});
+	  }
+	if (level.size() % 2 == 1)
+	  next.push_back(level.back());
+
+	task_group pairs(pool);
+	for (std::size_t k = first; k < m_tsqr_nodes.size(); ++k)
+	  pairs.run([this, &R, k, n]()
+		    {
+		      auto& node = m_tsqr_nodes[k];
+		      for (std::size_t i = 0; i < n; ++i)
+			for (std::size_t j = i; j < n; ++j)
+			  {
+			    node.a(i, j) = R(node.left, i, j);
+			    node.a(n + i, j) = R(node.right, i, j);
+			  }
+		      qr_decomp_blocked(2 * n, n, node.a, node.c, node.d,
+					node.singular);
+		    });
+	pairs.wait();
+
+	level = std::move(next);
+      }
+
+    m_singular = m_tsqr_nodes.back().singular;
+  }
+
+/**
+ * Replace y[0..n_rows - 1] by Q^T.y, applying the reflections of each row
+ * block and then those of the tree nodes to the stacked leading parts,
+ * and solve R.x = Q^T.y in y[0..n_cols - 1].
+ */
+template<typename _NumTp, typename _Matrix, typename _Storage>
+  void
+  qr_decomposition<_NumTp, _Matrix, _Storage>::
+  solve_tsqr(std::vector<value_type>& y) const
+  {
+    const auto n = m_n_cols;
+    const auto n_blocks = m_tsqr_rows.size() - 1;
+
+    std::vector<value_type> top((n_blocks + m_tsqr_nodes.size()) * n);
+    for (std::size_t b = 0; b < n_blocks; ++b)
+      {
+	const auto r0 = m_tsqr_rows[b];
+	auto A = __elem_access(m_a);
+	auto A_b = [A, r0](std::size_t i, std::size_t j) -> auto&
+		   { return A(r0 + i, j); };
+	auto c = m_c.data() + b * n;
+	auto y_b = y.data() + r0;
+	__qr_apply_qt(A_b, m_tsqr_rows[b + 1] - r0, n, c, y_b);
+	std::copy(y_b, y_b + n, top.data() + b * n);
+      }
+
+    std::vector<value_type> v(2 * n);
+    for (std::size_t k = 0; k < m_tsqr_nodes.size(); ++k)
+      {
+	const auto& node = m_tsqr_nodes[k];
+	std::copy_n(top.data() + node.left * n, n, v.data());
+	std::copy_n(top.data() + node.right * n, n, v.data() + n);
+	__qr_apply_qt(__elem_access(node.a), 2 * n, n, node.c, v);
+	std::copy_n(v.data(), n, top.data() + (n_blocks + k) * n);
+      }
+
+    const auto& root = m_tsqr_nodes.back();
+    std::copy_n(top.data() + (top.size() - n), n, y.data());
+    __r_backsub(__elem_access(root.a), n, root.d, y);
+  }
+
+template<typename _NumTp, typename _Matrix, typename _Storage>
+  template<typename _Vector2, typename _VectorOut>
+    void
+    qr_decomposition<_NumTp, _Matrix, _Storage>::
+    backsubstitution(const _Vector2& b, _VectorOut& x) const
+    {
+      std::vector<value_type> y(m_n_rows);
+      for (std::size_t i = 0; i < m_n_rows; ++i)
+	y[i] = b[i];
+      if (m_tsqr_rows.empty())
+	qr_backsub(m_n_rows, m_n_cols, m_a, m_c, m_d, y);
+      else
+	this->solve_tsqr(y);
+      for (std::size_t i = 0; i < m_n_cols; ++i)
+	x[i] = y[i];
+    }
+
+template<typename _NumTp, typename _Matrix, typename _Storage>
+  template<typename _InVecIter, typename _OutVecIter>
+    void
+    qr_decomposition<_NumTp, _Matrix, _Storage>::
+    backsubstitution(_InVecIter b_begin, _InVecIter b_end,
+		     _OutVecIter x_begin) const
+    {
+      std::vector<value_type> y(b_begin, b_end);
+      if (m_tsqr_rows.empty())
+	qr_backsub(m_n_rows, m_n_cols, m_a, m_c, m_d, y);
+      else
+	this->solve_tsqr(y);
+      std::copy(y.begin(), y.begin() + m_n_cols, x_begin);
+    }
+
+template<typename _NumTp, typename _Matrix, typename _Storage>
+  template<typename _Matrix2>
+    void
+    qr_decomposition<_NumTp, _Matrix, _Storage>::
+    inverse(_Matrix2& a_inv) const
+    {
+      if (m_tsqr_rows.empty())
+	{
+	  qr_invert(m_n_rows, m_n_cols, m_a, m_c, m_d, a_inv);
+	  return;
+	}
+
+      std::vector<value_type> col(m_n_rows);
+      for (std::size_t j = 0; j < m_n_rows; ++j)
+	{
+	  std::fill(col.begin(), col.end(), value_type{0});
+	  col[j] = value_type{1};
+	  this->solve_tsqr(col);
+	  for (std::size_t i = 0; i < m_n_cols; ++i)
+	    a_inv[i][j] = col[i];
+	}
+    }
+
+template<typename _NumTp, typename _Matrix, typename _Storage>
+  template<typename _Matrix2, typename _Vector2>
+    void
+    qr_decomposition<_NumTp, _Matrix, _Storage>::
+    update(_Matrix2& r, _Matrix2& qt, _Vector2& u, _Vector2& v) const
+    {
+      qr_update(m_n_rows, m_n_cols, r, qt, u, v);
+    }
+
 } // namespace matrix
 
 #endif // MATRIX_QR_DECOMP_TCC
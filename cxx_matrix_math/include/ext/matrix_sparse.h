@@ -0,0 +1,300 @@
+#ifndef MATRIX_SPARSE_H
+#define MATRIX_SPARSE_H 1
+
+#include <cstdlib>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "matrix_thread_pool.h"
+
+namespace matrix
+{
+
+template<typename _Tp, typename _Index>
+  class csr_matrix;
+
+template<typename _Tp, typename _Index>
+  class csc_matrix;
+
+/**
+ * A sparse n_rows * n_cols matrix in coordinate (triplet) format.
+ * Entries may be inserted in any order and an (i, j) may be repeated;
+ * the repeats are summed on conversion to csr_matrix or csc_matrix.
+ * This is the format for assembling a matrix; convert it to one
+ * of the compressed formats for arithmetic.
+ */
+template<typename _Tp, typename _Index = std::size_t>
+  class coo_matrix
+  {
+  public:
+
+    using value_type = _Tp;
+    using index_type = _Index;
+
+    coo_matrix() noexcept = default;
+
+    coo_matrix(std::size_t n_rows, std::size_t n_cols)
+    : m_rows(n_rows), m_cols(n_cols)
+    { }
+
+    explicit coo_matrix(const csr_matrix<_Tp, _Index>& a);
+
+    explicit coo_matrix(const csc_matrix<_Tp, _Index>& a);
+
+    std::size_t rows() const noexcept { return m_rows; }
+    std::size_t cols() const noexcept { return m_cols; }
+    std::size_t nnz() const noexcept { return m_val.size(); }
+
+    void
+    reserve(std::size_t nnz)
+    {
+      m_row.reserve(nnz);
+      m_col.reserve(nnz);
+      m_val.reserve(nnz);
+    }
+
+    /**
+     * Append the entry a(i, j) += v.
+     */
+    void
+    insert(std::size_t i, std::size_t j, const _Tp& v)
+    {
+      m_row.push_back(_Index(i));
+      m_col.push_back(_Index(j));
+      m_val.push_back(v);
+    }
+
+    const std::vector<_Index>& row_indices() const noexcept { return m_row; }
+    const std::vector<_Index>& col_indices() const noexcept { return m_col; }
+    const std::vector<_Tp>& values() const noexcept { return m_val; }
+
+  private:
+
+    std::size_t m_rows = 0;
+    std::size_t m_cols = 0;
+    std::vector<_Index> m_row;
+    std::vector<_Index> m_col;
+    std::vector<_Tp> m_val;
+  };
+
+/**
+ * A sparse n_rows * n_cols matrix in compressed sparse row format:
+ * the column indices and values of row i are at positions
+ * row_ptr()[i] .. row_ptr()[i + 1] - 1 of col_ind() and values(),
+ * with the column indices ascending and unique within each row.
+ * The matrix is move-only; use clone() for an explicit deep copy.
+ */
+template<typename _Tp, typename _Index = std::size_t>
+  class csr_matrix
+  {
+  public:
+
+    using value_type = _Tp;
+    using index_type = _Index;
+
+    csr_matrix() noexcept = default;
+
+    /**
+     * Construct the matrix from its three arrays, which must satisfy
+     * the invariants above.
+     */
+    csr_matrix(std::size_t n_rows, std::size_t n_cols,
+	       std::vector<_Index> row_ptr, std::vector<_Index> col_ind,
+	       std::vector<_Tp> values)
+    : m_rows(n_rows), m_cols(n_cols), m_ptr(std::move(row_ptr)),
+      m_ind(std::move(col_ind)), m_val(std::move(values))
+    { }
+
+    explicit csr_matrix(const coo_matrix<_Tp, _Index>& a);
+
+    explicit csr_matrix(const csc_matrix<_Tp, _Index>& a);
+
+    csr_matrix(const csr_matrix&) = delete;
+    csr_matrix& operator=(const csr_matrix&) = delete;
+    csr_matrix(csr_matrix&&) noexcept = default;
+    csr_matrix& operator=(csr_matrix&&) noexcept = default;
+
+    /**
+     * Return a deep copy.
+     */
+    csr_matrix
+    clone() const
+    { return csr_matrix(m_rows, m_cols, m_ptr, m_ind, m_val); }
+
+    std::size_t rows() const noexcept { return m_rows; }
+    std::size_t cols() const noexcept { return m_cols; }
+    std::size_t nnz() const noexcept { return m_val.size(); }
+
+    const std::vector<_Index>& row_ptr() const noexcept { return m_ptr; }
+    const std::vector<_Index>& col_ind() const noexcept { return m_ind; }
+    std::vector<_Tp>& values() noexcept { return m_val; }
+    const std::vector<_Tp>& values() const noexcept { return m_val; }
+
+    /**
+     * Return A~.x for the IML solvers that need the transpose
+     * product.  _Vector must hold its elements contiguously.
+     */
+    template<typename _Vector>
+      _Vector trans_mult(const _Vector& x) const;
+
+  private:
+
+    std::size_t m_rows = 0;
+    std::size_t m_cols = 0;
+    std::vector<_Index> m_ptr;
+    std::vector<_Index> m_ind;
+    std::vector<_Tp> m_val;
+  };
+
+/**
+ * A sparse n_rows * n_cols matrix in compressed sparse column format:
+ * the row indices and values of column j are at positions
+ * col_ptr()[j] .. col_ptr()[j + 1] - 1 of row_ind() and values(),
+ * with the row indices ascending and unique within each column.
+ * The matrix is move-only; use clone() for an explicit deep copy.
+ */
+template<typename _Tp, typename _Index = std::size_t>
+  class csc_matrix
+  {
+  public:
+
+    using value_type = _Tp;
+    using index_type = _Index;
+
+    csc_matrix() noexcept = default;
+
+    /**
+     * Construct the matrix from its three arrays, which must satisfy
+     * the invariants above.
+     */
+    csc_matrix(std::size_t n_rows, std::size_t n_cols,
+	       std::vector<_Index> col_ptr, std::vector<_Index> row_ind,
+	       std::vector<_Tp> values)
+    : m_rows(n_rows), m_cols(n_cols), m_ptr(std::move(col_ptr)),
+      m_ind(std::move(row_ind)), m_val(std::move(values))
+    { }
+
+    explicit csc_matrix(const coo_matrix<_Tp, _Index>& a);
+
+    explicit csc_matrix(const csr_matrix<_Tp, _Index>& a);
+
+    csc_matrix(const csc_matrix&) = delete;
+    csc_matrix& operator=(const csc_matrix&) = delete;
+    csc_matrix(csc_matrix&&) noexcept = default;
+    csc_matrix& operator=(csc_matrix&&) noexcept = default;
+
+    /**
+     * Return a deep copy.
+     */
+    csc_matrix
+    clone() const
+    { return csc_matrix(m_rows, m_cols, m_ptr, m_ind, m_val); }
+
+    std::size_t rows() const noexcept { return m_rows; }
+    std::size_t cols() const noexcept { return m_cols; }
+    std::size_t nnz() const noexcept { return m_val.size(); }
+
+    const std::vector<_Index>& col_ptr() const noexcept { return m_ptr; }
+    const std::vector<_Index>& row_ind() const noexcept { return m_ind; }
+    std::vector<_Tp>& values() noexcept { return m_val; }
+    const std::vector<_Tp>& values() const noexcept { return m_val; }
+
+    /**
+     * Return A~.x for the IML solvers that need the transpose
+     * product.  _Vector must hold its elements contiguously.
+     */
+    template<typename _Vector>
+      _Vector trans_mult(const _Vector& x) const;
+
+  private:
+
+    std::size_t m_rows = 0;
+    std::size_t m_cols = 0;
+    std::vector<_Index> m_ptr;
+    std::vector<_Index> m_ind;
+    std::vector<_Tp> m_val;
+  };
+
+/**
+ * Form y = A.x for the CSR matrix a.  The rows are split into ranges
+ * of equal numbers of nonzeros that run as tasks on pool; each row
+ * is a gathered dot product kept in four partial sums so that
+ * consecutive nonzeros are independent.  Matrices of fewer than
+ * 16384 nonzeros per task are done on the calling thread.
+ */
+template<typename _Tp, typename _Index>
+  void
+  spmv(const csr_matrix<_Tp, _Index>& a, const _Tp* x, _Tp* y,
+       thread_pool& pool = default_thread_pool());
+
+/**
+ * Form y = A~.x for the CSR matrix a by scattering each row of a
+ * into y.  With more than one task each task scatters into a private
+ * copy of y and the copies are summed in parallel afterwards,
+ * so the work is split only while the copies are smaller than a.
+ */
+template<typename _Tp, typename _Index>
+  void
+  spmv_trans(const csr_matrix<_Tp, _Index>& a, const _Tp* x, _Tp* y,
+	     thread_pool& pool = default_thread_pool());
+
+/**
+ * Form y = A.x for the CSC matrix a by scattering its columns,
+ * as spmv_trans() does for a CSR matrix.
+ */
+template<typename _Tp, typename _Index>
+  void
+  spmv(const csc_matrix<_Tp, _Index>& a, const _Tp* x, _Tp* y,
+       thread_pool& pool = default_thread_pool());
+
+/**
+ * Form y = A~.x for the CSC matrix a by gathering down its columns,
+ * as spmv() does for a CSR matrix.
+ */
+template<typename _Tp, typename _Index>
+  void
+  spmv_trans(const csc_matrix<_Tp, _Index>& a, const _Tp* x, _Tp* y,
+	     thread_pool& pool = default_thread_pool());
+
+/**
+ * Vector types with size() and operator[], the operand types of
+ * operator*() below; this keeps those templates out of overload
+ * resolution for sparse matrix times anything else.
+ */
+template<typename _Vector, typename = void>
+  struct __is_sparse_operand
+  : std::false_type
+  { };
+
+template<typename _Vector>
+  struct __is_sparse_operand<_Vector,
+	   std::void_t<decltype(std::declval<const _Vector&>().size()),
+		       decltype(std::declval<const _Vector&>()[0])>>
+  : std::true_type
+  { };
+
+template<typename _Vector>
+  using __sparse_operand_t
+    = std::enable_if_t<__is_sparse_operand<_Vector>::value, _Vector>;
+
+/**
+ * Return A.x by spmv() on the default thread pool.  This is the
+ * matrix-vector product the IML iterative solvers (cg.h, gmres.h, ...)
+ * call; _Vector is the solvers' vector type, such as MV_Vector_double
+ * or std::vector, and must hold its elements contiguously
+ * and be constructible from its size.
+ */
+template<typename _Tp, typename _Index, typename _Vector>
+  __sparse_operand_t<_Vector>
+  operator*(const csr_matrix<_Tp, _Index>& a, const _Vector& x);
+
+template<typename _Tp, typename _Index, typename _Vector>
+  __sparse_operand_t<_Vector>
+  operator*(const csc_matrix<_Tp, _Index>& a, const _Vector& x);
+
+} // namespace matrix
+
+#include "matrix_sparse.tcc"
+
+#endif // MATRIX_SPARSE_H
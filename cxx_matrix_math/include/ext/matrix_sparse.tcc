@@ -0,0 +1,392 @@
+#ifndef MATRIX_SPARSE_TCC
+#define MATRIX_SPARSE_TCC 1
+
+#include <algorithm>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include "matrix_thread_pool.h"
+
+namespace matrix
+{
+
+/**
+ * Compress the nnz triplets (outer[k], inner[k], val[k]) into
+ * n_outer lists: ptr[0..n_outer], and ind and v in the order of ptr.
+ * The triplets are bucketed by a counting sort on outer, each list
+ * is sorted on inner and the repeated entries in it are summed.
+ */
+template<typename _Tp, typename _Index>
+  void
+  __sparse_compress(std::size_t n_outer, const std::vector<_Index>& outer,
+		    const std::vector<_Index>& inner,
+		    const std::vector<_Tp>& val,
+		    std::vector<_Index>& ptr, std::vector<_Index>& ind,
+		    std::vector<_Tp>& v)
+  {
+    const auto nnz = val.size();
+
+    std::vector<_Index> start(n_outer + 1, _Index{0});
+    for (std::size_t k = 0; k < nnz; ++k)
+      ++start[outer[k] + 1];
+    std::partial_sum(start.begin(), start.end(), start.begin());
+
+    std::vector<std::pair<_Index, _Tp>> entry(nnz);
+    {
+      auto next = start;
+      for (std::size_t k = 0; k < nnz; ++k)
+	entry[next[outer[k]]++] = {inner[k], val[k]};
+    }
+
+    ptr.assign(n_outer + 1, _Index{0});
+    ind.clear();
+    ind.reserve(nnz);
+    v.clear();
+    v.reserve(nnz);
+    for (std::size_t i = 0; i < n_outer; ++i)
+      {
+	const auto first = entry.begin() + start[i];
+	const auto last = entry.begin() + start[i + 1];
+	std::sort(first, last, [](const auto& p, const auto& q)
+			       { return p.first < q.first; });
+	for (auto e = first; e != last; ++e)
+	  if (ind.size() > std::size_t(ptr[i]) && ind.back() == e->first)
+	    v.back() += e->second;
+	  else
+	    {
+	      ind.push_back(e->first);
+	      v.push_back(e->second);
+	    }
+	ptr[i + 1] = _Index(ind.size());
+      }
+  }
+
+
+/**
+ * Transpose the n_outer compressed lists (ptr, ind, val) over n_inner
+ * indices into the n_inner lists (tptr, tind, tval) by a counting sort.
+ * The indices of each output list come out ascending.
+ */
+template<typename _Tp, typename _Index>
+  void
+  __sparse_transpose(std::size_t n_outer, std::size_t n_inner,
+		     const std::vector<_Index>& ptr,
+		     const std::vector<_Index>& ind,
+		     const std::vector<_Tp>& val,
+		     std::vector<_Index>& tptr, std::vector<_Index>& tind,
+		     std::vector<_Tp>& tval)
+  {
+    const auto nnz = val.size();
+
+    tptr.assign(n_inner + 1, _Index{0});
+    for (std::size_t k = 0; k < nnz; ++k)
+      ++tptr[ind[k] + 1];
+    std::partial_sum(tptr.begin(), tptr.end(), tptr.begin());
+
+    tind.resize(nnz);
+    tval.resize(nnz);
+    std::vector<_Index> next(tptr.begin(), tptr.end() - 1);
+    for (std::size_t i = 0; i < n_outer; ++i)
+      for (auto k = ptr[i]; k < ptr[i + 1]; ++k)
+	{
+	  const auto pos = next[ind[k]]++;
+	  tind[pos] = _Index(i);
+	  tval[pos] = val[k];
+	}
+  }
+
+
+/**
+ * Expand the compressed lists (ptr, ind) into the outer index of each
+ * nonzero.
+ */
+template<typename _Index>
+  std::vector<_Index>
+  __sparse_expand(std::size_t n_outer, const std::vector<_Index>& ptr)
+  {
+    std::vector<_Index> outer(n_outer > 0 ? ptr[n_outer] : 0);
+    for (std::size_t i = 0; i < n_outer; ++i)
+      std::fill(outer.begin() + ptr[i], outer.begin() + ptr[i + 1],
+		_Index(i));
+    return outer;
+  }
+
+
+template<typename _Tp, typename _Index>
+  coo_matrix<_Tp, _Index>::coo_matrix(const csr_matrix<_Tp, _Index>& a)
+  : m_rows(a.rows()), m_cols(a.cols()),
+    m_row(__sparse_expand(a.rows(), a.row_ptr())),
+    m_col(a.col_ind()), m_val(a.values())
+  { }
+
+
+template<typename _Tp, typename _Index>
+  coo_matrix<_Tp, _Index>::coo_matrix(const csc_matrix<_Tp, _Index>& a)
+  : m_rows(a.rows()), m_cols(a.cols()),
+    m_row(a.row_ind()),
+    m_col(__sparse_expand(a.cols(), a.col_ptr())), m_val(a.values())
+  { }
+
+
+template<typename _Tp, typename _Index>
+  csr_matrix<_Tp, _Index>::csr_matrix(const coo_matrix<_Tp, _Index>& a)
+  : m_rows(a.rows()), m_cols(a.cols())
+  {
+    __sparse_compress(m_rows, a.row_indices(), a.col_indices(), a.values(),
+		      m_ptr, m_ind, m_val);
+  }
+
+
+template<typename _Tp, typename _Index>
+  csr_matrix<_Tp, _Index>::csr_matrix(const csc_matrix<_Tp, _Index>& a)
+  : m_rows(a.rows()), m_cols(a.cols())
+  {
+    __sparse_transpose(m_cols, m_rows, a.col_ptr(), a.row_ind(), a.values(),
+		       m_ptr, m_ind, m_val);
+  }
+
+
+template<typename _Tp, typename _Index>
+  csc_matrix<_Tp, _Index>::csc_matrix(const coo_matrix<_Tp, _Index>& a)
+  : m_rows(a.rows()), m_cols(a.cols())
+  {
+    __sparse_compress(m_cols, a.col_indices(), a.row_indices(), a.values(),
+		      m_ptr, m_ind, m_val);
+  }
+
+
+template<typename _Tp, typename _Index>
+  csc_matrix<_Tp, _Index>::csc_matrix(const csr_matrix<_Tp, _Index>& a)
+  : m_rows(a.rows()), m_cols(a.cols())
+  {
+    __sparse_transpose(m_rows, m_cols, a.row_ptr(), a.col_ind(), a.values(),
+		       m_ptr, m_ind, m_val);
+  }
+
+
+/**
+ * The number of nonzeros below which a product is not split further.
+ */
+constexpr std::size_t __spmv_grain = 16384;
+
+
+/**
+ * Form y[i] = sum val[k] * x[ind[k]] over the list i of the compressed
+ * lists (ptr, ind, val) for each i in [0, n_outer).  The lists are split
+ * into ranges of about equal numbers of nonzeros, one per task.
+ */
+template<typename _Tp, typename _Index>
+  void
+  __sparse_gather(thread_pool& pool, std::size_t n_outer,
+		  const _Index* ptr, const _Index* ind, const _Tp* val,
+		  const _Tp* x, _Tp* y)
+  {
+    auto rows = [ptr, ind, val, x, y](std::size_t i0, std::size_t i1)
+    {
+      for (std::size_t i = i0; i < i1; ++i)
+	{
+	  _Tp s0{}, s1{}, s2{}, s3{};
+	  auto k = std::size_t(ptr[i]);
+	  const auto k1 = std::size_t(ptr[i + 1]);
+	  for (; k + 4 <= k1; k += 4)
+	    {
+	      s0 += val[k] * x[ind[k]];
+	      s1 += val[k + 1] * x[ind[k + 1]];
+	      s2 += val[k + 2] * x[ind[k + 2]];
+	      s3 += val[k + 3] * x[ind[k + 3]];
+	    }
+	  for (; k < k1; ++k)
+	    s0 += val[k] * x[ind[k]];
+	  y[i] = (s0 + s1) + (s2 + s3);
+	}
+    };
+
+    const std::size_t nnz = n_outer > 0 ? ptr[n_outer] : 0;
+    const auto n_tasks = std::max<std::size_t>(1,
+			    std::min(nnz / __spmv_grain, pool.size() + 1));
+    if (n_tasks == 1)
+      {
+	rows(0, n_outer);
+	return;
+      }
+
+    // Split on the nonzero counts so that long rows do not unbalance
+    // the tasks.
+    std::vector<std::size_t> split(n_tasks + 1, n_outer);
+    split[0] = 0;
+    for (std::size_t t = 1; t < n_tasks; ++t)
+      split[t] = std::upper_bound(ptr, ptr + n_outer,
+				  _Index(t * nnz / n_tasks)) - ptr - 1;
+
+    task_group ranges(pool);
+    for (std::size_t t = 1; t < n_tasks; ++t)
+      ranges.run([&rows, &split, t]()
+		 { rows(split[t], split[t + 1]); });
+    rows(split[0], split[1]);
+    ranges.wait();
+  }
+
+
+/**
+ * Form y[j] = sum val[k] * x[i] over the entries ind[k] == j of all the
+ * lists i of the compressed lists (ptr, ind, val), for each j
+ * in [0, n_inner).  Each task scatters a range of lists into its own
+ * copy of y; the copies are allocated here, on the calling thread,
+ * and are then summed into y over ranges of j.
+ */
+template<typename _Tp, typename _Index>
+  void
+  __sparse_scatter(thread_pool& pool, std::size_t n_outer,
+		   std::size_t n_inner,
+		   const _Index* ptr, const _Index* ind, const _Tp* val,
+		   const _Tp* x, _Tp* y)
+  {
+    auto lists = [ptr, ind, val, x](_Tp* z, std::size_t i0, std::size_t i1)
+    {
+      for (std::size_t i = i0; i < i1; ++i)
+	if (const auto xi = x[i]; xi != _Tp{0})
+	  for (auto k = ptr[i]; k < ptr[i + 1]; ++k)
+	    z[ind[k]] += val[k] * xi;
+    };
+
+    std::fill(y, y + n_inner, _Tp{});
+
+    const std::size_t nnz = n_outer > 0 ? ptr[n_outer] : 0;
+    const auto n_copies = n_inner > 0 ? nnz / n_inner : 0;
+    const auto n_tasks = std::max<std::size_t>(1,
+			    std::min({nnz / __spmv_grain, pool.size() + 1,
+				      n_copies}));
+    if (n_tasks == 1)
+      {
+	lists(y, 0, n_outer);
+	return;
+      }
+
+    std::vector<_Tp> copy((n_tasks - 1) * n_inner);
+    std::vector<std::size_t> split(n_tasks + 1, n_outer);
+    split[0] = 0;
+    for (std::size_t t = 1; t < n_tasks; ++t)
+      split[t] = std::upper_bound(ptr, ptr + n_outer,
+				  _Index(t * nnz / n_tasks)) - ptr - 1;
+
+    {
+      task_group ranges(pool);
+      for (std::size_t t = 1; t < n_tasks; ++t)
+	ranges.run([&lists, &split, &copy, n_inner, t]()
+		   {
+		     lists(copy.data() + (t - 1) * n_inner,
+			   split[t], split[t + 1]);
+		   });
+      lists(y, split[0], split[1]);
+      ranges.wait();
+    }
+
+    task_group sums(pool);
+    auto add = [&copy, y, n_inner, n_tasks](std::size_t j0, std::size_t j1)
+    {
+      for (std::size_t t = 1; t < n_tasks; ++t)
+	{
+	  const auto z = copy.data() + (t - 1) * n_inner;
+	  for (std::size_t j = j0; j < j1; ++j)
+	    y[j] += z[j];
+	}
+    };
+    for (std::size_t t = 1; t < n_tasks; ++t)
+      sums.run([&add, n_inner, n_tasks, t]()
+	       { add(t * n_inner / n_tasks, (t + 1) * n_inner / n_tasks); });
+    add(0, n_inner / n_tasks);
+    sums.wait();
+  }
+
+
+template<typename _Tp, typename _Index>
+  void
+  spmv(const csr_matrix<_Tp, _Index>& a, const _Tp* x, _Tp* y,
+       thread_pool& pool)
+  {
+    __sparse_gather(pool, a.rows(), a.row_ptr().data(), a.col_ind().data(),
+		    a.values().data(), x, y);
+  }
+
+
+template<typename _Tp, typename _Index>
+  void
+  spmv_trans(const csr_matrix<_Tp, _Index>& a, const _Tp* x, _Tp* y,
+	     thread_pool& pool)
+  {
+    __sparse_scatter(pool, a.rows(), a.cols(), a.row_ptr().data(),
+		     a.col_ind().data(), a.values().data(), x, y);
+  }
+
+
+template<typename _Tp, typename _Index>
+  void
+  spmv(const csc_matrix<_Tp, _Index>& a, const _Tp* x, _Tp* y,
+       thread_pool& pool)
+  {
+    __sparse_scatter(pool, a.cols(), a.rows(), a.col_ptr().data(),
+		     a.row_ind().data(), a.values().data(), x, y);
+  }
+
+
+template<typename _Tp, typename _Index>
+  void
+  spmv_trans(const csc_matrix<_Tp, _Index>& a, const _Tp* x, _Tp* y,
+	     thread_pool& pool)
+  {
+    __sparse_gather(pool, a.cols(), a.col_ptr().data(), a.row_ind().data(),
+		    a.values().data(), x, y);
+  }
+
+
+/**
+ * Return the product of the sparse matrix a, or its transpose,
+ * with the contiguous vector x as a new vector of type _Vector.
+ */
+template<typename _Vector, typename _SparseMatrix>
+  _Vector
+  __sparse_apply(const _SparseMatrix& a, const _Vector& x, bool trans)
+  {
+    const auto n_out = trans ? a.cols() : a.rows();
+    _Vector y(n_out);
+    if (n_out == 0)
+      return y;
+    const auto n_in = trans ? a.rows() : a.cols();
+    const auto px = n_in > 0 ? &x[0] : nullptr;
+    if (trans)
+      spmv_trans(a, px, &y[0]);
+    else
+      spmv(a, px, &y[0]);
+    return y;
+  }
+
+
+template<typename _Tp, typename _Index>
+  template<typename _Vector>
+    _Vector
+    csr_matrix<_Tp, _Index>::trans_mult(const _Vector& x) const
+    { return __sparse_apply(*this, x, true); }
+
+
+template<typename _Tp, typename _Index>
+  template<typename _Vector>
+    _Vector
+    csc_matrix<_Tp, _Index>::trans_mult(const _Vector& x) const
+    { return __sparse_apply(*this, x, true); }
+
+
+template<typename _Tp, typename _Index, typename _Vector>
+  __sparse_operand_t<_Vector>
+  operator*(const csr_matrix<_Tp, _Index>& a, const _Vector& x)
+  { return __sparse_apply(a, x, false); }
+
+
+template<typename _Tp, typename _Index, typename _Vector>
+  __sparse_operand_t<_Vector>
+  operator*(const csc_matrix<_Tp, _Index>& a, const _Vector& x)
+  { return __sparse_apply(a, x, false); }
+
+} // namespace matrix
+
+#endif // MATRIX_SPARSE_TCC
@@ -0,0 +1,280 @@
+#ifndef MATRIX_SPARSE_DIRECT_H
+#define MATRIX_SPARSE_DIRECT_H 1
+
+#include <cstdlib>
+#include <vector>
+
+#include "matrix_sparse.h"
+
+namespace matrix
+{
+
+/**
+ * The fill-reducing orderings available for the sparse direct solvers.
+ */
+enum class sparse_ordering
+{
+  /// The original order.
+  natural,
+  /// Approximate minimum degree on the quotient graph of A + A~.
+  amd,
+  /// Recursive level-structure bisection of the graph of A + A~
+  /// with the pieces of under 128 vertices ordered by minimum degree.
+  nested_dissection
+};
+
+/**
+ * Return the fill-reducing permutation of the square sparse matrix a
+ * computed by ord: element k is the original index of the row and column
+ * eliminated k-th.  The ordering is done on the pattern of a + a~.
+ */
+template<typename _Tp, typename _Index>
+  std::vector<std::size_t>
+  sparse_permutation(const csc_matrix<_Tp, _Index>& a,
+		     sparse_ordering ord = sparse_ordering::amd);
+
+template<typename _Tp, typename _Index>
+  class sparse_lu_decomposition;
+
+template<typename _Tp, typename _Index>
+  class sparse_cholesky_decomposition;
+
+/**
+ * The symbolic analysis of the pattern of a square sparse matrix
+ * shared by sparse_lu_decomposition and sparse_cholesky_decomposition.
+ * The pattern of A + A~ is ordered by a fill-reducing permutation,
+ * postordered by its elimination tree and split into supernodes,
+ * runs of columns of the factor with the same structure below them;
+ * small neighbouring supernodes are merged when few explicit zeros
+ * are added.  The row structure of each supernode, the map of each
+ * supernode's update rows into its parent's and the position of each
+ * nonzero of the matrix in its supernode are all computed here, so that
+ * a numeric factorization of any matrix with this pattern is arithmetic
+ * on dense fronts alone.  An analysis may be shared by any number of
+ * decompositions and reused for every refactorization.
+ */
+class sparse_symbolic
+{
+public:
+
+  sparse_symbolic() = default;
+
+  /**
+   * Analyse the pattern of the square matrix a with the ordering ord.
+   * If match_rows is true, as sparse_lu_decomposition asks, the rows
+   * of a are first permuted by a maximum product matching, as MC64 does,
+   * so that large entries lie on the diagonal, and the analysis is that
+   * of the permuted matrix.  The matching is made on the values of a
+   * and kept for refactorizations with the same pattern.
+   * Throw std::logic_error if a is not square.
+   */
+  template<typename _Tp, typename _Index>
+    explicit sparse_symbolic(const csc_matrix<_Tp, _Index>& a,
+			     sparse_ordering ord = sparse_ordering::amd,
+			     bool match_rows = false);
+
+  /// The order of the matrix.
+  std::size_t size() const noexcept { return m_n; }
+
+  /// The number of supernodes.
+  std::size_t num_supernodes() const noexcept
+  { return m_sn_first.empty() ? 0 : m_sn_first.size() - 1; }
+
+  /// The number of entries of the Cholesky factor L, including
+  /// the explicit zeros of the merged supernodes.
+  std::size_t factor_nnz() const noexcept { return m_factor_nnz; }
+
+  /// The permutation: element k is the original index eliminated k-th.
+  const std::vector<std::size_t>& permutation() const noexcept
+  { return m_perm; }
+
+  /// The row permutation: element k is the original row eliminated k-th.
+  /// It differs from permutation() only if the rows were matched.
+  const std::vector<std::size_t>& row_permutation() const noexcept
+  { return m_row_perm; }
+
+  /// Whether the rows were permuted by a matching.
+  bool matched_rows() const noexcept { return m_matched; }
+
+private:
+
+  template<typename _Tp, typename _Index>
+    friend class sparse_lu_decomposition;
+
+  template<typename _Tp, typename _Index>
+    friend class sparse_cholesky_decomposition;
+
+  template<typename _Tp, typename _Index>
+    void __check_pattern(const csc_matrix<_Tp, _Index>& a) const;
+
+  std::size_t m_n = 0;
+  std::size_t m_factor_nnz = 0;
+  bool m_matched = false;
+
+  std::vector<std::size_t> m_perm;
+  std::vector<std::size_t> m_row_perm;
+
+  // Supernode s holds columns m_sn_first[s] .. m_sn_first[s + 1] - 1;
+  // its row structure, columns first, is at m_rows[m_rows_ptr[s] ..].
+  std::vector<std::size_t> m_sn_first;
+  std::vector<std::size_t> m_rows_ptr;
+  std::vector<std::size_t> m_rows;
+
+  // The children of supernode s are m_child[m_child_ptr[s] ..].
+  std::vector<std::size_t> m_child_ptr;
+  std::vector<std::size_t> m_child;
+
+  // The positions in its parent's structure of the update rows
+  // of supernode s are m_rel[m_rel_ptr[s] ..].
+  std::vector<std::size_t> m_rel_ptr;
+  std::vector<std::size_t> m_rel;
+
+  // Nonzero m_asm_src[k] of the matrix goes to row m_asm_row[k]
+  // and column m_asm_col[k] of the front of the supernode s
+  // with m_asm_ptr[s] <= k < m_asm_ptr[s + 1].
+  std::vector<std::size_t> m_asm_ptr;
+  std::vector<std::size_t> m_asm_src;
+  std::vector<std::size_t> m_asm_row;
+  std::vector<std::size_t> m_asm_col;
+
+  // A copy of the pattern to check refactorizations against.
+  std::vector<std::size_t> m_pat_ptr;
+  std::vector<std::size_t> m_pat_ind;
+};
+
+/**
+ * This class represents the sparse LU decomposition P.Q.M.A.Q~ = L.U
+ * of a square sparse matrix computed by the multifrontal method:
+ * M is the row matching of the symbolic analysis, Q its fill-reducing
+ * ordering and P the row interchanges of partial pivoting, which are
+ * confined to the pivot block of each supernode so that the analysed
+ * structure holds.  A pivot smaller than sqrt(eps) max|a_ij| is replaced
+ * by that value with its sign, as in static pivoting; the solves then
+ * apply iterative refinement against the original matrix.
+ * The update of each front is done by gemm().
+ */
+template<typename _Tp, typename _Index = std::size_t>
+  class sparse_lu_decomposition
+  {
+
+  public:
+
+    using value_type = _Tp;
+
+    explicit
+    sparse_lu_decomposition(const csc_matrix<_Tp, _Index>& a,
+			    sparse_ordering ord = sparse_ordering::amd);
+
+    /**
+     * Factor a with an existing analysis of its pattern, which
+     * should have been made with match_rows true.
+     */
+    sparse_lu_decomposition(const csc_matrix<_Tp, _Index>& a,
+			    const sparse_symbolic& sym);
+
+    /**
+     * Factor a, which must have the pattern of the matrix analysed,
+     * reusing the symbolic analysis.
+     * Throw std::logic_error if the pattern differs.
+     */
+    void refactor(const csc_matrix<_Tp, _Index>& a);
+
+    const sparse_symbolic&
+    symbolic() const
+    { return m_sym; }
+
+    /// The number of pivots replaced in the last factorization.
+    std::size_t
+    num_perturbed_pivots() const
+    { return m_perturbed; }
+
+    template<typename _Vector, typename _VectorOut>
+      void backsubstitute(const _Vector& b, _VectorOut& x) const;
+
+    template<typename InVecIter, typename OutVecIter>
+      void
+      backsubstitution(InVecIter b_begin, InVecIter b_end,
+		       OutVecIter x_begin) const;
+
+  private:
+
+    void solve(std::vector<_Tp>& x) const;
+
+    sparse_symbolic m_sym;
+
+    csc_matrix<_Tp, _Index> m_a;
+
+    // The fronts of supernode s from m_ptr[s]: its nc * m pivot rows,
+    // L11\U11 and U12, then the (m - nc) * nc block L21.
+    std::vector<std::size_t> m_ptr;
+    std::vector<_Tp> m_lu;
+
+    // The local row interchanges of each pivot block.
+    std::vector<std::size_t> m_piv;
+
+    std::size_t m_perturbed = 0;
+  };
+
+/**
+ * This class represents the sparse Cholesky decomposition Q.A.Q~ = L.L~
+ * of a symmetric positive definite sparse matrix computed by
+ * the multifrontal method.  Only the lower triangle of the matrix is read.
+ */
+template<typename _Tp, typename _Index = std::size_t>
+  class sparse_cholesky_decomposition
+  {
+
+  public:
+
+    using value_type = _Tp;
+
+    /**
+     * Throw std::logic_error if a is not positive definite.
+     */
+    explicit
+    sparse_cholesky_decomposition(const csc_matrix<_Tp, _Index>& a,
+				  sparse_ordering ord = sparse_ordering::amd);
+
+    /**
+     * Factor a with an existing analysis of its pattern.
+     * Throw std::logic_error if the analysis matched the rows.
+     */
+    sparse_cholesky_decomposition(const csc_matrix<_Tp, _Index>& a,
+				  const sparse_symbolic& sym);
+
+    /**
+     * Factor a, which must have the pattern of the matrix analysed,
+     * reusing the symbolic analysis.
+     * Throw std::logic_error if the pattern differs or a is not
+     * positive definite.
+     */
+    void refactor(const csc_matrix<_Tp, _Index>& a);
+
+    const sparse_symbolic&
+    symbolic() const
+    { return m_sym; }
+
+    template<typename _Vector, typename _VectorOut>
+      void backsubstitute(const _Vector& b, _VectorOut& x) const;
+
+    template<typename InVecIter, typename OutVecIter>
+      void
+      backsubstitution(InVecIter b_begin, InVecIter b_end,
+		       OutVecIter x_begin) const;
+
+  private:
+
+    void solve(std::vector<_Tp>& x) const;
+
+    sparse_symbolic m_sym;
+
+    // The m * nc panel [L11; L21] of supernode s from m_ptr[s].
+    std::vector<std::size_t> m_ptr;
+    std::vector<_Tp> m_l;
+  };
+
+} // namespace matrix
+
+#include "matrix_sparse_direct.tcc"
+
+#endif // MATRIX_SPARSE_DIRECT_H
@@ -0,0 +1,1451 @@
+#ifndef MATRIX_SPARSE_DIRECT_TCC
+#define MATRIX_SPARSE_DIRECT_TCC 1
+
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "matrix_gemm.h"
+#include "matrix_sparse.h"
+
+namespace matrix
+{
+
+constexpr std::size_t __sparse_none = std::numeric_limits<std::size_t>::max();
+
+/**
+ * Build the adjacency lists (gptr, gadj) of the graph of A + A~,
+ * without the diagonal, for the n * n pattern (ptr, ind) relabelled
+ * by iperm, or as it stands if iperm is empty.
+ * Each list is sorted and free of repeats.
+ */
+template<typename _IndexP, typename _IndexI>
+  void
+  __sparse_sym_graph(std::size_t n, const std::vector<_IndexP>& ptr,
+		     const std::vector<_IndexI>& ind,
+		     const std::vector<std::size_t>& iperm,
+		     std::vector<std::size_t>& gptr,
+		     std::vector<std::size_t>& gadj)
+  {
+    auto label = [&iperm](std::size_t i)
+		 { return iperm.empty() ? i : iperm[i]; };
+
+    std::vector<std::size_t> count(n + 1, 0);
+    for (std::size_t j = 0; j < n; ++j)
+      for (auto k = std::size_t(ptr[j]); k < std::size_t(ptr[j + 1]); ++k)
+	if (const std::size_t i = ind[k]; i != j)
+	  {
+	    ++count[label(i) + 1];
+	    ++count[label(j) + 1];
+	  }
+    std::partial_sum(count.begin(), count.end(), count.begin());
+
+    std::vector<std::size_t> adj(count[n]);
+    auto next = count;
+    for (std::size_t j = 0; j < n; ++j)
+      for (auto k = std::size_t(ptr[j]); k < std::size_t(ptr[j + 1]); ++k)
+	if (const std::size_t i = ind[k]; i != j)
+	  {
+	    const auto pi = label(i), pj = label(j);
+	    adj[next[pi]++] = pj;
+	    adj[next[pj]++] = pi;
+	  }
+
+    gptr.assign(n + 1, 0);
+    gadj.clear();
+    gadj.reserve(adj.size());
+    for (std::size_t v = 0; v < n; ++v)
+      {
+	const auto first = adj.begin() + count[v];
+	const auto last = adj.begin() + count[v + 1];
+	std::sort(first, last);
+	gadj.insert(gadj.end(), first, std::unique(first, last));
+	gptr[v + 1] = gadj.size();
+      }
+  }
+
+
+/**
+ * Return a minimum degree ordering of the graph (gptr, gadj).
+ * The elimination is simulated on the quotient graph: each eliminated
+ * vertex becomes an element standing for the clique of its neighbours,
+ * the elements it touches are absorbed into it and the degree
+ * of each neighbour is the approximate external degree of AMD,
+ * |A_i| + |L_p| + sum |L_e \ L_p| over its other elements e,
+ * which needs no set unions.  Elements whose variables all lie in
+ * the new element are absorbed as well.  As in AMD, dense rows, with
+ * more than 10 sqrt(n) entries, are left out of the graph and ordered
+ * last: a row such as the ground node of a circuit would otherwise be
+ * a variable of nearly every element.
+ */
+inline std::vector<std::size_t>
+__sparse_min_degree(std::size_t n, const std::vector<std::size_t>& gptr,
+		    const std::vector<std::size_t>& gadj)
+{
+  const auto dense = std::max(std::size_t{16},
+			      std::size_t(10 * std::sqrt(double(n))));
+  std::vector<char> is_dense(n, 0);
+  std::vector<std::size_t> dense_rows;
+  for (std::size_t i = 0; i < n; ++i)
+    if (gptr[i + 1] - gptr[i] > dense)
+      {
+	is_dense[i] = 1;
+	dense_rows.push_back(i);
+      }
+  const auto n_sparse = n - dense_rows.size();
+
+  // The variable and element neighbours of each vertex
+  // and the variables of each element.
+  std::vector<std::vector<std::size_t>> var(n), elem(n), lvar(n);
+  std::vector<std::size_t> deg(n);
+  for (std::size_t i = 0; i < n; ++i)
+    if (!is_dense[i])
+      {
+	for (auto k = gptr[i]; k < gptr[i + 1]; ++k)
+	  if (!is_dense[gadj[k]])
+	    var[i].push_back(gadj[k]);
+	deg[i] = var[i].size();
+      }
+
+  // The doubly linked degree lists.
+  std::vector<std::size_t> head(n, __sparse_none);
+  std::vector<std::size_t> next(n, __sparse_none), prev(n, __sparse_none);
+  auto insert = [&](std::size_t i)
+  {
+    next[i] = head[deg[i]];
+    prev[i] = __sparse_none;
+    if (next[i] != __sparse_none)
+      prev[next[i]] = i;
+    head[deg[i]] = i;
+  };
+  auto remove = [&](std::size_t i)
+  {
+    if (prev[i] != __sparse_none)
+      next[prev[i]] = next[i];
+    else
+      head[deg[i]] = next[i];
+    if (next[i] != __sparse_none)
+      prev[next[i]] = prev[i];
+  };
+  for (std::size_t i = 0; i < n; ++i)
+    if (!is_dense[i])
+      insert(i);
+
+  std::vector<char> done(n, 0), alive(n, 0);
+  std::vector<std::size_t> mark(n, 0), wmark(n, 0), w(n, 0);
+  std::size_t tag = 0;
+
+  std::vector<std::size_t> perm;
+  perm.reserve(n);
+  std::vector<std::size_t> lp;
+  std::size_t mindeg = 0;
+  for (std::size_t k = 0; k < n_sparse; ++k)
+    {
+      while (head[mindeg] == __sparse_none)
+	++mindeg;
+      const auto p = head[mindeg];
+      remove(p);
+      done[p] = 1;
+      perm.push_back(p);
+
+      // Form the new element from the variables of p and of the elements
+      // it touches, which are absorbed.
+      ++tag;
+      mark[p] = tag;
+      lp.clear();
+      for (auto v : var[p])
+	if (!done[v] && mark[v] != tag)
+	  {
+	    mark[v] = tag;
+	    lp.push_back(v);
+	  }
+      for (auto e : elem[p])
+	if (alive[e])
+	  {
+	    for (auto v : lvar[e])
+	      if (!done[v] && mark[v] != tag)
+		{
+		  mark[v] = tag;
+		  lp.push_back(v);
+		}
+	    alive[e] = 0;
+	    std::vector<std::size_t>().swap(lvar[e]);
+	  }
+      std::vector<std::size_t>().swap(var[p]);
+      std::vector<std::size_t>().swap(elem[p]);
+      alive[p] = 1;
+      lvar[p] = lp;
+
+      // w[e] = |L_e \ L_p| for the other elements of the new variables.
+      for (auto i : lp)
+	for (auto e : elem[i])
+	  if (alive[e])
+	    {
+	      if (wmark[e] != tag)
+		{
+		  wmark[e] = tag;
+		  w[e] = lvar[e].size();
+		}
+	      --w[e];
+	    }
+      for (auto i : lp)
+	for (auto e : elem[i])
+	  if (alive[e] && w[e] == 0)
+	    {
+	      alive[e] = 0;
+	      std::vector<std::size_t>().swap(lvar[e]);
+	    }
+
+      // Prune from the variable lists the variables the new element
+      // covers, p among them; those eliminated earlier went the same way.
+      const auto n_left = n_sparse - k - 1;
+      for (auto i : lp)
+	{
+	  remove(i);
+	  auto& vi = var[i];
+	  vi.erase(std::remove_if(vi.begin(), vi.end(),
+				  [&](std::size_t v) { return mark[v] == tag; }),
+		   vi.end());
+	  auto& ei = elem[i];
+	  ei.erase(std::remove_if(ei.begin(), ei.end(),
+				  [&](std::size_t e) { return !alive[e]; }),
+		   ei.end());
+	  auto d = vi.size() + lp.size() - 1;
+	  for (auto e : ei)
+	    d += w[e];
+	  ei.push_back(p);
+	  deg[i] = std::min(d, n_left - 1);
+	  insert(i);
+	  mindeg = std::min(mindeg, deg[i]);
+	}
+    }
+  perm.insert(perm.end(), dense_rows.begin(), dense_rows.end());
+  return perm;
+}
+
+
+/**
+ * Order the vertices nodes, all labelled id in owner, of the graph
+ * (gptr, gadj) by nested dissection and append them to perm.
+ * A breadth-first level structure is grown from a pseudo-peripheral
+ * vertex and the level that halves the vertices is the separator,
+ * less the vertices with no neighbour beyond it.  The two halves are
+ * ordered first, then the separator.  Pieces of fewer than 128 vertices,
+ * pieces too shallow to split and pieces whose separator would hold
+ * more than a quarter of their vertices are ordered by minimum degree.
+ * A disconnected piece is split into all its components at once.
+ * The pieces wait on an explicit stack, so the depth of the
+ * dissection does not grow the call stack.
+ */
+inline void
+__sparse_dissect(const std::vector<std::size_t>& gptr,
+		 const std::vector<std::size_t>& gadj,
+		 std::vector<std::size_t> nodes, std::size_t id,
+		 std::vector<std::size_t>& owner, std::size_t& next_id,
+		 std::vector<std::size_t>& level,
+		 std::vector<std::size_t>& perm)
+{
+  constexpr std::size_t LEAF = 128;
+
+  // A piece to dissect, or a separator to append once the pieces
+  // pushed after it are done.
+  struct piece
+  {
+    std::vector<std::size_t> nodes;
+    std::size_t id;
+    bool separator;
+  };
+  std::vector<piece> stack;
+  stack.push_back({std::move(nodes), id, false});
+
+  std::vector<std::size_t> order;
+  while (!stack.empty())
+    {
+      auto cur = std::move(stack.back());
+      stack.pop_back();
+      if (cur.separator)
+	{
+	  perm.insert(perm.end(), cur.nodes.begin(), cur.nodes.end());
+	  continue;
+	}
+      const auto& nodes = cur.nodes;
+      const auto id = cur.id;
+
+      auto order_leaf = [&]()
+      {
+	// Build the induced graph on local labels.
+	for (std::size_t k = 0; k < nodes.size(); ++k)
+	  level[nodes[k]] = k;
+	std::vector<std::size_t> lptr(1, 0), ladj;
+	for (auto v : nodes)
+	  {
+	    for (auto k = gptr[v]; k < gptr[v + 1]; ++k)
+	      if (owner[gadj[k]] == id)
+		ladj.push_back(level[gadj[k]]);
+	    lptr.push_back(ladj.size());
+	  }
+	for (auto k : __sparse_min_degree(nodes.size(), lptr, ladj))
+	  perm.push_back(nodes[k]);
+      };
+
+      if (nodes.size() < LEAF)
+	{
+	  order_leaf();
+	  continue;
+	}
+
+      // Breadth-first search from root within the piece; leaves the order
+      // of the visit in order and sets level[].
+      auto bfs = [&](std::size_t root)
+      {
+	for (auto v : nodes)
+	  level[v] = __sparse_none;
+	order.clear();
+	order.push_back(root);
+	level[root] = 0;
+	for (std::size_t h = 0; h < order.size(); ++h)
+	  {
+	    const auto v = order[h];
+	    for (auto k = gptr[v]; k < gptr[v + 1]; ++k)
+	      if (const auto u = gadj[k];
+		  owner[u] == id && level[u] == __sparse_none)
+		{
+		  level[u] = level[v] + 1;
+		  order.push_back(u);
+		}
+	  }
+      };
+
+      auto root = nodes[0];
+      bfs(root);
+
+      // A disconnected piece: label each component with a new id in one
+      // sweep, owner marking the vertices reached, and push them so that
+      // they are ordered in turn.
+      if (order.size() < nodes.size())
+	{
+	  std::vector<piece> comps;
+	  comps.push_back({order, next_id++, false});
+	  for (auto v : order)
+	    owner[v] = comps.back().id;
+	  for (auto s : nodes)
+	    if (owner[s] == id)
+	      {
+		const auto cid = next_id++;
+		std::vector<std::size_t> comp(1, s);
+		owner[s] = cid;
+		for (std::size_t h = 0; h < comp.size(); ++h)
+		  {
+		    const auto v = comp[h];
+		    for (auto k = gptr[v]; k < gptr[v + 1]; ++k)
+		      if (const auto u = gadj[k]; owner[u] == id)
+			{
+			  owner[u] = cid;
+			  comp.push_back(u);
+			}
+		  }
+		comps.push_back({std::move(comp), cid, false});
+	      }
+	  for (auto c = comps.size(); c-- > 0; )
+	    stack.push_back(std::move(comps[c]));
+	  continue;
+	}
+
+      // Find a pseudo-peripheral root: restart from a vertex of least
+      // degree in the last level while the eccentricity grows.
+      for (int sweep = 0; sweep < 4; ++sweep)
+	{
+	  const auto depth = level[order.back()];
+	  auto best = order.back();
+	  for (auto h = order.size(); h-- > 0 && level[order[h]] == depth; )
+	    if (gptr[order[h] + 1] - gptr[order[h]]
+		< gptr[best + 1] - gptr[best])
+	      best = order[h];
+	  bfs(best);
+	  if (level[order.back()] <= depth)
+	    {
+	      if (level[order.back()] < depth)
+		bfs(root);
+	      break;
+	    }
+	  root = best;
+	}
+
+      const auto depth = level[order.back()];
+      if (depth < 2)
+	{
+	  order_leaf();
+	  continue;
+	}
+
+      // The separating level: the first at which half the vertices
+      // are passed.
+      std::size_t sep_level = 1;
+      for (std::size_t h = 0; h < order.size(); ++h)
+	if (2 * (h + 1) >= order.size())
+	  {
+	    sep_level = std::clamp<std::size_t>(level[order[h]],
+						1, depth - 1);
+	    break;
+	  }
+
+      std::vector<std::size_t> part1, part2, sep;
+      for (auto v : order)
+	{
+	  if (level[v] < sep_level)
+	    part1.push_back(v);
+	  else if (level[v] > sep_level)
+	    part2.push_back(v);
+	  else
+	    {
+	      bool beyond = false;
+	      for (auto k = gptr[v]; k < gptr[v + 1] && !beyond; ++k)
+		beyond = owner[gadj[k]] == id
+		      && level[gadj[k]] == sep_level + 1;
+	      (beyond ? sep : part1).push_back(v);
+	    }
+	}
+
+      // A level that wide is no separator: the graph has few levels,
+      // as with long-range edges, and minimum degree does better.
+      if (4 * sep.size() > nodes.size())
+	{
+	  order_leaf();
+	  continue;
+	}
+
+      const auto id1 = next_id++, id2 = next_id++, id3 = next_id++;
+      for (auto v : part1)
+	owner[v] = id1;
+      for (auto v : part2)
+	owner[v] = id2;
+      for (auto v : sep)
+	owner[v] = id3;
+      stack.push_back({std::move(sep), id3, true});
+      stack.push_back({std::move(part2), id2, false});
+      stack.push_back({std::move(part1), id1, false});
+    }
+}
+
+
+/**
+ * Return a nested dissection ordering of the graph (gptr, gadj).
+ */
+inline std::vector<std::size_t>
+__sparse_nested_dissection(std::size_t n,
+			   const std::vector<std::size_t>& gptr,
+			   const std::vector<std::size_t>& gadj)
+{
+  std::vector<std::size_t> perm;
+  perm.reserve(n);
+  std::vector<std::size_t> nodes(n), owner(n, 0), level(n);
+  std::iota(nodes.begin(), nodes.end(), std::size_t{0});
+  std::size_t next_id = 1;
+  __sparse_dissect(gptr, gadj, std::move(nodes), 0, owner, next_id,
+		   level, perm);
+  return perm;
+}
+
+
+/**
+ * Return the ordering ord of the n * n pattern (ptr, ind).
+ */
+template<typename _IndexP, typename _IndexI>
+  std::vector<std::size_t>
+  __sparse_order(std::size_t n, const std::vector<_IndexP>& ptr,
+		 const std::vector<_IndexI>& ind, sparse_ordering ord)
+  {
+    if (ord == sparse_ordering::natural)
+      {
+	std::vector<std::size_t> perm(n);
+	std::iota(perm.begin(), perm.end(), std::size_t{0});
+	return perm;
+      }
+
+    std::vector<std::size_t> gptr, gadj;
+    __sparse_sym_graph(n, ptr, ind, {}, gptr, gadj);
+    if (ord == sparse_ordering::nested_dissection)
+      return __sparse_nested_dissection(n, gptr, gadj);
+    else
+      return __sparse_min_degree(n, gptr, gadj);
+  }
+
+
+template<typename _Tp, typename _Index>
+  std::vector<std::size_t>
+  sparse_permutation(const csc_matrix<_Tp, _Index>& a, sparse_ordering ord)
+  {
+    if (a.rows() != a.cols())
+      std::__throw_logic_error("sparse_permutation: matrix must be square");
+    return __sparse_order(a.rows(), a.col_ptr(), a.row_ind(), ord);
+  }
+
+
+/**
+ * Return the column matched to each row by a maximum product matching
+ * of the n * n matrix (ptr, ind, val): the product of the magnitudes
+ * of the matched entries is maximized, as in MC64, by finding
+ * a minimum cost perfect matching with the costs
+ * log max_i |a_ij| - log |a_ij| by successive shortest augmenting paths
+ * (Dijkstra's algorithm on the reduced costs).  Rows and columns left
+ * unmatched by a structurally singular matrix are paired off in order.
+ */
+template<typename _Tp, typename _Index>
+  std::vector<std::size_t>
+  __sparse_row_matching(std::size_t n, const std::vector<_Index>& ptr,
+			const std::vector<_Index>& ind,
+			const std::vector<_Tp>& val)
+  {
+    const auto inf = std::numeric_limits<double>::infinity();
+    const std::size_t nnz = val.size();
+
+    std::vector<double> cost(nnz, inf);
+    for (std::size_t j = 0; j < n; ++j)
+      {
+	double cmax = 0.0;
+	for (auto k = std::size_t(ptr[j]); k < std::size_t(ptr[j + 1]); ++k)
+	  cmax = std::max(cmax, double(std::abs(val[k])));
+	if (cmax > 0.0)
+	  for (auto k = std::size_t(ptr[j]); k < std::size_t(ptr[j + 1]); ++k)
+	    if (const double v = std::abs(val[k]); v > 0.0)
+	      cost[k] = std::log(cmax) - std::log(v);
+      }
+
+    std::vector<std::size_t> row_match(n, __sparse_none);
+    std::vector<std::size_t> col_match(n, __sparse_none);
+    std::vector<double> u(n, 0.0), v(n, 0.0);
+
+    // Match each column to an unmatched row of its largest entry.
+    for (std::size_t j = 0; j < n; ++j)
+      for (auto k = std::size_t(ptr[j]); k < std::size_t(ptr[j + 1]); ++k)
+	if (cost[k] == 0.0 && row_match[ind[k]] == __sparse_none)
+	  {
+	    row_match[ind[k]] = j;
+	    col_match[j] = ind[k];
+	    break;
+	  }
+
+    std::vector<double> dist(n, inf);
+    std::vector<std::size_t> pred(n), seen;
+    std::vector<char> final(n, 0);
+    using item = std::pair<double, std::size_t>;
+    std::vector<item> heap;
+    auto later = [](const item& x, const item& y) { return x.first > y.first; };
+    for (std::size_t j0 = 0; j0 < n; ++j0)
+      {
+	if (col_match[j0] != __sparse_none)
+	  continue;
+
+	auto relax = [&](std::size_t j, double dj)
+	{
+	  for (auto k = std::size_t(ptr[j]); k < std::size_t(ptr[j + 1]); ++k)
+	    if (const std::size_t i = ind[k]; cost[k] < inf && !final[i])
+	      if (const auto d = dj + cost[k] - u[j] - v[i]; d < dist[i])
+		{
+		  if (dist[i] == inf)
+		    seen.push_back(i);
+		  dist[i] = d;
+		  pred[i] = j;
+		  heap.push_back({d, i});
+		  std::push_heap(heap.begin(), heap.end(), later);
+		}
+	};
+
+	relax(j0, 0.0);
+	auto free_row = __sparse_none;
+	double len = inf;
+	std::vector<std::size_t> done_rows;
+	while (!heap.empty())
+	  {
+	    std::pop_heap(heap.begin(), heap.end(), later);
+	    const auto [d, i] = heap.back();
+	    heap.pop_back();
+	    if (final[i] || d > dist[i])
+	      continue;
+	    final[i] = 1;
+	    done_rows.push_back(i);
+	    if (row_match[i] == __sparse_none)
+	      {
+		free_row = i;
+		len = d;
+		break;
+	      }
+	    relax(row_match[i], d);
+	  }
+	heap.clear();
+
+	if (free_row != __sparse_none)
+	  {
+	    // Keep the reduced costs nonnegative and the path tight.
+	    u[j0] += len;
+	    for (auto i : done_rows)
+	      if (i != free_row)
+		{
+		  u[row_match[i]] += len - dist[i];
+		  v[i] -= len - dist[i];
+		}
+	    for (auto i = free_row; ; )
+	      {
+		const auto j = pred[i];
+		const auto next = col_match[j];
+		col_match[j] = i;
+		row_match[i] = j;
+		if (j == j0)
+		  break;
+		i = next;
+	      }
+	  }
+	for (auto i : seen)
+	  {
+	    dist[i] = inf;
+	    final[i] = 0;
+	  }
+	seen.clear();
+      }
+
+    // Pair off whatever a structurally singular matrix leaves.
+    std::size_t j = 0;
+    for (std::size_t i = 0; i < n; ++i)
+      if (row_match[i] == __sparse_none)
+	{
+	  while (col_match[j] != __sparse_none)
+	    ++j;
+	  row_match[i] = j;
+	  col_match[j] = i;
+	}
+    return row_match;
+  }
+
+
+/**
+ * Return the elimination tree of the graph (gptr, gadj):
+ * parent[j] is the parent of column j or __sparse_none for a root.
+ */
+inline std::vector<std::size_t>
+__sparse_etree(std::size_t n, const std::vector<std::size_t>& gptr,
+	       const std::vector<std::size_t>& gadj)
+{
+  std::vector<std::size_t> parent(n, __sparse_none), anc(n, __sparse_none);
+  for (std::size_t j = 0; j < n; ++j)
+    for (auto k = gptr[j]; k < gptr[j + 1] && gadj[k] < j; ++k)
+      {
+	// Climb from gadj[k] to its root, compressing the path onto j.
+	auto r = gadj[k];
+	while (anc[r] != __sparse_none && anc[r] != j)
+	  r = std::exchange(anc[r], j);
+	if (anc[r] == __sparse_none)
+	  {
+	    anc[r] = j;
+	    parent[r] = j;
+	  }
+      }
+  return parent;
+}
+
+
+template<typename _Tp, typename _Index>
+  sparse_symbolic::sparse_symbolic(const csc_matrix<_Tp, _Index>& a,
+				   sparse_ordering ord, bool match_rows)
+  : m_n(a.rows()), m_matched(match_rows),
+    m_pat_ptr(a.col_ptr().begin(), a.col_ptr().end()),
+    m_pat_ind(a.row_ind().begin(), a.row_ind().end())
+  {
+    if (a.rows() != a.cols())
+      std::__throw_logic_error("sparse_symbolic: matrix must be square");
+
+    // The rows of the matrix analysed, after the matching.
+    const auto n = m_n;
+    const auto& ptr = a.col_ptr();
+    std::vector<std::size_t> row_match;
+    if (match_rows)
+      row_match = __sparse_row_matching(n, ptr, a.row_ind(), a.values());
+    std::vector<std::size_t> ind(m_pat_ind);
+    if (match_rows)
+      for (auto& i : ind)
+	i = row_match[i];
+
+    m_perm = __sparse_order(n, ptr, ind, ord);
+    std::vector<std::size_t> iperm(n);
+    for (std::size_t k = 0; k < n; ++k)
+      iperm[m_perm[k]] = k;
+
+    // Postorder the elimination tree so that every subtree,
+    // and so every supernode, is a contiguous run of columns.
+    std::vector<std::size_t> gptr, gadj;
+    __sparse_sym_graph(n, ptr, ind, iperm, gptr, gadj);
+    auto parent = __sparse_etree(n, gptr, gadj);
+    {
+      std::vector<std::size_t> head(n, __sparse_none), sibling(n);
+      for (std::size_t j = n; j-- > 0; )
+	if (parent[j] != __sparse_none)
+	  {
+	    sibling[j] = head[parent[j]];
+	    head[parent[j]] = j;
+	  }
+      std::vector<std::size_t> post, stack;
+      post.reserve(n);
+      for (std::size_t r = 0; r < n; ++r)
+	if (parent[r] == __sparse_none)
+	  {
+	    stack.push_back(r);
+	    while (!stack.empty())
+	      {
+		const auto v = stack.back();
+		if (const auto c = head[v]; c != __sparse_none)
+		  {
+		    head[v] = sibling[c];
+		    stack.push_back(c);
+		  }
+		else
+		  {
+		    stack.pop_back();
+		    post.push_back(v);
+		  }
+	      }
+	  }
+      std::vector<std::size_t> perm(n);
+      for (std::size_t k = 0; k < n; ++k)
+	perm[k] = m_perm[post[k]];
+      m_perm = std::move(perm);
+      for (std::size_t k = 0; k < n; ++k)
+	iperm[m_perm[k]] = k;
+    }
+    __sparse_sym_graph(n, ptr, ind, iperm, gptr, gadj);
+    parent = __sparse_etree(n, gptr, gadj);
+
+    // Column counts of L by climbing the row subtrees.
+    std::vector<std::size_t> cc(n, 1), mark(n, __sparse_none);
+    std::vector<std::size_t> n_child(n, 0);
+    for (std::size_t i = 0; i < n; ++i)
+      {
+	if (parent[i] != __sparse_none)
+	  ++n_child[parent[i]];
+	mark[i] = i;
+	for (auto k = gptr[i]; k < gptr[i + 1] && gadj[k] < i; ++k)
+	  for (auto r = gadj[k]; mark[r] != i; r = parent[r])
+	    {
+	      ++cc[r];
+	      mark[r] = i;
+	    }
+      }
+
+    // Fundamental supernodes, then merge each with its parent while
+    // the merged panel stays small and nearly free of explicit zeros.
+    struct snode { std::size_t first, nc, m, nnz; };
+    std::vector<snode> sn;
+    for (std::size_t j = 0; j < n; ++j)
+      if (j > 0 && parent[j - 1] == j && cc[j - 1] == cc[j] + 1
+	  && n_child[j] == 1)
+	{
+	  ++sn.back().nc;
+	  sn.back().nnz += cc[j];
+	}
+      else
+	sn.push_back({j, 1, cc[j], cc[j]});
+
+    constexpr std::size_t MAX_MERGE = 32;
+    std::vector<snode> merged;
+    for (const auto& s : sn)
+      {
+	if (!merged.empty())
+	  {
+	    auto& c = merged.back();
+	    const auto last = c.first + c.nc - 1;
+	    if (parent[last] == s.first)
+	      {
+		const auto nc = c.nc + s.nc, m = c.nc + s.m;
+		const auto panel = nc * m - nc * (nc - 1) / 2;
+		const auto zeros = panel - (c.nnz + s.nnz);
+		if (nc <= MAX_MERGE && 4 * zeros <= panel)
+		  {
+		    c = {c.first, nc, m, c.nnz + s.nnz};
+		    continue;
+		  }
+	      }
+	  }
+	merged.push_back(s);
+      }
+
+    const auto ns = merged.size();
+    std::vector<std::size_t> sn_of(n);
+    m_sn_first.resize(ns + 1);
+    for (std::size_t s = 0; s < ns; ++s)
+      {
+	m_sn_first[s] = merged[s].first;
+	for (std::size_t j = 0; j < merged[s].nc; ++j)
+	  sn_of[merged[s].first + j] = s;
+      }
+    m_sn_first[ns] = n;
+
+    std::vector<std::size_t> sn_parent(ns, __sparse_none);
+    m_child_ptr.assign(ns + 1, 0);
+    for (std::size_t s = 0; s < ns; ++s)
+      if (const auto p = parent[m_sn_first[s + 1] - 1]; p != __sparse_none)
+	{
+	  sn_parent[s] = sn_of[p];
+	  ++m_child_ptr[sn_of[p] + 1];
+	}
+    std::partial_sum(m_child_ptr.begin(), m_child_ptr.end(),
+		     m_child_ptr.begin());
+    m_child.resize(m_child_ptr[ns]);
+    {
+      auto next = m_child_ptr;
+      for (std::size_t s = 0; s < ns; ++s)
+	if (sn_parent[s] != __sparse_none)
+	  m_child[next[sn_parent[s]]++] = s;
+    }
+
+    // The row structure of each supernode: its columns, then the rows
+    // below of its columns and of its children's update rows.
+    // The children come first in the postorder.
+    m_rows_ptr.assign(ns + 1, 0);
+    m_rows.clear();
+    m_rel_ptr.assign(ns + 1, 0);
+    std::fill(mark.begin(), mark.end(), __sparse_none);
+    std::vector<std::size_t> where(n), below;
+    m_factor_nnz = 0;
+    for (std::size_t s = 0; s < ns; ++s)
+      {
+	const auto f = m_sn_first[s], l = m_sn_first[s + 1];
+	below.clear();
+	for (auto j = f; j < l; ++j)
+	  for (auto k = gptr[j]; k < gptr[j + 1]; ++k)
+	    if (const auto i = gadj[k]; i >= l && mark[i] != s)
+	      {
+		mark[i] = s;
+		below.push_back(i);
+	      }
+	for (auto t = m_child_ptr[s]; t < m_child_ptr[s + 1]; ++t)
+	  {
+	    const auto c = m_child[t];
+	    const auto nc_c = m_sn_first[c + 1] - m_sn_first[c];
+	    for (auto k = m_rows_ptr[c] + nc_c; k < m_rows_ptr[c + 1]; ++k)
+	      if (const auto i = m_rows[k]; i >= l && mark[i] != s)
+		{
+		  mark[i] = s;
+		  below.push_back(i);
+		}
+	  }
+	std::sort(below.begin(), below.end());
+	for (auto j = f; j < l; ++j)
+	  m_rows.push_back(j);
+	m_rows.insert(m_rows.end(), below.begin(), below.end());
+	m_rows_ptr[s + 1] = m_rows.size();
+
+	const auto nc = l - f, m = m_rows_ptr[s + 1] - m_rows_ptr[s];
+	m_factor_nnz += nc * m - nc * (nc - 1) / 2;
+	m_rel_ptr[s + 1] = m_rel_ptr[s] + (m - nc);
+      }
+
+    // Map the update rows of each child into its parent's structure.
+    m_rel.resize(m_rel_ptr[ns]);
+    for (std::size_t s = 0; s < ns; ++s)
+      {
+	for (auto k = m_rows_ptr[s]; k < m_rows_ptr[s + 1]; ++k)
+	  where[m_rows[k]] = k - m_rows_ptr[s];
+	for (auto t = m_child_ptr[s]; t < m_child_ptr[s + 1]; ++t)
+	  {
+	    const auto c = m_child[t];
+	    const auto nc_c = m_sn_first[c + 1] - m_sn_first[c];
+	    auto r = m_rel_ptr[c];
+	    for (auto k = m_rows_ptr[c] + nc_c; k < m_rows_ptr[c + 1]; ++k)
+	      m_rel[r++] = where[m_rows[k]];
+	  }
+      }
+
+    // The original row eliminated at each step.
+    m_row_perm = m_perm;
+    if (match_rows)
+      for (std::size_t i = 0; i < n; ++i)
+	m_row_perm[iperm[row_match[i]]] = i;
+
+    // Place each nonzero of the matrix in the front of the supernode
+    // of the first of its row and column to be eliminated.
+    const std::size_t nnz = a.nnz();
+    std::vector<std::size_t> owner(nnz);
+    m_asm_ptr.assign(ns + 1, 0);
+    for (std::size_t j = 0; j < n; ++j)
+      for (auto k = std::size_t(ptr[j]); k < std::size_t(ptr[j + 1]); ++k)
+	{
+	  owner[k] = sn_of[std::min(iperm[ind[k]], iperm[j])];
+	  ++m_asm_ptr[owner[k] + 1];
+	}
+    std::partial_sum(m_asm_ptr.begin(), m_asm_ptr.end(), m_asm_ptr.begin());
+    m_asm_src.resize(nnz);
+    {
+      auto next = m_asm_ptr;
+      for (std::size_t k = 0; k < nnz; ++k)
+	m_asm_src[next[owner[k]]++] = k;
+    }
+    std::vector<std::size_t> col_of(nnz);
+    for (std::size_t j = 0; j < n; ++j)
+      for (auto k = std::size_t(ptr[j]); k < std::size_t(ptr[j + 1]); ++k)
+	col_of[k] = j;
+    m_asm_row.resize(nnz);
+    m_asm_col.resize(nnz);
+    for (std::size_t s = 0; s < ns; ++s)
+      {
+	for (auto k = m_rows_ptr[s]; k < m_rows_ptr[s + 1]; ++k)
+	  where[m_rows[k]] = k - m_rows_ptr[s];
+	for (auto t = m_asm_ptr[s]; t < m_asm_ptr[s + 1]; ++t)
+	  {
+	    const auto k = m_asm_src[t];
+	    m_asm_row[t] = where[iperm[ind[k]]];
+	    m_asm_col[t] = where[iperm[col_of[k]]];
+	  }
+      }
+  }
+
+
+/**
+ * Throw std::logic_error unless a has the pattern analysed.
+ */
+template<typename _Tp, typename _Index>
+  void
+  sparse_symbolic::__check_pattern(const csc_matrix<_Tp, _Index>& a) const
+  {
+    const auto& ptr = a.col_ptr();
+    const auto& ind = a.row_ind();
+    if (a.rows() != m_n || a.cols() != m_n
+	|| !std::equal(ptr.begin(), ptr.end(),
+		       m_pat_ptr.begin(), m_pat_ptr.end(),
+		       [](auto p, auto q) { return std::size_t(p) == q; })
+	|| !std::equal(ind.begin(), ind.end(),
+		       m_pat_ind.begin(), m_pat_ind.end(),
+		       [](auto p, auto q) { return std::size_t(p) == q; }))
+      std::__throw_logic_error("sparse_symbolic: "
+			       "matrix pattern differs from the analysis");
+  }
+
+
+/**
+ * The number of pivot columns of a front factored between updates.
+ */
+constexpr std::size_t __sparse_front_block = 64;
+
+
+/**
+ * Add the update matrices of the children of supernode s
+ * into its m * m front.  Each update is freed once added.
+ */
+template<typename _Tp>
+  void
+  __sparse_extend_add(const std::vector<std::size_t>& child_ptr,
+		      const std::vector<std::size_t>& child,
+		      const std::vector<std::size_t>& rel_ptr,
+		      const std::vector<std::size_t>& rel,
+		      std::size_t s, std::size_t m, _Tp* front,
+		      std::vector<std::vector<_Tp>>& update)
+  {
+    for (auto t = child_ptr[s]; t < child_ptr[s + 1]; ++t)
+      {
+	const auto c = child[t];
+	const auto r = rel.data() + rel_ptr[c];
+	const auto mc = rel_ptr[c + 1] - rel_ptr[c];
+	const auto uc = update[c].data();
+	for (std::size_t i = 0; i < mc; ++i)
+	  {
+	    auto row = front + r[i] * m;
+	    for (std::size_t j = 0; j < mc; ++j)
+	      row[r[j]] += uc[i * mc + j];
+	  }
+	std::vector<_Tp>().swap(update[c]);
+      }
+  }
+
+
+template<typename _Tp, typename _Index>
+  sparse_lu_decomposition<_Tp, _Index>::
+  sparse_lu_decomposition(const csc_matrix<_Tp, _Index>& a,
+			  sparse_ordering ord)
+  : sparse_lu_decomposition(a, sparse_symbolic(a, ord, true))
+  { }
+
+
+template<typename _Tp, typename _Index>
+  sparse_lu_decomposition<_Tp, _Index>::
+  sparse_lu_decomposition(const csc_matrix<_Tp, _Index>& a,
+			  const sparse_symbolic& sym)
+  : m_sym(sym)
+  {
+    const auto& S = m_sym;
+    const auto ns = S.num_supernodes();
+    m_ptr.assign(ns + 1, 0);
+    for (std::size_t s = 0; s < ns; ++s)
+      {
+	const auto nc = S.m_sn_first[s + 1] - S.m_sn_first[s];
+	const auto m = S.m_rows_ptr[s + 1] - S.m_rows_ptr[s];
+	m_ptr[s + 1] = m_ptr[s] + nc * m + (m - nc) * nc;
+      }
+    m_lu.resize(m_ptr[ns]);
+    m_piv.resize(S.m_n);
+    this->refactor(a);
+  }
+
+
+/**
+ * Factor a by the multifrontal method.  Each supernode in turn assembles
+ * its front from the matrix and its children's updates and factors its
+ * nc pivot columns with partial pivoting among its nc pivot rows;
+ * the updated block that remains is passed on to the parent.
+ */
+template<typename _Tp, typename _Index>
+  void
+  sparse_lu_decomposition<_Tp, _Index>::
+  refactor(const csc_matrix<_Tp, _Index>& a)
+  {
+    const auto& S = m_sym;
+    S.__check_pattern(a);
+    m_a = a.clone();
+
+    const auto& val = a.values();
+    _Tp anorm{0};
+    for (const auto& v : val)
+      anorm = std::max(anorm, std::abs(v));
+    const auto thresh = std::sqrt(std::numeric_limits<_Tp>::epsilon())
+		      * anorm;
+
+    m_perturbed = 0;
+    const auto ns = S.num_supernodes();
+    std::vector<std::vector<_Tp>> update(ns);
+    std::vector<_Tp> front;
+    for (std::size_t s = 0; s < ns; ++s)
+      {
+	const auto f = S.m_sn_first[s];
+	const auto nc = S.m_sn_first[s + 1] - f;
+	const auto m = S.m_rows_ptr[s + 1] - S.m_rows_ptr[s];
+	const auto m2 = m - nc;
+
+	front.assign(m * m, _Tp{0});
+	auto F = front.data();
+	for (auto t = S.m_asm_ptr[s]; t < S.m_asm_ptr[s + 1]; ++t)
+	  F[S.m_asm_row[t] * m + S.m_asm_col[t]] += val[S.m_asm_src[t]];
+	__sparse_extend_add(S.m_child_ptr, S.m_child, S.m_rel_ptr, S.m_rel,
+			    s, m, F, update);
+
+	// Factor the nc pivot columns in blocks.  Each block is factored
+	// down the whole front, its rows of U are formed across the front
+	// and the rest of the front, F22 included, is updated by gemm().
+	constexpr std::size_t NB = __sparse_front_block;
+	for (std::size_t k0 = 0; k0 < nc; k0 += NB)
+	  {
+	    const auto k1 = std::min(k0 + NB, nc);
+	    for (auto k = k0; k < k1; ++k)
+	      {
+		auto p = k;
+		for (auto r = k + 1; r < nc; ++r)
+		  if (std::abs(F[r * m + k]) > std::abs(F[p * m + k]))
+		    p = r;
+		m_piv[f + k] = p;
+		if (p != k)
+		  std::swap_ranges(F + k * m, F + (k + 1) * m, F + p * m);
+		auto& pivot = F[k * m + k];
+		if (std::abs(pivot) < thresh)
+		  {
+		    pivot = pivot < _Tp{0} ? -thresh : thresh;
+		    ++m_perturbed;
+		  }
+		else if (pivot == _Tp{0})
+		  std::__throw_logic_error("sparse_lu_decomposition: "
+					   "singular matrix");
+		const auto rk = F + k * m;
+		for (auto r = k + 1; r < m; ++r)
+		  {
+		    auto rr = F + r * m;
+		    const auto l = rr[k] /= pivot;
+		    for (auto c = k + 1; c < k1; ++c)
+		      rr[c] -= l * rk[c];
+		  }
+	      }
+
+	    // The block rows of U beyond the block.
+	    for (auto r = k0 + 1; r < k1; ++r)
+	      for (auto k = k0; k < r; ++k)
+		{
+		  const auto l = F[r * m + k];
+		  for (auto c = k1; c < m; ++c)
+		    F[r * m + c] -= l * F[k * m + c];
+		}
+
+	    if (k1 < m)
+	      gemm(m - k1, m - k1, k1 - k0, _Tp{-1}, F + k1 * m + k0, m,
+		   F + k0 * m + k1, m, _Tp{1}, F + k1 * m + k1, m);
+	  }
+
+	// Pass the updated F22 on to the parent.
+	if (m2 > 0)
+	  {
+	    auto& u = update[s];
+	    u.resize(m2 * m2);
+	    for (std::size_t r = 0; r < m2; ++r)
+	      std::copy_n(F + (nc + r) * m + nc, m2, u.data() + r * m2);
+	  }
+
+	auto out = m_lu.data() + m_ptr[s];
+	std::copy_n(F, nc * m, out);
+	for (std::size_t r = 0; r < m2; ++r)
+	  std::copy_n(F + (nc + r) * m, nc, out + nc * m + r * nc);
+      }
+  }
+
+
+/**
+ * Solve in place with the factors in the permuted order.
+ */
+template<typename _Tp, typename _Index>
+  void
+  sparse_lu_decomposition<_Tp, _Index>::solve(std::vector<_Tp>& y) const
+  {
+    const auto& S = m_sym;
+    const auto ns = S.num_supernodes();
+
+    // L.z = P.y, applying each block's interchanges as it is reached.
+    for (std::size_t s = 0; s < ns; ++s)
+      {
+	const auto f = S.m_sn_first[s];
+	const auto nc = S.m_sn_first[s + 1] - f;
+	const auto m = S.m_rows_ptr[s + 1] - S.m_rows_ptr[s];
+	const auto rows = S.m_rows.data() + S.m_rows_ptr[s];
+	const auto U = m_lu.data() + m_ptr[s];
+	const auto L21 = U + nc * m;
+	for (std::size_t k = 0; k < nc; ++k)
+	  if (const auto p = m_piv[f + k]; p != k)
+	    std::swap(y[f + k], y[f + p]);
+	for (std::size_t r = 1; r < nc; ++r)
+	  {
+	    auto sum = y[f + r];
+	    for (std::size_t k = 0; k < r; ++k)
+	      sum -= U[r * m + k] * y[f + k];
+	    y[f + r] = sum;
+	  }
+	for (auto r = nc; r < m; ++r)
+	  {
+	    _Tp sum{0};
+	    for (std::size_t k = 0; k < nc; ++k)
+	      sum += L21[(r - nc) * nc + k] * y[f + k];
+	    y[rows[r]] -= sum;
+	  }
+      }
+
+    // U.x = z.
+    for (std::size_t s = ns; s-- > 0; )
+      {
+	const auto f = S.m_sn_first[s];
+	const auto nc = S.m_sn_first[s + 1] - f;
+	const auto m = S.m_rows_ptr[s + 1] - S.m_rows_ptr[s];
+	const auto rows = S.m_rows.data() + S.m_rows_ptr[s];
+	const auto U = m_lu.data() + m_ptr[s];
+	for (std::size_t r = nc; r-- > 0; )
+	  {
+	    auto sum = y[f + r];
+	    for (auto c = r + 1; c < m; ++c)
+	      sum -= U[r * m + c] * y[rows[c]];
+	    y[f + r] = sum / U[r * m + r];
+	  }
+      }
+  }
+
+
+/**
+ * Solve A.x = b.  If any pivot was perturbed, up to three steps
+ * of iterative refinement with the original matrix follow,
+ * each kept only if it reduces the residual.
+ */
+template<typename _Tp, typename _Index>
+  template<typename _Vector, typename _VectorOut>
+    void
+    sparse_lu_decomposition<_Tp, _Index>::
+    backsubstitute(const _Vector& b, _VectorOut& x) const
+    {
+      const auto n = m_sym.m_n;
+      const auto& perm = m_sym.m_perm;
+      const auto& row_perm = m_sym.m_row_perm;
+      std::vector<_Tp> y(n), z(n);
+      for (std::size_t k = 0; k < n; ++k)
+	y[k] = b[row_perm[k]];
+      this->solve(y);
+      for (std::size_t k = 0; k < n; ++k)
+	z[perm[k]] = y[k];
+
+      if (m_perturbed > 0)
+	{
+	  std::vector<_Tp> r(n), z_new(n);
+	  auto residual = [&](const std::vector<_Tp>& zz)
+	  {
+	    spmv(m_a, zz.data(), r.data());
+	    _Tp norm{0};
+	    for (std::size_t i = 0; i < n; ++i)
+	      {
+		r[i] = b[i] - r[i];
+		norm = std::max(norm, std::abs(r[i]));
+	      }
+	    return norm;
+	  };
+	  auto norm = residual(z);
+	  for (int iter = 0; iter < 3 && norm > _Tp{0}; ++iter)
+	    {
+	      for (std::size_t k = 0; k < n; ++k)
+		y[k] = r[row_perm[k]];
+	      this->solve(y);
+	      z_new = z;
+	      for (std::size_t k = 0; k < n; ++k)
+		z_new[perm[k]] += y[k];
+	      const auto norm_new = residual(z_new);
+	      if (!(norm_new < norm))
+		break;
+	      z.swap(z_new);
+	      norm = norm_new;
+	    }
+	}
+
+      for (std::size_t i = 0; i < n; ++i)
+	x[i] = z[i];
+    }
+
+
+template<typename _Tp, typename _Index>
+  template<typename InVecIter, typename OutVecIter>
+    void
+    sparse_lu_decomposition<_Tp, _Index>::
+    backsubstitution(InVecIter b_begin, InVecIter b_end,
+		     OutVecIter x_begin) const
+    {
+      const std::vector<_Tp> b(b_begin, b_end);
+      std::vector<_Tp> x(b.size());
+      this->backsubstitute(b, x);
+      std::copy(x.begin(), x.end(), x_begin);
+    }
+
+
+template<typename _Tp, typename _Index>
+  sparse_cholesky_decomposition<_Tp, _Index>::
+  sparse_cholesky_decomposition(const csc_matrix<_Tp, _Index>& a,
+				sparse_ordering ord)
+  : sparse_cholesky_decomposition(a, sparse_symbolic(a, ord))
+  { }
+
+
+template<typename _Tp, typename _Index>
+  sparse_cholesky_decomposition<_Tp, _Index>::
+  sparse_cholesky_decomposition(const csc_matrix<_Tp, _Index>& a,
+				const sparse_symbolic& sym)
+  : m_sym(sym)
+  {
+    if (m_sym.m_matched)
+      std::__throw_logic_error("sparse_cholesky_decomposition: "
+			       "the analysis must not match rows");
+    const auto& S = m_sym;
+    const auto ns = S.num_supernodes();
+    m_ptr.assign(ns + 1, 0);
+    for (std::size_t s = 0; s < ns; ++s)
+      {
+	const auto nc = S.m_sn_first[s + 1] - S.m_sn_first[s];
+	const auto m = S.m_rows_ptr[s + 1] - S.m_rows_ptr[s];
+	m_ptr[s + 1] = m_ptr[s] + m * nc;
+      }
+    m_l.resize(m_ptr[ns]);
+    this->refactor(a);
+  }
+
+
+/**
+ * Factor a by the multifrontal method.  The fronts are kept symmetric
+ * in full so that every update is a gemm() on contiguous rows.
+ */
+template<typename _Tp, typename _Index>
+  void
+  sparse_cholesky_decomposition<_Tp, _Index>::
+  refactor(const csc_matrix<_Tp, _Index>& a)
+  {
+    const auto& S = m_sym;
+    S.__check_pattern(a);
+
+    const auto& val = a.values();
+    const auto& ind = a.row_ind();
+    const auto& ptr = a.col_ptr();
+    std::vector<std::size_t> col_of(a.nnz());
+    for (std::size_t j = 0; j < S.m_n; ++j)
+      for (auto k = std::size_t(ptr[j]); k < std::size_t(ptr[j + 1]); ++k)
+	col_of[k] = j;
+
+    const auto ns = S.num_supernodes();
+    std::vector<std::vector<_Tp>> update(ns);
+    std::vector<_Tp> front, w;
+    for (std::size_t s = 0; s < ns; ++s)
+      {
+	const auto nc = S.m_sn_first[s + 1] - S.m_sn_first[s];
+	const auto m = S.m_rows_ptr[s + 1] - S.m_rows_ptr[s];
+	const auto m2 = m - nc;
+
+	// Assemble the lower triangle of a into both triangles.
+	front.assign(m * m, _Tp{0});
+	auto F = front.data();
+	for (auto t = S.m_asm_ptr[s]; t < S.m_asm_ptr[s + 1]; ++t)
+	  {
+	    const auto k = S.m_asm_src[t];
+	    const std::size_t i = ind[k], j = col_of[k];
+	    if (i < j)
+	      continue;
+	    const auto r = S.m_asm_row[t], c = S.m_asm_col[t];
+	    F[r * m + c] += val[k];
+	    if (i != j)
+	      F[c * m + r] += val[k];
+	  }
+	__sparse_extend_add(S.m_child_ptr, S.m_child, S.m_rel_ptr, S.m_rel,
+			    s, m, F, update);
+
+	// Factor the nc pivot columns in blocks.  The entries of each block
+	// column are dot products of contiguous rows; the rest of the front,
+	// F22 included, is then updated by gemm() with the block's transpose.
+	constexpr std::size_t NB = __sparse_front_block;
+	for (std::size_t k0 = 0; k0 < nc; k0 += NB)
+	  {
+	    const auto k1 = std::min(k0 + NB, nc);
+	    for (auto r = k0; r < m; ++r)
+	      {
+		auto fr = F + r * m;
+		const auto kmax = std::min(r, k1);
+		for (auto k = k0; k < kmax; ++k)
+		  {
+		    const auto fk = F + k * m;
+		    auto sum = fr[k];
+		    for (auto t = k0; t < k; ++t)
+		      sum -= fr[t] * fk[t];
+		    fr[k] = sum / fk[k];
+		  }
+		if (r < k1)
+		  {
+		    auto sum = fr[r];
+		    for (auto t = k0; t < r; ++t)
+		      sum -= fr[t] * fr[t];
+		    if (sum <= _Tp{0})
+		      std::__throw_logic_error("sparse_cholesky_decomposition: "
+					       "Matrix must be positive definite");
+		    fr[r] = std::sqrt(sum);
+		  }
+	      }
+
+	    if (k1 < m)
+	      {
+		const auto mt = m - k1, kb = k1 - k0;
+		w.resize(kb * mt);
+		for (std::size_t r = 0; r < mt; ++r)
+		  for (std::size_t k = 0; k < kb; ++k)
+		    w[k * mt + r] = F[(k1 + r) * m + k0 + k];
+		gemm(mt, mt, kb, _Tp{-1}, F + k1 * m + k0, m, w.data(), mt,
+		     _Tp{1}, F + k1 * m + k1, m);
+	      }
+	  }
+
+	// Pass the updated F22 on to the parent.
+	if (m2 > 0)
+	  {
+	    auto& u = update[s];
+	    u.resize(m2 * m2);
+	    for (std::size_t r = 0; r < m2; ++r)
+	      std::copy_n(F + (nc + r) * m + nc, m2, u.data() + r * m2);
+	  }
+
+	auto out = m_l.data() + m_ptr[s];
+	for (std::size_t r = 0; r < m; ++r)
+	  std::copy_n(F + r * m, nc, out + r * nc);
+      }
+  }
+
+
+/**
+ * Solve in place with the factor in the permuted order.
+ */
+template<typename _Tp, typename _Index>
+  void
+  sparse_cholesky_decomposition<_Tp, _Index>::
+  solve(std::vector<_Tp>& y) const
+  {
+    const auto& S = m_sym;
+    const auto ns = S.num_supernodes();
+
+    // L.z = y.
+    for (std::size_t s = 0; s < ns; ++s)
+      {
+	const auto f = S.m_sn_first[s];
+	const auto nc = S.m_sn_first[s + 1] - f;
+	const auto m = S.m_rows_ptr[s + 1] - S.m_rows_ptr[s];
+	const auto rows = S.m_rows.data() + S.m_rows_ptr[s];
+	const auto L = m_l.data() + m_ptr[s];
+	for (std::size_t r = 0; r < nc; ++r)
+	  {
+	    auto sum = y[f + r];
+	    for (std::size_t k = 0; k < r; ++k)
+	      sum -= L[r * nc + k] * y[f + k];
+	    y[f + r] = sum / L[r * nc + r];
+	  }
+	for (auto r = nc; r < m; ++r)
+	  {
+	    _Tp sum{0};
+	    for (std::size_t k = 0; k < nc; ++k)
+	      sum += L[r * nc + k] * y[f + k];
+	    y[rows[r]] -= sum;
+	  }
+      }
+
+    // L~.x = z.
+    for (std::size_t s = ns; s-- > 0; )
+      {
+	const auto f = S.m_sn_first[s];
+	const auto nc = S.m_sn_first[s + 1] - f;
+	const auto m = S.m_rows_ptr[s + 1] - S.m_rows_ptr[s];
+	const auto rows = S.m_rows.data() + S.m_rows_ptr[s];
+	const auto L = m_l.data() + m_ptr[s];
+	for (auto r = nc; r < m; ++r)
+	  {
+	    const auto yr = y[rows[r]];
+	    for (std::size_t k = 0; k < nc; ++k)
+	      y[f + k] -= L[r * nc + k] * yr;
+	  }
+	for (std::size_t r = nc; r-- > 0; )
+	  {
+	    const auto yr = y[f + r] /= L[r * nc + r];
+	    for (std::size_t k = 0; k < r; ++k)
+	      y[f + k] -= L[r * nc + k] * yr;
+	  }
+      }
+  }
+
+
+template<typename _Tp, typename _Index>
+  template<typename _Vector, typename _VectorOut>
+    void
+    sparse_cholesky_decomposition<_Tp, _Index>::
+    backsubstitute(const _Vector& b, _VectorOut& x) const
+    {
+      const auto n = m_sym.m_n;
+      const auto& perm = m_sym.m_perm;
+      std::vector<_Tp> y(n);
+      for (std::size_t k = 0; k < n; ++k)
+	y[k] = b[perm[k]];
+      this->solve(y);
+      for (std::size_t k = 0; k < n; ++k)
+	x[perm[k]] = y[k];
+    }
+
+
+template<typename _Tp, typename _Index>
+  template<typename InVecIter, typename OutVecIter>
+    void
+    sparse_cholesky_decomposition<_Tp, _Index>::
+    backsubstitution(InVecIter b_begin, InVecIter b_end,
+		     OutVecIter x_begin) const
+    {
+      const std::vector<_Tp> b(b_begin, b_end);
+      std::vector<_Tp> x(b.size());
+      this->backsubstitute(b, x);
+      std::copy(x.begin(), x.end(), x_begin);
+    }
+
+} // namespace matrix
+
+#endif // MATRIX_SPARSE_DIRECT_TCC
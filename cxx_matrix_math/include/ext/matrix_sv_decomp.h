@@ -1,25 +1,70 @@
 #ifndef MATRIX_SV_DECOMP_H
 #define MATRIX_SV_DECOMP_H
 
+#include <cstdint>
 #include <vector>
 
+#include "matrix_dense.h"
+#include "matrix_layout.h"
+#include "matrix_qr_decomp.h"
+#include "matrix_thread_pool.h"
+#include "matrix_workspace.h"
+
 namespace matrix
 {
 
+/**
+ *  The algorithms available for computing the singular value decomposition.
+ */
+enum class sv_algorithm
+{
+  /// Householder bidiagonalization and implicitly shifted QR sweeps.
+  golub_reinsch,
+  /// Householder bidiagonalization and divide and conquer on the
+  /// bidiagonal form; the fastest for large matrices.
+  divide_conquer,
+  /// One-sided Jacobi rotations of column pairs on a thread pool;
+  /// suited to mid-sized matrices and accurate for small singular values.
+  jacobi
+};
+
+/**
+ *  The singular vectors to be formed by sv_decomp().
+ */
+enum class sv_vectors
+{
+  /// The singular values only.
+  none,
+  /// The singular values and U.
+  left,
+  /// The singular values and V.
+  right,
+  /// The singular values, U and V.
+  both
+};
+
 /**
  *  This class represents an singular value decomposition of a matrix.
+ *  The factors are held in matrices of type _Storage,
+ *  by default an aligned, contiguous dense_matrix.
  */
-template<typename NumTp, typename _Matrix>
+template<typename NumTp, typename _Matrix,
+	 typename _Storage = dense_matrix<__matrix_value_t<_Matrix>>>
   class sv_decomposition
   {
 
   public:
 
-    using value_type = std::decay_t<decltype(_Matrix{}[0][0])>;
+    using value_type = __matrix_value_t<_Matrix>;
 
     template<typename _Matrix2>
       sv_decomposition(std::size_t m_n_rows, std::size_t n_cols,
-		       _Matrix2& a);
+		       const _Matrix2& a,
+		       sv_algorithm alg = sv_algorithm::golub_reinsch);
+
+    template<typename _Matrix2>
+      sv_decomposition(std::size_t m_n_rows, std::size_t n_cols,
+		       const _Matrix2& a, thread_pool& pool);
 
     template<typename _Vector2, typename _VectorOut>
       void
@@ -32,12 +77,12 @@ template<typename NumTp, typename _Matrix>
 
     template<typename _Matrix2, typename _Vector2, typename _VectorOut>
       void
-      improve(const _Matrix2 a_orig,
+      improve(const _Matrix2& a_orig,
 	      const _Vector2& b, _VectorOut& x) const;
 
     template<typename _Matrix2, typename InVecIter, typename OutVecIter>
       void
-      improve(const _Matrix2 a_orig,
+      improve(const _Matrix2& a_orig,
 	      InVecIter b_begin, InVecIter b_end,
 	      OutVecIter x_begin) const;
 
@@ -47,11 +92,11 @@ template<typename NumTp, typename _Matrix>
 
     std::size_t m_n_cols;
 
-    _Matrix m_a;
+    _Storage m_a;
 
-    std::vector<std::size_t> m_w;
+    std::vector<value_type> m_w;
 
-    std::vector<std::size_t> m_v;
+    _Storage m_v;
   };
 
 /**
@@ -62,6 +107,92 @@ template<typename _Matrix, typename _Vector>
   sv_decomp(const std::size_t n_rows, const std::size_t n_cols,
 	    _Matrix& a, _Vector& w, _Matrix& v);
 
+/**
+ *  Return the number of elements of workspace needed by sv_decomp()
+ *  for an n_rows*n_cols matrix.
+ */
+constexpr std::size_t
+sv_decomp_workspace_size(std::size_t /*n_rows*/, std::size_t n_cols) noexcept
+{ return 2 * n_cols; }
+
+/**
+ *  Compute the singular value decomposition as above without allocating.
+ *  work must hold at least sv_decomp_workspace_size(n_rows, n_cols)
+ *  elements.
+ */
+template<typename _Matrix, typename _Vector>
+  void
+  sv_decomp(const std::size_t n_rows, const std::size_t n_cols,
+	    _Matrix& a, _Vector& w, _Matrix& v,
+	    workspace_span<__matrix_value_t<_Matrix>> work);
+
+/**
+ *  Compute the singular value decomposition a = u.diag(w).v~ of
+ *  a[0..n_rows-1][0..n_cols-1] with the algorithm alg.  Only the singular
+ *  vectors named by vectors are formed: without U, a is left holding
+ *  intermediate results and without V, v is not referenced and may be
+ *  an empty matrix.  The Jacobi algorithm runs on default_thread_pool().
+ */
+template<typename _Matrix, typename _Vector>
+  void
+  sv_decomp(const std::size_t n_rows, const std::size_t n_cols,
+	    _Matrix& a, _Vector& w, _Matrix& v,
+	    sv_algorithm alg, sv_vectors vectors = sv_vectors::both);
+
+/**
+ *  Compute the singular value decomposition by reducing a to bidiagonal
+ *  form B as sv_decomp() does and finding the singular triplets of B
+ *  by divide and conquer on the eigenproblem of its 2n_cols*2n_cols
+ *  Golub-Kahan tridiagonal form.  The singular vectors of B are applied
+ *  to the Householder transformations with gemm.
+ *  The singular values are returned in descending order.
+ *  If no singular vectors are wanted the QR sweeps of sv_decomp() are used.
+ */
+template<typename _Matrix, typename _Vector>
+  void
+  sv_decomp_dc(const std::size_t n_rows, const std::size_t n_cols,
+	       _Matrix& a, _Vector& w, _Matrix& v,
+	       sv_vectors vectors = sv_vectors::both);
+
+/**
+ *  Compute the singular value decomposition by one-sided (Hestenes) Jacobi:
+ *  pairs of columns of a are rotated until all are mutually orthogonal,
+ *  the column norms then being the singular values.  Each sweep visits
+ *  the column pairs in round-robin order so that the pairs of a round are
+ *  disjoint; they are split across the threads of pool.  The result does
+ *  not depend on the number of threads.  The singular values are returned
+ *  in column order.  Throw std::logic_error if the sweeps fail to converge.
+ */
+template<typename _Matrix, typename _Vector>
+  void
+  sv_decomp_jacobi(const std::size_t n_rows, const std::size_t n_cols,
+		   _Matrix& a, _Vector& w, _Matrix& v,
+		   thread_pool& pool = default_thread_pool(),
+		   sv_vectors vectors = sv_vectors::both);
+
+/**
+ *  Compute the leading rank singular triplets of a[0..n_rows-1][0..n_cols-1]
+ *  by the randomized range finder of Halko, Martinsson and Tropp.
+ *  a is multiplied by a Gaussian n_cols*(rank + oversample) test matrix and
+ *  the product orthonormalized by Householder QR into Q, with power_iters
+ *  passes through a~ and a again to sharpen the decay of the spectrum.
+ *  The small projected matrix Q~.a is then decomposed with the QR and
+ *  SVD kernels above.  On output u[0..n_rows-1][0..rank-1] and
+ *  v[0..n_cols-1][0..rank-1] hold the singular vectors and w[0..rank-1]
+ *  the singular values in descending order, as sv_backsub() with
+ *  the rank takes them.  a is not modified.  The random test matrix
+ *  is drawn from a generator seeded with seed so the result is repeatable.
+ *  The work is O(n_rows n_cols (rank + oversample)) per pass.
+ */
+template<typename _MatrixA, typename _Matrix, typename _Vector>
+  void
+  sv_decomp_randomized(std::size_t n_rows, std::size_t n_cols,
+		       const _MatrixA& a, std::size_t rank,
+		       _Matrix& u, _Vector& w, _Matrix& v,
+		       std::size_t oversample = 10,
+		       std::size_t power_iters = 2,
+		       std::uint_fast64_t seed = 5489u);
+
 /**
  *  
  */
@@ -72,19 +203,73 @@ template<typename _Matrix, typename _Vector>
 	     const _Vector& w, const _Matrix& v,
 	     const _Vector& b, _Vector& x);
 
+/**
+ *  Return the number of elements of workspace needed by sv_backsub()
+ *  for an n_rows*n_cols matrix.
+ */
+constexpr std::size_t
+sv_backsub_workspace_size(std::size_t /*n_rows*/, std::size_t n_cols) noexcept
+{ return n_cols; }
+
+/**
+ *  Solve A.x = b as above without allocating.
+ *  work must hold at least sv_backsub_workspace_size(n_rows, n_cols)
+ *  elements.
+ */
+template<typename _Matrix, typename _Vector>
+  void
+  sv_backsub(std::size_t n_rows, std::size_t n_cols,
+	     const _Matrix& u,
+	     const _Vector& w, const _Matrix& v,
+	     const _Vector& b, _Vector& x,
+	     workspace_span<__matrix_value_t<_Matrix>> work);
+
+/**
+ *  Solve A.x = b in the least-squares sense from the leading rank singular
+ *  triplets of A in u[0..n_rows-1][0..rank-1], w[0..rank-1] and
+ *  v[0..n_cols-1][0..rank-1], as sv_decomp_randomized() returns them.
+ */
+template<typename _Matrix, typename _Vector>
+  void
+  sv_backsub(std::size_t n_rows, std::size_t n_cols, std::size_t rank,
+	     const _Matrix& u,
+	     const _Vector& w, const _Matrix& v,
+	     const _Vector& b, _Vector& x);
+
 /**
  *  Improves a solution vector x of the linear set A.x = b.
  *  The _Matrix a and the SV decomposition of a -- u, w, v and the
  *  right-hand side _Vector are input along with the solution vector x.
  *  The solution vector x is improved and modified on output.
  */
-template<typename _Matrix, typename _Vector>
+template<typename _MatrixA, typename _Matrix, typename _Vector>
   void
   sv_improve(std::size_t n_rows, std::size_t n_cols,
-	     const _Matrix& a, const _Matrix& u,
+	     const _MatrixA& a, const _Matrix& u,
 	     const _Vector& w, const _Matrix& v,
 	     const _Vector& b, _Vector& x);
 
+/**
+ *  Return the number of elements of workspace needed by sv_improve()
+ *  for an n_rows*n_cols matrix.
+ */
+constexpr std::size_t
+sv_improve_workspace_size(std::size_t n_rows, std::size_t n_cols) noexcept
+{ return n_rows + 2 * n_cols; }
+
+/**
+ *  Improve the solution vector x as above without allocating.
+ *  work must hold at least sv_improve_workspace_size(n_rows, n_cols)
+ *  elements.
+ */
+template<typename _MatrixA, typename _Matrix, typename _Vector>
+  void
+  sv_improve(std::size_t n_rows, std::size_t n_cols,
+	     const _MatrixA& a, const _Matrix& u,
+	     const _Vector& w, const _Matrix& v,
+	     const _Vector& b, _Vector& x,
+	     workspace_span<__matrix_value_t<_Matrix>> work);
+
 } // namespace matrix
 
 #include "matrix_sv_decomp.tcc"
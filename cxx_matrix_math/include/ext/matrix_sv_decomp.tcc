@@ -3,10 +3,20 @@
 
 
 #include <cstdlib>
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <random>
 #include <sstream>
+#include <type_traits>
+#include <utility>
 #include <vector>
 #include <cmath>
 
+#include "matrix_gemm.h"
+#include "matrix_layout.h"
+#include "matrix_tridiag_eigen.h"
+
 
 namespace matrix
 {
@@ -20,88 +30,116 @@ template<typename _Matrix, typename _Vector>
   sv_decomp(const std::size_t n_rows, const std::size_t n_cols,
 	    _Matrix& a, _Vector& w, _Matrix& v)
   {
-    using NumTp = std::remove_reference_t<decltype(a[0][0])>;
+    using NumTp = __matrix_value_t<_Matrix>;
 
-    int l;
-    NumTp c, f, h, s;
+    std::vector<NumTp> work(sv_decomp_workspace_size(n_rows, n_cols));
+    sv_decomp(n_rows, n_cols, a, w, v, workspace_span<NumTp>(work));
+  }
 
-    const int ITS = 30;
 
-    std::vector<NumTp> rv1(n_cols);
+/**
+ *  Householder reduction of the n_rows*n_cols element accessor A
+ *  to upper bidiagonal form with the diagonal in w[0..n_cols-1] and
+ *  the superdiagonal in rv1[1..n_cols-1], rv1[0] being zero.
+ *  The Householder vectors are left in A.  The reflections are applied
+ *  a row at a time through the temporary row tmp[0..n_cols-1].
+ *  Return the largest row sum of the bidiagonal form.
+ */
+template<typename _ElemA, typename _Vector, typename _NumTp>
+  _NumTp
+  __sv_bidiagonalize(const std::size_t n_rows, const std::size_t n_cols,
+		     _ElemA A, _Vector& w, _NumTp* rv1, _NumTp* tmp)
+  {
+    _NumTp f, h, s;
 
-    NumTp g = NumTp{0};
-    NumTp scale = NumTp{0};
-    NumTp anorm = NumTp{0};
+    _NumTp g = _NumTp{0};
+    _NumTp scale = _NumTp{0};
+    _NumTp anorm = _NumTp{0};
 
-    //  Householder reduction to bidiagonal form.
     for (std::size_t i = 0; i < n_cols; ++i)
       {
 	auto l = i + 1;
 	rv1[i] = scale * g;
-	g = s = scale = NumTp{0};
+	g = s = scale = _NumTp{0};
 	if (i <= n_rows - 1)
 	  {
 	    for (std::size_t k = i; k < n_rows; ++k)
-	      scale += std::abs(a[k][i]);
+	      scale += std::abs(A(k, i));
 	    if (scale)
 	      {
 		for (std::size_t k = i; k < n_rows; ++k)
 		  {
-		    a[k][i] /= scale;
-		    s += a[k][i] * a[k][i];
+		    A(k, i) /= scale;
+		    s += A(k, i) * A(k, i);
 		  }
-		f = a[i][i];
+		f = A(i, i);
 		g = -std::copysign(std::sqrt(s), f);
 		h = f * g - s;
-		a[i][i] = f - g;
+		A(i, i) = f - g;
 		for (std::size_t j = l; j < n_cols; ++j)
-		  {
-		    s = NumTp{0};
-		    for (std::size_t k = i; k < n_rows; ++k)
-		      s += a[k][i] * a[k][j];
-		    f = s / h;
-		    for (std::size_t k = i; k < n_rows; ++k)
-		      a[k][j] += f * a[k][i];
-		  }
+		  tmp[j] = _NumTp{0};
 		for (std::size_t k = i; k < n_rows; ++k)
-		  a[k][i] *= scale;
+		  for (std::size_t j = l; j < n_cols; ++j)
+		    tmp[j] += A(k, i) * A(k, j);
+		for (std::size_t j = l; j < n_cols; ++j)
+		  tmp[j] /= h;
+		for (std::size_t k = i; k < n_rows; ++k)
+		  for (std::size_t j = l; j < n_cols; ++j)
+		    A(k, j) += tmp[j] * A(k, i);
+		for (std::size_t k = i; k < n_rows; ++k)
+		  A(k, i) *= scale;
 	      }
 	  }
 	w[i] = scale * g;
-	g = s = scale = NumTp{0};
+	g = s = scale = _NumTp{0};
 	if (i <= n_rows - 1 && i != n_cols - 1)
 	  {
 	    for (std::size_t k = l; k < n_cols; ++k)
-	      scale += std::abs(a[i][k]);
+	      scale += std::abs(A(i, k));
 	    if (scale)
 	      {
 		for (std::size_t k = l; k < n_cols; ++k)
 		  {
-		    a[i][k] /= scale;
-		    s += a[i][k] * a[i][k];
+		    A(i, k) /= scale;
+		    s += A(i, k) * A(i, k);
 		  }
-		f = a[i][l];
+		f = A(i, l);
 		g = -std::copysign(std::sqrt(s), f);
 		h = f * g - s;
-		a[i][l] = f - g;
+		A(i, l) = f - g;
 		for (std::size_t k = l; k < n_cols; ++k)
-		  rv1[k] = a[i][k] / h;
+		  rv1[k] = A(i, k) / h;
 		for (std::size_t j = l; j < n_rows; ++j)
 		  {
-		    s = NumTp{0};
+		    s = _NumTp{0};
 		    for (std::size_t k = l; k < n_cols; ++k)
-		      s += a[j][k] * a[i][k];
+		      s += A(j, k) * A(i, k);
 		    for (std::size_t k = l; k < n_cols; ++k)
-		      a[j][k] += s * rv1[k];
+		      A(j, k) += s * rv1[k];
 		  }
 		for (std::size_t k = l; k < n_cols; ++k)
-		  a[i][k] *= scale;
+		  A(i, k) *= scale;
 	      }
 	  }
 	anorm = std::max(anorm, std::abs(w[i]) + std::abs(rv1[i]));
       }
 
-    //  Accumulation of right-hand decomposition V.
+    return anorm;
+  }
+
+
+/**
+ *  Accumulate the right-hand Householder transformations left in A
+ *  by __sv_bidiagonalize() into the n_cols*n_cols element accessor V
+ *  with the temporary row tmp[0..n_cols-1].
+ */
+template<typename _ElemA, typename _ElemV, typename _NumTp>
+  void
+  __sv_accumulate_v(const std::size_t n_cols, _ElemA A, _ElemV V,
+		    const _NumTp* rv1, _NumTp* tmp)
+  {
+    std::size_t l = 0;
+    _NumTp g = _NumTp{0};
     for (std::ptrdiff_t i = n_cols - 1; i >= 0; --i)
       {
 	if (i < std::ptrdiff_t(n_cols - 1))
@@ -109,53 +147,81 @@ template<typename _Matrix, typename _Vector>
 	    if (g)
 	      {
 		for (std::size_t j = l; j < n_cols; ++j)
-		  v[j][i] = (a[i][j]/a[i][l])/g;
+		  V(j, i) = (A(i, j)/A(i, l))/g;
 		for (std::size_t j = l; j < n_cols; ++j)
-		  {
-		    s = NumTp{0};
-		    for (std::size_t k = l; k < n_cols; ++k)
-		      s += a[i][k] * v[k][j];
-		    for (std::size_t k = l; k < n_cols; ++k)
-		      v[k][j] += s * v[k][i];
-		  }
+		  tmp[j] = _NumTp{0};
+		for (std::size_t k = l; k < n_cols; ++k)
+		  for (std::size_t j = l; j < n_cols; ++j)
+		    tmp[j] += A(i, k) * V(k, j);
+		for (std::size_t k = l; k < n_cols; ++k)
+		  for (std::size_t j = l; j < n_cols; ++j)
+		    V(k, j) += tmp[j] * V(k, i);
 	      }
 	    for (std::size_t j = l; j < n_cols; ++j)
-	      v[i][j] = v[j][i] = NumTp{0};
+	      V(i, j) = V(j, i) = _NumTp{0};
 	  }
-	v[i][i] = NumTp{1};
+	V(i, i) = _NumTp{1};
 	g = rv1[i];
 	l = i;
       }
+  }
 
-    //  Accumulation of left-hand decompositions.
+
+/**
+ *  Accumulate the left-hand Householder transformations left in A
+ *  by __sv_bidiagonalize() into A itself with the temporary row
+ *  tmp[0..n_cols-1].
+ */
+template<typename _ElemA, typename _Vector, typename _NumTp>
+  void
+  __sv_accumulate_u(const std::size_t n_rows, const std::size_t n_cols,
+		    _ElemA A, const _Vector& w, _NumTp* tmp)
+  {
     for (std::ptrdiff_t i = std::min(n_rows, n_cols) - 1; i >= 0; --i)
       {
-	l = i + 1;
-	g = w[i];
+	const std::size_t l = i + 1;
+	_NumTp g = w[i];
 	for (std::size_t j = l; j < n_cols; ++j)
-	  a[i][j] = NumTp{0};
+	  A(i, j) = _NumTp{0};
 	if (g)
 	  {
-	    g = NumTp{1} / g;
+	    g = _NumTp{1} / g;
 	    for (std::size_t j = l; j < n_cols; ++j)
-	      {
-		s = NumTp{0};
-		for (std::size_t k = l; k < n_rows; ++k)
-		  s += a[k][i] * a[k][j];
-		f = (s / a[i][i]) * g;
-		for (std::size_t k = i; k < n_rows; ++k)
-		  a[k][j] += f * a[k][i];
-	      }
+	      tmp[j] = _NumTp{0};
+	    for (std::size_t k = l; k < n_rows; ++k)
+	      for (std::size_t j = l; j < n_cols; ++j)
+		tmp[j] += A(k, i) * A(k, j);
+	    for (std::size_t j = l; j < n_cols; ++j)
+	      tmp[j] = (tmp[j] / A(i, i)) * g;
+	    for (std::size_t k = i; k < n_rows; ++k)
+	      for (std::size_t j = l; j < n_cols; ++j)
+		A(k, j) += tmp[j] * A(k, i);
 	    for (std::size_t j = i; j < n_rows; ++j)
-	      a[j][i] *= g;
+	      A(j, i) *= g;
 	  }
 	else
 	  for (std::size_t j = i; j < n_rows; ++j)
-	    a[j][i] = NumTp{0};
-	++a[i][i];
+	    A(j, i) = _NumTp{0};
+	++A(i, i);
       }
+  }
+
+
+/**
+ *  Diagonalize the bidiagonal form w, rv1 by implicitly shifted QR,
+ *  applying the rotations to the columns of U, held in A, if want_u
+ *  and to the columns of V if want_v.
+ */
+template<typename _ElemA, typename _Vector, typename _ElemV, typename _NumTp>
+  void
+  __sv_diagonalize(const std::size_t n_rows, const std::size_t n_cols,
+		   _ElemA A, _Vector& w, _ElemV V, _NumTp* rv1, _NumTp anorm,
+		   bool want_u, bool want_v)
+  {
+    const int ITS = 30;
+
+    _NumTp c, f, g, h, s;
 
-    //  Diagonalization of the bidiagonal form;
     for (std::ptrdiff_t k = n_cols - 1; k >= 0; --k)
       {
 	for (std::size_t its = 1; its <= ITS; ++its)
@@ -175,8 +241,8 @@ template<typename _Matrix, typename _Vector>
 	      }
 	    if (flag)
 	      {
-		auto c = NumTp{0};
-		auto s = NumTp{1};
+		auto c = _NumTp{0};
+		auto s = _NumTp{1};
 		for (std::ptrdiff_t i = l; i < k; ++i)
 		  {
 		    const auto f = s * rv1[i];
@@ -186,28 +252,30 @@ template<typename _Matrix, typename _Vector>
 		    auto g = w[i];
 		    auto h = std::hypot(f, g);
 		    w[i] = h;
-		    h = NumTp{1} / h;
+		    h = _NumTp{1} / h;
 		    c = g * h;
 		    s = -f * h;
-		    for (std::size_t j = 0; j < n_rows; ++j)
-		      {
-			auto y = a[j][nm];
-			auto z = a[j][i];
-			a[j][nm] = y * c + z * s;
-			a[j][i] = z * c - y * s;
-		      }
+		    if (want_u)
+		      for (std::size_t j = 0; j < n_rows; ++j)
+			{
+			  auto y = A(j, nm);
+			  auto z = A(j, i);
+			  A(j, nm) = y * c + z * s;
+			  A(j, i) = z * c - y * s;
+			}
 		  }
 	      }
 	    auto z = w[k];
 	    if (l == k)
 	      {
 		//  Convergence!!!
-		if (z < NumTp{0})
+		if (z < _NumTp{0})
 		  {
 		    //  Make singular value non negative.
 		    w[k] = -z;
-		    for (std::size_t j = 0; j < n_cols; ++j)
-		      v[j][k] = -v[j][k];
+		    if (want_v)
+		      for (std::size_t j = 0; j < n_cols; ++j)
+			V(j, k) = -V(j, k);
 		  }
 		break;
 	      }
@@ -225,11 +293,11 @@ template<typename _Matrix, typename _Vector>
 	    g = rv1[nm];
 	    h = rv1[k];
 	    f = ((y - z) * (y + z) + (g - h) * (g + h)) / (2 * h * y);
-	    g = std::hypot(f, NumTp{1});
+	    g = std::hypot(f, _NumTp{1});
 	    f = ((x - z) * (x + z) + h * ((y / (f + std::copysign(g, f))) - h)) / x;
 
 	    //  Next QR transformation.
-	    c = s = NumTp{1};
+	    c = s = _NumTp{1};
 	    for (std::ptrdiff_t j = l; j <= nm; ++j)
 	      {
 		auto i = j + 1;
@@ -245,42 +313,616 @@ template<typename _Matrix, typename _Vector>
 		g = g * c - x * s;
 		h = y * s;
 		y *= c;
-		for (std::size_t jj = 0; jj < n_cols; ++jj)
-		  {
-		    x = v[jj][j];
-		    z = v[jj][i];
-		    v[jj][j] = x * c + z * s;
-		    v[jj][i] = z * c - x * s;
-		  }
+		if (want_v)
+		  for (std::size_t jj = 0; jj < n_cols; ++jj)
+		    {
+		      x = V(jj, j);
+		      z = V(jj, i);
+		      V(jj, j) = x * c + z * s;
+		      V(jj, i) = z * c - x * s;
+		    }
 		z = std::hypot(f, h);
 		w[j] = z;
 		//  Rotation can be arbitrary if z = 0.
 		if (z)
 		  {
-		    z = NumTp{1} / z;
+		    z = _NumTp{1} / z;
 		    c = f * z;
 		    s = h * z;
 		  }
 		f = c * g + s * y;
 		x = c * y - s * g;
-		for (std::size_t jj = 0; jj < n_rows; ++jj)
-		  {
-		    auto y = a[jj][j];
-		    auto z = a[jj][i];
-		    a[jj][j] = y * c + z * s;
-		    a[jj][i] = z * c - y * s;
-		  }
+		if (want_u)
+		  for (std::size_t jj = 0; jj < n_rows; ++jj)
+		    {
+		      auto y = A(jj, j);
+		      auto z = A(jj, i);
+		      A(jj, j) = y * c + z * s;
+		      A(jj, i) = z * c - y * s;
+		    }
 	      }
-	    rv1[l] = NumTp{0};
+	    rv1[l] = _NumTp{0};
 	    rv1[k] = f;
 	    w[k] = x;
 	  }
       }
+  }
+
+
+/**
+ *  Compute the singular value decomposition as sv_decomp()
+ *  taking the superdiagonal of the bidiagonal form from the
+ *  caller-supplied workspace.
+ */
+template<typename _Matrix, typename _Vector>
+  void
+  sv_decomp(const std::size_t n_rows, const std::size_t n_cols,
+	    _Matrix& a, _Vector& w, _Matrix& v,
+	    workspace_span<__matrix_value_t<_Matrix>> work)
+  {
+    auto A = __elem_access(a);
+    auto V = __elem_access(v);
+
+    auto rv1 = work.take(n_cols);
+    auto tmp = work.take(n_cols);
+
+    //  Householder reduction to bidiagonal form.
+    const auto anorm = __sv_bidiagonalize(n_rows, n_cols, A, w, rv1, tmp);
+
+    //  Accumulation of right-hand decomposition V.
+    __sv_accumulate_v(n_cols, A, V, rv1, tmp);
+
+    //  Accumulation of left-hand decompositions.
+    __sv_accumulate_u(n_rows, n_cols, A, w, tmp);
+
+    //  Diagonalization of the bidiagonal form;
+    __sv_diagonalize(n_rows, n_cols, A, w, V, rv1, anorm, true, true);
 
     return;
   }
 
 
+/**
+ *  Return whether the left singular vectors U are wanted.
+ */
+constexpr bool
+__sv_want_u(sv_vectors vectors) noexcept
+{ return vectors == sv_vectors::left || vectors == sv_vectors::both; }
+
+/**
+ *  Return whether the right singular vectors V are wanted.
+ */
+constexpr bool
+__sv_want_v(sv_vectors vectors) noexcept
+{ return vectors == sv_vectors::right || vectors == sv_vectors::both; }
+
+
+/**
+ *  Normalize column j of the element accessor X with n_rows rows.
+ *  If reorthogonalize is true first remove its components along
+ *  the columns k < n_cols for which in_basis(k) holds and, should nothing
+ *  be left, replace it by the unit vector furthest from their span,
+ *  or by zero if they span everything.
+ */
+template<typename _ElemX, typename _Pred>
+  void
+  __sv_normalize_column(std::size_t n_rows, std::size_t n_cols,
+			std::size_t j, _ElemX X, bool reorthogonalize,
+			_Pred in_basis)
+  {
+    using _NumTp = std::decay_t<decltype(X(0, 0))>;
+
+    auto project_out = [=](auto&& y)
+      {
+	for (int pass = 0; pass < 2; ++pass)
+	  for (std::size_t k = 0; k < n_cols; ++k)
+	    if (k != j && in_basis(k))
+	      {
+		_NumTp s = _NumTp{0};
+		for (std::size_t i = 0; i < n_rows; ++i)
+		  s += X(i, k) * y(i);
+		for (std::size_t i = 0; i < n_rows; ++i)
+		  y(i) -= s * X(i, k);
+	      }
+      };
+    auto norm = [n_rows](auto&& y)
+      {
+	_NumTp s = _NumTp{0};
+	for (std::size_t i = 0; i < n_rows; ++i)
+	  s += y(i) * y(i);
+	return std::sqrt(s);
+      };
+    auto col = [j, X](std::size_t i) -> _NumTp& { return X(i, j); };
+
+    if (reorthogonalize)
+      {
+	project_out(col);
+	if (norm(col) < _NumTp{1} / _NumTp{4})
+	  {
+	    std::vector<_NumTp> e(n_rows), best(n_rows);
+	    _NumTp best_norm = _NumTp{0};
+	    for (std::size_t m = 0; m < n_rows; ++m)
+	      {
+		std::fill(e.begin(), e.end(), _NumTp{0});
+		e[m] = _NumTp{1};
+		auto y = [&e](std::size_t i) -> _NumTp& { return e[i]; };
+		project_out(y);
+		const auto en = norm(y);
+		if (en > best_norm)
+		  {
+		    best_norm = en;
+		    best = e;
+		  }
+		if (en > _NumTp{1} / _NumTp{2})
+		  break;
+	      }
+	    if (best_norm
+		<= std::sqrt(std::numeric_limits<_NumTp>::epsilon()))
+	      std::fill(best.begin(), best.end(), _NumTp{0});
+	    for (std::size_t i = 0; i < n_rows; ++i)
+	      X(i, j) = best[i];
+	  }
+      }
+
+    const auto s = norm(col);
+    if (s > _NumTp{0})
+      for (std::size_t i = 0; i < n_rows; ++i)
+	X(i, j) /= s;
+  }
+
+
+/**
+ *  Bring the nearly orthonormal columns of the n*n matrix x to working
+ *  orthonormality by Newton-Schulz steps x <- x.(3I - x~.x)/2 toward
+ *  the nearest orthogonal matrix.  Each step squares the departure
+ *  from orthonormality and is two matrix multiplications.
+ */
+template<typename _NumTp>
+  void
+  __sv_polish_orthonormal(std::size_t n, dense_matrix<_NumTp>& x)
+  {
+    const auto tol = _NumTp(4 * n) * std::numeric_limits<_NumTp>::epsilon();
+
+    dense_matrix<_NumTp> gram(n, n), x0(n, n);
+    for (int iter = 0; iter < 4; ++iter)
+      {
+	auto Xt = [&x](std::size_t i, std::size_t j) -> const _NumTp&
+		  { return x(j, i); };
+	__gemm(n, n, n, _NumTp{1}, Xt, __elem_access(std::as_const(x)),
+	       _NumTp{0}, __elem_access(gram));
+
+	_NumTp err = _NumTp{0};
+	for (std::size_t i = 0; i < n; ++i)
+	  for (std::size_t j = 0; j < n; ++j)
+	    {
+	      const auto delta = gram(i, j) - (i == j ? _NumTp{1} : _NumTp{0});
+	      err = std::max(err, std::abs(delta));
+	      gram(i, j) = (i == j ? _NumTp{1} : _NumTp{0}) - delta / _NumTp{2};
+	    }
+	if (err <= tol)
+	  break;
+
+	for (std::size_t i = 0; i < n; ++i)
+	  for (std::size_t j = 0; j < n; ++j)
+	    x0(i, j) = x(i, j);
+	__gemm(n, n, n, _NumTp{1}, __elem_access(std::as_const(x0)),
+	       __elem_access(std::as_const(gram)), _NumTp{0},
+	       __elem_access(x));
+      }
+  }
+
+
+/**
+ *  Compute the singular value decomposition with the algorithm alg
+ *  forming only the singular vectors asked for.
+ */
+template<typename _Matrix, typename _Vector>
+  void
+  sv_decomp(const std::size_t n_rows, const std::size_t n_cols,
+	    _Matrix& a, _Vector& w, _Matrix& v,
+	    sv_algorithm alg, sv_vectors vectors)
+  {
+    using NumTp = __matrix_value_t<_Matrix>;
+
+    switch (alg)
+      {
+      case sv_algorithm::divide_conquer:
+	sv_decomp_dc(n_rows, n_cols, a, w, v, vectors);
+	break;
+      case sv_algorithm::jacobi:
+	sv_decomp_jacobi(n_rows, n_cols, a, w, v,
+			 default_thread_pool(), vectors);
+	break;
+      case sv_algorithm::golub_reinsch:
+      default:
+	{
+	  const bool want_u = __sv_want_u(vectors);
+	  const bool want_v = __sv_want_v(vectors);
+	  auto A = __elem_access(a);
+	  auto V = __elem_access(v);
+	  std::vector<NumTp> rv1(n_cols), tmp(n_cols);
+	  const auto anorm = __sv_bidiagonalize(n_rows, n_cols, A, w,
+						rv1.data(), tmp.data());
+	  if (want_v)
+	    __sv_accumulate_v(n_cols, A, V, rv1.data(), tmp.data());
+	  if (want_u)
+	    __sv_accumulate_u(n_rows, n_cols, A, w, tmp.data());
+	  __sv_diagonalize(n_rows, n_cols, A, w, V, rv1.data(), anorm,
+			   want_u, want_v);
+	}
+	break;
+      }
+  }
+
+
+/**
+ *  Compute the singular value decomposition by divide and conquer
+ *  on the bidiagonal form.
+ */
+template<typename _Matrix, typename _Vector>
+  void
+  sv_decomp_dc(const std::size_t n_rows, const std::size_t n_cols,
+	       _Matrix& a, _Vector& w, _Matrix& v,
+	       sv_vectors vectors)
+  {
+    using NumTp = __matrix_value_t<_Matrix>;
+
+    const bool want_u = __sv_want_u(vectors);
+    const bool want_v = __sv_want_v(vectors);
+    const auto n = n_cols;
+
+    auto A = __elem_access(a);
+    auto V = __elem_access(v);
+
+    std::vector<NumTp> rv1(n), tmp(n);
+    const auto anorm = __sv_bidiagonalize(n_rows, n, A, w,
+					  rv1.data(), tmp.data());
+    if (want_v)
+      __sv_accumulate_v(n, A, V, rv1.data(), tmp.data());
+    if (want_u)
+      __sv_accumulate_u(n_rows, n, A, w, tmp.data());
+    if (n == 0 || (!want_u && !want_v))
+      {
+	//  The singular values alone come cheaper from the QR sweeps.
+	__sv_diagonalize(n_rows, n, A, w, V, rv1.data(), anorm,
+			 false, false);
+	return;
+      }
+
+    //  The Golub-Kahan matrix of the bidiagonal form B: the 2n*2n
+    //  tridiagonal with zero diagonal and off-diagonal w[0], rv1[1], w[1],
+    //  ... w[n-1] has the eigenvalues +-sigma with the eigenvectors
+    //  (v[0], u[0], v[1], u[1], ...)/sqrt(2) of B = u.sigma.v~.
+    const auto n2 = 2 * n;
+    std::vector<NumTp> td(n2), te(n2);
+    for (std::size_t i = 0; i < n; ++i)
+      {
+	te[2 * i] = w[i];
+	if (i + 1 < n)
+	  te[2 * i + 1] = rv1[i + 1];
+      }
+    dense_matrix<NumTp> x(n2, n2);
+    __tridiag_dc(n2, td.data(), te.data(), x.data(), x.leading_dim());
+    __tridiag_eigen_sort(n2, td, n2, __elem_access(x), true);
+
+    //  Split the eigenvectors of the positive eigenvalues, largest first.
+    dense_matrix<NumTp> ub(n, n), vb(n, n);
+    auto Ub = __elem_access(ub);
+    auto Vb = __elem_access(vb);
+    for (std::size_t j = 0; j < n; ++j)
+      {
+	const auto col = n2 - 1 - j;
+	w[j] = std::max(td[col], NumTp{0});
+	for (std::size_t i = 0; i < n; ++i)
+	  {
+	    Vb(i, j) = x(2 * i, col);
+	    Ub(i, j) = x(2 * i + 1, col);
+	  }
+      }
+
+    //  The halves of the eigenvectors of a cluster of tiny singular
+    //  values, where +sigma and -sigma mix, need not be orthogonal:
+    //  orthonormalize them against the vectors before them.
+    const auto tiny = NumTp(n2) * std::numeric_limits<NumTp>::epsilon()
+		    * std::max(anorm, td[n2 - 1]);
+    auto before = [](std::size_t j)
+		  { return [j](std::size_t k) { return k < j; }; };
+    for (std::size_t j = 0; j < n; ++j)
+      {
+	__sv_normalize_column(n, n, j, Ub, w[j] <= tiny, before(j));
+	__sv_normalize_column(n, n, j, Vb, w[j] <= tiny, before(j));
+      }
+
+    //  Within clusters the halves mix differently; polish them.
+    __sv_polish_orthonormal(n, ub);
+    __sv_polish_orthonormal(n, vb);
+
+    //  Apply the singular vectors of B to the accumulated transformations.
+    if (want_u)
+      {
+	dense_matrix<NumTp> u0(n_rows, n);
+	for (std::size_t i = 0; i < n_rows; ++i)
+	  for (std::size_t j = 0; j < n; ++j)
+	    u0(i, j) = A(i, j);
+	__gemm(n_rows, n, n, NumTp{1}, __elem_access(std::as_const(u0)),
+	       __elem_access(std::as_const(ub)), NumTp{0}, A);
+      }
+    if (want_v)
+      {
+	dense_matrix<NumTp> v0(n, n);
+	for (std::size_t i = 0; i < n; ++i)
+	  for (std::size_t j = 0; j < n; ++j)
+	    v0(i, j) = V(i, j);
+	__gemm(n, n, n, NumTp{1}, __elem_access(std::as_const(v0)),
+	       __elem_access(std::as_const(vb)), NumTp{0}, V);
+      }
+  }
+
+
+/**
+ *  Compute the singular value decomposition by one-sided Jacobi
+ *  with the sweeps' disjoint column pairs rotated on the pool.
+ */
+template<typename _Matrix, typename _Vector>
+  void
+  sv_decomp_jacobi(const std::size_t n_rows, const std::size_t n_cols,
+		   _Matrix& a, _Vector& w, _Matrix& v,
+		   thread_pool& pool, sv_vectors vectors)
+  {
+    using NumTp = __matrix_value_t<_Matrix>;
+
+    const int SWEEPS = 60;
+
+    const bool want_u = __sv_want_u(vectors);
+    const bool want_v = __sv_want_v(vectors);
+    const auto m = n_rows;
+    const auto n = n_cols;
+    const auto tol = std::sqrt(NumTp(m))
+		   * std::numeric_limits<NumTp>::epsilon();
+
+    auto A = __elem_access(a);
+    auto V = __elem_access(v);
+
+    //  Work on the transpose so that the columns rotated are contiguous.
+    dense_matrix<NumTp> g(n, m);
+    for (std::size_t i = 0; i < m; ++i)
+      for (std::size_t j = 0; j < n; ++j)
+	g(j, i) = A(i, j);
+    dense_matrix<NumTp> vt(want_v ? n : 0, want_v ? n : 0);
+    for (std::size_t j = 0; want_v && j < n; ++j)
+      vt(j, j) = NumTp{1};
+
+    //  With more columns than rows all but n_rows of them must go to zero
+    //  and can only get down to roundoff: stop rotating those.
+    NumTp negligible = NumTp{0};
+    if (n > m)
+      {
+	for (std::size_t j = 0; j < n; ++j)
+	  for (std::size_t k = 0; k < m; ++k)
+	    negligible += g(j, k) * g(j, k);
+	negligible *= std::numeric_limits<NumTp>::epsilon()
+		    * std::numeric_limits<NumTp>::epsilon();
+      }
+
+    //  Orthogonalize columns p and q; return false if they already are.
+    auto rotate = [&](std::size_t p, std::size_t q)
+      {
+	auto gp = g[p];
+	auto gq = g[q];
+	NumTp alpha = NumTp{0}, beta = NumTp{0}, gamma = NumTp{0};
+	for (std::size_t k = 0; k < m; ++k)
+	  {
+	    alpha += gp[k] * gp[k];
+	    beta += gq[k] * gq[k];
+	    gamma += gp[k] * gq[k];
+	  }
+	if (std::abs(gamma) <= tol * std::sqrt(alpha) * std::sqrt(beta)
+	    || std::min(alpha, beta) <= negligible)
+	  return false;
+	const auto zeta = (beta - alpha) / (NumTp{2} * gamma);
+	const auto t = std::copysign(NumTp{1}, zeta)
+		     / (std::abs(zeta) + std::hypot(NumTp{1}, zeta));
+	const auto c = NumTp{1} / std::sqrt(NumTp{1} + t * t);
+	const auto s = c * t;
+	for (std::size_t k = 0; k < m; ++k)
+	  {
+	    const auto x = gp[k];
+	    const auto y = gq[k];
+	    gp[k] = c * x - s * y;
+	    gq[k] = s * x + c * y;
+	  }
+	if (want_v)
+	  {
+	    auto vp = vt[p];
+	    auto vq = vt[q];
+	    for (std::size_t k = 0; k < n; ++k)
+	      {
+		const auto x = vp[k];
+		const auto y = vq[k];
+		vp[k] = c * x - s * y;
+		vq[k] = s * x + c * y;
+	      }
+	  }
+	return true;
+      };
+
+    //  A sweep is n_players - 1 rounds of the round-robin tournament,
+    //  each pairing every column with one other (or with the bye).
+    const auto n_players = n + n % 2;
+    const auto n_pairs = n_players / 2;
+    const auto n_tasks = std::max<std::size_t>(1,
+				std::min(n_pairs, pool.size() + 1));
+    std::vector<char> rotated(n_tasks);
+
+    bool converged = (n < 2);
+    for (int sweep = 0; sweep < SWEEPS && !converged; ++sweep)
+      {
+	converged = true;
+	for (std::size_t r = 0; r + 1 < n_players; ++r)
+	  {
+	    auto player = [n_players, r](std::size_t k) -> std::size_t
+	      { return k == 0 ? 0 : (k - 1 + r) % (n_players - 1) + 1; };
+	    auto chunk = [&](std::size_t t)
+	      {
+		bool any = false;
+		const auto i_begin = t * n_pairs / n_tasks;
+		const auto i_end = (t + 1) * n_pairs / n_tasks;
+		for (std::size_t i = i_begin; i < i_end; ++i)
+		  {
+		    const auto p = player(i);
+		    const auto q = player(n_players - 1 - i);
+		    if (p < n && q < n)
+		      any |= rotate(std::min(p, q), std::max(p, q));
+		  }
+		rotated[t] = any;
+	      };
+
+	    {
+	      task_group pairs(pool);
+	      for (std::size_t t = 1; t < n_tasks; ++t)
+		pairs.run([&chunk, t]{ chunk(t); });
+	      chunk(0);
+	      pairs.wait();
+	    }
+	    for (auto any : rotated)
+	      if (any)
+		converged = false;
+	  }
+      }
+    if (!converged)
+      {
+	std::ostringstream msg;
+	msg << "No convergence in " << SWEEPS << " sv_decomp_jacobi sweeps.";
+	std::__throw_logic_error(msg.str().c_str());
+      }
+
+    //  The column norms are the singular values.
+    std::vector<char> in_basis(n);
+    for (std::size_t j = 0; j < n; ++j)
+      {
+	auto gj = g[j];
+	NumTp s = NumTp{0};
+	for (std::size_t k = 0; k < m; ++k)
+	  s += gj[k] * gj[k];
+	s = std::sqrt(s);
+	w[j] = s;
+	in_basis[j] = s > NumTp{0};
+	if (want_u)
+	  for (std::size_t i = 0; i < m; ++i)
+	    A(i, j) = s > NumTp{0} ? gj[i] / s : NumTp{0};
+      }
+
+    //  Complete U with vectors orthogonal to those of the nonzero
+    //  singular values as far as the rows allow.
+    for (std::size_t j = 0; want_u && j < n; ++j)
+      if (!in_basis[j])
+	{
+	  __sv_normalize_column(m, n, j, A, true,
+				[&in_basis](std::size_t k)
+				{ return in_basis[k] != 0; });
+	  in_basis[j] = 1;
+	}
+    if (want_v)
+      for (std::size_t i = 0; i < n; ++i)
+	for (std::size_t j = 0; j < n; ++j)
+	  V(i, j) = vt(j, i);
+  }
+
+
+/**
+ *  Compute the leading rank singular triplets of a by a randomized
+ *  range finder and the SVD of the projected matrix.
+ */
+template<typename _MatrixA, typename _Matrix, typename _Vector>
+  void
+  sv_decomp_randomized(std::size_t n_rows, std::size_t n_cols,
+		       const _MatrixA& a, std::size_t rank,
+		       _Matrix& u, _Vector& w, _Matrix& v,
+		       std::size_t oversample, std::size_t power_iters,
+		       std::uint_fast64_t seed)
+  {
+    using NumTp = __matrix_value_t<_Matrix>;
+
+    const auto l = std::min({rank + oversample, n_rows, n_cols});
+    rank = std::min(rank, l);
+    if (rank == 0)
+      return;
+
+    auto A = __elem_access(a);
+    auto At = [A](std::size_t i, std::size_t j) -> decltype(auto)
+	      { return A(j, i); };
+    auto cacc = [](const dense_matrix<NumTp>& x)
+		{ return __elem_access(x); };
+
+    //  The Gaussian test matrix.
+    std::mt19937_64 gen(seed);
+    std::normal_distribution<NumTp> normal;
+    dense_matrix<NumTp> omega(n_cols, l);
+    for (std::size_t i = 0; i < n_cols; ++i)
+      for (std::size_t j = 0; j < l; ++j)
+	omega(i, j) = normal(gen);
+
+    std::vector<NumTp> c(l), d(l);
+    bool singular;
+
+    //  Replace the columns of x by an orthonormal basis of their span.
+    auto orthonormalize = [&](dense_matrix<NumTp>& x)
+      {
+	const auto rows = x.rows();
+	__qr_decomp_blocked(__elem_access(x), rows, l, c, d, singular, 32);
+	dense_matrix<NumTp> q(rows, l);
+	__qr_form_q(__elem_access(x), rows, l, c, __elem_access(q));
+	x = std::move(q);
+      };
+
+    //  The range of a sampled, then sharpened by power iterations.
+    dense_matrix<NumTp> q(n_rows, l), z(n_cols, l);
+    __gemm(n_rows, l, n_cols, NumTp{1}, A, cacc(omega),
+	   NumTp{0}, __elem_access(q));
+    orthonormalize(q);
+    for (std::size_t it = 0; it < power_iters; ++it)
+      {
+	__gemm(n_cols, l, n_rows, NumTp{1}, At, cacc(q),
+	       NumTp{0}, __elem_access(z));
+	orthonormalize(z);
+	__gemm(n_rows, l, n_cols, NumTp{1}, A, cacc(z),
+	       NumTp{0}, __elem_access(q));
+	orthonormalize(q);
+      }
+
+    //  The projected matrix B = Q~.a, held transposed as Q2.R.
+    __gemm(n_cols, l, n_rows, NumTp{1}, At, cacc(q),
+	   NumTp{0}, __elem_access(z));
+    __qr_decomp_blocked(__elem_access(z), n_cols, l, c, d, singular, 32);
+    dense_matrix<NumTp> r(l, l), vr(l, l), q2(n_cols, l);
+    for (std::size_t i = 0; i < l; ++i)
+      for (std::size_t j = i; j < l; ++j)
+	r(i, j) = i == j ? d[i] : z(i, j);
+    __qr_form_q(__elem_access(z), n_cols, l, c, __elem_access(q2));
+
+    //  R = Ur.diag(sigma).Vr~ so that a = (Q.Vr).diag(sigma).(Q2.Ur)~.
+    std::vector<NumTp> sigma(l);
+    sv_decomp(l, l, r, sigma, vr);
+
+    std::vector<std::size_t> order(l);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+		     [&sigma](std::size_t i, std::size_t j)
+		     { return sigma[i] > sigma[j]; });
+
+    __gemm(n_rows, rank, l, NumTp{1}, cacc(q),
+	   [&vr, &order](std::size_t i, std::size_t j) -> const NumTp&
+	   { return vr(i, order[j]); },
+	   NumTp{0}, __elem_access(u));
+    __gemm(n_cols, rank, l, NumTp{1}, cacc(q2),
+	   [&r, &order](std::size_t i, std::size_t j) -> const NumTp&
+	   { return r(i, order[j]); },
+	   NumTp{0}, __elem_access(v));
+    for (std::size_t j = 0; j < rank; ++j)
+      w[j] = sigma[order[j]];
+  }
+
+
 /**
  *  
  */
@@ -291,30 +933,79 @@ template<typename _Matrix, typename _Vector>
 	     const _Vector& w, const _Matrix& v,
 	     const _Vector& b, _Vector& x)
   {
-    using NumTp = std::remove_reference_t<decltype(u[0][0])>;
+    using NumTp = __matrix_value_t<_Matrix>;
 
-    std::vector<NumTp> tmp(n_cols);
+    std::vector<NumTp> work(sv_backsub_workspace_size(n_rows, n_cols));
+    sv_backsub(n_rows, n_cols, u, w, v, b, x, workspace_span<NumTp>(work));
+  }
 
-    for (std::size_t j = 0; j < n_cols; ++j)
+
+/**
+ *  Form x = V.diag(1/w).U~.b from the leading rank singular triplets
+ *  with the temporary vector tmp[0..rank-1].
+ *  Zero singular values are skipped.
+ */
+template<typename _Matrix, typename _VectorW, typename _VectorB,
+	 typename _VectorX, typename _NumTp>
+  void
+  __sv_backsub(std::size_t n_rows, std::size_t n_cols, std::size_t rank,
+	       const _Matrix& u, const _VectorW& w, const _Matrix& v,
+	       const _VectorB& b, _VectorX& x, _NumTp* tmp)
+  {
+    auto U = __elem_access(u);
+    auto V = __elem_access(v);
+
+    for (std::size_t j = 0; j < rank; ++j)
       {
-	NumTp s = NumTp{0};
-	if (w[j] != NumTp{0})
+	_NumTp s = _NumTp{0};
+	if (w[j] != _NumTp{0})
 	  {
 	    for (std::size_t i = 0; i < n_rows; ++i)
-	      s += u[i][j] * b[i];
+	      s += U(i, j) * b[i];
 	    s /= w[j];
 	  }
 	tmp[j] = s;
       }
     for (std::size_t j = 0; j < n_cols; ++j)
       {
-	NumTp s = NumTp{0};
-	for (std::size_t jj = 0; jj < n_cols; ++jj)
-	  s += v[j][jj] * tmp[jj];
+	_NumTp s = _NumTp{0};
+	for (std::size_t jj = 0; jj < rank; ++jj)
+	  s += V(j, jj) * tmp[jj];
 	x[j] = s;
       }
+  }
 
-    return;
+
+/**
+ *  Solve A.x = b from the singular value decomposition as sv_backsub()
+ *  taking the temporary vector from the caller-supplied workspace.
+ */
+template<typename _Matrix, typename _Vector>
+  void
+  sv_backsub(std::size_t n_rows, std::size_t n_cols,
+	     const _Matrix& u,
+	     const _Vector& w, const _Matrix& v,
+	     const _Vector& b, _Vector& x,
+	     workspace_span<__matrix_value_t<_Matrix>> work)
+  {
+    __sv_backsub(n_rows, n_cols, n_cols, u, w, v, b, x, work.take(n_cols));
+  }
+
+
+/**
+ *  Solve A.x = b from the leading rank singular triplets.
+ */
+template<typename _Matrix, typename _Vector>
+  void
+  sv_backsub(std::size_t n_rows, std::size_t n_cols, std::size_t rank,
+	     const _Matrix& u,
+	     const _Vector& w, const _Matrix& v,
+	     const _Vector& b, _Vector& x)
+  {
+    using NumTp = __matrix_value_t<_Matrix>;
+
+    std::vector<NumTp> tmp(rank);
+    __sv_backsub(n_rows, n_cols, rank, u, w, v, b, x, tmp.data());
   }
 
 
@@ -325,17 +1016,35 @@ template<typename _Matrix, typename _Vector>
  *  right-hand side _Vector are input along with the solution vector x.
  *  The solution vector x is improved and modified on output.
  */
-template<typename _Matrix, typename _Vector>
+template<typename _MatrixA, typename _Matrix, typename _Vector>
   void
   sv_improve(std::size_t n_rows, std::size_t n_cols,
-	     const _Matrix& a, const _Matrix& u,
+	     const _MatrixA& a, const _Matrix& u,
 	     const _Vector& w, const _Matrix& v,
 	     const _Vector& b, _Vector& x)
   {
-    using NumTp = std::remove_reference_t<decltype(a[0][0])>;
+    using NumTp = __matrix_value_t<_Matrix>;
 
-    std::vector<NumTp> r(n_rows);
-    std::vector<NumTp> dx(n_cols);
+    std::vector<NumTp> work(sv_improve_workspace_size(n_rows, n_cols));
+    sv_improve(n_rows, n_cols, a, u, w, v, b, x, workspace_span<NumTp>(work));
+  }
+
+
+/**
+ *  Improve a solution vector x of the linear set A.x = b as sv_improve()
+ *  taking the residual and the correction from the caller-supplied
+ *  workspace.
+ */
+template<typename _MatrixA, typename _Matrix, typename _Vector>
+  void
+  sv_improve(std::size_t n_rows, std::size_t n_cols,
+	     const _MatrixA& a, const _Matrix& u,
+	     const _Vector& w, const _Matrix& v,
+	     const _Vector& b, _Vector& x,
+	     workspace_span<__matrix_value_t<_Matrix>> work)
+  {
+    auto r = work.take(n_rows);
+    auto dx = work.take(n_cols);
 
     for (std::size_t i = 0; i < n_rows; ++i)
       {
@@ -344,7 +1053,7 @@ template<typename _Matrix, typename _Vector>
 	  r[i] += a[i][j] * x[j];
       }
 
-    sv_backsub(n_rows, n_cols, u, w, v, r, dx);
+    __sv_backsub(n_rows, n_cols, n_cols, u, w, v, r, dx, work.take(n_cols));
 
     for (std::size_t i = 0; i < n_cols; ++i)
       x[i] -= dx[i];
@@ -352,6 +1061,90 @@ template<typename _Matrix, typename _Vector>
     return;
   }
 
+
+template<typename NumTp, typename _Matrix, typename _Storage>
+  template<typename _Matrix2>
+    sv_decomposition<NumTp, _Matrix, _Storage>::
+    sv_decomposition(std::size_t n_rows, std::size_t n_cols,
+		     const _Matrix2& a, sv_algorithm alg)
+    : m_n_rows(n_rows), m_n_cols(n_cols),
+      m_a(__make_storage<_Storage>(n_rows, n_cols, a)),
+      m_w(n_cols), m_v(n_cols, n_cols)
+    {
+      if (alg == sv_algorithm::golub_reinsch)
+	sv_decomp(m_n_rows, m_n_cols, m_a, m_w, m_v);
+      else
+	sv_decomp(m_n_rows, m_n_cols, m_a, m_w, m_v, alg);
+    }
+
+template<typename NumTp, typename _Matrix, typename _Storage>
+  template<typename _Matrix2>
+    sv_decomposition<NumTp, _Matrix, _Storage>::
+    sv_decomposition(std::size_t n_rows, std::size_t n_cols,
+		     const _Matrix2& a, thread_pool& pool)
+    : m_n_rows(n_rows), m_n_cols(n_cols),
+      m_a(__make_storage<_Storage>(n_rows, n_cols, a)),
+      m_w(n_cols), m_v(n_cols, n_cols)
+    {
+      sv_decomp_jacobi(m_n_rows, m_n_cols, m_a, m_w, m_v, pool);
+    }
+
+template<typename NumTp, typename _Matrix, typename _Storage>
+  template<typename _Vector2, typename _VectorOut>
+    void
+    sv_decomposition<NumTp, _Matrix, _Storage>::
+    backsubstitution(const _Vector2& b, _VectorOut& x) const
+    {
+      std::vector<value_type> bb(m_n_rows), xx(m_n_cols);
+      for (std::size_t i = 0; i < m_n_rows; ++i)
+	bb[i] = b[i];
+      sv_backsub(m_n_rows, m_n_cols, m_a, m_w, m_v, bb, xx);
+      for (std::size_t i = 0; i < m_n_cols; ++i)
+	x[i] = xx[i];
+    }
+
+template<typename NumTp, typename _Matrix, typename _Storage>
+  template<typename _InVecIter, typename _OutVecIter>
+    void
+    sv_decomposition<NumTp, _Matrix, _Storage>::
+    backsubstitution(_InVecIter b_begin, _InVecIter b_end,
+		     _OutVecIter x_begin) const
+    {
+      std::vector<value_type> bb(b_begin, b_end), xx(m_n_cols);
+      sv_backsub(m_n_rows, m_n_cols, m_a, m_w, m_v, bb, xx);
+      std::copy(xx.begin(), xx.end(), x_begin);
+    }
+
+template<typename NumTp, typename _Matrix, typename _Storage>
+  template<typename _Matrix2, typename _Vector2, typename _VectorOut>
+    void
+    sv_decomposition<NumTp, _Matrix, _Storage>::
+    improve(const _Matrix2& a_orig, const _Vector2& b, _VectorOut& x) const
+    {
+      std::vector<value_type> bb(m_n_rows), xx(m_n_cols);
+      for (std::size_t i = 0; i < m_n_rows; ++i)
+	bb[i] = b[i];
+      for (std::size_t i = 0; i < m_n_cols; ++i)
+	xx[i] = x[i];
+      sv_improve(m_n_rows, m_n_cols, a_orig, m_a, m_w, m_v, bb, xx);
+      for (std::size_t i = 0; i < m_n_cols; ++i)
+	x[i] = xx[i];
+    }
+
+template<typename NumTp, typename _Matrix, typename _Storage>
+  template<typename _Matrix2, typename InVecIter, typename OutVecIter>
+    void
+    sv_decomposition<NumTp, _Matrix, _Storage>::
+    improve(const _Matrix2& a_orig,
+	    InVecIter b_begin, InVecIter b_end,
+	    OutVecIter x_begin) const
+    {
+      std::vector<value_type> bb(b_begin, b_end);
+      std::vector<value_type> xx(x_begin, x_begin + m_n_cols);
+      sv_improve(m_n_rows, m_n_cols, a_orig, m_a, m_w, m_v, bb, xx);
+      std::copy(xx.begin(), xx.end(), x_begin);
+    }
+
 } // namespace matrix
 
 #endif // MATRIX_SV_DECOMP_TCC
@@ -0,0 +1,136 @@
+#ifndef MATRIX_SYM_EIGEN_H
+#define MATRIX_SYM_EIGEN_H 1
+
+#include <vector>
+
+#include "matrix_dense.h"
+#include "matrix_layout.h"
+#include "matrix_thread_pool.h"
+#include "matrix_tridiag_eigen.h"
+
+namespace matrix
+{
+
+/**
+ * The algorithms available for the eigensystem of the tridiagonal matrix
+ * a symmetric matrix is reduced to.
+ */
+enum class sym_eigen_algorithm
+{
+  /// Implicit QL with Wilkinson shifts.
+  ql,
+  /// Cuppen's divide and conquer; the fastest for large matrices
+  /// when the eigenvectors are wanted.
+  divide_conquer
+};
+
+/**
+ * This class represents the eigen-decomposition A = Z.diag(w).Z~
+ * of a symmetric matrix.
+ * The eigenvectors are held in a matrix of type _Storage,
+ * by default an aligned, contiguous dense_matrix.
+ */
+template<typename _SymmetricMatrix,
+	 typename _Storage = dense_matrix<__matrix_value_t<_SymmetricMatrix>>>
+  class sym_eigen_decomposition
+  {
+
+  public:
+
+    using value_type = __matrix_value_t<_SymmetricMatrix>;
+
+    template<typename _SymmetricMatrix2>
+      sym_eigen_decomposition(std::size_t n, const _SymmetricMatrix2& a,
+			      sym_eigen_algorithm alg
+				  = sym_eigen_algorithm::ql);
+
+    template<typename _SymmetricMatrix2>
+      sym_eigen_decomposition(std::size_t n, const _SymmetricMatrix2& a,
+			      sym_eigen_algorithm alg, thread_pool& pool);
+
+    /// The eigenvalues in ascending order.
+    const std::vector<value_type>&
+    eigenvalues() const
+    { return m_w; }
+
+    /// The eigenvectors, column j belonging to eigenvalue j.
+    const _Storage&
+    eigenvectors() const
+    { return m_z; }
+
+    template<typename _Vector2, typename _VectorOut>
+      void
+      backsubstitution(const _Vector2& b, _VectorOut& x) const;
+
+    template<typename _InVecIter, typename _OutVecIter>
+      void
+      backsubstitution(_InVecIter b_begin, _InVecIter b_end,
+		       _OutVecIter x_begin) const;
+
+  private:
+
+    std::size_t m_n;
+
+    _Storage m_z;
+
+    std::vector<value_type> m_w;
+  };
+
+/**
+ * Reduce the symmetric matrix a[0..n-1][0..n-1] to tridiagonal form
+ * T = Q~.A.Q by n - 2 Householder reflections.  Only the lower triangle
+ * of a is read.  The diagonal of T is returned in d[0..n-1] and the
+ * off-diagonal in e[0..n-2], e[i] coupling rows i and i+1, as
+ * tridiag_eigen_ql() takes them.  If want_vectors is true a is replaced
+ * by Q, otherwise its contents are destroyed.
+ * The symmetric matrix-vector product and the rank-two update of each step,
+ * and the accumulation of Q, are split into row or column ranges
+ * that run as tasks on pool.
+ */
+template<typename _SymmetricMatrix, typename _VectorD, typename _VectorE>
+  void
+  sym_tridiagonalize(std::size_t n, _SymmetricMatrix& a,
+		     _VectorD& d, _VectorE& e, bool want_vectors = true,
+		     thread_pool& pool = default_thread_pool());
+
+/**
+ * Compute the eigenvalues and eigenvectors of the symmetric matrix
+ * a[0..n-1][0..n-1] by Householder tridiagonalization followed by
+ * the tridiagonal eigensolver alg.  Only the lower triangle of a is read.
+ * The eigenvalues are returned in w[0..n-1] in ascending order and
+ * a is replaced by the eigenvectors, column j belonging to w[j].
+ * Throw std::logic_error if an eigenvalue fails to converge.
+ */
+template<typename _SymmetricMatrix, typename _Vector>
+  void
+  sym_eigen(std::size_t n, _SymmetricMatrix& a, _Vector& w,
+	    sym_eigen_algorithm alg = sym_eigen_algorithm::ql,
+	    thread_pool& pool = default_thread_pool());
+
+/**
+ * Compute the eigenvalues alone of the symmetric matrix a[0..n-1][0..n-1]
+ * in ascending order into w[0..n-1].  Q is not formed and the QL
+ * iteration does not apply its rotations so the work after
+ * the reduction is O(n^2).  The contents of a are destroyed.
+ */
+template<typename _SymmetricMatrix, typename _Vector>
+  void
+  sym_eigenvalues(std::size_t n, _SymmetricMatrix& a, _Vector& w,
+		  thread_pool& pool = default_thread_pool());
+
+/**
+ * Solve A.x = b given the eigen-decomposition of A from sym_eigen():
+ * x = Z.diag(1/w).Z~.b.  Eigenvalues of magnitude below n eps max|w|
+ * are treated as zero so that x is the least squares solution of
+ * least norm for a singular A.
+ */
+template<typename _Matrix, typename _Vector>
+  void
+  sym_eigen_backsub(std::size_t n, const _Matrix& z, const _Vector& w,
+		    const _Vector& b, _Vector& x);
+
+} // namespace matrix
+
+#include "matrix_sym_eigen.tcc"
+
+#endif // MATRIX_SYM_EIGEN_H
@@ -0,0 +1,408 @@
+#ifndef MATRIX_SYM_EIGEN_TCC
+#define MATRIX_SYM_EIGEN_TCC 1
+
+
+#include <cstdlib>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "matrix_dense.h"
+#include "matrix_layout.h"
+#include "matrix_thread_pool.h"
+#include "matrix_tridiag_eigen.h"
+
+
+namespace matrix
+{
+
+
+/**
+ * Call func(i0, i1) on consecutive ranges covering [0, n) with one range
+ * for the calling thread and one for each worker of pool, but none shorter
+ * than grain.  The ranges after the first run as tasks on pool.
+ */
+template<typename _Func>
+  void
+  __sym_eigen_split(thread_pool& pool, std::size_t n, std::size_t grain,
+		    _Func func)
+  {
+    const auto n_tasks = std::max<std::size_t>(1,
+				std::min(n / grain, pool.size() + 1));
+    if (n_tasks == 1)
+      {
+	func(std::size_t{0}, n);
+	return;
+      }
+    task_group ranges(pool);
+    for (std::size_t t = 1; t < n_tasks; ++t)
+      ranges.run([&func, t, n, n_tasks]()
+		 { func(t * n / n_tasks, (t + 1) * n / n_tasks); });
+    func(std::size_t{0}, n / n_tasks);
+    ranges.wait();
+  }
+
+
+/**
+ * Reduce the full symmetric n*n matrix h to tridiagonal form in place.
+ * Reflection k, I - tau[k] v.v~ with v[0] = 1, annihilates row and column k
+ * beyond the subdiagonal; v is left in h[k][k+1..n-1] and tau[k] in tau.
+ * The trailing block is kept in full so that every pass over it runs along
+ * contiguous rows, and the rank-two update of each step is applied in
+ * the same pass as the product of the next step's v with the block,
+ * each row being updated and then multiplied while it is in cache.
+ * Only the row the next reflection is taken from is updated ahead.
+ */
+template<typename _Tp>
+  void
+  __sym_tridiag_reduce(std::size_t n, dense_matrix<_Tp>& h,
+		       _Tp* d, _Tp* e, _Tp* tau, thread_pool& pool)
+  {
+    const std::size_t GRAIN = 64;
+
+    std::vector<_Tp> p(n), w(n);
+
+    //  The update A -= v w~ + w v~ of the previous step, if any, is still
+    //  to be applied to the rows and columns from k on; vp[0] and w[0]
+    //  belong to index k.
+    const _Tp* vp = nullptr;
+    auto update = [&vp, &w, &h, n](std::size_t k, std::size_t r,
+				   std::size_t j0)
+      {
+	auto hr = h[r];
+	const auto vr = vp[r - k];
+	const auto wr = w[r - k];
+	for (std::size_t j = j0; j < n; ++j)
+	  hr[j] -= vr * w[j - k] + wr * vp[j - k];
+      };
+
+    for (std::size_t k = 0; k + 2 < n; ++k)
+      {
+	if (vp)
+	  update(k, k, k);
+
+	auto v = h[k] + k + 1;
+	const auto m = n - k - 1;
+
+	d[k] = h(k, k);
+	tau[k] = _Tp{0};
+	e[k] = v[0];
+
+	_Tp xnorm = _Tp{0};
+	for (std::size_t j = 1; j < m; ++j)
+	  xnorm += v[j] * v[j];
+	if (xnorm != _Tp{0})
+	  {
+	    xnorm = std::sqrt(xnorm);
+	    const auto alpha = v[0];
+	    const auto beta = -std::copysign(std::hypot(alpha, xnorm), alpha);
+	    tau[k] = (beta - alpha) / beta;
+	    const auto scale = _Tp{1} / (alpha - beta);
+	    v[0] = _Tp{1};
+	    for (std::size_t j = 1; j < m; ++j)
+	      v[j] *= scale;
+	    e[k] = beta;
+	  }
+
+	//  Finish the previous update of A22 and form p = tau A22 v.
+	const auto t = tau[k];
+	if (!vp && t == _Tp{0})
+	  continue;
+	__sym_eigen_split(pool, m, GRAIN,
+	  [&h, &p, &update, v, k, m, t, pending = (vp != nullptr)]
+	  (std::size_t i0, std::size_t i1)
+	  {
+	    for (std::size_t i = i0; i < i1; ++i)
+	      {
+		if (pending)
+		  update(k, k + 1 + i, k + 1);
+		if (t != _Tp{0})
+		  {
+		    const auto hi = h[k + 1 + i] + k + 1;
+		    _Tp s = _Tp{0};
+		    for (std::size_t j = 0; j < m; ++j)
+		      s += hi[j] * v[j];
+		    p[i] = t * s;
+		  }
+	      }
+	  });
+
+	if (t == _Tp{0})
+	  {
+	    vp = nullptr;
+	    continue;
+	  }
+
+	//  w = p - (tau p~.v / 2) v
+	_Tp pv = _Tp{0};
+	for (std::size_t i = 0; i < m; ++i)
+	  pv += p[i] * v[i];
+	const auto K = t * pv / _Tp{2};
+	for (std::size_t i = 0; i < m; ++i)
+	  w[i] = p[i] - K * v[i];
+	vp = v;
+      }
+
+    if (n >= 2)
+      {
+	if (vp)
+	  {
+	    update(n - 2, n - 2, n - 2);
+	    update(n - 2, n - 1, n - 2);
+	  }
+	d[n - 2] = h(n - 2, n - 2);
+	e[n - 2] = h(n - 1, n - 2);
+      }
+    if (n >= 1)
+      d[n - 1] = h(n - 1, n - 1);
+  }
+
+
+/**
+ * Accumulate Q = H[0].H[1]...H[n-3] from the reflections
+ * __sym_tridiag_reduce() left in h into the n*n matrix q, backwards
+ * so that each reflection touches only the trailing block it acts on.
+ * The columns of the block are split among the tasks.
+ */
+template<typename _Tp>
+  void
+  __sym_tridiag_form_q(std::size_t n, const dense_matrix<_Tp>& h,
+		       const _Tp* tau, dense_matrix<_Tp>& q,
+		       thread_pool& pool)
+  {
+    const std::size_t GRAIN = 64;
+
+    for (std::size_t i = 0; i < n; ++i)
+      for (std::size_t j = 0; j < n; ++j)
+	q(i, j) = (i == j ? _Tp{1} : _Tp{0});
+
+    for (std::size_t k = n < 3 ? 0 : n - 2; k-- > 0; )
+      {
+	if (tau[k] == _Tp{0})
+	  continue;
+	const auto v = h[k] + k + 1;
+	const auto m = n - k - 1;
+	__sym_eigen_split(pool, m, GRAIN,
+	  [&q, v, k, m, t = tau[k]](std::size_t j0, std::size_t j1)
+	  {
+	    std::vector<_Tp> s(j1 - j0);
+	    for (std::size_t i = 0; i < m; ++i)
+	      {
+		const auto qi = q[k + 1 + i] + k + 1;
+		for (std::size_t j = j0; j < j1; ++j)
+		  s[j - j0] += v[i] * qi[j];
+	      }
+	    for (std::size_t i = 0; i < m; ++i)
+	      {
+		auto qi = q[k + 1 + i] + k + 1;
+		const auto tvi = t * v[i];
+		for (std::size_t j = j0; j < j1; ++j)
+		  qi[j] -= tvi * s[j - j0];
+	      }
+	  });
+      }
+  }
+
+
+/**
+ * Copy the lower triangle of a into the full symmetric matrix h.
+ */
+template<typename _Tp, typename _SymmetricMatrix>
+  void
+  __sym_eigen_load(std::size_t n, const _SymmetricMatrix& a,
+		   dense_matrix<_Tp>& h)
+  {
+    auto A = __elem_access(a);
+    for (std::size_t i = 0; i < n; ++i)
+      for (std::size_t j = 0; j <= i; ++j)
+	h(i, j) = h(j, i) = A(i, j);
+  }
+
+
+template<typename _SymmetricMatrix, typename _VectorD, typename _VectorE>
+  void
+  sym_tridiagonalize(std::size_t n, _SymmetricMatrix& a,
+		     _VectorD& d, _VectorE& e, bool want_vectors,
+		     thread_pool& pool)
+  {
+    using _Tp = __matrix_value_t<_SymmetricMatrix>;
+
+    if (n == 0)
+      return;
+
+    dense_matrix<_Tp> h(n, n);
+    __sym_eigen_load(n, a, h);
+    std::vector<_Tp> dd(n), ee(n), tau(n);
+    __sym_tridiag_reduce(n, h, dd.data(), ee.data(), tau.data(), pool);
+
+    for (std::size_t i = 0; i < n; ++i)
+      d[i] = dd[i];
+    for (std::size_t i = 0; i + 1 < n; ++i)
+      e[i] = ee[i];
+
+    if (want_vectors)
+      {
+	dense_matrix<_Tp> q(n, n);
+	__sym_tridiag_form_q(n, h, tau.data(), q, pool);
+	auto A = __elem_access(a);
+	for (std::size_t i = 0; i < n; ++i)
+	  for (std::size_t j = 0; j < n; ++j)
+	    A(i, j) = q(i, j);
+      }
+  }
+
+
+template<typename _SymmetricMatrix, typename _Vector>
+  void
+  sym_eigen(std::size_t n, _SymmetricMatrix& a, _Vector& w,
+	    sym_eigen_algorithm alg, thread_pool& pool)
+  {
+    using _Tp = __matrix_value_t<_SymmetricMatrix>;
+
+    if (n == 0)
+      return;
+
+    dense_matrix<_Tp> h(n, n);
+    __sym_eigen_load(n, a, h);
+    std::vector<_Tp> d(n), e(n), tau(n);
+    __sym_tridiag_reduce(n, h, d.data(), e.data(), tau.data(), pool);
+
+    dense_matrix<_Tp> q(n, n);
+    __sym_tridiag_form_q(n, h, tau.data(), q, pool);
+
+    if (alg == sym_eigen_algorithm::divide_conquer)
+      tridiag_eigen_dc(n, d, e, q);
+    else
+      {
+	auto Q = __elem_access(q);
+	__tridiag_ql(n, d, e.data(), n, Q, true);
+	__tridiag_eigen_sort(n, d, n, Q, true);
+      }
+
+    auto A = __elem_access(a);
+    for (std::size_t i = 0; i < n; ++i)
+      for (std::size_t j = 0; j < n; ++j)
+	A(i, j) = q(i, j);
+    for (std::size_t i = 0; i < n; ++i)
+      w[i] = d[i];
+  }
+
+
+template<typename _SymmetricMatrix, typename _Vector>
+  void
+  sym_eigenvalues(std::size_t n, _SymmetricMatrix& a, _Vector& w,
+		  thread_pool& pool)
+  {
+    using _Tp = __matrix_value_t<_SymmetricMatrix>;
+
+    if (n == 0)
+      return;
+
+    dense_matrix<_Tp> h(n, n);
+    __sym_eigen_load(n, a, h);
+    std::vector<_Tp> d(n), e(n), tau(n);
+    __sym_tridiag_reduce(n, h, d.data(), e.data(), tau.data(), pool);
+
+    auto H = __elem_access(h);
+    __tridiag_ql(n, d, e.data(), n, H, false);
+    __tridiag_eigen_sort(n, d, n, H, false);
+
+    auto A = __elem_access(a);
+    for (std::size_t i = 0; i < n; ++i)
+      for (std::size_t j = 0; j < n; ++j)
+	A(i, j) = h(i, j);
+    for (std::size_t i = 0; i < n; ++i)
+      w[i] = d[i];
+  }
+
+
+template<typename _Matrix, typename _Vector>
+  void
+  sym_eigen_backsub(std::size_t n, const _Matrix& z, const _Vector& w,
+		    const _Vector& b, _Vector& x)
+  {
+    using _Tp = __matrix_value_t<_Matrix>;
+
+    auto Z = __elem_access(z);
+
+    _Tp wmax = _Tp{0};
+    for (std::size_t j = 0; j < n; ++j)
+      wmax = std::max(wmax, std::abs(w[j]));
+    const auto thresh = _Tp(n) * std::numeric_limits<_Tp>::epsilon() * wmax;
+
+    std::vector<_Tp> tmp(n);
+    for (std::size_t j = 0; j < n; ++j)
+      {
+	_Tp s = _Tp{0};
+	if (std::abs(w[j]) > thresh)
+	  {
+	    for (std::size_t i = 0; i < n; ++i)
+	      s += Z(i, j) * b[i];
+	    s /= w[j];
+	  }
+	tmp[j] = s;
+      }
+    for (std::size_t i = 0; i < n; ++i)
+      {
+	_Tp s = _Tp{0};
+	for (std::size_t j = 0; j < n; ++j)
+	  s += Z(i, j) * tmp[j];
+	x[i] = s;
+      }
+  }
+
+
+template<typename _SymmetricMatrix, typename _Storage>
+  template<typename _SymmetricMatrix2>
+    sym_eigen_decomposition<_SymmetricMatrix, _Storage>::
+    sym_eigen_decomposition(std::size_t n, const _SymmetricMatrix2& a,
+			    sym_eigen_algorithm alg)
+    : m_n(n),
+      m_z(__make_storage<_Storage>(n, n, a)),
+      m_w(n)
+    {
+      sym_eigen(m_n, m_z, m_w, alg);
+    }
+
+template<typename _SymmetricMatrix, typename _Storage>
+  template<typename _SymmetricMatrix2>
+    sym_eigen_decomposition<_SymmetricMatrix, _Storage>::
+    sym_eigen_decomposition(std::size_t n, const _SymmetricMatrix2& a,
+			    sym_eigen_algorithm alg, thread_pool& pool)
+    : m_n(n),
+      m_z(__make_storage<_Storage>(n, n, a)),
+      m_w(n)
+    {
+      sym_eigen(m_n, m_z, m_w, alg, pool);
+    }
+
+template<typename _SymmetricMatrix, typename _Storage>
+  template<typename _Vector2, typename _VectorOut>
+    void
+    sym_eigen_decomposition<_SymmetricMatrix, _Storage>::
+    backsubstitution(const _Vector2& b, _VectorOut& x) const
+    {
+      std::vector<value_type> bb(m_n), xx(m_n);
+      for (std::size_t i = 0; i < m_n; ++i)
+	bb[i] = b[i];
+      sym_eigen_backsub(m_n, m_z, m_w, bb, xx);
+      for (std::size_t i = 0; i < m_n; ++i)
+	x[i] = xx[i];
+    }
+
+template<typename _SymmetricMatrix, typename _Storage>
+  template<typename _InVecIter, typename _OutVecIter>
+    void
+    sym_eigen_decomposition<_SymmetricMatrix, _Storage>::
+    backsubstitution(_InVecIter b_begin, _InVecIter b_end,
+		     _OutVecIter x_begin) const
+    {
+      std::vector<value_type> bb(b_begin, b_end), xx(m_n);
+      sym_eigen_backsub(m_n, m_z, m_w, bb, xx);
+      std::copy(xx.begin(), xx.end(), x_begin);
+    }
+
+} // namespace matrix
+
+#endif // MATRIX_SYM_EIGEN_TCC
@@ -0,0 +1,233 @@
+#ifndef MATRIX_THREAD_POOL_H
+#define MATRIX_THREAD_POOL_H 1
+
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace matrix
+{
+
+/**
+ * A simple fixed-size pool of worker threads fed from a shared task queue.
+ * Tasks are grouped and waited on through task_group.  A thread waiting
+ * on a group runs queued tasks itself so a pool with zero workers
+ * still makes progress.
+ */
+class thread_pool
+{
+public:
+
+  /**
+   * Construct a pool with num_threads worker threads.
+   */
+  explicit
+  thread_pool(std::size_t num_threads = std::thread::hardware_concurrency())
+  {
+    m_workers.reserve(num_threads);
+    for (std::size_t i = 0; i < num_threads; ++i)
+      m_workers.emplace_back([this]{ this->work(); });
+  }
+
+  thread_pool(const thread_pool&) = delete;
+  thread_pool& operator=(const thread_pool&) = delete;
+
+  ~thread_pool()
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stop = true;
+    }
+    m_ready.notify_all();
+    for (auto& worker : m_workers)
+      worker.join();
+  }
+
+  /**
+   * Return the number of worker threads.
+   */
+  std::size_t
+  size() const
+  { return m_workers.size(); }
+
+  /**
+   * Queue a task.
+   */
+  void
+  submit(std::function<void()> task)
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_tasks.push_back(std::move(task));
+    }
+    m_ready.notify_one();
+  }
+
+  /**
+   * Run one queued task on the calling thread.
+   * Return false if the queue was empty.
+   */
+  bool
+  run_one()
+  {
+    std::function<void()> task;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (m_tasks.empty())
+	return false;
+      task = std::move(m_tasks.front());
+      m_tasks.pop_front();
+    }
+    task();
+    return true;
+  }
+
+private:
+
+  void
+  work()
+  {
+    while (true)
+      {
+	std::function<void()> task;
+	{
+	  std::unique_lock<std::mutex> lock(m_mutex);
+	  m_ready.wait(lock, [this]{ return m_stop || !m_tasks.empty(); });
+	  if (m_stop && m_tasks.empty())
+	    return;
+	  task = std::move(m_tasks.front());
+	  m_tasks.pop_front();
+	}
+	task();
+      }
+  }
+
+  std::vector<std::thread> m_workers;
+
+  std::deque<std::function<void()>> m_tasks;
+
+  std::mutex m_mutex;
+
+  std::condition_variable m_ready;
+
+  bool m_stop = false;
+};
+
+/**
+ * A set of tasks submitted to a thread_pool that can be waited on together.
+ */
+class task_group
+{
+public:
+
+  explicit
+  task_group(thread_pool& pool)
+  : m_pool(pool)
+  { }
+
+  task_group(const task_group&) = delete;
+  task_group& operator=(const task_group&) = delete;
+
+  ~task_group()
+  { this->join(); }
+
+  /**
+   * Submit a task to the pool as a member of this group.
+   * An exception thrown by the task is held for wait().
+   */
+  template<typename _Func>
+    void
+    run(_Func&& func)
+    {
+      {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	++m_pending;
+      }
+      m_pool.submit([this, func = std::forward<_Func>(func)]() mutable
+		    {
+		      std::exception_ptr error;
+		      try
+			{
+			  func();
+			}
+		      catch (...)
+			{
+			  error = std::current_exception();
+			}
+		      std::lock_guard<std::mutex> lock(m_mutex);
+		      if (error && !m_error)
+			m_error = std::move(error);
+		      if (--m_pending == 0)
+			m_done.notify_all();
+		    });
+    }
+
+  /**
+   * Wait for all tasks of the group to finish,
+   * running queued tasks on the calling thread in the meantime.
+   * If any of them threw, rethrow the first exception.
+   */
+  void
+  wait()
+  {
+    this->join();
+    std::exception_ptr error;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      std::swap(error, m_error);
+    }
+    if (error)
+      std::rethrow_exception(error);
+  }
+
+private:
+
+  void
+  join()
+  {
+    while (true)
+      {
+	{
+	  std::lock_guard<std::mutex> lock(m_mutex);
+	  if (m_pending == 0)
+	    return;
+	}
+	if (!m_pool.run_one())
+	  {
+	    std::unique_lock<std::mutex> lock(m_mutex);
+	    m_done.wait(lock, [this]{ return m_pending == 0; });
+	    return;
+	  }
+      }
+  }
+
+  thread_pool& m_pool;
+
+  std::size_t m_pending = 0;
+
+  std::exception_ptr m_error;
+
+  std::mutex m_mutex;
+
+  std::condition_variable m_done;
+};
+
+/**
+ * Return the pool used by the parallel algorithms when none is given.
+ * It has one worker per hardware thread.
+ */
+inline thread_pool&
+default_thread_pool()
+{
+  static thread_pool pool;
+  return pool;
+}
+
+} // namespace matrix
+
+#endif // MATRIX_THREAD_POOL_H
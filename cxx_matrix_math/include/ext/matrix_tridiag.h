@@ -1,6 +1,10 @@
 #ifndef MATRIX_TRIDIAG_H
 #define MATRIX_TRIDIAG_H 1
 
+#include "matrix_layout.h"
+#include "matrix_thread_pool.h"
+#include "matrix_workspace.h"
+
 namespace matrix
 {
 
@@ -15,6 +19,43 @@ template<typename _Tp>
   tridiagonal(const _Tp* a, const _Tp* b, const _Tp* c,
 	      const _Tp* r, _Tp* u, std::size_t n);
 
+/**
+ * Return the number of elements of workspace needed by tridiagonal().
+ */
+constexpr std::size_t
+tridiagonal_workspace_size(std::size_t n) noexcept
+{ return n; }
+
+/**
+ * Solve the tridiagonal system as above without allocating:
+ * the decomposition is kept in work, which must hold at least
+ * tridiagonal_workspace_size(n) elements.
+ */
+template<typename _Tp>
+  void
+  tridiagonal(const _Tp* a, const _Tp* b, const _Tp* c,
+	      const _Tp* r, _Tp* u, std::size_t n,
+	      workspace_span<__nondeduced_t<_Tp>> work);
+
+/**
+ * Solve the tridiagonal system of tridiagonal() with the SPIKE partition
+ * method on pool.  The rows are split into one block for the calling
+ * thread and each worker of pool, but no block shorter than 4096 rows.
+ * Each block is solved by the Thomas algorithm together with its two
+ * spikes, the columns coupling it to the neighbouring blocks;
+ * the reduced system for the unknowns at the block ends is then solved
+ * and the blocks are corrected in parallel.
+ * Small systems are passed on to tridiagonal().  Each diagonal block
+ * must be factorable without pivoting, as for tridiagonal(), which holds
+ * for diagonally dominant systems.
+ * Throw std::runtime_error if a zero pivot is met.
+ */
+template<typename _Tp>
+  void
+  tridiagonal_parallel(const _Tp* a, const _Tp* b, const _Tp* c,
+		       const _Tp* r, _Tp* u, std::size_t n,
+		       thread_pool& pool = default_thread_pool());
+
 /**
  * Solves for a vector x[1..n] the cyclic set of linear equations.
  * a[[1..n], b[1..n], c[1..n], and r[1..n] are input vectors of the three diagonal rows and the
@@ -27,6 +68,24 @@ template<typename _Tp>
 	 _Tp alpha, _Tp beta,
 	 const _Tp* r, _Tp* x, std::size_t n);
 
+/**
+ * Return the number of elements of workspace needed by cyclic().
+ */
+constexpr std::size_t
+cyclic_workspace_size(std::size_t n) noexcept
+{ return 3 * n + tridiagonal_workspace_size(n); }
+
+/**
+ * Solve the cyclic tridiagonal system as above without allocating.
+ * work must hold at least cyclic_workspace_size(n) elements.
+ */
+template<typename _Tp>
+  void
+  cyclic(const _Tp* a, const _Tp* b, const _Tp* c,
+	 _Tp alpha, _Tp beta,
+	 const _Tp* r, _Tp* x, std::size_t n,
+	 workspace_span<__nondeduced_t<_Tp>> work);
+
 } // namespace matrix
 
 #include "matrix_tridiag.tcc"
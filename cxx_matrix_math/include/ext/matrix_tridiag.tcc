@@ -2,6 +2,12 @@
 #define MATRIX_TRIDIAG_TCC 1
 
 #include <cmath>
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include "matrix_lu_decomp.h"
+#include "matrix_thread_pool.h"
 
 namespace matrix
 {
@@ -17,7 +23,22 @@ template<typename _Tp>
   tridiagonal(const _Tp* a, const _Tp* b, const _Tp* c,
 	      const _Tp* r, _Tp* u, std::size_t n)
   {
-    std::vector<_Tp> gam(n);
+    std::vector<_Tp> work(tridiagonal_workspace_size(n));
+    tridiagonal(a, b, c, r, u, n, workspace_span<_Tp>(work));
+  }
+
+
+/**
+ * Solves a tridiagonal set of equations as tridiagonal() taking
+ * the decomposition vector gam[0..n-1] from the caller-supplied workspace.
+ */
+template<typename _Tp>
+  void
+  tridiagonal(const _Tp* a, const _Tp* b, const _Tp* c,
+	      const _Tp* r, _Tp* u, std::size_t n,
+	      workspace_span<__nondeduced_t<_Tp>> work)
+  {
+    auto gam = work.take(n);
 
     if (b[0] == _Tp{0})
       std::__throw_runtime_error("Error 1 in tridiagonal.");
@@ -25,7 +46,7 @@ template<typename _Tp>
     u[0] = r[0] / bet;
 
     //Decomposition and forward substitution.
-    for (int j = 1; j < n; ++j)
+    for (std::size_t j = 1; j < n; ++j)
       {
 	gam[j] = c[j - 1] / bet;
 	bet = b[j] - a[j] * gam[j];
@@ -35,11 +56,145 @@ template<typename _Tp>
       }
 
     // Backsubstitution.
-    for (int j = n - 2; j >= 0; --j)
+    for (std::ptrdiff_t j = std::ptrdiff_t(n) - 2; j >= 0; --j)
       u[j] -= gam[j + 1] * u[j + 1];
   }
 
 
+/**
+ * Solve the diagonal block [s, e) of a tridiagonal system for the right
+ * hand side r into u, for the left spike (a[s] at row s) into v unless
+ * the block is first and for the right spike (c[e-1] at row e-1) into w
+ * unless it is last.  gam[s+1..e-1] is scratch.
+ * Return true if a zero pivot was met.
+ */
+template<typename _Tp>
+  bool
+  __tridiag_spike_block(const _Tp* a, const _Tp* b, const _Tp* c,
+			const _Tp* r, _Tp* u, _Tp* v, _Tp* w, _Tp* gam,
+			std::size_t s, std::size_t e,
+			bool first, bool last)
+  {
+    _Tp bet = b[s];
+    if (bet == _Tp{0})
+      return true;
+    u[s] = r[s] / bet;
+    v[s] = first ? _Tp{0} : a[s] / bet;
+    w[s] = (!last && e - s == 1) ? c[s] / bet : _Tp{0};
+
+    for (std::size_t i = s + 1; i < e; ++i)
+      {
+	gam[i] = c[i - 1] / bet;
+	bet = b[i] - a[i] * gam[i];
+	if (bet == _Tp{0})
+	  return true;
+	u[i] = (r[i] - a[i] * u[i - 1]) / bet;
+	v[i] = -a[i] * v[i - 1] / bet;
+	w[i] = ((!last && i == e - 1 ? c[i] : _Tp{0}) - a[i] * w[i - 1]) / bet;
+      }
+
+    for (std::size_t i = e - 1; i-- > s; )
+      {
+	u[i] -= gam[i + 1] * u[i + 1];
+	v[i] -= gam[i + 1] * v[i + 1];
+	w[i] -= gam[i + 1] * w[i + 1];
+      }
+
+    return false;
+  }
+
+
+template<typename _Tp>
+  void
+  tridiagonal_parallel(const _Tp* a, const _Tp* b, const _Tp* c,
+		       const _Tp* r, _Tp* u, std::size_t n,
+		       thread_pool& pool)
+  {
+    const std::size_t MIN_BLOCK = 4096;
+
+    const auto n_blocks = std::min(pool.size() + 1, n / MIN_BLOCK);
+    if (n_blocks < 2)
+      {
+	tridiagonal(a, b, c, r, u, n);
+	return;
+      }
+
+    auto start = [n, n_blocks](std::size_t k)
+		 { return k * n / n_blocks; };
+
+    std::vector<_Tp> v(n), w(n), gam(n);
+    std::vector<char> zero(n_blocks);
+    {
+      task_group blocks(pool);
+      for (std::size_t k = 1; k < n_blocks; ++k)
+	blocks.run([&, k]()
+		   {
+		     zero[k] = __tridiag_spike_block(a, b, c, r, u,
+					v.data(), w.data(), gam.data(),
+					start(k), start(k + 1),
+					false, k + 1 == n_blocks);
+		   });
+      zero[0] = __tridiag_spike_block(a, b, c, r, u,
+				      v.data(), w.data(), gam.data(),
+				      start(0), start(1), true, false);
+      blocks.wait();
+    }
+    for (auto z : zero)
+      if (z)
+	std::__throw_runtime_error("Zero pivot in tridiagonal_parallel.");
+
+    //  The reduced system for the last unknown of each block but the last
+    //  and the first of each block but the first, in the order
+    //  l_0, f_1, l_1, f_2, ...: each end of block k is its particular
+    //  solution less the spikes times l_{k-1} and f_{k+1}.
+    const auto m = 2 * (n_blocks - 1);
+    std::vector<std::vector<_Tp>> s(m, std::vector<_Tp>(m));
+    std::vector<_Tp> z(m);
+    std::vector<std::size_t> index(m);
+    for (std::size_t k = 0; k < n_blocks; ++k)
+      {
+	const auto s_k = start(k);
+	const auto e_k = start(k + 1) - 1;
+	if (k > 0)
+	  {
+	    const auto row = 2 * k - 1;
+	    s[row][row] = _Tp{1};
+	    s[row][row - 1] = v[s_k];
+	    if (k + 1 < n_blocks)
+	      s[row][row + 2] = w[s_k];
+	    z[row] = u[s_k];
+	  }
+	if (k + 1 < n_blocks)
+	  {
+	    const auto row = 2 * k;
+	    s[row][row] = _Tp{1};
+	    if (k > 0)
+	      s[row][row - 2] = v[e_k];
+	    s[row][row + 1] = w[e_k];
+	    z[row] = u[e_k];
+	  }
+      }
+    _Tp parity;
+    lu_decomp(m, s, index, parity);
+    lu_backsub(m, s, index, z);
+
+    {
+      auto correct = [&](std::size_t k)
+	{
+	  const auto l_prev = k > 0 ? z[2 * k - 2] : _Tp{0};
+	  const auto f_next = k + 1 < n_blocks ? z[2 * k + 1] : _Tp{0};
+	  for (std::size_t i = start(k); i < start(k + 1); ++i)
+	    u[i] -= v[i] * l_prev + w[i] * f_next;
+	};
+      task_group blocks(pool);
+      for (std::size_t k = 1; k < n_blocks; ++k)
+	blocks.run([&correct, k]{ correct(k); });
+      correct(0);
+      blocks.wait();
+    }
+  }
+
+
 /**
  * Solves for a vector x[1..n] the cyclic set of linear equations.
  * a[[1..n], b[1..n], c[1..n], and r[1..n] are input vectors of the three diagonal rows and the
@@ -51,27 +206,44 @@ template<typename _Tp>
   cyclic(const _Tp* a, const _Tp* b, const _Tp* c,
 	 _Tp alpha, _Tp beta,
 	 const _Tp* r, _Tp* x, std::size_t n)
+  {
+    std::vector<_Tp> work(cyclic_workspace_size(n));
+    cyclic(a, b, c, alpha, beta, r, x, n, workspace_span<_Tp>(work));
+  }
+
+
+/**
+ * Solves for a vector x[1..n] the cyclic set of linear equations
+ * as cyclic() taking the modified diagonal, the correction vectors
+ * and the workspace of the tridiagonal solves from work.
+ */
+template<typename _Tp>
+  void
+  cyclic(const _Tp* a, const _Tp* b, const _Tp* c,
+	 _Tp alpha, _Tp beta,
+	 const _Tp* r, _Tp* x, std::size_t n,
+	 workspace_span<__nondeduced_t<_Tp>> work)
   {
     if (n <= 2)
       std::__throw_domain_error("n too small in cyclic.");
 
-    std::vector<_Tp> bb(n);
-    std::vector<_Tp> u(n);
-    std::vector<_Tp> z(n);
+    auto bb = work.take(n);
+    auto u = work.take(n);
+    auto z = work.take(n);
 
     _Tp gamma = -b[0];
 
     bb[0] = b[0] - gamma;
     bb[n - 1] = b[n - 1] - alpha * beta / gamma;
     for (unsigned long i = 1; i < n - 1; ++i)
-      bb[0] = b[i];
-    tridiagonal(a, bb.data(), c, r, x, n);
+      bb[i] = b[i];
+    tridiagonal(a, bb, c, r, x, n, work);
 
     u[0] = gamma;
     u[n - 1] = alpha;
     for (unsigned long i = 1; i < n - 1; ++i)
       u[i] = _Tp{0};
-    tridiagonal(a, bb, c, u.data(), z.data(), n);
+    tridiagonal(a, bb, c, u, z, n, work);
 
     _Tp fact = (x[0] + beta * x[n - 1] / gamma)
 		/ (1.0 + z[0] + beta * z[n - 1] / gamma);
@@ -81,5 +253,5 @@ template<typename _Tp>
 
 } // namespace matrix
 
-#endif // MATRIX_GAUSS_JORDAN_TCC
+#endif // MATRIX_TRIDIAG_TCC
 
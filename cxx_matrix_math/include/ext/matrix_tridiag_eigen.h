@@ -0,0 +1,47 @@
+#ifndef MATRIX_TRIDIAG_EIGEN_H
+#define MATRIX_TRIDIAG_EIGEN_H 1
+
+#include "matrix_layout.h"
+
+namespace matrix
+{
+
+/**
+ * Compute the eigenvalues and eigenvectors of the symmetric tridiagonal
+ * matrix with diagonal d[0..n-1] and off-diagonal e[0..n-2], e[i] coupling
+ * rows i and i+1, by the implicit QL algorithm with Wilkinson shifts.
+ * On output d holds the eigenvalues in ascending order and e is destroyed.
+ * On input z[0..n-1][0..n-1] holds the identity, or the orthogonal matrix
+ * that reduced a full symmetric matrix to the tridiagonal form;
+ * on output its columns are the corresponding eigenvectors.
+ * If want_vectors is false z is not referenced.
+ * Throw std::logic_error if an eigenvalue fails to converge
+ * in 30 iterations.
+ */
+template<typename _VectorD, typename _VectorE, typename _Matrix>
+  void
+  tridiag_eigen_ql(std::size_t n, _VectorD& d, _VectorE& e, _Matrix& z,
+		   bool want_vectors = true);
+
+/**
+ * Compute the eigenvalues and eigenvectors of the symmetric tridiagonal
+ * matrix d, e as tridiag_eigen_ql() does by Cuppen's divide and conquer:
+ * the matrix is torn in two by a rank-one modification, the halves are
+ * solved recursively and the eigensystem of each merged half is found from
+ * the roots of the secular equation with the eigenvectors computed after
+ * Gu and Eisenstat so that they stay orthogonal.  The eigenvectors of the
+ * tridiagonal matrix are then applied to z with a single gemm.
+ * Subproblems of 25 or fewer rows are solved with implicit QL.
+ * The cost is dominated by matrix multiplication and is well below that
+ * of QL for large n when the eigenvectors are wanted;
+ * for eigenvalues alone use tridiag_eigen_ql() with want_vectors false.
+ */
+template<typename _VectorD, typename _VectorE, typename _Matrix>
+  void
+  tridiag_eigen_dc(std::size_t n, _VectorD& d, _VectorE& e, _Matrix& z);
+
+} // namespace matrix
+
+#include "matrix_tridiag_eigen.tcc"
+
+#endif // MATRIX_TRIDIAG_EIGEN_H
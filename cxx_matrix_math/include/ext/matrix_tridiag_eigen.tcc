@@ -0,0 +1,530 @@
+#ifndef MATRIX_TRIDIAG_EIGEN_TCC
+#define MATRIX_TRIDIAG_EIGEN_TCC 1
+
+
+#include <cstdlib>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#include "matrix_dense.h"
+#include "matrix_gemm.h"
+#include "matrix_layout.h"
+
+
+namespace matrix
+{
+
+
+/**
+ * The implicit QL iteration on the diagonal d[0..n-1] and the off-diagonal
+ * e[0..n-1], e[n-1] being scratch.  When want_vectors is true the rotations
+ * are applied to the columns of the n_rows*n element accessor Z.
+ * The eigenvalues are left unsorted.
+ */
+template<typename _VectorD, typename _Tp, typename _ElemZ>
+  void
+  __tridiag_ql(std::size_t n, _VectorD& d, _Tp* e,
+	       std::size_t n_rows, _ElemZ Z, bool want_vectors)
+  {
+    const int ITS = 30;
+    const auto eps = std::numeric_limits<_Tp>::epsilon();
+
+    if (n == 0)
+      return;
+
+    e[n - 1] = _Tp{0};
+    for (std::size_t l = 0; l < n; ++l)
+      {
+	int iter = 0;
+	std::size_t m;
+	do
+	  {
+	    for (m = l; m < n - 1; ++m)
+	      {
+		const auto dd = std::abs(d[m]) + std::abs(d[m + 1]);
+		if (std::abs(e[m]) <= eps * dd)
+		  break;
+	      }
+	    if (m != l)
+	      {
+		if (iter++ == ITS)
+		  {
+		    std::ostringstream msg;
+		    msg << "No convergence in " << ITS
+			<< " tridiag_eigen_ql iterations.";
+		    std::__throw_logic_error(msg.str().c_str());
+		  }
+
+		//  Wilkinson shift from the leading 2x2 minor.
+		_Tp g = (d[l + 1] - d[l]) / (_Tp{2} * e[l]);
+		_Tp r = std::hypot(g, _Tp{1});
+		g = d[m] - d[l] + e[l] / (g + std::copysign(r, g));
+
+		_Tp s = _Tp{1};
+		_Tp c = _Tp{1};
+		_Tp p = _Tp{0};
+		std::ptrdiff_t i;
+		for (i = std::ptrdiff_t(m) - 1; i >= std::ptrdiff_t(l); --i)
+		  {
+		    _Tp f = s * e[i];
+		    const _Tp b = c * e[i];
+		    r = std::hypot(f, g);
+		    e[i + 1] = r;
+		    if (r == _Tp{0})
+		      {
+			//  Recover from underflow.
+			d[i + 1] -= p;
+			e[m] = _Tp{0};
+			break;
+		      }
+		    s = f / r;
+		    c = g / r;
+		    g = d[i + 1] - p;
+		    r = (d[i] - g) * s + _Tp{2} * c * b;
+		    p = s * r;
+		    d[i + 1] = g + p;
+		    g = c * r - b;
+		    if (want_vectors)
+		      for (std::size_t k = 0; k < n_rows; ++k)
+			{
+			  f = Z(k, i + 1);
+			  Z(k, i + 1) = s * Z(k, i) + c * f;
+			  Z(k, i) = c * Z(k, i) - s * f;
+			}
+		  }
+		if (r == _Tp{0} && i >= std::ptrdiff_t(l))
+		  continue;
+		d[l] -= p;
+		e[l] = g;
+		e[m] = _Tp{0};
+	      }
+	  }
+	while (m != l);
+      }
+  }
+
+
+/**
+ * Sort the eigenvalues d[0..n-1] into ascending order by straight selection
+ * and, when want_vectors is true, the columns of the n_rows*n element
+ * accessor Z with them.
+ */
+template<typename _VectorD, typename _ElemZ>
+  void
+  __tridiag_eigen_sort(std::size_t n, _VectorD& d,
+		       std::size_t n_rows, _ElemZ Z, bool want_vectors)
+  {
+    for (std::size_t i = 0; i + 1 < n; ++i)
+      {
+	auto k = i;
+	for (std::size_t j = i + 1; j < n; ++j)
+	  if (d[j] < d[k])
+	    k = j;
+	if (k != i)
+	  {
+	    std::swap(d[i], d[k]);
+	    if (want_vectors)
+	      for (std::size_t j = 0; j < n_rows; ++j)
+		std::swap(Z(j, i), Z(j, k));
+	  }
+      }
+  }
+
+
+template<typename _VectorD, typename _VectorE, typename _Matrix>
+  void
+  tridiag_eigen_ql(std::size_t n, _VectorD& d, _VectorE& e, _Matrix& z,
+		   bool want_vectors)
+  {
+    using _Tp = __matrix_value_t<_Matrix>;
+
+    if (n == 0)
+      return;
+
+    std::vector<_Tp> ee(n);
+    for (std::size_t i = 0; i + 1 < n; ++i)
+      ee[i] = e[i];
+
+    auto Z = __elem_access(z);
+    __tridiag_ql(n, d, ee.data(), n, Z, want_vectors);
+    __tridiag_eigen_sort(n, d, n, Z, want_vectors);
+
+    for (std::size_t i = 0; i + 1 < n; ++i)
+      e[i] = ee[i];
+  }
+
+
+/**
+ * Find the root in the j-th interval of the secular equation
+ *   1 + rho sum_i z[i]^2 / (d[i] - lambda) = 0
+ * for the K increasing poles d[0..K-1] and rho > 0.
+ * The root is returned as the offset tau from the pole d[origin],
+ * the nearer end of its interval, so that the differences d[i] - lambda
+ * can later be formed accurately as (d[i] - d[origin]) - tau.
+ * Each step solves a model with the two poles bounding the interval
+ * fitted to the value and slope of either part of the sum;
+ * steps leaving the bracket fall back to bisection.
+ * delta[0..K-1] is scratch.
+ */
+template<typename _Tp>
+  void
+  __tridiag_secular_root(std::size_t K, std::size_t j, const _Tp* d,
+			 const _Tp* z, _Tp rho, _Tp zz, _Tp* delta,
+			 std::size_t& origin, _Tp& tau)
+  {
+    const auto eps = std::numeric_limits<_Tp>::epsilon();
+    const bool last = (j == K - 1);
+
+    //  Take the origin at the pole nearer the root.
+    origin = j;
+    if (!last)
+      {
+	const auto half = (d[j + 1] - d[j]) / _Tp{2};
+	_Tp f = _Tp{1};
+	for (std::size_t i = 0; i < K; ++i)
+	  f += rho * z[i] * z[i] / ((d[i] - d[j]) - half);
+	if (f < _Tp{0})
+	  origin = j + 1;
+      }
+    for (std::size_t i = 0; i < K; ++i)
+      delta[i] = d[i] - d[origin];
+
+    _Tp lo, hi;
+    if (last)
+      {
+	lo = _Tp{0};
+	hi = rho * zz;
+      }
+    else if (origin == j)
+      {
+	lo = _Tp{0};
+	hi = delta[j + 1] / _Tp{2};
+      }
+    else
+      {
+	lo = delta[j] / _Tp{2};
+	hi = _Tp{0};
+      }
+
+    const auto pl = delta[j];
+    const auto pu = last ? _Tp{0} : delta[j + 1];
+    _Tp t = (lo + hi) / _Tp{2};
+    for (int iter = 0; iter < 100; ++iter)
+      {
+	_Tp psi1 = _Tp{0}, dpsi1 = _Tp{0};
+	for (std::size_t i = 0; i <= j; ++i)
+	  {
+	    const auto r = z[i] / (delta[i] - t);
+	    psi1 += z[i] * r;
+	    dpsi1 += r * r;
+	  }
+	_Tp psi2 = _Tp{0}, dpsi2 = _Tp{0};
+	for (std::size_t i = j + 1; i < K; ++i)
+	  {
+	    const auto r = z[i] / (delta[i] - t);
+	    psi2 += z[i] * r;
+	    dpsi2 += r * r;
+	  }
+	const auto f = _Tp{1} + rho * (psi1 + psi2);
+	if (f < _Tp{0})
+	  lo = t;
+	else
+	  hi = t;
+	if (std::abs(f) <= eps * _Tp(K + 8)
+			 * (_Tp{1} + rho * (std::abs(psi1) + psi2)))
+	  break;
+
+	//  Fit c + s1/(pl - x) + s2/(pu - x) at t and solve for its root.
+	const auto s1 = rho * dpsi1 * (pl - t) * (pl - t);
+	bool ok = false;
+	_Tp tn = t;
+	if (last)
+	  {
+	    const auto c = f - s1 / (pl - t);
+	    if (c > _Tp{0})
+	      {
+		tn = pl + s1 / c;
+		ok = true;
+	      }
+	  }
+	else
+	  {
+	    const auto s2 = rho * dpsi2 * (pu - t) * (pu - t);
+	    const auto c = f - s1 / (pl - t) - s2 / (pu - t);
+	    const auto qb = -(c * (pl + pu) + s1 + s2);
+	    const auto qc = c * pl * pu + s1 * pu + s2 * pl;
+	    if (c == _Tp{0})
+	      {
+		if (qb != _Tp{0})
+		  {
+		    tn = -qc / qb;
+		    ok = true;
+		  }
+	      }
+	    else
+	      {
+		const auto disc = qb * qb - _Tp{4} * c * qc;
+		if (disc >= _Tp{0})
+		  {
+		    const auto q = -(qb + std::copysign(std::sqrt(disc), qb))
+				 / _Tp{2};
+		    tn = q / c;
+		    if (!(tn > lo && tn < hi) && q != _Tp{0})
+		      tn = qc / q;
+		    ok = true;
+		  }
+	      }
+	  }
+	if (!ok || !(tn > lo && tn < hi))
+	  tn = (lo + hi) / _Tp{2};
+	if (tn == t
+	    || hi - lo <= _Tp{2} * eps * std::max(std::abs(lo), std::abs(hi)))
+	  break;
+	t = tn;
+      }
+    tau = t;
+  }
+
+
+/**
+ * Merge the eigensystems of the two halves [0, k) and [k, n) of a torn
+ * tridiagonal matrix.  On input d holds the eigenvalues of the halves
+ * and the diagonal blocks of the n*n row-major block at q the eigenvectors;
+ * the rank-one modification is rho v.v^T with v = e_{k-1} + sgn e_k.
+ * On output d and q hold the sorted eigensystem of the whole.
+ */
+template<typename _Tp>
+  void
+  __tridiag_dc_merge(std::size_t n, std::size_t k, _Tp* d,
+		     _Tp* q, std::size_t ldq, _Tp rho, _Tp sgn)
+  {
+    const auto eps = std::numeric_limits<_Tp>::epsilon();
+    auto Q = [q, ldq](std::size_t i, std::size_t j) -> _Tp&
+	     { return q[i * ldq + j]; };
+
+    //  The modification vector in the eigenbasis of the halves.
+    std::vector<_Tp> z(n);
+    for (std::size_t i = 0; i < k; ++i)
+      z[i] = Q(k - 1, i);
+    for (std::size_t i = k; i < n; ++i)
+      z[i] = sgn * Q(k, i);
+    _Tp zz = _Tp{0};
+    for (std::size_t i = 0; i < n; ++i)
+      zz += z[i] * z[i];
+    const auto znorm = std::sqrt(zz);
+    for (std::size_t i = 0; i < n; ++i)
+      z[i] /= znorm;
+    rho *= zz;
+
+    std::vector<std::size_t> perm(n);
+    std::iota(perm.begin(), perm.end(), 0);
+    std::stable_sort(perm.begin(), perm.end(),
+		     [d](std::size_t i, std::size_t j)
+		     { return d[i] < d[j]; });
+
+    _Tp dmax = _Tp{0};
+    for (std::size_t i = 0; i < n; ++i)
+      dmax = std::max(dmax, std::abs(d[i]));
+    const auto tol = _Tp{8} * eps * std::max(dmax, rho);
+
+    //  Deflate the components with negligible z and, by a rotation,
+    //  the one of each pair of nearly equal poles.
+    std::vector<std::size_t> kept, defl;
+    kept.reserve(n);
+    defl.reserve(n);
+    for (auto i : perm)
+      {
+	if (rho * std::abs(z[i]) <= tol)
+	  {
+	    defl.push_back(i);
+	    continue;
+	  }
+	if (!kept.empty())
+	  {
+	    const auto j = kept.back();
+	    const auto r = std::hypot(z[j], z[i]);
+	    const auto c = z[i] / r;
+	    const auto s = z[j] / r;
+	    if (std::abs((d[i] - d[j]) * c * s) <= tol)
+	      {
+		for (std::size_t row = 0; row < n; ++row)
+		  {
+		    const auto qj = Q(row, j);
+		    const auto qi = Q(row, i);
+		    Q(row, j) = c * qj - s * qi;
+		    Q(row, i) = s * qj + c * qi;
+		  }
+		const auto dj = d[j];
+		const auto di = d[i];
+		d[j] = c * c * dj + s * s * di;
+		d[i] = s * s * dj + c * c * di;
+		z[i] = r;
+		z[j] = _Tp{0};
+		kept.back() = i;
+		defl.push_back(j);
+		continue;
+	      }
+	  }
+	kept.push_back(i);
+      }
+    std::stable_sort(kept.begin(), kept.end(),
+		     [d](std::size_t i, std::size_t j)
+		     { return d[i] < d[j]; });
+
+    const auto K = kept.size();
+    std::vector<_Tp> dk(K), zk(K), tau(K), delta(K);
+    std::vector<std::size_t> org(K);
+    _Tp zzk = _Tp{0};
+    for (std::size_t j = 0; j < K; ++j)
+      {
+	dk[j] = d[kept[j]];
+	zk[j] = z[kept[j]];
+	zzk += zk[j] * zk[j];
+      }
+    for (std::size_t j = 0; j < K; ++j)
+      __tridiag_secular_root(K, j, dk.data(), zk.data(), rho, zzk,
+			     delta.data(), org[j], tau[j]);
+
+    //  Recompute z from the computed roots (Loewner's theorem)
+    //  so that the eigenvectors come out numerically orthogonal.
+    auto lambda_minus = [&](std::size_t j, std::size_t i)
+			{ return (dk[org[j]] - dk[i]) + tau[j]; };
+    for (std::size_t i = 0; i < K; ++i)
+      {
+	_Tp p = lambda_minus(K - 1, i) / rho;
+	for (std::size_t j = 0; j < i; ++j)
+	  p *= lambda_minus(j, i) / (dk[j] - dk[i]);
+	for (std::size_t j = i; j + 1 < K; ++j)
+	  p *= lambda_minus(j, i) / (dk[j + 1] - dk[i]);
+	zk[i] = std::copysign(std::sqrt(std::abs(p)), zk[i]);
+      }
+
+    //  The eigenvectors of the modified diagonal matrix.
+    std::vector<_Tp> s(K * K);
+    for (std::size_t j = 0; j < K; ++j)
+      {
+	_Tp norm = _Tp{0};
+	for (std::size_t i = 0; i < K; ++i)
+	  {
+	    const auto x = zk[i] / -lambda_minus(j, i);
+	    s[i * K + j] = x;
+	    norm += x * x;
+	  }
+	norm = std::sqrt(norm);
+	for (std::size_t i = 0; i < K; ++i)
+	  s[i * K + j] /= norm;
+      }
+
+    //  Rotate the eigenvectors of the halves belonging to the kept poles.
+    std::vector<_Tp> qk(n * K), qs(n * K);
+    for (std::size_t row = 0; row < n; ++row)
+      for (std::size_t i = 0; i < K; ++i)
+	qk[row * K + i] = Q(row, kept[i]);
+    if (K > 0)
+      gemm<_Tp>(n, K, K, _Tp{1}, qk.data(), K, s.data(), K,
+		_Tp{0}, qs.data(), K);
+
+    //  Gather the deflated and the new eigenpairs in ascending order.
+    std::vector<std::pair<_Tp, std::ptrdiff_t>> order;
+    order.reserve(n);
+    for (auto i : defl)
+      order.emplace_back(d[i], -1 - std::ptrdiff_t(i));
+    for (std::size_t j = 0; j < K; ++j)
+      order.emplace_back(dk[org[j]] + tau[j], std::ptrdiff_t(j));
+    std::stable_sort(order.begin(), order.end(),
+		     [](const auto& x, const auto& y)
+		     { return x.first < y.first; });
+
+    std::vector<_Tp> qn(n * n);
+    for (std::size_t p = 0; p < n; ++p)
+      {
+	const auto src = order[p].second;
+	for (std::size_t row = 0; row < n; ++row)
+	  qn[row * n + p] = src < 0 ? Q(row, std::size_t(-1 - src))
+				    : qs[row * K + std::size_t(src)];
+	d[p] = order[p].first;
+      }
+    for (std::size_t row = 0; row < n; ++row)
+      for (std::size_t p = 0; p < n; ++p)
+	Q(row, p) = qn[row * n + p];
+  }
+
+
+/**
+ * Cuppen's divide and conquer on the diagonal d[0..n-1] and
+ * off-diagonal e[0..n-2] leaving the eigenvectors in the n*n row-major
+ * block at q, whose entries outside the block's diagonal blocks
+ * must be zero on input.  The eigenvalues are sorted unless n is small.
+ */
+template<typename _Tp>
+  void
+  __tridiag_dc(std::size_t n, _Tp* d, _Tp* e, _Tp* q, std::size_t ldq)
+  {
+    constexpr std::size_t __small = 25;
+
+    if (n <= __small)
+      {
+	auto Q = [q, ldq](std::size_t i, std::size_t j) -> _Tp&
+		 { return q[i * ldq + j]; };
+	for (std::size_t i = 0; i < n; ++i)
+	  for (std::size_t j = 0; j < n; ++j)
+	    Q(i, j) = i == j ? _Tp{1} : _Tp{0};
+	std::vector<_Tp> ee(e, e + n);
+	__tridiag_ql(n, d, ee.data(), n, Q, true);
+	return;
+      }
+
+    //  Tear the matrix into two halves by a rank-one modification.
+    const auto k = n / 2;
+    const auto rho = std::abs(e[k - 1]);
+    const auto sgn = e[k - 1] < _Tp{0} ? _Tp{-1} : _Tp{1};
+    d[k - 1] -= rho;
+    d[k] -= rho;
+
+    __tridiag_dc(k, d, e, q, ldq);
+    __tridiag_dc(n - k, d + k, e + k, q + k * ldq + k, ldq);
+    __tridiag_dc_merge(n, k, d, q, ldq, rho, sgn);
+  }
+
+
+template<typename _VectorD, typename _VectorE, typename _Matrix>
+  void
+  tridiag_eigen_dc(std::size_t n, _VectorD& d, _VectorE& e, _Matrix& z)
+  {
+    using _Tp = __matrix_value_t<_Matrix>;
+
+    if (n == 0)
+      return;
+
+    std::vector<_Tp> dd(n), ee(n);
+    for (std::size_t i = 0; i < n; ++i)
+      dd[i] = d[i];
+    for (std::size_t i = 0; i + 1 < n; ++i)
+      ee[i] = e[i];
+
+    dense_matrix<_Tp> s(n, n);
+    __tridiag_dc(n, dd.data(), ee.data(), s.data(), s.leading_dim());
+    __tridiag_eigen_sort(n, dd, n, __elem_access(s), true);
+
+    auto Z = __elem_access(z);
+    dense_matrix<_Tp> z0(n, n);
+    for (std::size_t i = 0; i < n; ++i)
+      for (std::size_t j = 0; j < n; ++j)
+	z0(i, j) = Z(i, j);
+    __gemm(n, n, n, _Tp{1}, __elem_access(std::as_const(z0)),
+	   __elem_access(std::as_const(s)), _Tp{0}, Z);
+
+    for (std::size_t i = 0; i < n; ++i)
+      d[i] = dd[i];
+    for (std::size_t i = 0; i + 1 < n; ++i)
+      e[i] = _Tp{0};
+  }
+
+} // namespace matrix
+
+#endif // MATRIX_TRIDIAG_EIGEN_TCC
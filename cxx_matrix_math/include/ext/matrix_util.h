@@ -1,7 +1,10 @@
 #if ! defined(MATRIX_UTIL_H)
 #define MATRIX_UTIL_H
 
-#include <iosfwd>
+#include <iostream>
+#include <iomanip>
+
+#include "matrix_gemm.h"
 
 namespace matrix
 {
@@ -39,21 +42,13 @@ namespace matrix
   template<typename Numeric, std::size_t M, std::size_t K, std::size_t N>
     void
     mul_matrix(Numeric (&c)[M][N], const Numeric (&a)[M][K], const Numeric (&b)[K][N])
-    {
-      for (std::size_t i = 0; i < M; ++i)
-	for (std::size_t j = 0; j < N; ++j)
-	  {
-	    c[i][j] = Numeric{0};
-	    for (std::size_t k = 0; k < K; ++k)
-	      c[i][j] += a[i][k] * b[k][j];
-	  }
-    }
+    { gemm<Numeric>(Numeric{1}, a, b, Numeric{0}, c); }
 
   template<typename Numeric, std::size_t M, std::size_t K>
     void
     mul_matrix(Numeric (&c)[M], const Numeric (&a)[M][K], const Numeric (&b)[K])
     {
-      for (int i = 0; i < M; ++i)
+      for (std::size_t i = 0; i < M; ++i)
 	{
 	  c[i] = Numeric{0};
 	  for (std::size_t k = 0; k < K; ++k)
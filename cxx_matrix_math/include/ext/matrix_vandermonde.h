@@ -1,6 +1,9 @@
 #ifndef MATRIX_VANDERMONDE_H
 #define MATRIX_VANDERMONDE_H 1
 
+#include "matrix_layout.h"
+#include "matrix_workspace.h"
+
 namespace matrix
 {
 
@@ -8,6 +11,23 @@ template<typename _Tp>
   void
   vandermonde(std::size_t n, const _Tp* x, const _Tp* q, _Tp* w);
 
+/**
+ * Return the number of elements of workspace needed by vandermonde().
+ */
+constexpr std::size_t
+vandermonde_workspace_size(std::size_t n) noexcept
+{ return n; }
+
+/**
+ * Solve the Vandermonde system as above without allocating:
+ * the master polynomial coefficients are kept in work, which must hold
+ * at least vandermonde_workspace_size(n) elements.
+ */
+template<typename _Tp>
+  void
+  vandermonde(std::size_t n, const _Tp* x, const _Tp* q, _Tp* w,
+	      workspace_span<__nondeduced_t<_Tp>> work);
+
 } // namespace matrix
 
 #include "matrix_vandermonde.tcc"
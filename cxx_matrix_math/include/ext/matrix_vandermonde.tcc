@@ -1,6 +1,9 @@
 #ifndef MATRIX_VANDERMONDE_TCC
 #define MATRIX_VANDERMONDE_TCC 1
 
+#include <algorithm>
+#include <vector>
+
 namespace matrix
 {
 
@@ -10,12 +13,25 @@ namespace matrix
 template<typename _Tp>
   void
   vandermonde(std::size_t n, const _Tp* x, const _Tp* q, _Tp* w)
+  {
+    std::vector<_Tp> work(vandermonde_workspace_size(n));
+    vandermonde(n, x, q, w, workspace_span<_Tp>(work));
+  }
+
+/**
+ *
+ */
+template<typename _Tp>
+  void
+  vandermonde(std::size_t n, const _Tp* x, const _Tp* q, _Tp* w,
+	      workspace_span<__nondeduced_t<_Tp>> work)
   {
     if (n == 1)
       w[0] = q[0];
     else
       {
-	std::vector<_Tp> c(n);
+	auto c = work.take(n);
+	std::fill_n(c, n, _Tp{0});
 	c[n - 1] = -x[0];
 	for (std::size_t i = 1; i < n; ++i)
 	  {
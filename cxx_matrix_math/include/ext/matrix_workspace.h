@@ -0,0 +1,73 @@
+#ifndef MATRIX_WORKSPACE_H
+#define MATRIX_WORKSPACE_H 1
+
+#include <cstdlib>
+#include <stdexcept>
+#include <utility>
+
+namespace matrix
+{
+
+/**
+ * A non-owning view of caller-supplied scratch memory.
+ * Routines that would otherwise allocate temporaries have overloads
+ * taking a workspace_span; each such routine has a matching
+ * *_workspace_size() query giving the number of elements it needs.
+ * The routines carve their temporaries from the front of the span
+ * with take() so a steady-state solve loop does no heap allocation.
+ */
+template<typename _Tp>
+  class workspace_span
+  {
+  public:
+
+    using value_type = _Tp;
+
+    workspace_span() noexcept = default;
+
+    workspace_span(_Tp* data, std::size_t size) noexcept
+    : m_data(data), m_size(size)
+    { }
+
+    /**
+     * View the elements of a contiguous container such as
+     * std::vector or std::array.
+     */
+    template<typename _Container,
+	     typename = decltype(std::declval<_Container&>().data())>
+      workspace_span(_Container& c) noexcept
+      : m_data(c.data()), m_size(c.size())
+      { }
+
+    template<std::size_t _Num>
+      workspace_span(_Tp (&a)[_Num]) noexcept
+      : m_data(a), m_size(_Num)
+      { }
+
+    _Tp* data() const noexcept { return m_data; }
+    std::size_t size() const noexcept { return m_size; }
+
+    /**
+     * Return the first n elements and drop them from the view.
+     * Throw std::length_error if fewer than n elements are left.
+     */
+    _Tp*
+    take(std::size_t n)
+    {
+      if (n > m_size)
+	std::__throw_length_error("workspace_span: workspace too small");
+      auto p = m_data;
+      m_data += n;
+      m_size -= n;
+      return p;
+    }
+
+  private:
+
+    _Tp* m_data = nullptr;
+    std::size_t m_size = 0;
+  };
+
+} // namespace matrix
+
+#endif // MATRIX_WORKSPACE_H
@@ -1,6 +1,10 @@
 
+#include <algorithm>
+#include <functional>
 #include <iostream>
 #include <iomanip>
+#include <stdexcept>
+#include <utility>
 
 #include <ext/matrix.h>
 #include <ext/matrix_util.h>
@@ -18,8 +22,8 @@ main()
   const std::size_t M = 3, N = 3;
   double A_sing[M][N]{{1, 2, 3}, {4, 5, 6}, {7, 8, 9}};
   auto detA = A_sing[0][0] * (A_sing[1][1] * A_sing[2][2] - A_sing[1][2] * A_sing[2][1])
-            + A_sing[0][1] * (A_sing[1][2] * A_sing[2][0] - A_sing[1][0] * A_sing[2][2])
-            + A_sing[0][2] * (A_sing[1][0] * A_sing[2][1] - A_sing[1][1] * A_sing[2][0]);
+	    + A_sing[0][1] * (A_sing[1][2] * A_sing[2][0] - A_sing[1][0] * A_sing[2][2])
+	    + A_sing[0][2] * (A_sing[1][0] * A_sing[2][1] - A_sing[1][1] * A_sing[2][0]);
 
   std::cout << "\n det(a) = " << std::setw(10) << detA << '\n';
 
@@ -49,6 +53,37 @@ main()
   std::cout << "\n A.A^{-1}\n";
   matrix::print_matrix(I_sing);
 
+  // General matrix multiply
+
+  std::cout << "\n General Matrix Multiply";
+  std::cout << "\n -----------------------\n";
+
+  {
+    const std::size_t m = 37, k = 41, n = 29;
+    std::vector<std::vector<double>> a(m, std::vector<double>(k));
+    std::vector<std::vector<double>> b(k, std::vector<double>(n));
+    std::vector<std::vector<double>> c(m, std::vector<double>(n, 1.0));
+    for (std::size_t i = 0; i < m; ++i)
+      for (std::size_t p = 0; p < k; ++p)
+	a[i][p] = 1.0 / (1.0 + i + 2 * p);
+    for (std::size_t p = 0; p < k; ++p)
+      for (std::size_t j = 0; j < n; ++j)
+	b[p][j] = 1.0 / (1.0 + 3 * p + j);
+    matrix::gemm(2.0, a, b, 0.5, c);
+
+    auto diff = 0.0;
+    for (std::size_t i = 0; i < m; ++i)
+      for (std::size_t j = 0; j < n; ++j)
+	{
+	  auto sum = 0.0;
+	  for (std::size_t p = 0; p < k; ++p)
+	    sum += a[i][p] * b[p][j];
+	  diff = std::max(diff, std::abs(c[i][j] - (2.0 * sum + 0.5)));
+	}
+    std::cout << "\n Verify gemm against the triple loop: "
+	      << (diff < 1.0e-13 ? "ok" : "FAIL") << '\n';
+  }
+
   // Input arrays and vectors...
 
   const double
@@ -147,6 +182,123 @@ main()
   std::cout << "\n Verify A^{-1}.A = I\n";
   matrix::print_matrix(I_LU);
 
+  decltype(B_GJ) X_LU;
+  matrix::copy_matrix(X_LU, B_in);
+  matrix::lu_backsub(3, A_LU, index_LU, X_LU, 5);
+
+  std::cout << "\n Solution vectors from LU decomposition:\n";
+  matrix::print_matrix(X_LU);
+
+  decltype(B_GJ) B_LU;
+  matrix::mul_matrix(B_LU, A_in, X_LU);
+  std::cout << "\n Verify A.X = B for LU decomposition:\n";
+  matrix::print_matrix(B_LU);
+
+  // The same right-hand sides stored column-major.
+  double X_LU_col[5 * 3];
+  for (int i = 0; i < 3; ++i)
+    for (int j = 0; j < 5; ++j)
+      X_LU_col[i + 3 * j] = B_in[i][j];
+  matrix::lu_backsub(3, A_LU, index_LU, X_LU_col, 5, 3, matrix::layout_left{});
+  auto diff_LU_col = 0.0;
+  for (int i = 0; i < 3; ++i)
+    for (int j = 0; j < 5; ++j)
+      diff_LU_col = std::max(diff_LU_col, std::abs(X_LU_col[i + 3 * j] - X_LU[i][j]));
+  std::cout << "\n Column-major solution difference: " << diff_LU_col << '\n';
+
+  // Blocked Lower-Upper Decomposition
+
+  std::cout << "\n Blocked Lower-Upper Decomposition";
+  std::cout << "\n ---------------------------------\n";
+
+  double A_BLU[3][3];
+  matrix::copy_matrix(A_BLU, A_in);
+  std::cout << "\n Input matrix for blocked LU decomposition:\n";
+  matrix::print_matrix(A_BLU);
+
+  std::size_t index_BLU[3];
+  double parity_BLU;
+  matrix::lu_decomp_blocked(3, A_BLU, index_BLU, parity_BLU, 2);
+
+  std::cout << "\n Output matrix of blocked LU decomposition:\n";
+  matrix::print_matrix(A_BLU);
+
+  std::cout << "\n Output row permutation vector of blocked LU decomposition:\n";
+  matrix::print_matrix(index_BLU);
+
+  std::cout << "\n Output parity of blocked LU decomposition: " << parity_BLU << "\n";
+
+  // Parallel Lower-Upper Decomposition
+
+  double A_PLU[3][3];
+  matrix::copy_matrix(A_PLU, A_in);
+
+  matrix::thread_pool pool(2);
+  std::size_t index_PLU[3];
+  double parity_PLU;
+  matrix::lu_decomp_parallel(3, A_PLU, index_PLU, parity_PLU, pool, 1);
+
+  std::cout << "\n Output matrix of parallel LU decomposition:\n";
+  matrix::print_matrix(A_PLU);
+
+  std::cout << "\n Output row permutation vector of parallel LU decomposition:\n";
+  matrix::print_matrix(index_PLU);
+
+  std::cout << "\n Output parity of parallel LU decomposition: " << parity_PLU << "\n";
+
+  std::vector<std::vector<double>> A_vec(3, std::vector<double>(3));
+  for (int i = 0; i < 3; ++i)
+    for (int j = 0; j < 3; ++j)
+      A_vec[i][j] = A_in[i][j];
+  matrix::lu_decomposition<double, std::vector<std::vector<double>>>
+    LU_dec(3, A_vec, matrix::lu_algorithm::blocked);
+
+  std::cout << "\n Determinant of input matrix from lu_decomposition: "
+	    << LU_dec.determinant() << '\n';
+
+  std::vector<double> b_LU{1.0, 2.0, 3.0}, x_LU(3);
+  LU_dec.backsubstitute(b_LU, x_LU);
+  LU_dec.improve(A_vec, b_LU, x_LU);
+  const double x_LU_arr[3]{x_LU[0], x_LU[1], x_LU[2]};
+  double r_LU[3];
+  matrix::mul_matrix(r_LU, A_in, x_LU_arr);
+  std::cout << "\n Verify A.x = b for lu_decomposition:\n";
+  matrix::print_matrix(r_LU);
+
+  // Replace a column and add a rank-one term without refactoring.
+
+  double A_UP[3][3];
+  matrix::copy_matrix(A_UP, A_in);
+  const std::vector<double> c_UP{1.0, -1.0, 2.0};
+  LU_dec.replace_column(1, c_UP);
+  for (int i = 0; i < 3; ++i)
+    A_UP[i][1] = c_UP[i];
+  const std::vector<double> u_UP{0.5, 0.0, -0.5}, v_UP{1.0, 2.0, 1.0};
+  LU_dec.update(u_UP, v_UP);
+  for (int i = 0; i < 3; ++i)
+    for (int j = 0; j < 3; ++j)
+      A_UP[i][j] += u_UP[i] * v_UP[j];
+  LU_dec.backsubstitute(b_LU, x_LU);
+  const double x_UP[3]{x_LU[0], x_LU[1], x_LU[2]};
+  double r_UP[3];
+  matrix::mul_matrix(r_UP, A_UP, x_UP);
+  std::cout << "\n Verify A.x = b for updated lu_decomposition:\n";
+  matrix::print_matrix(r_UP);
+
+  std::cout << "\n Trace of updated lu_decomposition: " << LU_dec.trace()
+	    << "  (direct: " << A_UP[0][0] + A_UP[1][1] + A_UP[2][2] << ")\n";
+
+  // Mixed precision solve: float factor, double refinement.
+
+  const double b_MP[3]{1.0, 2.0, 3.0};
+  double x_MP[3], r_MP[3];
+  const auto info_MP = matrix::lu_solve_mixed(3, A_in, b_MP, x_MP);
+  matrix::mul_matrix(r_MP, A_in, x_MP);
+  std::cout << "\n Verify A.x = b for lu_solve_mixed:\n";
+  matrix::print_matrix(r_MP);
+  std::cout << "\n Refinement steps: " << info_MP.iterations
+	    << "  fallback: " << info_MP.fallback << '\n';
+
   // Singular Value Decomposition
 
   std::cout << "\n Singular Value Decomposition";
@@ -174,14 +326,14 @@ main()
   for (int i = 0; i < 3; ++i)
     for (int j = 0; j < 3; ++j)
       {
-        R[i][j] = 0.0;
-        IU[i][j] = 0.0;
-        IV[i][j] = 0.0;
-        for (int k = 0; k < 3; ++k)
+	R[i][j] = 0.0;
+	IU[i][j] = 0.0;
+	IV[i][j] = 0.0;
+	for (int k = 0; k < 3; ++k)
 	  {
-            R[i][j] += A_SV[i][k] * W_SV[k] * V_SV[j][k];
-            IU[i][j] += A_SV[k][i] * A_SV[k][j];
-            IV[i][j] += V_SV[k][i] * V_SV[k][j];
+	    R[i][j] += A_SV[i][k] * W_SV[k] * V_SV[j][k];
+	    IU[i][j] += A_SV[k][i] * A_SV[k][j];
+	    IV[i][j] += V_SV[k][i] * V_SV[k][j];
 	  }
       }
 
@@ -194,6 +346,74 @@ main()
   std::cout << "\n Reconstruction of input matrix from SV decomposition:\n";
   matrix::print_matrix(R);
 
+  // The singular values alone from each engine, largest first.
+  const std::pair<matrix::sv_algorithm, const char*> sv_engines[]
+  {
+    {matrix::sv_algorithm::golub_reinsch, "Golub-Reinsch"},
+    {matrix::sv_algorithm::divide_conquer, "divide and conquer"},
+    {matrix::sv_algorithm::jacobi, "one-sided Jacobi"}
+  };
+  for (const auto& [alg, name] : sv_engines)
+    {
+      double A_alg[3][3], V_alg[3][3], W_alg[3];
+      matrix::copy_matrix(A_alg, A_in);
+      matrix::sv_decomp(3, 3, A_alg, W_alg, V_alg, alg,
+			matrix::sv_vectors::none);
+      std::sort(W_alg, W_alg + 3, std::greater<double>());
+      std::cout << "\n Singular values from " << name << ":\n";
+      matrix::print_matrix(W_alg);
+    }
+
+  // Divide and conquer with singular vectors on a matrix large enough
+  // (2n > 25) for the tridiagonal problem to be split and merged.
+  matrix::dense_matrix<double> A_dc_in(20, 16), A_dc(20, 16), V_dc(16, 16);
+  matrix::dense_matrix<double> A_gr(20, 16), V_gr(16, 16);
+  double W_dc[16], W_gr[16];
+  for (int i = 0; i < 20; ++i)
+    for (int j = 0; j < 16; ++j)
+      A_dc_in[i][j] = A_dc[i][j] = A_gr[i][j]
+	= 1.0 / (1 + i + 2 * j) + ((7 * i + 3 * j) % 11) / 10.0;
+  matrix::sv_decomp(20, 16, A_dc, W_dc, V_dc,
+		    matrix::sv_algorithm::divide_conquer);
+
+  double err_dc = 0.0, err_u_dc = 0.0, err_v_dc = 0.0;
+  for (int i = 0; i < 20; ++i)
+    for (int j = 0; j < 16; ++j)
+      {
+	double r = 0.0;
+	for (int k = 0; k < 16; ++k)
+	  r += A_dc[i][k] * W_dc[k] * V_dc[j][k];
+	err_dc = std::max(err_dc, std::abs(r - A_dc_in[i][j]));
+      }
+  for (int i = 0; i < 16; ++i)
+    for (int j = 0; j < 16; ++j)
+      {
+	double iu = 0.0, iv = 0.0;
+	for (int k = 0; k < 20; ++k)
+	  iu += A_dc[k][i] * A_dc[k][j];
+	for (int k = 0; k < 16; ++k)
+	  iv += V_dc[k][i] * V_dc[k][j];
+	err_u_dc = std::max(err_u_dc, std::abs(iu - (i == j)));
+	err_v_dc = std::max(err_v_dc, std::abs(iv - (i == j)));
+      }
+
+  matrix::sv_decomp(20, 16, A_gr, W_gr, V_gr,
+		    matrix::sv_algorithm::golub_reinsch,
+		    matrix::sv_vectors::none);
+  std::sort(W_dc, W_dc + 16, std::greater<double>());
+  std::sort(W_gr, W_gr + 16, std::greater<double>());
+  double err_w_dc = 0.0;
+  for (int k = 0; k < 16; ++k)
+    err_w_dc = std::max(err_w_dc, std::abs(W_dc[k] - W_gr[k]));
+
+  std::cout << "\n Divide and conquer SVD of a 20x16 matrix:\n";
+  std::cout << " Largest and smallest singular values: "
+	    << W_dc[0] << ' ' << W_dc[15] << '\n';
+  std::cout << " Max |U.W.V~ - A|:                     " << err_dc << '\n';
+  std::cout << " Max |U~.U - I|:                       " << err_u_dc << '\n';
+  std::cout << " Max |V~.V - I|:                       " << err_v_dc << '\n';
+  std::cout << " Max |w - w(Golub-Reinsch)|:           " << err_w_dc << '\n';
+
   // Cholesky Decomposition
 
   std::cout << "\n Cholesky Decomposition";
@@ -233,6 +453,143 @@ main()
   std::cout << "\n Verify A^{-1}.A = I\n";
   matrix::print_matrix(I_C);
 
+  // Rank-one update and downdate of the Cholesky decomposition.
+
+  double A_UD[3][3];
+  matrix::copy_matrix(A_UD, A_in);
+  for (int i = 0; i < 3; ++i)
+    A_UD[i][i] = 5 * std::abs(A_UD[i][i]);
+  for (int i = 0; i < 3; ++i)
+    for (int j = 0; j < i; ++j)
+      A_UD[i][j] = A_UD[j][i]
+		 = std::abs(A_UD[i][j]) / (A_UD[i][i] + A_UD[j][j]) / 2;
+  double A_UD_plus[3][3];
+  const double u_UD[3]{0.5, -1.0, 0.25};
+  for (int i = 0; i < 3; ++i)
+    for (int j = 0; j < 3; ++j)
+      A_UD_plus[i][j] = A_UD[i][j] + u_UD[i] * u_UD[j];
+
+  double L_UD[3][3], D_UD[3];
+  matrix::copy_matrix(L_UD, A_UD);
+  matrix::cholesky_decomp(3, L_UD, D_UD);
+
+  const double b_UD[3]{1.0, 2.0, 3.0};
+  double x_UD[3], r_UD[3];
+  matrix::cholesky_update(3, L_UD, D_UD, u_UD);
+  matrix::cholesky_backsub(3, L_UD, D_UD, b_UD, x_UD);
+  matrix::mul_matrix(r_UD, A_UD_plus, x_UD);
+  std::cout << "\n Verify (A + u.u~).x = b after cholesky_update:\n";
+  matrix::print_matrix(r_UD);
+
+  matrix::cholesky_downdate(3, L_UD, D_UD, u_UD);
+  matrix::cholesky_backsub(3, L_UD, D_UD, b_UD, x_UD);
+  matrix::mul_matrix(r_UD, A_UD, x_UD);
+  std::cout << "\n Verify A.x = b after cholesky_downdate:\n";
+  matrix::print_matrix(r_UD);
+
+  try
+    {
+      const double w_UD[3]{10.0, 0.0, 0.0};
+      matrix::cholesky_downdate(3, L_UD, D_UD, w_UD);
+    }
+  catch (const std::logic_error& err)
+    {
+      std::cout << "\n " << err.what() << '\n';
+    }
+
+  // Blocked Cholesky Decomposition
+
+  double A_BC[3][3];
+  matrix::copy_matrix(A_BC, A_in);
+  for (int i = 0; i < 3; ++i)
+    A_BC[i][i] = 5 * std::abs(A_BC[i][i]);
+  for (int i = 0; i < 3; ++i)
+    for (int j = 0; j < i; ++j)
+      A_BC[i][j] = A_BC[j][i]
+		 = std::abs(A_BC[i][j]) / (A_BC[i][i] + A_BC[j][j]) / 2;
+  double A_PC[3][3];
+  matrix::copy_matrix(A_PC, A_BC);
+
+  double D_BC[3];
+  matrix::cholesky_decomp_blocked(3, A_BC, D_BC, 2);
+
+  std::cout << "\n Output matrix of blocked Cholesky decomposition:\n";
+  matrix::print_matrix(A_BC);
+
+  std::cout << "\n Output vector of blocked Cholesky decomposition:\n";
+  matrix::print_matrix(D_BC);
+
+  double D_PC[3];
+  matrix::cholesky_decomp_parallel(3, A_PC, D_PC, pool, 1);
+
+  std::cout << "\n Output vector of parallel Cholesky decomposition:\n";
+  matrix::print_matrix(D_PC);
+
+  // Symmetric Eigensystem
+
+  std::cout << "\n Symmetric Eigensystem";
+  std::cout << "\n ---------------------\n";
+
+  const double A_S[4][4]
+  {
+    { 4.0,  1.0, -2.0,  2.0},
+    { 1.0,  2.0,  0.0,  1.0},
+    {-2.0,  0.0,  3.0, -2.0},
+    { 2.0,  1.0, -2.0, -1.0}
+  };
+  std::cout << "\n Input matrix for symmetric eigensystem:\n";
+  matrix::print_matrix(A_S);
+
+  double D_S[4], E_S[3], Q_S[4][4];
+  matrix::copy_matrix(Q_S, A_S);
+  matrix::sym_tridiagonalize(4, Q_S, D_S, E_S, true, pool);
+
+  std::cout << "\n Diagonal of tridiagonal form:\n";
+  matrix::print_matrix(D_S);
+
+  std::cout << "\n Off-diagonal of tridiagonal form:\n";
+  matrix::print_matrix(E_S);
+
+  const std::pair<matrix::sym_eigen_algorithm, const char*> sym_engines[]
+  {
+    {matrix::sym_eigen_algorithm::ql, "implicit QL"},
+    {matrix::sym_eigen_algorithm::divide_conquer, "divide and conquer"}
+  };
+  for (const auto& [alg, name] : sym_engines)
+    {
+      double Z_S[4][4], W_S[4];
+      matrix::copy_matrix(Z_S, A_S);
+      matrix::sym_eigen(4, Z_S, W_S, alg, pool);
+
+      std::cout << "\n Eigenvalues from " << name << ":\n";
+      matrix::print_matrix(W_S);
+
+      double R_S[4][4];
+      for (int i = 0; i < 4; ++i)
+	for (int j = 0; j < 4; ++j)
+	  {
+	    R_S[i][j] = 0.0;
+	    for (int k = 0; k < 4; ++k)
+	      R_S[i][j] += Z_S[i][k] * W_S[k] * Z_S[j][k];
+	  }
+      std::cout << "\n Reconstruction of input matrix from " << name << ":\n";
+      matrix::print_matrix(R_S);
+    }
+
+  double H_S[4][4], W_S_only[4];
+  matrix::copy_matrix(H_S, A_S);
+  matrix::sym_eigenvalues(4, H_S, W_S_only, pool);
+  std::cout << "\n Eigenvalues alone:\n";
+  matrix::print_matrix(W_S_only);
+
+  matrix::sym_eigen_decomposition<double[4][4]> SE(4, A_S);
+  const double b_S[4]{1.0, 2.0, 3.0, 4.0};
+  double x_S[4], r_S[4];
+  SE.backsubstitution(b_S, b_S + 4, x_S);
+  matrix::mul_matrix(r_S, A_S, x_S);
+  std::cout << "\n Verify A.x = b for sym_eigen_decomposition:\n";
+  matrix::print_matrix(r_S);
+
   // QR Decomposition
 
   std::cout << "\n QR Decomposition";
@@ -268,5 +625,656 @@ main()
   std::cout << "\n Verify A^{-1}.A = I\n";
   matrix::print_matrix(I_QR);
 
+  // Matrix views
+
+  std::cout << "\n Matrix Views";
+  std::cout << "\n ------------\n";
+
+  // A column-major copy of the input matrix.
+  double A_col[3 * 3];
+  for (int i = 0; i < 3; ++i)
+    for (int j = 0; j < 3; ++j)
+      A_col[i + 3 * j] = A_in[i][j];
+  matrix::matrix<double*, matrix::layout_left> A_view(A_col, 3, 3);
+  std::cout << "\n Column-major view: extents " << A_view.extent(0)
+	    << " x " << A_view.extent(1) << ", strides " << A_view.stride(0)
+	    << ", " << A_view.stride(1) << '\n';
+
+  double C_view[3], D_view[3];
+  bool sing_view;
+  matrix::qr_decomp(3, 3, A_view, C_view, D_view, sing_view);
+  auto diff_view = 0.0;
+  for (int i = 0; i < 3; ++i)
+    {
+      diff_view = std::max(diff_view, std::abs(C_view[i] - C_QR[i]));
+      diff_view = std::max(diff_view, std::abs(D_view[i] - D_QR[i]));
+      for (int j = 0; j < 3; ++j)
+	diff_view = std::max(diff_view, std::abs(A_view(i, j) - A_QR[i][j]));
+    }
+  std::cout << "\n QR decomposition difference for the column-major view: "
+	    << diff_view << '\n';
+
+  std::valarray<double> A_va(9);
+  for (int i = 0; i < 3; ++i)
+    for (int j = 0; j < 3; ++j)
+      A_va[3 * i + j] = A_in[i][j];
+  matrix::matrix A_va_view(A_va, 3);
+  std::size_t index_view[3];
+  double parity_view;
+  matrix::lu_decomp(3, A_va_view, index_view, parity_view);
+  std::cout << "\n Determinant from the valarray view: "
+	    << matrix::lu_determinant(3, A_va_view, parity_view) << '\n';
+
+  // Decomposition objects with dense_matrix storage
+
+  std::cout << "\n Decomposition Objects";
+  std::cout << "\n ---------------------\n";
+
+  std::cout << "\n Padded leading dimension of a 512 x 512 dense_matrix<double>: "
+	    << matrix::dense_matrix<double>::padded_leading_dim(512) << '\n';
+
+  const double b_dec[3]{1.0, 2.0, 3.0};
+  auto residual = [&A_in, &b_dec](const double (&x)[3])
+		  {
+		    auto res = 0.0;
+		    for (int i = 0; i < 3; ++i)
+		      {
+			auto sum = -b_dec[i];
+			for (int j = 0; j < 3; ++j)
+			  sum += A_in[i][j] * x[j];
+			res = std::max(res, std::abs(sum));
+		      }
+		    return res;
+		  };
+
+  matrix::lu_decomposition<double, double[3][3]> LU_obj(3, A_in);
+  double x_lu_obj[3];
+  LU_obj.backsubstitute(b_dec, x_lu_obj);
+  std::cout << "\n Residual for lu_decomposition: "
+	    << residual(x_lu_obj) << '\n';
+
+  matrix::qr_decomposition<double, double[3][3]> QR_obj(3, 3, A_in);
+  double x_qr_obj[3];
+  QR_obj.backsubstitution(b_dec, x_qr_obj);
+  std::cout << "\n Residual for qr_decomposition: "
+	    << residual(x_qr_obj) << '\n';
+
+  // Least squares fit of a quadratic to 12 exact points
+  // with the three QR algorithms.
+  double A_fit[12][3], b_fit[12];
+  for (int i = 0; i < 12; ++i)
+    {
+      const double t = 0.25 * i - 1.0;
+      A_fit[i][0] = 1.0;
+      A_fit[i][1] = t;
+      A_fit[i][2] = t * t;
+      b_fit[i] = 1.0 + 2.0 * t + 3.0 * t * t;
+    }
+  matrix::qr_decomposition<double, double[12][3]>
+    QR_house(12, 3, A_fit, matrix::qr_algorithm::householder),
+    QR_block(12, 3, A_fit, matrix::qr_algorithm::blocked),
+    QR_tsqr(12, 3, A_fit, pool);
+  double x_house[3], x_block[3], x_tsqr[3];
+  QR_house.backsubstitution(b_fit, x_house);
+  QR_block.backsubstitution(b_fit, x_block);
+  QR_tsqr.backsubstitution(b_fit, x_tsqr);
+  std::cout << "\n Least squares fit with Householder QR:\n";
+  matrix::print_matrix(x_house);
+  std::cout << "\n Least squares fit with blocked QR:\n";
+  matrix::print_matrix(x_block);
+  std::cout << "\n Least squares fit with TSQR:\n";
+  matrix::print_matrix(x_tsqr);
+
+  matrix::sv_decomposition<double, double[12][3]>
+    SV_dc(12, 3, A_fit, matrix::sv_algorithm::divide_conquer),
+    SV_jacobi(12, 3, A_fit, pool);
+  double x_sv_dc[3], x_sv_jacobi[3];
+  SV_dc.backsubstitution(b_fit, x_sv_dc);
+  SV_jacobi.backsubstitution(b_fit, x_sv_jacobi);
+  std::cout << "\n Least squares fit with divide and conquer SVD:\n";
+  matrix::print_matrix(x_sv_dc);
+  std::cout << "\n Least squares fit with one-sided Jacobi SVD:\n";
+  matrix::print_matrix(x_sv_jacobi);
+
+  // The leading singular triplets of the fit matrix from the randomized
+  // range finder, and the fit from all three of them.
+  matrix::dense_matrix<double> U_rand(12, 3), V_rand(3, 3);
+  std::vector<double> W_rand(3);
+  matrix::sv_decomp_randomized(12, 3, A_fit, 2, U_rand, W_rand, V_rand);
+  std::cout << "\n Leading two singular values from randomized SVD:\n";
+  std::cout << ' ' << std::setw(10) << W_rand[0]
+	    << ' ' << std::setw(10) << W_rand[1] << '\n';
+  matrix::sv_decomp_randomized(12, 3, A_fit, 3, U_rand, W_rand, V_rand);
+  std::vector<double> b_rand(b_fit, b_fit + 12), x_rand(3);
+  matrix::sv_backsub(12, 3, 3, U_rand, W_rand, V_rand, b_rand, x_rand);
+  std::cout << "\n Least squares fit with randomized SVD:\n";
+  for (auto x : x_rand)
+    std::cout << ' ' << std::setw(10) << x;
+  std::cout << '\n';
+
+  // A 200x100 matrix with decaying singular values, where the 5 + 10
+  // samples fall well short of the columns: the truncated range finder
+  // with power iterations against the full decomposition.
+  matrix::dense_matrix<double> A_big(200, 100), A_big_gr(200, 100),
+			       V_big_gr(100, 100), U_big(200, 5), V_big(100, 5);
+  for (std::size_t i = 0; i < 200; ++i)
+    for (std::size_t j = 0; j < 100; ++j)
+      A_big[i][j] = A_big_gr[i][j] = 1.0 / (1.0 + 0.5 * i + j);
+  std::vector<double> W_big(5), W_big_gr(100);
+  matrix::sv_decomp_randomized(200, 100, A_big, 5, U_big, W_big, V_big);
+  matrix::sv_decomp(200, 100, A_big_gr, W_big_gr, V_big_gr,
+		    matrix::sv_algorithm::golub_reinsch,
+		    matrix::sv_vectors::none);
+  std::sort(W_big_gr.begin(), W_big_gr.end(), std::greater<double>());
+  auto err_w_big = 0.0;
+  for (std::size_t j = 0; j < 5; ++j)
+    err_w_big = std::max(err_w_big,
+			 std::abs(W_big[j] - W_big_gr[j]) / W_big_gr[j]);
+  std::cout << "\n Leading five singular values of a 200x100 matrix"
+	       " from randomized SVD:\n";
+  for (auto w : W_big)
+    std::cout << ' ' << std::setw(12) << w;
+  std::cout << "\n Max relative difference from sv_decomp: " << err_w_big
+	    << '\n';
+
+  matrix::sv_decomposition<double, double[3][3]> SV_obj(3, 3, A_in);
+  double x_sv_obj[3];
+  SV_obj.backsubstitution(b_dec, x_sv_obj);
+  SV_obj.improve(A_in, b_dec, x_sv_obj);
+  std::cout << "\n Residual for sv_decomposition: "
+	    << residual(x_sv_obj) << '\n';
+
+  double A_chol[3][3];
+  matrix::copy_matrix(A_chol, A_in);
+  for (int i = 0; i < 3; ++i)
+    A_chol[i][i] = 5 * std::abs(A_chol[i][i]);
+  for (int i = 0; i < 3; ++i)
+    for (int j = 0; j < i; ++j)
+      A_chol[i][j] = A_chol[j][i]
+		   = std::abs(A_chol[i][j]) / (A_chol[i][i] + A_chol[j][j]) / 2;
+  matrix::cholesky_decomposition<double[3][3], double[3]>
+    Chol_obj(3, A_chol, matrix::cholesky_algorithm::blocked);
+  double x_chol_obj[3];
+  Chol_obj.backsubstitute(b_dec, x_chol_obj);
+  auto res_chol = 0.0;
+  for (int i = 0; i < 3; ++i)
+    {
+      auto sum = -b_dec[i];
+      for (int j = 0; j < 3; ++j)
+	sum += A_chol[i][j] * x_chol_obj[j];
+      res_chol = std::max(res_chol, std::abs(sum));
+    }
+  std::cout << "\n Residual for cholesky_decomposition: " << res_chol << '\n';
+
+  // Workspace overloads
+
+  std::cout << "\n Workspace Overloads";
+  std::cout << "\n -------------------\n";
+
+  std::vector<double> work(std::max({matrix::lu_decomp_workspace_size(3),
+				     matrix::sv_decomp_workspace_size(3, 3),
+				     matrix::cyclic_workspace_size(5)}));
+
+  double A_ws[3][3];
+  matrix::copy_matrix(A_ws, A_in);
+  std::size_t index_ws[3];
+  double parity_ws;
+  matrix::lu_decomp(3, A_ws, index_ws, parity_ws,
+		    matrix::workspace_span<double>(work));
+  std::cout << "\n Determinant from lu_decomp with workspace: "
+	    << matrix::lu_determinant(3, A_ws, parity_ws) << '\n';
+
+  double V_ws[3][3], W_ws[3];
+  matrix::copy_matrix(A_ws, A_in);
+  matrix::sv_decomp(3, 3, A_ws, W_ws, V_ws, work);
+  auto diff_ws = 0.0;
+  for (int i = 0; i < 3; ++i)
+    diff_ws = std::max(diff_ws, std::abs(W_ws[i] - W_SV[i]));
+  std::cout << "\n Singular value difference for sv_decomp with workspace: "
+	    << diff_ws << '\n';
+
+  // A diagonally dominant cyclic tridiagonal system.
+  const double sub_cyc[5]{1.0, 1.0, 1.0, 1.0, 1.0};
+  const double diag_cyc[5]{4.0, 4.0, 4.0, 4.0, 4.0};
+  const double sup_cyc[5]{1.0, 1.0, 1.0, 1.0, 1.0};
+  const double rhs_cyc[5]{1.0, 2.0, 3.0, 4.0, 5.0};
+  const double alpha_cyc = 1.0, beta_cyc = 1.0;
+  double x_cyc[5];
+  matrix::cyclic(sub_cyc, diag_cyc, sup_cyc, alpha_cyc, beta_cyc,
+		 rhs_cyc, x_cyc, 5, work);
+  auto res_cyc = 0.0;
+  for (int i = 0; i < 5; ++i)
+    {
+      auto sum = diag_cyc[i] * x_cyc[i] - rhs_cyc[i];
+      sum += (i > 0 ? sub_cyc[i] * x_cyc[i - 1] : beta_cyc * x_cyc[4]);
+      sum += (i < 4 ? sup_cyc[i] * x_cyc[i + 1] : alpha_cyc * x_cyc[0]);
+      res_cyc = std::max(res_cyc, std::abs(sum));
+    }
+  std::cout << "\n Residual for cyclic with workspace: " << res_cyc << '\n';
+
+  // Banded solvers
+
+  std::cout << "\n Banded Solvers";
+  std::cout << "\n --------------\n";
+
+  // A nonsymmetric band matrix whose small diagonal forces interchanges.
+  constexpr std::size_t n_band = 8, kl_band = 2, ku_band = 1;
+  double A_band[n_band][n_band]{};
+  for (std::size_t i = 0; i < n_band; ++i)
+    for (std::size_t j = 0; j < n_band; ++j)
+      if (i <= j + kl_band && j <= i + ku_band)
+	A_band[i][j] = (i == j ? 0.1 : 1.0 + double((3 * i + j) % 5));
+  double b_band[n_band];
+  for (std::size_t i = 0; i < n_band; ++i)
+    b_band[i] = double(i) - 3.0;
+
+  matrix::banded_matrix<double> AB(n_band, kl_band, ku_band, A_band);
+  matrix::banded_lu_decomposition<double> BLU(AB);
+  double x_band[n_band];
+  BLU.backsubstitute(b_band, x_band);
+
+  double A_band_LU[n_band][n_band], x_band_LU[n_band], d_band_LU;
+  std::size_t i_band_LU[n_band];
+  matrix::copy_matrix(A_band_LU, A_band);
+  std::copy(b_band, b_band + n_band, x_band_LU);
+  matrix::lu_decomp(n_band, A_band_LU, i_band_LU, d_band_LU);
+  matrix::lu_backsub(n_band, A_band_LU, i_band_LU, x_band_LU);
+  auto diff_band_LU = 0.0;
+  for (std::size_t i = 0; i < n_band; ++i)
+    diff_band_LU = std::max(diff_band_LU,
+			    std::abs(x_band[i] - x_band_LU[i]));
+  std::cout << "\n Solution from banded_lu_decomposition:\n";
+  matrix::print_matrix(x_band);
+  std::cout << "\n Difference between banded and dense LU solutions: "
+	    << (diff_band_LU < 1.0e-12 ? "ok" : "FAIL") << '\n';
+
+  auto det_band = d_band_LU;
+  for (std::size_t i = 0; i < n_band; ++i)
+    det_band *= A_band_LU[i][i];
+  std::cout << "\n Relative difference between banded and dense determinants: "
+	    << (std::abs(BLU.determinant() - det_band)
+		< 1.0e-12 * std::abs(det_band) ? "ok" : "FAIL") << '\n';
+
+  // A symmetric positive definite band matrix.
+  constexpr std::size_t kd_band = 2;
+  double S_band[n_band][n_band]{};
+  for (std::size_t i = 0; i < n_band; ++i)
+    for (std::size_t j = 0; j < n_band; ++j)
+      if (i == j)
+	S_band[i][j] = 6.0 + double(i % 3);
+      else if (i <= j + kd_band && j <= i + kd_band)
+	S_band[i][j] = -1.0 - 0.5 * double((i + j) % 2);
+
+  matrix::symmetric_banded_matrix<double> SB(n_band, kd_band, S_band);
+  matrix::banded_cholesky_decomposition<double> BCH(SB);
+  double y_band[n_band];
+  BCH.backsubstitution(b_band, b_band + n_band, y_band);
+
+  double S_band_CH[n_band][n_band], d_band_CH[n_band], y_band_CH[n_band];
+  matrix::copy_matrix(S_band_CH, S_band);
+  matrix::cholesky_decomp(n_band, S_band_CH, d_band_CH);
+  matrix::cholesky_backsub(n_band, S_band_CH, d_band_CH, b_band, y_band_CH);
+  auto diff_band_CH = 0.0;
+  for (std::size_t i = 0; i < n_band; ++i)
+    diff_band_CH = std::max(diff_band_CH,
+			    std::abs(y_band[i] - y_band_CH[i]));
+  std::cout << "\n Solution from banded_cholesky_decomposition:\n";
+  matrix::print_matrix(y_band);
+  std::cout << "\n Difference between banded and dense Cholesky solutions: "
+	    << (diff_band_CH < 1.0e-12 ? "ok" : "FAIL") << '\n';
+
+  SB(3, 3) = -1.0;
+  try
+    {
+      matrix::banded_cholesky_decomp(SB);
+    }
+  catch (const std::logic_error& err)
+    {
+      std::cout << "\n Indefinite band matrix: " << err.what() << '\n';
+    }
+
+  // Batched solvers
+
+  std::cout << "\n Batched Solvers";
+  std::cout << "\n ---------------\n";
+
+  // A batch of perturbed copies of the input matrix in interleaved layout.
+  constexpr std::size_t n_batch = 37;
+  std::vector<double> A_batch(9 * n_batch), P_batch(n_batch);
+  std::vector<double> B_batch(3 * n_batch);
+  std::vector<std::size_t> I_batch(3 * n_batch);
+  for (std::size_t m = 0; m < n_batch; ++m)
+    {
+      for (std::size_t i = 0; i < 3; ++i)
+	{
+	  for (std::size_t j = 0; j < 3; ++j)
+	    A_batch[(i * 3 + j) * n_batch + m]
+	      = A_in[(i + m) % 3][j] + 0.01 * double(m * (i + 1));
+	  B_batch[i * n_batch + m] = double(i + 1);
+	}
+    }
+  const auto A_batch_in = A_batch;
+  matrix::lu_decomp_batch<3>(n_batch, A_batch.data(), I_batch.data(),
+			     P_batch.data());
+  matrix::lu_backsub_batch(3, n_batch, A_batch.data(), I_batch.data(),
+			   B_batch.data());
+
+  auto diff_batch = 0.0;
+  auto res_batch = 0.0;
+  for (std::size_t m = 0; m < n_batch; ++m)
+    {
+      double A_one[3][3];
+      for (std::size_t i = 0; i < 3; ++i)
+	for (std::size_t j = 0; j < 3; ++j)
+	  A_one[i][j] = A_batch_in[(i * 3 + j) * n_batch + m];
+      std::size_t index_one[3];
+      double parity_one;
+      matrix::lu_decomp(3, A_one, index_one, parity_one);
+      diff_batch = std::max(diff_batch,
+			    std::abs(parity_one - P_batch[m]));
+      for (std::size_t i = 0; i < 3; ++i)
+	{
+	  if (index_one[i] != I_batch[i * n_batch + m])
+	    diff_batch = 1.0;
+	  auto sum = -double(i + 1);
+	  for (std::size_t j = 0; j < 3; ++j)
+	    {
+	      diff_batch = std::max(diff_batch,
+		      std::abs(A_one[i][j] - A_batch[(i * 3 + j) * n_batch + m]));
+	      sum += A_batch_in[(i * 3 + j) * n_batch + m]
+		   * B_batch[j * n_batch + m];
+	    }
+	  res_batch = std::max(res_batch, std::abs(sum));
+	}
+    }
+  std::cout << "\n Difference between lu_decomp_batch and lu_decomp: "
+	    << diff_batch << '\n';
+  std::cout << "\n Maximum residual for lu_backsub_batch: "
+	    << (res_batch < 1.0e-12 ? "ok" : "FAIL") << '\n';
+
+  // A batch of symmetric positive definite matrices for Cholesky.
+  std::vector<double> C_batch(9 * n_batch), D_batch(3 * n_batch);
+  for (std::size_t m = 0; m < n_batch; ++m)
+    for (std::size_t i = 0; i < 3; ++i)
+      for (std::size_t j = 0; j < 3; ++j)
+	C_batch[(i * 3 + j) * n_batch + m]
+	  = (i == j ? 4.0 + 0.1 * double(m) : 1.0 / double(1 + i + j));
+  const auto C_batch_in = C_batch;
+  matrix::cholesky_decomp_batch(3, n_batch, C_batch.data(), D_batch.data());
+
+  auto diff_chol_batch = 0.0;
+  for (std::size_t m = 0; m < n_batch; ++m)
+    {
+      double C_one[3][3], D_one[3];
+      for (std::size_t i = 0; i < 3; ++i)
+	for (std::size_t j = 0; j < 3; ++j)
+	  C_one[i][j] = C_batch_in[(i * 3 + j) * n_batch + m];
+      matrix::cholesky_decomp(3, C_one, D_one);
+      for (std::size_t i = 0; i < 3; ++i)
+	{
+	  diff_chol_batch = std::max(diff_chol_batch,
+				std::abs(D_one[i] - D_batch[i * n_batch + m]));
+	  for (std::size_t j = 0; j < 3; ++j)
+	    diff_chol_batch = std::max(diff_chol_batch,
+		std::abs(C_one[i][j] - C_batch[(i * 3 + j) * n_batch + m]));
+	}
+    }
+  std::cout << "\n Difference between cholesky_decomp_batch and cholesky_decomp: "
+	    << diff_chol_batch << '\n';
+
+  // A batch of diagonally dominant tridiagonal systems.
+  constexpr std::size_t n_tri = 7;
+  std::vector<double> a_tri(n_tri * n_batch), b_tri(n_tri * n_batch);
+  std::vector<double> c_tri(n_tri * n_batch), r_tri(n_tri * n_batch);
+  std::vector<double> u_tri(n_tri * n_batch), u_tri_pool(n_tri * n_batch);
+  for (std::size_t i = 0; i < n_tri; ++i)
+    for (std::size_t m = 0; m < n_batch; ++m)
+      {
+	a_tri[i * n_batch + m] = -1.0 + 0.01 * double(m);
+	b_tri[i * n_batch + m] = 4.0 + 0.1 * double(i);
+	c_tri[i * n_batch + m] = -1.0 - 0.01 * double(i);
+	r_tri[i * n_batch + m] = double(i + m);
+      }
+  matrix::tridiagonal_batch(n_tri, n_batch, a_tri.data(), b_tri.data(),
+			    c_tri.data(), r_tri.data(), u_tri.data());
+  matrix::tridiagonal_batch(n_tri, n_batch, a_tri.data(), b_tri.data(),
+			    c_tri.data(), r_tri.data(), u_tri_pool.data(),
+			    pool);
+
+  auto diff_tri_batch = 0.0;
+  for (std::size_t m = 0; m < n_batch; ++m)
+    {
+      double a_one[n_tri], b_one[n_tri], c_one[n_tri], r_one[n_tri];
+      double u_one[n_tri];
+      for (std::size_t i = 0; i < n_tri; ++i)
+	{
+	  a_one[i] = a_tri[i * n_batch + m];
+	  b_one[i] = b_tri[i * n_batch + m];
+	  c_one[i] = c_tri[i * n_batch + m];
+	  r_one[i] = r_tri[i * n_batch + m];
+	}
+      matrix::tridiagonal(a_one, b_one, c_one, r_one, u_one, n_tri);
+      for (std::size_t i = 0; i < n_tri; ++i)
+	diff_tri_batch = std::max({diff_tri_batch,
+			  std::abs(u_one[i] - u_tri[i * n_batch + m]),
+			  std::abs(u_one[i] - u_tri_pool[i * n_batch + m])});
+    }
+  std::cout << "\n Difference between tridiagonal_batch and tridiagonal: "
+	    << diff_tri_batch << '\n';
+
+  // One large system split into blocks by tridiagonal_parallel.
+  constexpr std::size_t n_spike = 3 * 4096 + 5;
+  std::vector<double> a_spike(n_spike), b_spike(n_spike), c_spike(n_spike);
+  std::vector<double> r_spike(n_spike), u_spike(n_spike);
+  for (std::size_t i = 0; i < n_spike; ++i)
+    {
+      a_spike[i] = -1.0;
+      b_spike[i] = 3.0 + double(i % 5) / 5.0;
+      c_spike[i] = -1.0 + double(i % 3) / 10.0;
+      r_spike[i] = double(i % 11) - 5.0;
+    }
+  matrix::thread_pool pool_spike(2);
+  matrix::tridiagonal_parallel(a_spike.data(), b_spike.data(),
+			       c_spike.data(), r_spike.data(),
+			       u_spike.data(), n_spike, pool_spike);
+  auto res_spike = 0.0;
+  for (std::size_t i = 0; i < n_spike; ++i)
+    {
+      auto sum = b_spike[i] * u_spike[i] - r_spike[i];
+      if (i > 0)
+	sum += a_spike[i] * u_spike[i - 1];
+      if (i + 1 < n_spike)
+	sum += c_spike[i] * u_spike[i + 1];
+      res_spike = std::max(res_spike, std::abs(sum));
+    }
+  std::cout << "\n Maximum residual for tridiagonal_parallel: "
+	    << (res_spike < 1.0e-12 ? "ok" : "FAIL") << '\n';
+
+  // Sparse matrices
+
+  std::cout << "\n Sparse Matrices";
+  std::cout << "\n ---------------\n";
+
+  // Assemble a 4 * 5 matrix with a repeated entry.
+  matrix::coo_matrix<double> A_coo(4, 5);
+  A_coo.insert(2, 1, 3.0);
+  A_coo.insert(0, 0, 1.0);
+  A_coo.insert(3, 4, -2.0);
+  A_coo.insert(0, 3, 2.0);
+  A_coo.insert(2, 1, 1.5);
+  A_coo.insert(1, 2, 4.0);
+  A_coo.insert(3, 0, 5.0);
+
+  matrix::csr_matrix<double> A_csr(A_coo);
+  matrix::csc_matrix<double> A_csc(A_csr);
+  std::cout << "\n Number of nonzeros after summing repeats: "
+	    << A_csr.nnz() << '\n';
+  std::cout << "\n CSR row pointers:";
+  for (auto p : A_csr.row_ptr())
+    std::cout << ' ' << p;
+  std::cout << "\n CSC column pointers:";
+  for (auto p : A_csc.col_ptr())
+    std::cout << ' ' << p;
+  std::cout << '\n';
+
+  const std::vector<double> x_sp{1.0, 2.0, 3.0, 4.0, 5.0};
+  const std::vector<double> w_sp{1.0, -1.0, 2.0, -2.0};
+  const auto y_csr = A_csr * x_sp;
+  const auto y_csc = A_csc * x_sp;
+  const auto z_csr = A_csr.trans_mult(w_sp);
+  const auto z_csc = A_csc.trans_mult(w_sp);
+  std::cout << "\n A.x from CSR and CSC:\n";
+  for (std::size_t i = 0; i < 4; ++i)
+    std::cout << ' ' << std::setw(6) << y_csr[i];
+  std::cout << '\n';
+  for (std::size_t i = 0; i < 4; ++i)
+    std::cout << ' ' << std::setw(6) << y_csc[i];
+  std::cout << "\n\n A~.w from CSR and CSC:\n";
+  for (std::size_t j = 0; j < 5; ++j)
+    std::cout << ' ' << std::setw(6) << z_csr[j];
+  std::cout << '\n';
+  for (std::size_t j = 0; j < 5; ++j)
+    std::cout << ' ' << std::setw(6) << z_csc[j];
+  std::cout << '\n';
+
+  // A matrix large enough to be split across the pool.
+  constexpr std::size_t n_sp = 20000;
+  matrix::coo_matrix<double, unsigned> L_coo(n_sp, n_sp);
+  for (std::size_t i = 0; i < n_sp; ++i)
+    for (std::size_t k = 0; k < 1 + i % 7; ++k)
+      L_coo.insert(i, (i * 7919 + k * 104729) % n_sp, double(k + 1));
+  matrix::csr_matrix<double, unsigned> L_csr(L_coo);
+  matrix::csc_matrix<double, unsigned> L_csc(L_coo);
+  matrix::coo_matrix<double, unsigned> L_back(L_csc);
+  matrix::csr_matrix<double, unsigned> L_csr2(L_back);
+  std::vector<double> x_big(n_sp), y_one(n_sp), y_pool(n_sp), y_col(n_sp);
+  for (std::size_t i = 0; i < n_sp; ++i)
+    x_big[i] = double(i % 13) - 6.0;
+  matrix::thread_pool pool_sp(3), pool_none(0);
+  auto diff_sp = 0.0;
+  matrix::spmv(L_csr, x_big.data(), y_one.data(), pool_none);
+  matrix::spmv(L_csr, x_big.data(), y_pool.data(), pool_sp);
+  matrix::spmv(L_csc, x_big.data(), y_col.data(), pool_sp);
+  for (std::size_t i = 0; i < n_sp; ++i)
+    diff_sp = std::max({diff_sp, std::abs(y_one[i] - y_pool[i]),
+			std::abs(y_one[i] - y_col[i])});
+  matrix::spmv_trans(L_csc, x_big.data(), y_one.data(), pool_none);
+  matrix::spmv_trans(L_csc, x_big.data(), y_pool.data(), pool_sp);
+  matrix::spmv_trans(L_csr2, x_big.data(), y_col.data(), pool_sp);
+  for (std::size_t i = 0; i < n_sp; ++i)
+    diff_sp = std::max({diff_sp, std::abs(y_one[i] - y_pool[i]),
+			std::abs(y_one[i] - y_col[i])});
+  std::cout << "\n Difference between serial and threaded SpMV: "
+	    << (diff_sp < 1.0e-10 ? "ok" : "FAIL") << '\n';
+
+  std::cout << "\n Sparse Direct Solvers";
+  std::cout << "\n ---------------------\n";
+
+  // A 5 * 5 unsymmetric matrix with a zero on the diagonal.
+  matrix::coo_matrix<double> S_coo(5, 5);
+  const double S_dense[5][5]
+  {
+    { 0.0, 2.0, 0.0, 1.0, 0.0},
+    { 3.0, 1.0, 0.0, 0.0, 0.0},
+    { 0.0, 0.0, 4.0, 0.0, 1.0},
+    { 1.0, 0.0, 0.0, 5.0, 2.0},
+    { 0.0, 0.0, 1.0, 2.0, 6.0}
+  };
+  for (std::size_t i = 0; i < 5; ++i)
+    for (std::size_t j = 0; j < 5; ++j)
+      if (S_dense[i][j] != 0.0)
+	S_coo.insert(i, j, S_dense[i][j]);
+  matrix::csc_matrix<double> S_csc(S_coo);
+
+  std::vector<std::vector<double>> S_full(5, std::vector<double>(5));
+  for (std::size_t i = 0; i < 5; ++i)
+    std::copy_n(S_dense[i], 5, S_full[i].begin());
+  matrix::lu_decomposition<double, std::vector<std::vector<double>>>
+    S_dense_lu(5, S_full);
+
+  const std::vector<double> b_sd{1.0, 2.0, 3.0, 4.0, 5.0};
+  std::vector<double> x_sd(5), x_dense(5);
+  for (auto ord : {matrix::sparse_ordering::natural,
+		   matrix::sparse_ordering::amd,
+		   matrix::sparse_ordering::nested_dissection})
+    {
+      matrix::sparse_lu_decomposition<double> S_lu(S_csc, ord);
+      S_lu.backsubstitute(b_sd, x_sd);
+      S_dense_lu.backsubstitute(b_sd, x_dense);
+      auto diff_sd = 0.0;
+      for (std::size_t i = 0; i < 5; ++i)
+	diff_sd = std::max(diff_sd, std::abs(x_sd[i] - x_dense[i]));
+      std::cout << "\n Sparse LU against dense LU, ordering "
+		<< int(ord) << ": " << (diff_sd < 1.0e-12 ? "ok" : "FAIL");
+    }
+  std::cout << '\n';
+
+  std::cout << "\n Solution of the sparse LU system:\n";
+  for (std::size_t i = 0; i < 5; ++i)
+    std::cout << ' ' << std::setw(12) << x_sd[i];
+  std::cout << '\n';
+
+  // The five-point Laplacian on a 30 * 30 grid, lower triangle only.
+  constexpr std::size_t k_sd = 30, n_sd = k_sd * k_sd;
+  matrix::coo_matrix<double> P_coo(n_sd, n_sd);
+  for (std::size_t i = 0; i < k_sd; ++i)
+    for (std::size_t j = 0; j < k_sd; ++j)
+      {
+	const auto v = i * k_sd + j;
+	P_coo.insert(v, v, 4.0);
+	if (j > 0)
+	  P_coo.insert(v, v - 1, -1.0);
+	if (i > 0)
+	  P_coo.insert(v, v - k_sd, -1.0);
+      }
+  matrix::csc_matrix<double> P_csc(P_coo);
+
+  // One analysis serves any number of factorizations.
+  const matrix::sparse_symbolic P_sym(P_csc,
+			matrix::sparse_ordering::nested_dissection);
+  matrix::sparse_cholesky_decomposition<double> P_chol(P_csc, P_sym);
+  std::cout << "\n Supernodes of the Laplacian: "
+	    << (P_sym.num_supernodes() < n_sd ? "ok" : "FAIL");
+  std::cout << "\n Fill of the nested dissection ordering: "
+	    << (P_sym.factor_nnz() < 20 * n_sd ? "ok" : "FAIL");
+
+  // Refactor with a shifted diagonal and check the residual.
+  for (std::size_t j = 0; j < n_sd; ++j)
+    P_csc.values()[P_csc.col_ptr()[j]] += 1.0;
+  P_chol.refactor(P_csc);
+  std::vector<double> b_P(n_sd), x_P(n_sd);
+  for (std::size_t i = 0; i < n_sd; ++i)
+    b_P[i] = double(i % 7) - 3.0;
+  P_chol.backsubstitute(b_P, x_P);
+  auto res_P = 0.0;
+  for (std::size_t i = 0; i < k_sd; ++i)
+    for (std::size_t j = 0; j < k_sd; ++j)
+      {
+	const auto v = i * k_sd + j;
+	auto r = 5.0 * x_P[v] - b_P[v];
+	if (j > 0)
+	  r -= x_P[v - 1];
+	if (j + 1 < k_sd)
+	  r -= x_P[v + 1];
+	if (i > 0)
+	  r -= x_P[v - k_sd];
+	if (i + 1 < k_sd)
+	  r -= x_P[v + k_sd];
+	res_P = std::max(res_P, std::abs(r));
+      }
+  std::cout << "\n Residual of the refactored Cholesky solve: "
+	    << (res_P < 1.0e-12 ? "ok" : "FAIL") << '\n';
+
+  try
+    {
+      P_csc.values()[0] = -10.0;
+      P_chol.refactor(P_csc);
+      std::cout << "\n Indefinite matrix: FAIL\n";
+    }
+  catch (const std::logic_error& err)
+    {
+      std::cout << "\n Indefinite matrix: " << err.what() << '\n';
+    }
+
   return 0;
 }
@@ -1,5 +1,6 @@
 
 #include <ext/cmath>
+#include <tuple>
 #include <limits>
 #include <vector>
 #include <iostream>
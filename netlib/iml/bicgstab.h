@@ -7,6 +7,11 @@
 // BiCGSTAB follows the algorithm described on p. 27 of the 
 // SIAM Templates book.
 //
+// The workspace is allocated once.  Each vector update is one sweep
+// that also forms the norms and dot products that follow it: s with
+// norm(s), the two dot products of omega together, and x and r with
+// norm(r) and the next rho (see fused.h).
+//
 // The return value indicates convergence within max_iter (input)
 // iterations (0), or no convergence within max_iter iterations (1).
 //
@@ -19,64 +24,89 @@
 //  
 //*****************************************************************
 
+#include "fused.h"
 
 template < class Matrix, class Vector, class Preconditioner, class Real >
 int 
 BiCGSTAB(const Matrix &A, Vector &x, const Vector &b,
          const Preconditioner &M, int &max_iter, Real &tol)
 {
+  typedef VectorScalar<Vector> Scalar;
+
+  int n = b.size();
   Real resid;
-  Vector rho_1(1), rho_2(1), alpha(1), beta(1), omega(1);
-  Vector p, phat, s, shat, t, v;
+  Scalar rho_1, rho_2 = 0, alpha = 0, beta, omega = 0;
+  Scalar ss, ts, tt, rr;
+  Vector r(n), p(n), phat(n), s(n), shat(n), t(n), v(n);
 
   Real normb = norm(b);
-  Vector r = b - A * x;
-  Vector rtilde = r;
+  Real normr = Residual(A, x, b, r);
+  Vector rtilde(r);
 
   if (normb == 0.0)
     normb = 1;
   
-  if ((resid = norm(r) / normb) <= tol) {
+  if ((resid = normr / normb) <= tol) {
     tol = resid;
     max_iter = 0;
     return 0;
   }
 
+  rho_1 = dot(rtilde, r);
   for (int i = 1; i <= max_iter; i++) {
-    rho_1(0) = dot(rtilde, r);
-    if (rho_1(0) == 0) {
-      tol = norm(r) / normb;
+    if (rho_1 == 0) {
+      tol = resid;
       return 2;
     }
     if (i == 1)
       p = r;
     else {
-      beta(0) = (rho_1(0)/rho_2(0)) * (alpha(0)/omega(0));
-      p = r + beta(0) * (p - omega(0) * v);
+      beta = (rho_1/rho_2) * (alpha/omega);
+      for (int k = 0; k < n; k++)
+        p(k) = r(k) + beta * (p(k) - omega * v(k));
     }
-    phat = M.solve(p);
-    v = A * phat;
-    alpha(0) = rho_1(0) / dot(rtilde, v);
-    s = r - alpha(0) * v;
-    if ((resid = norm(s)/normb) < tol) {
-      x += alpha(0) * phat;
+    Solve(M, p, phat);
+    Mult(A, phat, v);
+    alpha = rho_1 / dot(rtilde, v);
+    ss = 0;
+    for (int k = 0; k < n; k++) {
+      s(k) = r(k) - alpha * v(k);
+      ss += s(k) * s(k);
+    }
+    if ((resid = sqrt(ss)/normb) < tol) {
+      for (int k = 0; k < n; k++)
+        x(k) += alpha * phat(k);
       tol = resid;
+      max_iter = i;
       return 0;
     }
-    shat = M.solve(s);
-    t = A * shat;
-    omega = dot(t,s) / dot(t,t);
-    x += alpha(0) * phat + omega(0) * shat;
-    r = s - omega(0) * t;
+    Solve(M, s, shat);
+    Mult(A, shat, t);
+    ts = 0;
+    tt = 0;
+    for (int k = 0; k < n; k++) {
+      ts += t(k) * s(k);
+      tt += t(k) * t(k);
+    }
+    omega = ts / tt;
+
+    rho_2 = rho_1;
+    rho_1 = 0;
+    rr = 0;
+    for (int k = 0; k < n; k++) {
+      x(k) += alpha * phat(k) + omega * shat(k);
+      r(k) = s(k) - omega * t(k);
+      rr += r(k) * r(k);
+      rho_1 += rtilde(k) * r(k);
+    }
 
-    rho_2(0) = rho_1(0);
-    if ((resid = norm(r) / normb) < tol) {
+    if ((resid = sqrt(rr) / normb) < tol) {
       tol = resid;
       max_iter = i;
       return 0;
     }
-    if (omega(0) == 0) {
-      tol = norm(r) / normb;
+    if (omega == 0) {
+      tol = resid;
       return 3;
     }
   }
@@ -7,6 +7,9 @@
 // CG follows the algorithm described on p. 15 in the 
 // SIAM Templates book.
 //
+// The workspace is allocated once; the updates of x and r and
+// the norm of r are computed in one sweep (see fused.h).
+//
 // The return value indicates convergence within max_iter (input)
 // iterations (0), or no convergence within max_iter iterations (1).
 //
@@ -19,54 +22,63 @@
 //  
 //*****************************************************************
 
+#include "fused.h"
+
 template < class Matrix, class Vector, class Preconditioner, class Real >
 int 
 CG(const Matrix &A, Vector &x, const Vector &b,
    const Preconditioner &M, int &max_iter, Real &tol)
 {
+  typedef VectorScalar<Vector> Scalar;
+
+  int n = b.size();
   Real resid;
-  Vector p, z, q;
-  Vector alpha(1), beta(1), rho(1), rho_1(1);
+  Vector r(n), p(n), z(n), q(n);
+  Scalar alpha, beta, rho, rho_1 = 0, rr;
 
   Real normb = norm(b);
-  Vector r = b - A*x;
+  Real normr = Residual(A, x, b, r);
 
   if (normb == 0.0) 
     normb = 1;
   
-  if ((resid = norm(r) / normb) <= tol) {
+  if ((resid = normr / normb) <= tol) {
     tol = resid;
     max_iter = 0;
     return 0;
   }
 
   for (int i = 1; i <= max_iter; i++) {
-    z = M.solve(r);
-    rho(0) = dot(r, z);
+    Solve(M, r, z);
+    rho = dot(r, z);
     
     if (i == 1)
       p = z;
     else {
-      beta(0) = rho(0) / rho_1(0);
-      p = z + beta(0) * p;
+      beta = rho / rho_1;
+      for (int k = 0; k < n; k++)
+        p(k) = z(k) + beta * p(k);
     }
     
-    q = A*p;
-    alpha(0) = rho(0) / dot(p, q);
+    Mult(A, p, q);
+    alpha = rho / dot(p, q);
     
-    x += alpha(0) * p;
-    r -= alpha(0) * q;
+    rr = 0;
+    for (int k = 0; k < n; k++) {
+      x(k) += alpha * p(k);
+      r(k) -= alpha * q(k);
+      rr += r(k) * r(k);
+    }
     
-    if ((resid = norm(r) / normb) <= tol) {
+    if ((resid = sqrt(rr) / normb) <= tol) {
       tol = resid;
       max_iter = i;
       return 0;     
     }
 
-    rho_1(0) = rho(0);
+    rho_1 = rho;
   }
   
   tol = resid;
   return 1;
 }
-
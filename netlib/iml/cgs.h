@@ -7,6 +7,10 @@
 // CGS follows the algorithm described on p. 26 of the 
 // SIAM Templates book.
 //
+// The workspace is allocated once.  u and p are updated in one sweep,
+// q and u + q in another, and x and r together with norm(r) and the
+// next rho in a third (see fused.h).
+//
 // The return value indicates convergence within max_iter (input)
 // iterations (0), or no convergence within max_iter iterations (1).
 //
@@ -19,52 +23,71 @@
 //  
 //*****************************************************************
 
+#include "fused.h"
+
 template < class Matrix, class Vector, class Preconditioner, class Real >
 int 
 CGS(const Matrix &A, Vector &x, const Vector &b,
     const Preconditioner &M, int &max_iter, Real &tol)
 {
+  typedef VectorScalar<Vector> Scalar;
+
+  int n = b.size();
   Real resid;
-  Vector rho_1(1), rho_2(1), alpha(1), beta(1);
-  Vector p, phat, q, qhat, vhat, u, uhat;
+  Scalar rho_1, rho_2 = 0, alpha, beta, rr;
+  Vector r(n), p(n), phat(n), q(n), qhat(n), vhat(n), u(n), uhat(n);
 
   Real normb = norm(b);
-  Vector r = b - A*x;
-  Vector rtilde = r;
+  Real normr = Residual(A, x, b, r);
+  Vector rtilde(r);
 
   if (normb == 0.0)
     normb = 1;
   
-  if ((resid = norm(r) / normb) <= tol) {
+  if ((resid = normr / normb) <= tol) {
     tol = resid;
     max_iter = 0;
     return 0;
   }
 
+  rho_1 = dot(rtilde, r);
   for (int i = 1; i <= max_iter; i++) {
-    rho_1(0) = dot(rtilde, r);
-    if (rho_1(0) == 0) {
-      tol = norm(r) / normb;
+    if (rho_1 == 0) {
+      tol = resid;
       return 2;
     }
     if (i == 1) {
       u = r;
       p = u;
     } else {
-      beta(0) = rho_1(0) / rho_2(0);
-      u = r + beta(0) * q;
-      p = u + beta(0) * (q + beta(0) * p);
+      beta = rho_1 / rho_2;
+      for (int k = 0; k < n; k++) {
+        u(k) = r(k) + beta * q(k);
+        p(k) = u(k) + beta * (q(k) + beta * p(k));
+      }
     }
-    phat = M.solve(p);
-    vhat = A*phat;
-    alpha(0) = rho_1(0) / dot(rtilde, vhat);
-    q = u - alpha(0) * vhat;
-    uhat = M.solve(u + q);
-    x += alpha(0) * uhat;
-    qhat = A * uhat;
-    r -= alpha(0) * qhat;
-    rho_2(0) = rho_1(0);
-    if ((resid = norm(r) / normb) < tol) {
+    Solve(M, p, phat);
+    Mult(A, phat, vhat);
+    alpha = rho_1 / dot(rtilde, vhat);
+
+    // u is not needed again this iteration: leave u + q in it.
+    for (int k = 0; k < n; k++) {
+      q(k) = u(k) - alpha * vhat(k);
+      u(k) += q(k);
+    }
+    Solve(M, u, uhat);
+    Mult(A, uhat, qhat);
+
+    rho_2 = rho_1;
+    rho_1 = 0;
+    rr = 0;
+    for (int k = 0; k < n; k++) {
+      x(k) += alpha * uhat(k);
+      r(k) -= alpha * qhat(k);
+      rr += r(k) * r(k);
+      rho_1 += rtilde(k) * r(k);
+    }
+    if ((resid = sqrt(rr) / normb) < tol) {
       tol = resid;
       max_iter = i;
       return 0;
@@ -74,4 +97,3 @@ CGS(const Matrix &A, Vector &x, const Vector &b,
   tol = resid;
   return 1;
 }
-
@@ -0,0 +1,145 @@
+//*****************************************************************
+// Iterative template routines -- workspace and fused kernels
+//
+// CG, CGS, BiCGSTAB, QMR and GMRES allocate all of their workspace
+// before the first iteration.  Every matrix-vector product and
+// preconditioner solve inside the iteration writes into that
+// workspace through the four routines below:
+//
+//      Mult(A, x, y)         y = A * x
+//      TransMult(A, x, y)    y = A.trans_mult(x)
+//      Solve(M, r, z)        z = M.solve(r)
+//      TransSolve(M, r, z)   z = M.trans_solve(r)
+//
+// The defaults call the usual IML interface and copy its result into
+// place, so they still build one temporary per call.  Overload them
+// for your own matrix and preconditioner types, e.g.
+//
+//   void Mult(const CompCol_Mat_double &A, const VECTOR_double &x,
+//             VECTOR_double &y);
+//
+// and the overload is found by argument-dependent lookup, making the
+// iterations free of heap allocation.
+//
+// The vector updates of each solver are written as single sweeps
+// over the elements, x(i), that also accumulate the norms and dot
+// products the next step needs, so a vector is read once per update
+// rather than once per operation.  The products are formed as in the
+// MV++ dot(): x(i) * y(i), without conjugation.
+//
+// The s-step methods gather the inner products of a block of s
+// vectors into one small Gram matrix, which GramCholesky() and
+// GramSolve() below factor and solve (real Scalar types only).
+//
+//*****************************************************************
+
+#ifndef IML_FUSED_H
+#define IML_FUSED_H
+
+#include <math.h>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+
+// The element type of Vector.
+template < class Vector >
+using VectorScalar =
+  typename std::decay<decltype(std::declval<const Vector &>()(0))>::type;
+
+
+template < class Matrix, class Vector >
+void
+Mult(const Matrix &A, const Vector &x, Vector &y)
+{
+  y = A * x;
+}
+
+
+template < class Matrix, class Vector >
+void
+TransMult(const Matrix &A, const Vector &x, Vector &y)
+{
+  y = A.trans_mult(x);
+}
+
+
+template < class Preconditioner, class Vector >
+void
+Solve(const Preconditioner &M, const Vector &r, Vector &z)
+{
+  z = M.solve(r);
+}
+
+
+template < class Preconditioner, class Vector >
+void
+TransSolve(const Preconditioner &M, const Vector &r, Vector &z)
+{
+  z = M.trans_solve(r);
+}
+
+
+// Form r = b - A * x in place and return norm(r).
+template < class Matrix, class Vector >
+VectorScalar<Vector>
+Residual(const Matrix &A, const Vector &x, const Vector &b, Vector &r)
+{
+  VectorScalar<Vector> rr = 0;
+  int n = b.size();
+
+  Mult(A, x, r);
+  for (int k = 0; k < n; k++) {
+    r(k) = b(k) - r(k);
+    rr += r(k) * r(k);
+  }
+  return sqrt(rr);
+}
+
+
+// Factor the leading k x k block of the symmetric matrix G, stored by
+// columns with leading dimension ld, as R^T R; R overwrites the upper
+// triangle of G.  The factorization stops at the first column that
+// depends on the ones before it to working accuracy, and returns the
+// number of columns factored.
+template < class Scalar >
+int
+GramCholesky(int k, Scalar *G, int ld)
+{
+  const Scalar eps = std::numeric_limits<Scalar>::epsilon();
+
+  for (int j = 0; j < k; j++) {
+    Scalar d = G[j + j*ld];
+    for (int i = 0; i < j; i++) {
+      Scalar t = G[i + j*ld];
+      for (int l = 0; l < i; l++)
+        t -= G[l + i*ld] * G[l + j*ld];
+      G[i + j*ld] = t / G[i + i*ld];
+      d -= G[i + j*ld] * G[i + j*ld];
+    }
+    if (!(d > eps * G[j + j*ld]))
+      return j;
+    G[j + j*ld] = sqrt(d);
+  }
+  return k;
+}
+
+
+// Solve R^T R y = y, with R from GramCholesky().
+template < class Scalar >
+void
+GramSolve(int k, const Scalar *R, int ld, Scalar *y)
+{
+  for (int i = 0; i < k; i++) {
+    for (int l = 0; l < i; l++)
+      y[i] -= R[l + i*ld] * y[l];
+    y[i] /= R[i + i*ld];
+  }
+  for (int i = k - 1; i >= 0; i--) {
+    for (int l = i + 1; l < k; l++)
+      y[i] -= R[i + l*ld] * y[l];
+    y[i] /= R[i + i*ld];
+  }
+}
+
+#endif
@@ -4,6 +4,11 @@
 // GMRES solves the unsymmetric linear system Ax = b using the 
 // Generalized Minimum Residual method
 //
+// The Krylov basis and the rest of the workspace are allocated once.
+// The modified Gram-Schmidt projections, the normalization of the new
+// basis vector and the update of x are each one sweep per vector
+// (see fused.h).
+//
 // GMRES follows the algorithm described on p. 20 of the 
 // SIAM Templates book.
 //
@@ -19,12 +24,18 @@
 //  
 //*****************************************************************
 
+#ifndef IML_GMRES_H
+#define IML_GMRES_H
+
+#include "fused.h"
+
 
 template < class Matrix, class Vector >
 void 
 Update(Vector &x, int k, Matrix &h, Vector &s, Vector v[])
 {
   Vector y(s);
+  int n = x.size();
 
   // Backsolve:  
   for (int i = k; i >= 0; i--) {
@@ -33,8 +44,13 @@ Update(Vector &x, int k, Matrix &h, Vector &s, Vector v[])
       y(j) -= h(j,i) * y(i);
   }
 
-  for (int j = 0; j <= k; j++)
-    x += v[j] * y(j);
+  // x += v[0] * y(0) + ... + v[k] * y(k) in one sweep over x.
+  for (int l = 0; l < n; l++) {
+    VectorScalar<Vector> t = 0;
+    for (int j = 0; j <= k; j++)
+      t += v[j](l) * y(j);
+    x(l) += t;
+  }
 }
 
 
@@ -46,6 +62,13 @@ abs(Real x)
 }
 
 
+template<class Real> 
+void GeneratePlaneRotation(Real &dx, Real &dy, Real &cs, Real &sn);
+
+template<class Real> 
+void ApplyPlaneRotation(Real &dx, Real &dy, Real &cs, Real &sn);
+
+
 template < class Operator, class Vector, class Preconditioner,
            class Matrix, class Real >
 int 
@@ -53,38 +76,61 @@ GMRES(const Operator &A, Vector &x, const Vector &b,
       const Preconditioner &M, Matrix &H, int &m, int &max_iter,
       Real &tol)
 {
+  typedef VectorScalar<Vector> Scalar;
+
   Real resid;
-  int i, j = 1, k;
-  Vector s(m+1), cs(m+1), sn(m+1), w;
+  int i, j = 1, k, l, n = b.size();
+  Scalar h, hn, scale;
+  Vector s(m+1), cs(m+1), sn(m+1), w(n), r(n), u(n);
   
-  Real normb = norm(M.solve(b));
-  Vector r = M.solve(b - A * x);
+  Solve(M, b, r);
+  Real normb = norm(r);
+  Residual(A, x, b, u);
+  Solve(M, u, r);
   Real beta = norm(r);
   
   if (normb == 0.0)
     normb = 1;
   
-  if ((resid = norm(r) / normb) <= tol) {
+  if ((resid = beta / normb) <= tol) {
     tol = resid;
     max_iter = 0;
     return 0;
   }
 
   Vector *v = new Vector[m+1];
+  for (k = 0; k <= m; k++)
+    v[k] = w;
 
   while (j <= max_iter) {
-    v[0] = r * (1.0 / beta);    // ??? r / beta
+    scale = 1.0 / beta;
+    for (l = 0; l < n; l++)
+      v[0](l) = scale * r(l);
     s = 0.0;
     s(0) = beta;
     
     for (i = 0; i < m && j <= max_iter; i++, j++) {
-      w = M.solve(A * v[i]);
+      Mult(A, v[i], u);
+      Solve(M, u, w);
+
+      // Modified Gram-Schmidt: each projection is removed in the
+      // sweep that forms the next dot product, the last one norm(w).
+      h = dot(w, v[0]);
       for (k = 0; k <= i; k++) {
-        H(k, i) = dot(w, v[k]);
-        w -= H(k, i) * v[k];
+        const Vector &vk = v[k];
+        const Vector &vn = k < i ? v[k+1] : w;
+        H(k, i) = h;
+        hn = 0;
+        for (l = 0; l < n; l++) {
+          w(l) -= h * vk(l);
+          hn += w(l) * vn(l);
+        }
+        h = hn;
       }
-      H(i+1, i) = norm(w);
-      v[i+1] = w * (1.0 / H(i+1, i)); // ??? w / H(i+1, i)
+      H(i+1, i) = sqrt(h);
+      scale = 1.0 / H(i+1, i);
+      for (l = 0; l < n; l++)
+        v[i+1](l) = scale * w(l);
 
       for (k = 0; k < i; k++)
         ApplyPlaneRotation(H(k,i), H(k+1,i), cs(k), sn(k));
@@ -102,7 +148,8 @@ GMRES(const Operator &A, Vector &x, const Vector &b,
       }
     }
     Update(x, m - 1, H, s, v);
-    r = M.solve(b - A * x);
+    Residual(A, x, b, u);
+    Solve(M, u, r);
     beta = norm(r);
     if ((resid = beta / normb) < tol) {
       tol = resid;
@@ -147,3 +194,4 @@ void ApplyPlaneRotation(Real &dx, Real &dy, Real &cs, Real &sn)
   dx = temp;
 }
 
+#endif
@@ -0,0 +1,118 @@
+//*****************************************************************
+// Iterative template routine -- PipeCG
+//
+// PipeCG solves the symmetric positive definite linear
+// system Ax=b using the pipelined Conjugate Gradient method.
+//
+// PipeCG follows Algorithm 4 (preconditioned pipelined CG) of
+// P. Ghysels and W. Vanroose, "Hiding global synchronization
+// latency in the preconditioned Conjugate Gradient algorithm",
+// Parallel Computing 40 (2014).
+//
+// CG forms dot(r,z), dot(p,q) and norm(r) per iteration, and each
+// has to wait for the preconditioner or the matrix-vector product
+// before it.  PipeCG also carries w = A u, with u = M r, and the
+// recurrences for s = A p, q = M s and z = A q, so that the three
+// scalars an iteration needs, (r,u), (w,u) and (r,r), are a single
+// reduction accumulated in the sweep that updates the vectors (see
+// fused.h).  Its result is not used until after the next Solve and
+// Mult, which do not depend on it, so vectors distributed across
+// processes can overlap the reduction with them.
+//
+// It needs five more vectors than CG, and since r is updated through
+// longer recurrences, b - Ax may drift further from r at tolerances
+// near the attainable accuracy.
+//
+// The return value indicates convergence within max_iter (input)
+// iterations (0), or no convergence within max_iter iterations (1).
+//
+// Upon successful return, output arguments have the following values:
+//
+//        x  --  approximate solution to Ax = b
+// max_iter  --  the number of iterations performed before the
+//               tolerance was reached
+//      tol  --  the residual after the final iteration
+//
+//*****************************************************************
+
+#include "fused.h"
+
+template < class Matrix, class Vector, class Preconditioner, class Real >
+int
+PipeCG(const Matrix &A, Vector &x, const Vector &b,
+       const Preconditioner &M, int &max_iter, Real &tol)
+{
+  typedef VectorScalar<Vector> Scalar;
+
+  int n = b.size();
+  Real resid;
+  Vector r(n), u(n), w(n), mw(n), amw(n), z(n), q(n), s(n), p(n);
+  Scalar alpha = 0, beta, gamma, gamma_1, delta, rr;
+
+  Real normb = norm(b);
+  Real normr = Residual(A, x, b, r);
+
+  if (normb == 0.0)
+    normb = 1;
+
+  if ((resid = normr / normb) <= tol) {
+    tol = resid;
+    max_iter = 0;
+    return 0;
+  }
+
+  Solve(M, r, u);
+  Mult(A, u, w);
+  gamma = 0;
+  delta = 0;
+  for (int k = 0; k < n; k++) {
+    gamma += r(k) * u(k);
+    delta += w(k) * u(k);
+  }
+
+  // beta is 0 in the first iteration: z, q, s and p start from 0.
+  z = 0.0;
+  q = 0.0;
+  s = 0.0;
+  p = 0.0;
+
+  for (int i = 1; i <= max_iter; i++) {
+    Solve(M, w, mw);
+    Mult(A, mw, amw);
+
+    if (i == 1) {
+      beta = 0;
+      alpha = gamma / delta;
+    } else {
+      beta = gamma / gamma_1;
+      alpha = gamma / (delta - beta * gamma / alpha);
+    }
+
+    gamma_1 = gamma;
+    gamma = 0;
+    delta = 0;
+    rr = 0;
+    for (int k = 0; k < n; k++) {
+      z(k) = amw(k) + beta * z(k);
+      q(k) = mw(k) + beta * q(k);
+      s(k) = w(k) + beta * s(k);
+      p(k) = u(k) + beta * p(k);
+      x(k) += alpha * p(k);
+      r(k) -= alpha * s(k);
+      u(k) -= alpha * q(k);
+      w(k) -= alpha * z(k);
+      gamma += r(k) * u(k);
+      delta += w(k) * u(k);
+      rr += r(k) * r(k);
+    }
+
+    if ((resid = sqrt(rr) / normb) <= tol) {
+      tol = resid;
+      max_iter = i;
+      return 0;
+    }
+  }
+
+  tol = resid;
+  return 1;
+}
@@ -5,6 +5,10 @@
 // Quasi-Minimal Residual method following the algorithm as described
 // on p. 24 in the SIAM Templates book.
 //
+// The workspace is allocated once.  The scaling of v, y, w and z and
+// delta are one sweep, p and q another, and d, s, x and r with norm(r)
+// a third (see fused.h).
+//
 //   -------------------------------------------------------------
 //   return value     indicates
 //   ------------     ---------------------
@@ -31,118 +35,134 @@
 
 #include <math.h>
 
+#include "fused.h"
+
 template < class Matrix, class Vector, class Preconditioner1,
            class Preconditioner2, class Real >
 int 
 QMR(const Matrix &A, Vector &x, const Vector &b, const Preconditioner1 &M1, 
     const Preconditioner2 &M2, int &max_iter, Real &tol)
 {
+  typedef VectorScalar<Vector> Scalar;
+
+  int n = b.size();
   Real resid;
 
-  Vector rho(1), rho_1(1), xi(1), gamma(1), gamma_1(1), theta(1), theta_1(1);
-  Vector eta(1), delta(1), ep(1), beta(1);
+  Scalar rho, rho_1, xi, gamma, gamma_1, theta, theta_1;
+  Scalar eta, delta, ep = 0, beta, c, rr;
 
-  Vector r, v_tld, y, w_tld, z;
-  Vector v, w, y_tld, z_tld;
-  Vector p, q, p_tld, d, s;
+  Vector r(n), v_tld(n), y(n), w_tld(n), z(n);
+  Vector v(n), w(n), y_tld(n), z_tld(n);
+  Vector p(n), q(n), p_tld(n), d(n), s(n);
 
   Real normb = norm(b);
-
-  r = b - A * x;
+  Real normr = Residual(A, x, b, r);
 
   if (normb == 0.0)
     normb = 1;
 
-  if ((resid = norm(r) / normb) <= tol) {
+  if ((resid = normr / normb) <= tol) {
     tol = resid;
     max_iter = 0;
     return 0;
   }
 
   v_tld = r;
-  y = M1.solve(v_tld);
-  rho(0) = norm(y);
+  Solve(M1, v_tld, y);
+  rho = norm(y);
 
   w_tld = r;
-  z = M2.trans_solve(w_tld);
-  xi(0) = norm(z);
+  TransSolve(M2, w_tld, z);
+  xi = norm(z);
+
+  gamma = 1.0;
+  eta = -1.0;
+  theta = 0.0;
 
-  gamma(0) = 1.0;
-  eta(0) = -1.0;
-  theta(0) = 0.0;
+  // The first d and s are eta * p and eta * p_tld.
+  d = 0.0;
+  s = 0.0;
 
   for (int i = 1; i <= max_iter; i++) {
 
-    if (rho(0) == 0.0)
+    if (rho == 0.0)
       return 2;                        // return on breakdown
 
-    if (xi(0) == 0.0)
+    if (xi == 0.0)
       return 7;                        // return on breakdown
 
-    v = (1. / rho(0)) * v_tld;
-    y = (1. / rho(0)) * y;
-
-    w = (1. / xi(0)) * w_tld;
-    z = (1. / xi(0)) * z;
-
-    delta(0) = dot(z, y);
-    if (delta(0) == 0.0)
+    Scalar rrho = 1. / rho, rxi = 1. / xi;
+    delta = 0;
+    for (int k = 0; k < n; k++) {
+      v(k) = rrho * v_tld(k);
+      y(k) *= rrho;
+      w(k) = rxi * w_tld(k);
+      z(k) *= rxi;
+      delta += z(k) * y(k);
+    }
+    if (delta == 0.0)
       return 5;                        // return on breakdown
 
-    y_tld = M2.solve(y);               // apply preconditioners
-    z_tld = M1.trans_solve(z);
+    Solve(M2, y, y_tld);               // apply preconditioners
+    TransSolve(M1, z, z_tld);
 
     if (i > 1) {
-      p = y_tld - (xi(0) * delta(0) / ep(0)) * p;
-      q = z_tld - (rho(0) * delta(0) / ep(0)) * q;
+      Scalar cp = xi * delta / ep, cq = rho * delta / ep;
+      for (int k = 0; k < n; k++) {
+        p(k) = y_tld(k) - cp * p(k);
+        q(k) = z_tld(k) - cq * q(k);
+      }
     } else {
       p = y_tld;
       q = z_tld;
     }
 
-    p_tld = A * p;
-    ep(0) = dot(q, p_tld);
-    if (ep(0) == 0.0)
+    Mult(A, p, p_tld);
+    ep = dot(q, p_tld);
+    if (ep == 0.0)
       return 6;                        // return on breakdown
 
-    beta(0) = ep(0) / delta(0);
-    if (beta(0) == 0.0)
+    beta = ep / delta;
+    if (beta == 0.0)
       return 3;                        // return on breakdown
 
-    v_tld = p_tld - beta(0) * v;
-    y = M1.solve(v_tld);
+    for (int k = 0; k < n; k++)
+      v_tld(k) = p_tld(k) - beta * v(k);
+    Solve(M1, v_tld, y);
 
-    rho_1(0) = rho(0);
-    rho(0) = norm(y);
-    w_tld = A.trans_mult(q) - beta(0) * w;
-    z = M2.trans_solve(w_tld);
+    rho_1 = rho;
+    rho = norm(y);
+    TransMult(A, q, w_tld);
+    for (int k = 0; k < n; k++)
+      w_tld(k) -= beta * w(k);
+    TransSolve(M2, w_tld, z);
 
-    xi(0) = norm(z);
+    xi = norm(z);
 
-    gamma_1(0) = gamma(0);
-    theta_1(0) = theta(0);
+    gamma_1 = gamma;
+    theta_1 = theta;
 
-    theta(0) = rho(0) / (gamma_1(0) * beta(0));
-    gamma(0) = 1.0 / sqrt(1.0 + theta(0) * theta(0));
+    theta = rho / (gamma_1 * beta);
+    gamma = 1.0 / sqrt(1.0 + theta * theta);
 
-    if (gamma(0) == 0.0)
+    if (gamma == 0.0)
       return 4;                        // return on breakdown
 
-    eta(0) = -eta(0) * rho_1(0) * gamma(0) * gamma(0) / 
-      (beta(0) * gamma_1(0) * gamma_1(0));
-
-    if (i > 1) {
-      d = eta(0) * p + (theta_1(0) * theta_1(0) * gamma(0) * gamma(0)) * d;
-      s = eta(0) * p_tld + (theta_1(0) * theta_1(0) * gamma(0) * gamma(0)) * s;
-    } else {
-      d = eta(0) * p;
-      s = eta(0) * p_tld;
+    eta = -eta * rho_1 * gamma * gamma /
+      (beta * gamma_1 * gamma_1);
+
+    // Update d and s, the approximation vector and the residual.
+    c = theta_1 * theta_1 * gamma * gamma;
+    rr = 0;
+    for (int k = 0; k < n; k++) {
+      d(k) = eta * p(k) + c * d(k);
+      s(k) = eta * p_tld(k) + c * s(k);
+      x(k) += d(k);
+      r(k) -= s(k);
+      rr += r(k) * r(k);
     }
 
-    x += d;                            // update approximation vector
-    r -= s;                            // compute residual
-
-    if ((resid = norm(r) / normb) <= tol) {
+    if ((resid = sqrt(rr) / normb) <= tol) {
       tol = resid;
       max_iter = i;
       return 0;
@@ -0,0 +1,193 @@
+//*****************************************************************
+// Iterative template routine -- SStepCG
+//
+// SStepCG solves the symmetric positive definite linear
+// system Ax=b using the s-step Conjugate Gradient method.
+//
+// SStepCG follows A.T. Chronopoulos and C.W. Gear, "s-step iterative
+// methods for symmetric linear systems", J. Comput. Appl. Math. 25
+// (1989), with the preconditioner applied to the basis.  Each outer
+// step takes s CG steps at once:
+//
+//   R  = [ M r, (M A) M r, ..., (M A)^(s-1) M r ]   (s Solves, s Mults)
+//   P  = R + P_1 B,   B = -(P_1^T A P_1)^-1 (A P_1)^T R
+//   x += P a,   r -= A P a,   a = (P^T A P)^-1 R^T r
+//
+// where P_1 holds the directions of the previous step.  The inner
+// products R^T A R, (A P_1)^T R, R^T r and norm(r) that this needs
+// are gathered in one sweep over the vectors, a single reduction per
+// s steps in place of CG's 3 s; P, A P, x and r are updated in a
+// second sweep (see fused.h).  With s = 1 this is CG.
+//
+// The basis is the monomial one, which becomes ill-conditioned as s
+// grows: for s up to about 4 the iterates stay close to those of CG,
+// at the cost of a few more iterations, and beyond that convergence
+// slows markedly.  A direction that depends on the ones before it to
+// working accuracy ends the step early.  s less than 1 is taken as 1.
+//
+// The return value indicates convergence within max_iter (input)
+// iterations (0), no convergence within max_iter iterations (1), or
+// breakdown (2), when P^T A P is not positive definite.
+//
+// Upon successful return, output arguments have the following values:
+//
+//        x  --  approximate solution to Ax = b
+// max_iter  --  the number of iterations (single steps, s per outer
+//               step) performed before the tolerance was reached
+//      tol  --  the residual after the final iteration
+//
+//*****************************************************************
+
+#include "fused.h"
+
+template < class Matrix, class Vector, class Preconditioner, class Real >
+int
+SStepCG(const Matrix &A, Vector &x, const Vector &b,
+        const Preconditioner &M, int s, int &max_iter, Real &tol)
+{
+  typedef VectorScalar<Vector> Scalar;
+
+  int i = 0, j, jj, k, kp = 0, l, n = b.size();
+  Real resid;
+  Scalar rr;
+  Vector r(n);
+
+  if (s < 1)
+    s = 1;
+
+  Real normb = norm(b);
+  Real normr = Residual(A, x, b, r);
+
+  if (normb == 0.0)
+    normb = 1;
+
+  if ((resid = normr / normb) <= tol) {
+    tol = resid;
+    max_iter = 0;
+    return 0;
+  }
+
+  Vector *R = new Vector[s], *AR = new Vector[s];
+  Vector *P = new Vector[s], *AP = new Vector[s];
+  for (j = 0; j < s; j++) {
+    R[j] = r;
+    AR[j] = r;
+    P[j] = r;
+    AP[j] = r;
+  }
+
+  // s x s matrices, by columns: W = P^T A P (then its factor), the
+  // factor of P_1^T A P_1, C = (A P_1)^T R and D = B; g = R^T r, and
+  // a row of P and A P.
+  Scalar *W = new Scalar[s*s], *W_1 = new Scalar[s*s];
+  Scalar *C = new Scalar[s*s], *D = new Scalar[s*s];
+  Scalar *g = new Scalar[s], *pl = new Scalar[s], *apl = new Scalar[s];
+  int ret = 1;
+
+  while (i < max_iter) {
+    k = s < max_iter - i ? s : max_iter - i;
+
+    Solve(M, r, R[0]);
+    for (j = 0; j < k; j++) {
+      Mult(A, R[j], AR[j]);
+      if (j + 1 < k)
+        Solve(M, AR[j], R[j+1]);
+    }
+
+    // The one reduction: W = R^T A R, C = (A P_1)^T R, g = R^T r.
+    for (j = 0; j < k; j++) {
+      g[j] = 0;
+      for (jj = 0; jj < k; jj++)
+        W[jj + j*s] = 0;
+      for (jj = 0; jj < kp; jj++)
+        C[jj + j*s] = 0;
+    }
+    rr = 0;
+    for (l = 0; l < n; l++) {
+      for (j = 0; j < k; j++) {
+        Scalar rj = R[j](l);
+        g[j] += rj * r(l);
+        for (jj = 0; jj <= j; jj++)
+          W[jj + j*s] += R[jj](l) * AR[j](l);
+        for (jj = 0; jj < kp; jj++)
+          C[jj + j*s] += AP[jj](l) * rj;
+      }
+      rr += r(l) * r(l);
+    }
+
+    if ((resid = sqrt(rr) / normb) <= tol) {
+      tol = resid;
+      max_iter = i;
+      ret = 0;
+      break;
+    }
+
+    // B = -(P_1^T A P_1)^-1 C and P^T A P = R^T A R + C^T B.
+    for (j = 0; j < k; j++) {
+      for (jj = 0; jj < kp; jj++)
+        D[jj + j*s] = -C[jj + j*s];
+      GramSolve(kp, W_1, s, D + j*s);
+      for (jj = 0; jj <= j; jj++)
+        for (l = 0; l < kp; l++)
+          W[jj + j*s] += C[l + jj*s] * D[l + j*s];
+    }
+
+    k = GramCholesky(k, W, s);
+    if (k == 0) {
+      tol = resid;
+      max_iter = i;
+      ret = 2;
+      break;
+    }
+    GramSolve(k, W, s, g);
+
+    // P = R + P_1 B, A P = A R + A P_1 B, x += P g, r -= A P g.
+    for (l = 0; l < n; l++) {
+      Scalar dx = 0, dr = 0;
+      for (j = 0; j < k; j++) {
+        pl[j] = R[j](l);
+        apl[j] = AR[j](l);
+        for (jj = 0; jj < kp; jj++) {
+          pl[j] += P[jj](l) * D[jj + j*s];
+          apl[j] += AP[jj](l) * D[jj + j*s];
+        }
+        dx += pl[j] * g[j];
+        dr += apl[j] * g[j];
+      }
+      for (j = 0; j < k; j++) {
+        P[j](l) = pl[j];
+        AP[j](l) = apl[j];
+      }
+      x(l) += dx;
+      r(l) -= dr;
+    }
+
+    for (j = 0; j < k; j++)
+      for (jj = 0; jj <= j; jj++)
+        W_1[jj + j*s] = W[jj + j*s];
+    kp = k;
+    i += k;
+  }
+
+  if (ret == 1) {
+    resid = norm(r) / normb;
+    if (resid <= tol) {
+      ret = 0;
+      max_iter = i;
+    }
+    tol = resid;
+  }
+
+  delete [] R;
+  delete [] AR;
+  delete [] P;
+  delete [] AP;
+  delete [] W;
+  delete [] W_1;
+  delete [] C;
+  delete [] D;
+  delete [] g;
+  delete [] pl;
+  delete [] apl;
+  return ret;
+}
@@ -0,0 +1,252 @@
+//*****************************************************************
+// Iterative template routine -- SStepGMRES
+//
+// SStepGMRES solves the unsymmetric linear system Ax = b using the
+// s-step (communication-avoiding) Generalized Minimum Residual method
+//
+// SStepGMRES computes the same iterates as GMRES (see gmres.h), but
+// extends the Krylov basis s vectors at a time.  From the last basis
+// vector v it forms the monomial basis
+//
+//   Z = [ (M A) v, (M A)^2 v, ..., (M A)^s v ]      (s Mults, s Solves)
+//
+// orthogonalizes Z against the basis V by block Gram-Schmidt in two
+// passes, the second fused with the inner products Z^T Z, and gets
+// the s new basis vectors and their Hessenberg columns from the
+// Cholesky factor of the Gram matrix.  That is two reductions per s
+// steps where modified Gram-Schmidt in GMRES has j + 2 in step j;
+// every other update is one sweep per vector (see fused.h).
+//
+// The monomial basis becomes ill-conditioned as s grows; with the
+// second pass, s up to about 8 gives the iterates of GMRES.  A vector
+// of Z that depends on the ones before it to working accuracy ends
+// the block early.
+//
+// m is the restart length, as in GMRES, and s the block length; s
+// less than 1 is taken as 1, and s is cut to m where it exceeds it.
+//
+// The return value indicates convergence within max_iter (input)
+// iterations (0), or no convergence within max_iter iterations (1).
+//
+// Upon successful return, output arguments have the following values:
+//
+//        x  --  approximate solution to Ax = b
+// max_iter  --  the number of iterations performed before the
+//               tolerance was reached
+//      tol  --  the residual after the final iteration
+//
+//*****************************************************************
+
+#include "fused.h"
+#include "gmres.h"
+
+
+template < class Operator, class Vector, class Preconditioner,
+           class Matrix, class Real >
+int
+SStepGMRES(const Operator &A, Vector &x, const Vector &b,
+           const Preconditioner &M, Matrix &H, int &m, int s,
+           int &max_iter, Real &tol)
+{
+  typedef VectorScalar<Vector> Scalar;
+
+  Real resid;
+  int c, i, j = 1, k, kc, l, t, tt, n = b.size(), ld = m + 1;
+  Scalar scale;
+  Vector g(m+1), cs(m+1), sn(m+1), w(n), r(n), u(n);
+
+  if (s > m)
+    s = m;
+  if (s < 1)
+    s = 1;
+
+  Solve(M, b, r);
+  Real normb = norm(r);
+  Residual(A, x, b, u);
+  Solve(M, u, r);
+  Real beta = norm(r);
+
+  if (normb == 0.0)
+    normb = 1;
+
+  if ((resid = beta / normb) <= tol) {
+    tol = resid;
+    max_iter = 0;
+    return 0;
+  }
+
+  Vector *v = new Vector[m+1], *z = new Vector[s];
+  for (k = 0; k <= m; k++)
+    v[k] = w;
+  for (k = 0; k < s; k++)
+    z[k] = w;
+
+  // By columns: the Hessenberg matrix before the plane rotations,
+  // V^T Z in two parts, and the Gram matrix of Z with its factor R;
+  // zl is a row of Z.
+  Scalar *hh = new Scalar[ld*m];
+  Scalar *C = new Scalar[ld*s], *C2 = new Scalar[ld*s];
+  Scalar *G = new Scalar[s*s], *zl = new Scalar[s];
+
+  while (j <= max_iter) {
+    scale = 1.0 / beta;
+    for (l = 0; l < n; l++)
+      v[0](l) = scale * r(l);
+    g = 0.0;
+    g(0) = beta;
+
+    for (i = 0; i < m && j <= max_iter; ) {
+      k = s;
+      if (k > m - i)
+        k = m - i;
+      if (k > max_iter - j + 1)
+        k = max_iter - j + 1;
+
+      Mult(A, v[i], u);
+      Solve(M, u, z[0]);
+      for (t = 1; t < k; t++) {
+        Mult(A, z[t-1], u);
+        Solve(M, u, z[t]);
+      }
+
+      // First pass: C = V^T Z.
+      for (t = 0; t < k; t++)
+        for (c = 0; c <= i; c++)
+          C[c + t*ld] = 0;
+      for (l = 0; l < n; l++)
+        for (c = 0; c <= i; c++) {
+          Scalar vl = v[c](l);
+          for (t = 0; t < k; t++)
+            C[c + t*ld] += vl * z[t](l);
+        }
+
+      // Second pass: Z -= V C, and C2 = V^T Z, G = Z^T Z in the
+      // same sweep.
+      for (t = 0; t < k; t++) {
+        for (c = 0; c <= i; c++)
+          C2[c + t*ld] = 0;
+        for (tt = 0; tt <= t; tt++)
+          G[tt + t*s] = 0;
+      }
+      for (l = 0; l < n; l++) {
+        for (t = 0; t < k; t++) {
+          Scalar zt = z[t](l);
+          for (c = 0; c <= i; c++)
+            zt -= v[c](l) * C[c + t*ld];
+          z[t](l) = zl[t] = zt;
+          for (tt = 0; tt <= t; tt++)
+            G[tt + t*s] += zl[tt] * zt;
+        }
+        for (c = 0; c <= i; c++) {
+          Scalar vl = v[c](l);
+          for (t = 0; t < k; t++)
+            C2[c + t*ld] += vl * zl[t];
+        }
+      }
+
+      // Z = V C + Q R, with Q the next basis vectors: C += C2, and
+      // R^T R = G - C2^T C2, the Gram matrix of Z - V C2.
+      for (t = 0; t < k; t++) {
+        for (c = 0; c <= i; c++)
+          C[c + t*ld] += C2[c + t*ld];
+        for (tt = 0; tt <= t; tt++)
+          for (c = 0; c <= i; c++)
+            G[tt + t*s] -= C2[c + tt*ld] * C2[c + t*ld];
+      }
+      kc = GramCholesky(k, G, s);
+
+      // v[i+1 .. i+kc] = (Z - V C2) R^-1, in one sweep.
+      for (l = 0; l < n; l++)
+        for (t = 0; t < kc; t++) {
+          Scalar zt = z[t](l);
+          for (c = 0; c <= i; c++)
+            zt -= v[c](l) * C2[c + t*ld];
+          for (tt = 0; tt < t; tt++)
+            zt -= zl[tt] * G[tt + t*s];
+          v[i+1+t](l) = zl[t] = zt / G[t + t*s];
+        }
+
+      // Columns i .. i+kc-1 of the Hessenberg matrix.  (M A) v[i] is
+      // Z's first column; for t > 0, (M A) v[i+t] follows from
+      // v[i+t] = (z_t-1 - V C(:,t-1) - Q R(0:t-2,t-1)) / R(t-1,t-1) and
+      // the columns before it.  If kc is 0, (M A) v[i] lies in the
+      // span of V to working accuracy: take its column, and restart.
+      for (t = 0; t < (kc > 0 ? kc : 1); t++) {
+        Scalar *h = hh + (i + t) * ld;
+        for (c = 0; c <= i + t + 1; c++)
+          h[c] = 0;
+        for (c = 0; c <= i; c++)
+          h[c] = C[c + t*ld];
+        for (tt = 0; tt <= t && tt < kc; tt++)
+          h[i+1+tt] = G[tt + t*s];
+        if (t > 0) {
+          for (c = 0; c <= i; c++)
+            for (l = 0; l <= c + 1; l++)
+              h[l] -= hh[l + c*ld] * C[c + (t-1)*ld];
+          for (tt = 0; tt < t - 1; tt++)
+            for (l = 0; l <= i + tt + 2; l++)
+              h[l] -= hh[l + (i+1+tt)*ld] * G[tt + (t-1)*s];
+          for (l = 0; l <= i + t + 1; l++)
+            h[l] /= G[(t-1) + (t-1)*s];
+        }
+
+        // Rotate the new column and test the residual, as in GMRES.
+        c = i + t;
+        for (l = 0; l <= c + 1; l++)
+          H(l, c) = h[l];
+        for (l = 0; l < c; l++)
+          ApplyPlaneRotation(H(l,c), H(l+1,c), cs(l), sn(l));
+
+        GeneratePlaneRotation(H(c,c), H(c+1,c), cs(c), sn(c));
+        ApplyPlaneRotation(H(c,c), H(c+1,c), cs(c), sn(c));
+        ApplyPlaneRotation(g(c), g(c+1), cs(c), sn(c));
+
+        if (kc > 0 && (resid = abs(g(c+1)) / normb) < tol) {
+          Update(x, c, H, g, v);
+          tol = resid;
+          max_iter = j;
+          delete [] v;
+          delete [] z;
+          delete [] hh;
+          delete [] C;
+          delete [] C2;
+          delete [] G;
+          delete [] zl;
+          return 0;
+        }
+        j++;
+      }
+      if (kc == 0) {
+        i++;
+        break;
+      }
+      i += kc;
+    }
+    Update(x, i - 1, H, g, v);
+    Residual(A, x, b, u);
+    Solve(M, u, r);
+    beta = norm(r);
+    if ((resid = beta / normb) < tol) {
+      tol = resid;
+      max_iter = j;
+      delete [] v;
+      delete [] z;
+      delete [] hh;
+      delete [] C;
+      delete [] C2;
+      delete [] G;
+      delete [] zl;
+      return 0;
+    }
+  }
+
+  tol = resid;
+  delete [] v;
+  delete [] z;
+  delete [] hh;
+  delete [] C;
+  delete [] C2;
+  delete [] G;
+  delete [] zl;
+  return 1;
+}
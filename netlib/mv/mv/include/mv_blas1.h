@@ -6,78 +6,18 @@
 #ifndef _MV_BLAS1_H_
 #define _MV_BLAS1_H_
 
+#include "mv_blas1_kernel.h"
 
 
 template <class TYPE>
 MV_Vector<TYPE>& operator*=(MV_Vector<TYPE> &x, const TYPE &a)
 {
       int N = x.size();
-      for (int i=0;i<N;i++)
-         x(i) *= a;
+      if (N > 0)
+         MV_blas1_scal(N, a, &x(0));
       return x;
 }
 
-template <class TYPE>
-MV_Vector<TYPE> operator*(const TYPE &a, const MV_Vector<TYPE> &x)
-{
-      int N = x.size();
-      MV_Vector<TYPE> result(N);
-      for (int i=0;i<N;i++)
-         result(i) = x(i)*a;
-      return result;
-}
-
-template <class TYPE>
-MV_Vector<TYPE> operator*(const MV_Vector<TYPE> &x, const TYPE &a)
-{
-    // This is the other commutative case of vector*scalar.
-    // It should be just defined to be
-    // "return operator*(a,x);"
-    // but some compilers (e.g. Turbo C++ v.3.0) have trouble
-    // determining the proper template match.  For the moment,
-    // we'll just duplicate the code in the scalar * MV_Vector 
-    // case above.
-
-      int N = x.size();
-      MV_Vector<TYPE> result(N);
-      for (int i=0;i<N;i++)
-         result(i) = x(i)*a;
-      return result;
-
-}
-
-template <class TYPE>
-MV_Vector<TYPE> operator+(const MV_Vector<TYPE> &x, const MV_Vector<TYPE> &y)
-{
-      int N = x.size();
-      if (N != y.size())
-      {
-         cout << "Incompatible vector lengths in +." << endl;
-         exit(1);
-      }
-      
-      MV_Vector<TYPE> result(N);
-      for (int i=0;i<N; i++)
-         result(i) = x(i) + y(i);
-      return result;
-}
-          
-template <class TYPE>
-MV_Vector<TYPE> operator-(const MV_Vector<TYPE> &x, const MV_Vector<TYPE> &y)
-{
-      int N = x.size();
-      if (N != y.size())
-      {
-         cout << "Incompatible vector lengths in -." << endl;
-         exit(1);
-      }
-      
-      MV_Vector<TYPE> result(N);
-      for (int i=0;i<N; i++)
-         result(i) = x(i) - y(i);
-      return result;
-}
-          
 
 template <class TYPE>
 MV_Vector<TYPE>& operator+=(MV_Vector<TYPE> &x, const MV_Vector<TYPE> &y)
@@ -89,8 +29,8 @@ MV_Vector<TYPE>& operator+=(MV_Vector<TYPE> &x, const MV_Vector<TYPE> &y)
          exit(1);
       }
       
-      for (int i=0;i<N; i++)
-         x(i) += y(i);
+      if (N > 0)
+         MV_blas1_add(N, &x(0), &y(0), &x(0));
       return x;
 }
           
@@ -105,12 +45,17 @@ MV_Vector<TYPE>& operator-=(MV_Vector<TYPE> &x, const MV_Vector<TYPE> &y)
          exit(1);
       }
       
-      for (int i=0;i<N; i++)
-         x(i) -= y(i);
+      if (N > 0)
+         MV_blas1_sub(N, &x(0), &y(0), &x(0));
       return x;
 }
-          
-      
+
+//  x + y, x - y, a * x and x * a, and +=, -= of such expressions, are
+//  in mv_expr.h; they are evaluated in one loop when assigned.  They
+//  return an expression rather than an MV_Vector<TYPE>, so code that
+//  deduces the result (auto, a template argument) gets the expression:
+//  assign it, or construct a vector from it, to evaluate it.
+
 
 //  norm and dot product functions for the MV_Vector<> class
 
@@ -126,10 +71,10 @@ TYPE dot(const MV_Vector<TYPE> &x, const MV_Vector<TYPE> &y)
          exit(1);
       }
 
-      TYPE temp=0.0;
-      for (int i=0; i<x.size();i++)
-           temp += x(i)*y(i);
-      return temp;
+      int N = x.size();
+      if (N == 0)
+         return TYPE(0);
+      return MV_blas1_dot(N, &x(0), &y(0));
 }
 
 template <class TYPE>
@@ -139,5 +84,53 @@ TYPE norm(const MV_Vector<TYPE> &x)
       return sqrt(temp);
 }
 
+
+//  level 1 BLAS: y += a * x, x *= a, y = x (of the same size),
+//  and the Euclidean norm without overflow or harmful underflow.
+
+
+template <class TYPE>
+void axpy(const TYPE &a, const MV_Vector<TYPE> &x, MV_Vector<TYPE> &y)
+{
+      int N = x.size();
+      if (N != y.size())
+      {
+         cout << "Incompatible vector lengths in axpy()." << endl;
+         exit(1);
+      }
+
+      if (N > 0)
+         MV_blas1_axpy(N, a, &x(0), &y(0));
+}
+
+template <class TYPE>
+void scal(const TYPE &a, MV_Vector<TYPE> &x)
+{
+      x *= a;
+}
+
+template <class TYPE>
+void copy(const MV_Vector<TYPE> &x, MV_Vector<TYPE> &y)
+{
+      int N = x.size();
+      if (N != y.size())
+      {
+         cout << "Incompatible vector lengths in copy()." << endl;
+         exit(1);
+      }
+
+      if (N > 0)
+         MV_blas1_copy(N, &x(0), &y(0));
+}
+
+template <class TYPE>
+typename MV_blas1_traits<TYPE>::real_type nrm2(const MV_Vector<TYPE> &x)
+{
+      int N = x.size();
+      if (N == 0)
+         return 0;
+      return MV_blas1_nrm2(N, &x(0));
+}
+
 #endif
 // _MV_BLAS1_H_
@@ -9,19 +9,43 @@
 #include <math.h>
 #include <stdlib.h>
 
+#include "mv_blas1_kernel.h"
+
+//  The magnitudes for nrm2().
+//
+template <>
+struct MV_blas1_traits<complex>
+{
+    typedef double real_type;
+    static double abs2(const complex &z)
+    { return real(z) * real(z) + imag(z) * imag(z); }
+    static double abs(const complex &z)
+    { return hypot(real(z), imag(z)); }
+};
+
 
 MV_Vector_complex& operator*=(MV_Vector_complex &x, const complex &a);
-MV_Vector_complex operator*(const complex &a, const MV_Vector_complex &x);
-MV_Vector_complex operator*(const MV_Vector_complex &x, const complex &a);
-MV_Vector_complex operator+(const MV_Vector_complex &x, 
-    const MV_Vector_complex &y);
-MV_Vector_complex operator-(const MV_Vector_complex &x, 
-    const MV_Vector_complex &y);
 MV_Vector_complex& operator+=(MV_Vector_complex &x, const MV_Vector_complex &y);
 MV_Vector_complex& operator-=(MV_Vector_complex &x, const MV_Vector_complex &y);
 
+//  x + y, x - y, a * x and x * a, and +=, -= of such expressions, are
+//  in mv_expr.h; they are evaluated in one loop when assigned.  They
+//  return an expression rather than an MV_Vector_complex and are no
+//  longer in mvlib.a, so code built against the earlier declarations
+//  must be recompiled, and code that deduces the result (auto, a
+//  template argument) gets the expression: assign it, or construct a
+//  vector from it, to evaluate it.
+
 complex dot(const MV_Vector_complex &x, const MV_Vector_complex &y);
 complex norm(const MV_Vector_complex &x);
 
+//  level 1 BLAS: y += a * x, x *= a, y = x (of the same size),
+//  and the Euclidean norm without overflow or harmful underflow.
+
+void axpy(const complex &a, const MV_Vector_complex &x, MV_Vector_complex &y);
+void scal(const complex &a, MV_Vector_complex &x);
+void copy(const MV_Vector_complex &x, MV_Vector_complex &y);
+MV_blas1_traits<complex>::real_type nrm2(const MV_Vector_complex &x);
+
 #endif
 // _MV_BLAS1_complex_H_
@@ -9,19 +9,31 @@
 #include <math.h>
 #include <stdlib.h>
 
+#include "mv_blas1_kernel.h"
+
 
 MV_Vector_double& operator*=(MV_Vector_double &x, const double &a);
-MV_Vector_double operator*(const double &a, const MV_Vector_double &x);
-MV_Vector_double operator*(const MV_Vector_double &x, const double &a);
-MV_Vector_double operator+(const MV_Vector_double &x, 
-    const MV_Vector_double &y);
-MV_Vector_double operator-(const MV_Vector_double &x, 
-    const MV_Vector_double &y);
 MV_Vector_double& operator+=(MV_Vector_double &x, const MV_Vector_double &y);
 MV_Vector_double& operator-=(MV_Vector_double &x, const MV_Vector_double &y);
 
+//  x + y, x - y, a * x and x * a, and +=, -= of such expressions, are
+//  in mv_expr.h; they are evaluated in one loop when assigned.  They
+//  return an expression rather than an MV_Vector_double and are no
+//  longer in mvlib.a, so code built against the earlier declarations
+//  must be recompiled, and code that deduces the result (auto, a
+//  template argument) gets the expression: assign it, or construct a
+//  vector from it, to evaluate it.
+
 double dot(const MV_Vector_double &x, const MV_Vector_double &y);
 double norm(const MV_Vector_double &x);
 
+//  level 1 BLAS: y += a * x, x *= a, y = x (of the same size),
+//  and the Euclidean norm without overflow or harmful underflow.
+
+void axpy(const double &a, const MV_Vector_double &x, MV_Vector_double &y);
+void scal(const double &a, MV_Vector_double &x);
+void copy(const MV_Vector_double &x, MV_Vector_double &y);
+MV_blas1_traits<double>::real_type nrm2(const MV_Vector_double &x);
+
 #endif
 // _MV_BLAS1_double_H_
@@ -9,19 +9,31 @@
 #include <math.h>
 #include <stdlib.h>
 
+#include "mv_blas1_kernel.h"
+
 
 MV_Vector_float& operator*=(MV_Vector_float &x, const float &a);
-MV_Vector_float operator*(const float &a, const MV_Vector_float &x);
-MV_Vector_float operator*(const MV_Vector_float &x, const float &a);
-MV_Vector_float operator+(const MV_Vector_float &x, 
-    const MV_Vector_float &y);
-MV_Vector_float operator-(const MV_Vector_float &x, 
-    const MV_Vector_float &y);
 MV_Vector_float& operator+=(MV_Vector_float &x, const MV_Vector_float &y);
 MV_Vector_float& operator-=(MV_Vector_float &x, const MV_Vector_float &y);
 
+//  x + y, x - y, a * x and x * a, and +=, -= of such expressions, are
+//  in mv_expr.h; they are evaluated in one loop when assigned.  They
+//  return an expression rather than an MV_Vector_float and are no
+//  longer in mvlib.a, so code built against the earlier declarations
+//  must be recompiled, and code that deduces the result (auto, a
+//  template argument) gets the expression: assign it, or construct a
+//  vector from it, to evaluate it.
+
 float dot(const MV_Vector_float &x, const MV_Vector_float &y);
 float norm(const MV_Vector_float &x);
 
+//  level 1 BLAS: y += a * x, x *= a, y = x (of the same size),
+//  and the Euclidean norm without overflow or harmful underflow.
+
+void axpy(const float &a, const MV_Vector_float &x, MV_Vector_float &y);
+void scal(const float &a, MV_Vector_float &x);
+void copy(const MV_Vector_float &x, MV_Vector_float &y);
+MV_blas1_traits<float>::real_type nrm2(const MV_Vector_float &x);
+
 #endif
 // _MV_BLAS1_float_H_
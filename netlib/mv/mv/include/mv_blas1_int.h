@@ -11,15 +11,17 @@
 
 
 MV_Vector_int& operator*=(MV_Vector_int &x, const int &a);
-MV_Vector_int operator*(const int &a, const MV_Vector_int &x);
-MV_Vector_int operator*(const MV_Vector_int &x, const int &a);
-MV_Vector_int operator+(const MV_Vector_int &x, 
-    const MV_Vector_int &y);
-MV_Vector_int operator-(const MV_Vector_int &x, 
-    const MV_Vector_int &y);
 MV_Vector_int& operator+=(MV_Vector_int &x, const MV_Vector_int &y);
 MV_Vector_int& operator-=(MV_Vector_int &x, const MV_Vector_int &y);
 
+//  x + y, x - y, a * x and x * a, and +=, -= of such expressions, are
+//  in mv_expr.h; they are evaluated in one loop when assigned.  They
+//  return an expression rather than an MV_Vector_int and are no longer
+//  in mvlib.a, so code built against the earlier declarations must be
+//  recompiled, and code that deduces the result (auto, a template
+//  argument) gets the expression: assign it, or construct a vector from
+//  it, to evaluate it.
+
 int dot(const MV_Vector_int &x, const MV_Vector_int &y);
 int norm(const MV_Vector_int &x);
 
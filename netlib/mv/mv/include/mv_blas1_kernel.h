@@ -0,0 +1,285 @@
+//      MV++  (V. 1.2b Beta)
+//      Numerical Matrix/MV_Vector Class Library
+//      (c) 1994  Roldan Pozo
+//
+
+//
+//      mv_blas1_kernel.h       BLAS-1 kernels on contiguous arrays
+//
+//      The level 1 operations of every MV_Vector type are done by the
+//      templates below, on the arrays &x(0) of the vectors.
+//
+//      o  The element-wise loops are plain unit-stride loops that the
+//          compiler vectorizes; the reductions keep MV_BLAS1_LANES
+//          independent partial sums, which vectorize without
+//          reassociating the sum.
+//
+//      o  Compiled with OpenMP (e.g. g++ -fopenmp) vectors of at least
+//          MV_BLAS1_PARALLEL_MIN elements are split across the threads
+//          (set their number with OMP_NUM_THREADS); otherwise everything
+//          runs on the calling thread.
+//
+//      o  A reduction is split into blocks that depend only on the
+//          length of the vector, and the block sums are added in order,
+//          so its result does not change with the number of threads.
+//          MV_blas1_deterministic(0) lets each thread sum one contiguous
+//          share instead, so that the rounding depends on the number
+//          of threads.
+//
+
+#ifndef _MV_BLAS1_KERNEL_H_
+#define _MV_BLAS1_KERNEL_H_
+
+#include <math.h>
+#include <limits>
+
+#ifdef _OPENMP
+#   include <omp.h>
+#   define MV_BLAS1_PRAGMA(x)   _Pragma(#x)
+#else
+#   define MV_BLAS1_PRAGMA(x)
+#endif
+
+#define MV_BLAS1_LANES          8
+#define MV_BLAS1_PARALLEL_MIN   32768
+#define MV_BLAS1_MIN_BLOCK      4096
+#define MV_BLAS1_MAX_BLOCKS     256
+
+
+//  The magnitudes of the elements of a vector, for nrm2().  Types other
+//  than the real ones, such as complex, specialize this.
+//
+template <class TYPE>
+struct MV_blas1_traits
+{
+    typedef TYPE real_type;
+    static TYPE abs2(const TYPE &x) { return x * x; }
+    static TYPE abs(const TYPE &x) { return x < 0 ? -x : x; }
+};
+
+
+inline int& MV_blas1_deterministic_flag()
+{
+    static int flag = 1;
+    return flag;
+}
+
+//  Set whether the reductions give the same result for any number
+//  of threads (on, the default); return the previous setting.
+//
+inline int MV_blas1_deterministic(int on)
+{
+    int old = MV_blas1_deterministic_flag();
+    MV_blas1_deterministic_flag() = on;
+    return old;
+}
+
+
+/*::::::::::::::::::::::::*/
+/*  Element-wise kernels  */
+/*::::::::::::::::::::::::*/
+
+//  y += a * x
+template <class TYPE>
+void MV_blas1_axpy(int N, const TYPE &a, const TYPE *x, TYPE *y)
+{
+    MV_BLAS1_PRAGMA(omp parallel for simd if(N >= MV_BLAS1_PARALLEL_MIN))
+    for (int i=0; i<N; i++)
+        y[i] += a * x[i];
+}
+
+//  x *= a
+template <class TYPE>
+void MV_blas1_scal(int N, const TYPE &a, TYPE *x)
+{
+    MV_BLAS1_PRAGMA(omp parallel for simd if(N >= MV_BLAS1_PARALLEL_MIN))
+    for (int i=0; i<N; i++)
+        x[i] *= a;
+}
+
+//  y = x
+template <class TYPE>
+void MV_blas1_copy(int N, const TYPE *x, TYPE *y)
+{
+    MV_BLAS1_PRAGMA(omp parallel for simd if(N >= MV_BLAS1_PARALLEL_MIN))
+    for (int i=0; i<N; i++)
+        y[i] = x[i];
+}
+
+//  z = x * a
+template <class TYPE>
+void MV_blas1_scale(int N, const TYPE *x, const TYPE &a, TYPE *z)
+{
+    MV_BLAS1_PRAGMA(omp parallel for simd if(N >= MV_BLAS1_PARALLEL_MIN))
+    for (int i=0; i<N; i++)
+        z[i] = x[i] * a;
+}
+
+//  z = x + y; z may be x or y.
+template <class TYPE>
+void MV_blas1_add(int N, const TYPE *x, const TYPE *y, TYPE *z)
+{
+    MV_BLAS1_PRAGMA(omp parallel for simd if(N >= MV_BLAS1_PARALLEL_MIN))
+    for (int i=0; i<N; i++)
+        z[i] = x[i] + y[i];
+}
+
+//  z = x - y; z may be x or y.
+template <class TYPE>
+void MV_blas1_sub(int N, const TYPE *x, const TYPE *y, TYPE *z)
+{
+    MV_BLAS1_PRAGMA(omp parallel for simd if(N >= MV_BLAS1_PARALLEL_MIN))
+    for (int i=0; i<N; i++)
+        z[i] = x[i] - y[i];
+}
+
+
+/*::::::::::::::*/
+/*  Reductions  */
+/*::::::::::::::*/
+
+//  The terms of the reductions: term(i) is added for each i.
+//
+template <class TYPE>
+struct MV_blas1_dot_term
+{
+    const TYPE *x, *y;
+    MV_blas1_dot_term(const TYPE *x_, const TYPE *y_) : x(x_), y(y_) {}
+    TYPE operator()(int i) const { return x[i] * y[i]; }
+};
+
+template <class TYPE>
+struct MV_blas1_abs2_term
+{
+    typedef typename MV_blas1_traits<TYPE>::real_type REAL;
+    const TYPE *x;
+    MV_blas1_abs2_term(const TYPE *x_) : x(x_) {}
+    REAL operator()(int i) const { return MV_blas1_traits<TYPE>::abs2(x[i]); }
+};
+
+template <class TYPE>
+struct MV_blas1_scaled_abs2_term
+{
+    typedef typename MV_blas1_traits<TYPE>::real_type REAL;
+    const TYPE *x;
+    REAL amax;
+    MV_blas1_scaled_abs2_term(const TYPE *x_, const REAL &a) :
+        x(x_), amax(a) {}
+    REAL operator()(int i) const
+    {
+        REAL t = MV_blas1_traits<TYPE>::abs(x[i]) / amax;
+        return t * t;
+    }
+};
+
+
+//  The sum of term(i) for i = lo .. hi-1, with term(i) added into
+//  partial sum (i - lo) % MV_BLAS1_LANES.
+//
+template <class SUM, class TERM>
+SUM MV_blas1_block_sum(int lo, int hi, const TERM &term)
+{
+    SUM s[MV_BLAS1_LANES];
+    for (int j=0; j<MV_BLAS1_LANES; j++)
+        s[j] = SUM(0);
+
+    int i = lo;
+    for (; i + MV_BLAS1_LANES <= hi; i += MV_BLAS1_LANES)
+        for (int j=0; j<MV_BLAS1_LANES; j++)
+            s[j] += term(i + j);
+    for (int j=0; i<hi; i++, j++)
+        s[j] += term(i);
+
+    for (int w = MV_BLAS1_LANES / 2; w > 0; w /= 2)
+        for (int j=0; j<w; j++)
+            s[j] += s[j + w];
+    return s[0];
+}
+
+
+//  The sum of term(i) for i = 0 .. N-1.
+//
+template <class SUM, class TERM>
+SUM MV_blas1_reduce(int N, const TERM &term)
+{
+#ifdef _OPENMP
+    if (N >= MV_BLAS1_PARALLEL_MIN && !MV_blas1_deterministic_flag())
+    {
+        SUM sum = SUM(0);
+#       pragma omp parallel
+        {
+            int nt = omp_get_num_threads(), t = omp_get_thread_num();
+            int lo = (int) ((long) N * t / nt);
+            int hi = (int) ((long) N * (t + 1) / nt);
+            SUM s = MV_blas1_block_sum<SUM>(lo, hi, term);
+#           pragma omp critical
+            sum += s;
+        }
+        return sum;
+    }
+#endif
+
+    int nblocks = (N + MV_BLAS1_MIN_BLOCK - 1) / MV_BLAS1_MIN_BLOCK;
+    if (nblocks > MV_BLAS1_MAX_BLOCKS)
+        nblocks = MV_BLAS1_MAX_BLOCKS;
+    if (nblocks <= 1)
+        return MV_blas1_block_sum<SUM>(0, N, term);
+
+    int block = (N + nblocks - 1) / nblocks;
+    SUM part[MV_BLAS1_MAX_BLOCKS];
+
+    MV_BLAS1_PRAGMA(omp parallel for schedule(static) if(N >= MV_BLAS1_PARALLEL_MIN))
+    for (int b=0; b<nblocks; b++)
+    {
+        int lo = b * block;
+        int hi = lo + block < N ? lo + block : N;
+        part[b] = MV_blas1_block_sum<SUM>(lo, hi, term);
+    }
+
+    SUM sum = part[0];
+    for (int b=1; b<nblocks; b++)
+        sum += part[b];
+    return sum;
+}
+
+
+//  x . y, without conjugation.
+template <class TYPE>
+TYPE MV_blas1_dot(int N, const TYPE *x, const TYPE *y)
+{
+    return MV_blas1_reduce<TYPE>(N, MV_blas1_dot_term<TYPE>(x, y));
+}
+
+
+//  The Euclidean norm of x.  The sum of squares is formed directly;
+//  only if it overflows, or falls where underflow may have lost
+//  accuracy, is it formed again scaled by the largest magnitude,
+//  as the reference BLAS nrm2 does throughout.
+//
+template <class TYPE>
+typename MV_blas1_traits<TYPE>::real_type MV_blas1_nrm2(int N, const TYPE *x)
+{
+    typedef typename MV_blas1_traits<TYPE>::real_type REAL;
+    typedef std::numeric_limits<REAL> limits;
+
+    REAL ssq = MV_blas1_reduce<REAL>(N, MV_blas1_abs2_term<TYPE>(x));
+    if (ssq <= limits::max() &&
+        ssq >= limits::min() / limits::epsilon())
+        return sqrt(ssq);
+
+    REAL amax = 0;
+    for (int i=0; i<N; i++)
+    {
+        REAL t = MV_blas1_traits<TYPE>::abs(x[i]);
+        if (t > amax || t != t)
+            amax = t;
+    }
+    if (amax == REAL(0) || !(amax <= limits::max()))
+        return amax;
+
+    ssq = MV_blas1_reduce<REAL>(N, MV_blas1_scaled_abs2_term<TYPE>(x, amax));
+    return amax * sqrt(ssq);
+}
+
+#endif
+// _MV_BLAS1_KERNEL_H_
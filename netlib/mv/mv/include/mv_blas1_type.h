@@ -9,19 +9,31 @@
 #include <math.h>
 #include <stdlib.h>
 
+#include "mv_blas1_kernel.h"
+
 
 MV_Vector_TYPE& operator*=(MV_Vector_TYPE &x, const TYPE &a);
-MV_Vector_TYPE operator*(const TYPE &a, const MV_Vector_TYPE &x);
-MV_Vector_TYPE operator*(const MV_Vector_TYPE &x, const TYPE &a);
-MV_Vector_TYPE operator+(const MV_Vector_TYPE &x, 
-    const MV_Vector_TYPE &y);
-MV_Vector_TYPE operator-(const MV_Vector_TYPE &x, 
-    const MV_Vector_TYPE &y);
 MV_Vector_TYPE& operator+=(MV_Vector_TYPE &x, const MV_Vector_TYPE &y);
 MV_Vector_TYPE& operator-=(MV_Vector_TYPE &x, const MV_Vector_TYPE &y);
 
+//  x + y, x - y, a * x and x * a, and +=, -= of such expressions, are
+//  in mv_expr.h; they are evaluated in one loop when assigned.  They
+//  return an expression rather than an MV_Vector_TYPE and are no longer
+//  in mvlib.a, so code built against the earlier declarations must be
+//  recompiled, and code that deduces the result (auto, a template
+//  argument) gets the expression: assign it, or construct a vector from
+//  it, to evaluate it.
+
 TYPE dot(const MV_Vector_TYPE &x, const MV_Vector_TYPE &y);
 TYPE norm(const MV_Vector_TYPE &x);
 
+//  level 1 BLAS: y += a * x, x *= a, y = x (of the same size),
+//  and the Euclidean norm without overflow or harmful underflow.
+
+void axpy(const TYPE &a, const MV_Vector_TYPE &x, MV_Vector_TYPE &y);
+void scal(const TYPE &a, MV_Vector_TYPE &x);
+void copy(const MV_Vector_TYPE &x, MV_Vector_TYPE &y);
+MV_blas1_traits<TYPE>::real_type nrm2(const MV_Vector_TYPE &x);
+
 #endif
 // _MV_BLAS1_TYPE_H_
@@ -0,0 +1,494 @@
+//      MV++  (V. 1.2b Beta)
+//      Numerical Matrix/MV_Vector Class Library
+//      (c) 1994  Roldan Pozo
+//
+
+//
+//      mv_expr.h       Expression templates for vector and matrix arithmetic
+//
+//      x + y, x - y, a * x and x * a, for MV_Vector and MV_ColMat operands
+//      x and y of the same type and scalars a, do not compute anything:
+//      they return an MV_Expr<> that records the operation.  The work is
+//      done when an expression is assigned (=, +=, -=) to a vector or
+//      matrix, or used to construct one, in a single loop over the
+//      elements with no temporary vectors.  (+= and -= also take a
+//      matrix, which MV_ColMat did not have before.)  For example,
+//
+//          p = z + beta * p;
+//
+//      reads z and p once and writes p once, where the operators that
+//      returned vectors made two temporaries and copied one of them.
+//
+//  NOTES:
+//
+//      o  The elements are computed in order, each before it is stored,
+//      so the destination may also appear in the expression, as p does
+//      above.  An expression that reads a different, overlapping view
+//      of the destination (e.g. x(I) = x(J) + y with I != J) is
+//      evaluated into a temporary first, as the operators that returned
+//      vectors did.
+//
+//      o  An expression refers to the vectors it was formed from; use it
+//      before they change or go out of scope.  In practice: do not store
+//      an expression, assign it.
+//
+//      o  dot(x, y) with an expression argument sums the products of the
+//      elements as they are computed; norm() of an expression evaluates
+//      it into a vector first.
+//
+//      o  The loops use the same OpenMP thresholds as the level 1 kernels
+//      (see mv_blas1_kernel.h).
+//
+//      A vector or matrix type takes part by specializing
+//      MV_expr_operand<> (from MV_expr_vector_operand<> or
+//      MV_expr_matrix_operand<>), and by defining a constructor and an
+//      operator= from const MV_Expr<E>&.
+//
+
+#ifndef _MV_EXPR_H_
+#define _MV_EXPR_H_
+
+#include <iostream.h>
+#include <stdlib.h>
+
+#include "mv_blas1_kernel.h"
+
+
+//  MV_expr_if_same<A, B, T>::type is T if A and B are the same type,
+//  and does not exist (so that the operator is not considered)
+//  otherwise.
+//
+template <class A, class B, class T>
+struct MV_expr_if_same {};
+
+template <class A, class T>
+struct MV_expr_if_same<A, A, T> { typedef T type; };
+
+
+//  The operands of the expressions.  MV_expr_operand<T> defines
+//
+//      value_type      the element type,
+//      result_type     the vector or matrix type that holds the value,
+//      expr_type       the type that stands for T in an expression,
+//      expr(x)         the expr_type of x,
+//
+//  and, for vectors and matrices, eval<OP>(x, e) which applies OP to
+//  each element of x and e.  Other types are not operands.
+//
+template <class T>
+struct MV_expr_operand {};
+
+
+/*:::::::::::::::::::::*/
+/*  Expression nodes   */
+/*:::::::::::::::::::::*/
+
+//  Every node has dim(0) and dim(1) (a vector has dim(1) == 1), and
+//  its elements are e[i] for vectors or e(i, j) for matrices.
+//  e.shifted(d, lda, lo, hi) tells whether a leaf reads the storage
+//  [lo, hi) of a destination at d, with leading dimension lda, other
+//  than element for element, so that assigning to d would overwrite
+//  elements the expression has yet to read.
+
+template <class TYPE, class VECTOR>
+class MV_expr_vec_leaf
+{
+    const TYPE *p_;
+    int n_;
+  public:
+    typedef TYPE value_type;
+    typedef VECTOR result_type;
+
+    MV_expr_vec_leaf(const TYPE *p, int n) : p_(p), n_(n) {}
+    int dim(int i) const { return i == 0 ? n_ : 1; }
+    const TYPE& operator[](int i) const { return p_[i]; }
+    bool shifted(const TYPE *d, int, const TYPE *lo, const TYPE *hi) const
+    {
+        return p_ != d && p_ < hi && lo < p_ + n_;
+    }
+};
+
+template <class TYPE, class MATRIX>
+class MV_expr_mat_leaf
+{
+    const TYPE *p_;
+    int m_, n_, lda_;
+  public:
+    typedef TYPE value_type;
+    typedef MATRIX result_type;
+
+    MV_expr_mat_leaf(const TYPE *p, int m, int n, int lda) :
+        p_(p), m_(m), n_(n), lda_(lda) {}
+    int dim(int i) const { return i == 0 ? m_ : n_; }
+    const TYPE& operator()(int i, int j) const { return p_[j*lda_ + i]; }
+    bool shifted(const TYPE *d, int lda, const TYPE *lo, const TYPE *hi) const
+    {
+        return (p_ != d || lda_ != lda) && m_ > 0 && n_ > 0 &&
+            p_ < hi && lo < p_ + (long) (n_ - 1) * lda_ + m_;
+    }
+};
+
+template <class L, class R>
+class MV_expr_add
+{
+    L l_;
+    R r_;
+  public:
+    typedef typename L::value_type value_type;
+    typedef typename L::result_type result_type;
+
+    MV_expr_add(const L &l, const R &r) : l_(l), r_(r) {}
+    int dim(int i) const { return l_.dim(i); }
+    value_type operator[](int i) const { return l_[i] + r_[i]; }
+    value_type operator()(int i, int j) const { return l_(i, j) + r_(i, j); }
+    bool shifted(const value_type *d, int lda,
+                 const value_type *lo, const value_type *hi) const
+    {
+        return l_.shifted(d, lda, lo, hi) || r_.shifted(d, lda, lo, hi);
+    }
+};
+
+template <class L, class R>
+class MV_expr_sub
+{
+    L l_;
+    R r_;
+  public:
+    typedef typename L::value_type value_type;
+    typedef typename L::result_type result_type;
+
+    MV_expr_sub(const L &l, const R &r) : l_(l), r_(r) {}
+    int dim(int i) const { return l_.dim(i); }
+    value_type operator[](int i) const { return l_[i] - r_[i]; }
+    value_type operator()(int i, int j) const { return l_(i, j) - r_(i, j); }
+    bool shifted(const value_type *d, int lda,
+                 const value_type *lo, const value_type *hi) const
+    {
+        return l_.shifted(d, lda, lo, hi) || r_.shifted(d, lda, lo, hi);
+    }
+};
+
+template <class E>
+class MV_expr_scale
+{
+    typename E::value_type a_;
+    E e_;
+  public:
+    typedef typename E::value_type value_type;
+    typedef typename E::result_type result_type;
+
+    MV_expr_scale(const value_type &a, const E &e) : a_(a), e_(e) {}
+    int dim(int i) const { return e_.dim(i); }
+    value_type operator[](int i) const { return a_ * e_[i]; }
+    value_type operator()(int i, int j) const { return a_ * e_(i, j); }
+    bool shifted(const value_type *d, int lda,
+                 const value_type *lo, const value_type *hi) const
+    {
+        return e_.shifted(d, lda, lo, hi);
+    }
+};
+
+
+//  The value of the operators: an expression e, not yet evaluated.
+//
+template <class E>
+class MV_Expr
+{
+    E e_;
+  public:
+    typedef typename E::value_type value_type;
+    typedef typename E::result_type result_type;
+
+    explicit MV_Expr(const E &e) : e_(e) {}
+    const E& expr() const { return e_; }
+    int dim(int i) const { return e_.dim(i); }
+};
+
+template <class E>
+struct MV_expr_operand< MV_Expr<E> >
+{
+    typedef typename E::value_type value_type;
+    typedef typename E::result_type result_type;
+    typedef E expr_type;
+    static const E& expr(const MV_Expr<E> &x) { return x.expr(); }
+};
+
+
+/*::::::::::::::*/
+/*  Evaluation  */
+/*::::::::::::::*/
+
+struct MV_expr_assign
+{
+    template <class T, class S>
+    static void apply(T &d, const S &s) { d = s; }
+};
+
+struct MV_expr_add_assign
+{
+    template <class T, class S>
+    static void apply(T &d, const S &s) { d += s; }
+};
+
+struct MV_expr_sub_assign
+{
+    template <class T, class S>
+    static void apply(T &d, const S &s) { d -= s; }
+};
+
+
+//  OP(d[i], e[i]), i = 0 .. N-1.  If e reads d at an offset, as in
+//  x(I+1) = x(I) + y(I), it is evaluated into a temporary first.
+template <class OP, class TYPE, class E>
+void MV_expr_vec_eval(int N, TYPE *d, const E &e)
+{
+    if (e.shifted(d, 0, d, d + N))
+    {
+        TYPE *t = new TYPE[N];
+        MV_expr_vec_eval<MV_expr_assign>(N, t, e);
+        MV_expr_vec_eval<OP>(N, d,
+            MV_expr_vec_leaf<TYPE, typename E::result_type>(t, N));
+        delete [] t;
+        return;
+    }
+
+    MV_BLAS1_PRAGMA(omp parallel for simd if(N >= MV_BLAS1_PARALLEL_MIN))
+    for (int i=0; i<N; i++)
+        OP::apply(d[i], e[i]);
+}
+
+//  OP(d[j*lda + i], e(i, j)), column by column, through a temporary
+//  if e reads d at an offset.
+template <class OP, class TYPE, class E>
+void MV_expr_mat_eval(int M, int N, TYPE *d, int lda, const E &e)
+{
+    if (M > 0 && N > 0 && e.shifted(d, lda, d, d + (long) (N - 1) * lda + M))
+    {
+        TYPE *t = new TYPE[(long) M * N];
+        MV_expr_mat_eval<MV_expr_assign>(M, N, t, M, e);
+        MV_expr_mat_eval<OP>(M, N, d, lda,
+            MV_expr_mat_leaf<TYPE, typename E::result_type>(t, M, N, M));
+        delete [] t;
+        return;
+    }
+
+    MV_BLAS1_PRAGMA(omp parallel for if((long) M * N >= MV_BLAS1_PARALLEL_MIN))
+    for (int j=0; j<N; j++)
+    {
+        TYPE *dj = d + (long) j * lda;
+        for (int i=0; i<M; i++)
+            OP::apply(dj[i], e(i, j));
+    }
+}
+
+
+template <class L, class R>
+void MV_expr_conform(const L &x, const R &y, const char *op)
+{
+    if (x.dim(0) != y.dim(0) || x.dim(1) != y.dim(1))
+    {
+        cout << "Incompatible dimensions in " << op << "." << endl;
+        exit(1);
+    }
+}
+
+
+//  The operands for vector and matrix types; VECTOR needs size() and
+//  operator(i), MATRIX size(0), size(1), lda() and operator(i, j).
+//
+template <class TYPE, class VECTOR>
+struct MV_expr_vector_operand
+{
+    typedef TYPE value_type;
+    typedef VECTOR result_type;
+    typedef MV_expr_vec_leaf<TYPE, VECTOR> expr_type;
+
+    static expr_type expr(const VECTOR &x)
+    {
+        return expr_type(x.size() ? &x(0) : 0, x.size());
+    }
+
+    template <class OP, class E>
+    static void eval(VECTOR &x, const E &e)
+    {
+        if (x.size() > 0)
+            MV_expr_vec_eval<OP>(x.size(), &x(0), e);
+    }
+};
+
+template <class TYPE, class MATRIX>
+struct MV_expr_matrix_operand
+{
+    typedef TYPE value_type;
+    typedef MATRIX result_type;
+    typedef MV_expr_mat_leaf<TYPE, MATRIX> expr_type;
+
+    static expr_type expr(const MATRIX &A)
+    {
+        int M = A.size(0), N = A.size(1);
+        return expr_type(M && N ? &A(0,0) : 0, M, N, A.lda());
+    }
+
+    template <class OP, class E>
+    static void eval(MATRIX &A, const E &e)
+    {
+        int M = A.size(0), N = A.size(1);
+        if (M > 0 && N > 0)
+            MV_expr_mat_eval<OP>(M, N, &A(0,0), A.lda(), e);
+    }
+};
+
+
+/*:::::::::::::*/
+/*  Operators  */
+/*:::::::::::::*/
+
+template <template <class, class> class NODE, class L, class R>
+struct MV_expr_binary
+{
+    typedef typename MV_expr_operand<L>::expr_type left;
+    typedef typename MV_expr_operand<R>::expr_type right;
+    typedef NODE<left, right> node;
+    typedef MV_Expr<node> type;
+
+    static type make(const L &x, const R &y, const char *op)
+    {
+        left l = MV_expr_operand<L>::expr(x);
+        right r = MV_expr_operand<R>::expr(y);
+        MV_expr_conform(l, r, op);
+        return type(node(l, r));
+    }
+};
+
+template <class L, class R>
+inline typename MV_expr_if_same<
+    typename MV_expr_operand<L>::result_type,
+    typename MV_expr_operand<R>::result_type,
+    MV_expr_binary<MV_expr_add, L, R> >::type::type
+operator+(const L &x, const R &y)
+{
+    return MV_expr_binary<MV_expr_add, L, R>::make(x, y, "+");
+}
+
+template <class L, class R>
+inline typename MV_expr_if_same<
+    typename MV_expr_operand<L>::result_type,
+    typename MV_expr_operand<R>::result_type,
+    MV_expr_binary<MV_expr_sub, L, R> >::type::type
+operator-(const L &x, const R &y)
+{
+    return MV_expr_binary<MV_expr_sub, L, R>::make(x, y, "-");
+}
+
+template <class R>
+inline MV_Expr< MV_expr_scale<typename MV_expr_operand<R>::expr_type> >
+operator*(const typename MV_expr_operand<R>::value_type &a, const R &x)
+{
+    typedef MV_expr_scale<typename MV_expr_operand<R>::expr_type> node;
+    return MV_Expr<node>(node(a, MV_expr_operand<R>::expr(x)));
+}
+
+template <class L>
+inline MV_Expr< MV_expr_scale<typename MV_expr_operand<L>::expr_type> >
+operator*(const L &x, const typename MV_expr_operand<L>::value_type &a)
+{
+    typedef MV_expr_scale<typename MV_expr_operand<L>::expr_type> node;
+    return MV_Expr<node>(node(a, MV_expr_operand<L>::expr(x)));
+}
+
+
+template <class T, class R>
+inline typename MV_expr_if_same<
+    T, typename MV_expr_operand<R>::result_type, T&>::type
+operator+=(T &x, const R &y)
+{
+    typename MV_expr_operand<R>::expr_type e = MV_expr_operand<R>::expr(y);
+    MV_expr_conform(MV_expr_operand<T>::expr(x), e, "+=");
+    MV_expr_operand<T>::template eval<MV_expr_add_assign>(x, e);
+    return x;
+}
+
+template <class T, class R>
+inline typename MV_expr_if_same<
+    T, typename MV_expr_operand<R>::result_type, T&>::type
+operator-=(T &x, const R &y)
+{
+    typename MV_expr_operand<R>::expr_type e = MV_expr_operand<R>::expr(y);
+    MV_expr_conform(MV_expr_operand<T>::expr(x), e, "-=");
+    MV_expr_operand<T>::template eval<MV_expr_sub_assign>(x, e);
+    return x;
+}
+
+
+/*:::::::::::::::::::::::::*/
+/*  dot() and norm()       */
+/*:::::::::::::::::::::::::*/
+
+template <class L, class R>
+struct MV_expr_dot_term
+{
+    L l;
+    R r;
+    MV_expr_dot_term(const L &l_, const R &r_) : l(l_), r(r_) {}
+    typename L::value_type operator()(int i) const { return l[i] * r[i]; }
+};
+
+//  The same sum, in the same order, as dot() of the evaluated vectors.
+template <class L, class R>
+typename L::value_type MV_expr_dot(const L &x, const R &y)
+{
+    typedef typename L::value_type TYPE;
+
+    MV_expr_conform(x, y, "dot()");
+    int N = x.dim(0);
+    if (N == 0)
+        return TYPE(0);
+    return MV_blas1_reduce<TYPE>(N, MV_expr_dot_term<L, R>(x, y));
+}
+
+template <class L, class R>
+inline typename MV_expr_if_same<
+    typename L::result_type, typename R::result_type,
+    typename L::value_type>::type
+dot(const MV_Expr<L> &x, const MV_Expr<R> &y)
+{
+    return MV_expr_dot(x.expr(), y.expr());
+}
+
+template <class L, class R>
+inline typename MV_expr_if_same<
+    typename L::result_type, typename MV_expr_operand<R>::result_type,
+    typename L::value_type>::type
+dot(const MV_Expr<L> &x, const R &y)
+{
+    return MV_expr_dot(x.expr(), MV_expr_operand<R>::expr(y));
+}
+
+template <class L, class R>
+inline typename MV_expr_if_same<
+    typename MV_expr_operand<L>::result_type, typename R::result_type,
+    typename R::value_type>::type
+dot(const L &x, const MV_Expr<R> &y)
+{
+    return MV_expr_dot(MV_expr_operand<L>::expr(x), y.expr());
+}
+
+template <class E>
+inline typename E::value_type norm(const MV_Expr<E> &x)
+{
+    return norm(typename E::result_type(x));
+}
+
+
+/*:::::::::::::::::::::::::*/
+/*  Output                 */
+/*:::::::::::::::::::::::::*/
+
+template <class E>
+inline ostream& operator<<(ostream &s, const MV_Expr<E> &x)
+{
+    return s << typename E::result_type(x);
+}
+
+#endif
+// _MV_EXPR_H_
@@ -39,6 +39,11 @@ class MV_ColMat
            int ref_;   // true if this is declared as a reference vector,
                         // i.e. it does not own the memory space, but 
                         // rather it is a view to another vector or array.
+
+    // view of the elements K of v, sharing them (see operator()(I,J))
+    //
+    MV_ColMat(MV_Vector<TYPE> &v, const MV_VecIndex &K, unsigned int m,
+                unsigned int n, unsigned int lda, Matrix_::ref_type i);
     public:                                                            
                                                                        
         /*::::::::::::::::::::::::::*/                                 
@@ -65,6 +70,10 @@ class MV_ColMat
                 Matrix_::ref_type i);
 
     MV_ColMat(const MV_ColMat<TYPE>&); 
+#ifdef MV_MOVE_SEMANTICS
+    MV_ColMat(MV_ColMat<TYPE>&&) noexcept;
+#endif
+    template <class E> MV_ColMat(const MV_Expr<E> &);   // evaluate e
     ~MV_ColMat();                              
                                                                        
         /*::::::::::::::::::::::::::::::::*/                           
@@ -78,13 +87,18 @@ class MV_ColMat
     unsigned int            size(int i) const; 
     MV_ColMat<TYPE>&        newsize(unsigned int, unsigned int);
     int ref() const { return ref_;}
+    int lda() const { return lda_;}
                                                                        
         /*::::::::::::::*/                                             
         /*  Assignment  */                                             
         /*::::::::::::::*/                                             
                                                                        
     MV_ColMat<TYPE> & operator=(const MV_ColMat<TYPE>&);
+#ifdef MV_MOVE_SEMANTICS
+    MV_ColMat<TYPE> & operator=(MV_ColMat<TYPE>&&);
+#endif
     MV_ColMat<TYPE> & operator=(const TYPE&);
+    template <class E> MV_ColMat<TYPE> & operator=(const MV_Expr<E> &);
 
 
     friend ostream& operator<<(ostream &s, const MV_ColMat<TYPE> &A);
@@ -304,6 +318,49 @@ MV_ColMat<TYPE>::MV_ColMat(TYPE* d, unsigned int m, unsigned int n,
 }
 
 
+template <class TYPE>
+MV_ColMat<TYPE>::MV_ColMat(MV_Vector<TYPE> &v, const MV_VecIndex &K,
+    unsigned int m, unsigned int n, unsigned int lda, Matrix_::ref_type i) :
+    v_(v, K, MV_Vector_::ref), dim0_(m), dim1_(n), lda_(lda), ref_(i) {}
+
+#ifdef MV_MOVE_SEMANTICS
+
+// the elements of m, views included, are taken over; m is left empty.
+//
+template <class TYPE>
+MV_ColMat<TYPE>::MV_ColMat(MV_ColMat<TYPE> && m) noexcept : 
+        v_(std::move(m.v_)), dim0_(m.dim0_), dim1_(m.dim1_), lda_(m.lda_),
+        ref_(m.ref_)
+{
+    m.dim0_ = 0;
+    m.dim1_ = 0;
+    m.lda_ = 0;
+    m.ref_ = 0;
+}
+
+template <class TYPE>
+MV_ColMat<TYPE>& MV_ColMat<TYPE>::operator=(MV_ColMat<TYPE> && m)
+{
+    // a view is assigned into, and a view of other elements is copied,
+    // as by operator=(const MV_ColMat<TYPE>&).
+    if (ref_ || m.ref_)
+        return operator=((const MV_ColMat<TYPE>&) m);
+
+    if (this != &m)
+    {
+        v_ = std::move(m.v_);
+        dim0_ = m.dim0_;
+        dim1_ = m.dim1_;
+        lda_ = m.lda_;
+        m.dim0_ = 0;
+        m.dim1_ = 0;
+        m.lda_ = 0;
+    }
+    return *this;
+}
+
+#endif
+
 template <class TYPE>
 MV_ColMat<TYPE> MV_ColMat<TYPE>::operator()(const MV_VecIndex &I, const MV_VecIndex &J)
 {
@@ -318,10 +375,11 @@ MV_ColMat<TYPE> MV_ColMat<TYPE>::operator()(const MV_VecIndex &I, const MV_VecIn
         exit(1);
     }
 
-    // this automatically returns a reference
+    // this automatically returns a reference, sharing the elements
+    // from (I.start(), J.start()) to (I.end(), J.end()).
     // 
-    return MV_ColMat<TYPE>(&v_[J.start()*lda_ + I.start()], 
-            I.end() - I.start() + 1, 
+    MV_VecIndex K(J.start()*lda_ + I.start(), J.end()*lda_ + I.end());
+    return MV_ColMat<TYPE>(v_, K, I.end() - I.start() + 1, 
             J.end() - J.start() + 1, lda_, Matrix_::ref);
 }
 
@@ -344,18 +402,64 @@ const MV_ColMat<TYPE> MV_ColMat<TYPE>::operator()(const MV_VecIndex &I,
     }
 
     // this automatically returns a reference.  we need to 
-    // "cast away" constness here, so the &v_[] arg will
+    // "cast away" constness here, so the v_ arg will
     // not cause a compiler error.
     //
     MV_ColMat<TYPE> *t =  (MV_ColMat<TYPE>*) this;
-    return MV_ColMat<TYPE>(&(t->v_[J.start()*lda_ + I.start()]), 
-            I.end() - I.start() + 1, 
+    MV_VecIndex K(J.start()*lda_ + I.start(), J.end()*lda_ + I.end());
+    return MV_ColMat<TYPE>(t->v_, K, I.end() - I.start() + 1, 
             J.end() - J.start() + 1, lda_, Matrix_::ref);
 }
 
 template <class TYPE>
 MV_ColMat<TYPE>::~MV_ColMat() {}
 
+template <class TYPE>
+struct MV_expr_operand< MV_ColMat<TYPE> > :
+    public MV_expr_matrix_operand<TYPE, MV_ColMat<TYPE> > {};
+
+template <class TYPE>
+template <class E>
+MV_ColMat<TYPE>::MV_ColMat(const MV_Expr<E> &e) :
+        v_(e.dim(0) * e.dim(1)), dim0_(e.dim(0)), dim1_(e.dim(1)),
+        lda_(e.dim(0)), ref_(0)
+{
+    if (dim0_ > 0 && dim1_ > 0)
+        MV_expr_mat_eval<MV_expr_assign>(dim0_, dim1_, &v_(0), lda_, e.expr());
+}
+
+template <class TYPE>
+template <class E>
+MV_ColMat<TYPE>& MV_ColMat<TYPE>::operator=(const MV_Expr<E> &e)
+{
+    int M = e.dim(0);
+    int N = e.dim(1);
+
+    if (ref_)
+    {
+        // check conformance,
+        if (dim0_ != M || dim1_ != N)
+        {
+            cerr << "MV_ColMatRef::operator=  non-conformant assignment.\n";
+            exit(1);
+        }
+    }
+    else if (dim0_ != M || dim1_ != N)
+    {
+        // e may refer to the elements that newsize() would delete
+        if (dim0_ > 0 && dim1_ > 0)
+        {
+            MV_ColMat<TYPE> tmp(e);
+            return operator=(tmp);
+        }
+        newsize(M, N);
+    }
+
+    if (M > 0 && N > 0)
+        MV_expr_mat_eval<MV_expr_assign>(M, N, &v_(0), lda_, e.expr());
+    return *this;
+}
+
 template <class TYPE>
 ostream&   operator<<(ostream& s, const MV_ColMat<TYPE>& V)
 {
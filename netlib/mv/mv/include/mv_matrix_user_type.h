@@ -36,6 +36,11 @@ class MV_ColMat_TYPE
            int ref_;   // true if this is declared as a reference vector,
                         // i.e. it does not own the memory space, but 
                         // rather it is a view to another vector or array.
+
+    // view of the elements K of v, sharing them (see operator()(I,J))
+    //
+    MV_ColMat_TYPE(MV_Vector_TYPE &v, const MV_VecIndex &K, unsigned int m,
+                unsigned int n, unsigned int lda, MV_Matrix_::ref_type i);
     public:                                                            
                                                                        
         /*::::::::::::::::::::::::::*/                                 
@@ -62,6 +67,10 @@ class MV_ColMat_TYPE
                 MV_Matrix_::ref_type i);
 
     MV_ColMat_TYPE(const MV_ColMat_TYPE&); 
+#ifdef MV_MOVE_SEMANTICS
+    MV_ColMat_TYPE(MV_ColMat_TYPE&&) noexcept;
+#endif
+    template <class E> MV_ColMat_TYPE(const MV_Expr<E> &);   // evaluate e
     ~MV_ColMat_TYPE();                              
                                                                        
         /*::::::::::::::::::::::::::::::::*/                           
@@ -75,13 +84,18 @@ class MV_ColMat_TYPE
     unsigned int            size(int i) const; 
     MV_ColMat_TYPE&         newsize(unsigned int, unsigned int);
     int ref() const { return ref_;}
+    int lda() const { return lda_;}
                                                                        
         /*::::::::::::::*/                                             
         /*  Assignment  */                                             
         /*::::::::::::::*/                                             
                                                                        
     MV_ColMat_TYPE & operator=(const MV_ColMat_TYPE&);
+#ifdef MV_MOVE_SEMANTICS
+    MV_ColMat_TYPE & operator=(MV_ColMat_TYPE&&);
+#endif
     MV_ColMat_TYPE & operator=(const TYPE&);
+    template <class E> MV_ColMat_TYPE & operator=(const MV_Expr<E> &);
 
 
     friend ostream& operator<<(ostream &s, const MV_ColMat_TYPE &A);
@@ -117,5 +131,49 @@ inline MV_ColMat_TYPE::MV_ColMat_TYPE(TYPE* d, unsigned int m, unsigned int n,
             v_(d, lda*n, MV_Vector_::ref), dim0_(m), dim1_(n), lda_(lda),
             ref_(i) {}
 
+template <>
+struct MV_expr_operand<MV_ColMat_TYPE> :
+    public MV_expr_matrix_operand<TYPE, MV_ColMat_TYPE> {};
+
+template <class E>
+MV_ColMat_TYPE::MV_ColMat_TYPE(const MV_Expr<E> &e) :
+        v_(e.dim(0) * e.dim(1)), dim0_(e.dim(0)), dim1_(e.dim(1)),
+        lda_(e.dim(0)), ref_(0)
+{
+    if (dim0_ > 0 && dim1_ > 0)
+        MV_expr_mat_eval<MV_expr_assign>(dim0_, dim1_, &v_(0), lda_, e.expr());
+}
+
+template <class E>
+MV_ColMat_TYPE& MV_ColMat_TYPE::operator=(const MV_Expr<E> &e)
+{
+    int M = e.dim(0);
+    int N = e.dim(1);
+
+    if (ref_)
+    {
+        // check conformance,
+        if (dim0_ != M || dim1_ != N)
+        {
+            cerr << "MV_ColMatRef::operator=  non-conformant assignment.\n";
+            exit(1);
+        }
+    }
+    else if (dim0_ != M || dim1_ != N)
+    {
+        // e may refer to the elements that newsize() would delete
+        if (dim0_ > 0 && dim1_ > 0)
+        {
+            MV_ColMat_TYPE tmp(e);
+            return operator=(tmp);
+        }
+        newsize(M, N);
+    }
+
+    if (M > 0 && N > 0)
+        MV_expr_mat_eval<MV_expr_assign>(M, N, &v_(0), lda_, e.expr());
+    return *this;
+}
+
 #endif
 
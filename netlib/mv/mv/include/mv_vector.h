@@ -55,6 +55,11 @@
 //      array.  It will not destruct the memory space when the vector
 //      is destroyed or goes out of scope.
 //
+//      o  The views A(I) and A() share the elements of A, which are
+//      reference counted (see mv_vector_ref.h): they remain valid
+//      after A is resized or destroyed, and taking one is O(1).
+//      With C++11, vectors returned by value are moved, not copied.
+//
 
                                  
 
@@ -67,14 +72,16 @@
 
 #include "mv_vecindex.h"
 #include "mv_vector_ref.h"
+#include "mv_expr.h"
 
 template <class TYPE>
 class MV_Vector
 {                                                                      
     protected:                                                           
+           MV_Vector_storage<TYPE> *s_;    // the elements, if counted
            TYPE *p_;
            unsigned int dim_;
-           int ref_;  // 0 or 1; does this own its own memory space?
+           int ref_;  // 0 or 1; is this a view of other elements?
     public:                                                            
 
 
@@ -92,7 +99,15 @@ class MV_Vector
     // reference of an exisiting data structure
     //
     MV_Vector(TYPE*, unsigned int, MV_Vector_::ref_type i); 
+
+    // view of x(I), sharing the elements of x
+    //
+    MV_Vector(MV_Vector<TYPE> &x, const MV_VecIndex &I, MV_Vector_::ref_type i);
     MV_Vector(const MV_Vector<TYPE>&); 
+#ifdef MV_MOVE_SEMANTICS
+    MV_Vector(MV_Vector<TYPE>&&) noexcept;
+#endif
+    template <class E> MV_Vector(const MV_Expr<E> &);   // evaluate e
     ~MV_Vector();                              
                                                                        
         /*::::::::::::::::::::::::::::::::*/                           
@@ -156,7 +171,11 @@ class MV_Vector
         /*::::::::::::::*/                                             
                                                                        
             MV_Vector<TYPE> & operator=(const MV_Vector<TYPE>&);
+#ifdef MV_MOVE_SEMANTICS
+            MV_Vector<TYPE> & operator=(MV_Vector<TYPE>&&);
+#endif
             MV_Vector<TYPE> & operator=(const TYPE&);
+            template <class E> MV_Vector<TYPE> & operator=(const MV_Expr<E> &);
 
 
     friend ostream& operator<<(ostream &s, const MV_Vector<TYPE> &A);
@@ -165,10 +184,11 @@ class MV_Vector
 
     
 template <class TYPE>
-MV_Vector<TYPE>::MV_Vector()  : p_(0), dim_(0) , ref_(0){};
+MV_Vector<TYPE>::MV_Vector()  : s_(0), p_(0), dim_(0) , ref_(0){};
 
 template <class TYPE>
-MV_Vector<TYPE>::MV_Vector(unsigned int n) : p_(new TYPE[n]), dim_(n), 
+MV_Vector<TYPE>::MV_Vector(unsigned int n) : 
+            s_(new MV_Vector_storage<TYPE>(n)), p_(s_->data), dim_(n), 
             ref_(0)
 {
     if (p_ == NULL)
@@ -181,7 +201,7 @@ MV_Vector<TYPE>::MV_Vector(unsigned int n) : p_(new TYPE[n]), dim_(n),
 
 template <class TYPE>
 MV_Vector<TYPE>::MV_Vector(unsigned int n, const TYPE& v) : 
-        p_(new TYPE[n]), dim_(n), ref_(0)
+        s_(new MV_Vector_storage<TYPE>(n)), p_(s_->data), dim_(n), ref_(0)
 {
     if (p_ == NULL)
     {
@@ -243,10 +263,13 @@ MV_Vector<TYPE>& MV_Vector<TYPE>::newsize(unsigned int n)
         }
     }
     else
-    if (dim_ != n )                     // only delete and new if
+    if (dim_ != n )                     // only release and new if
     {                                   // the size of memory is really
-        if (p_) delete [] p_;           // changing, otherwise just
-        p_ = new TYPE[n];               // copy in place.
+                                        // changing, otherwise just
+                                        // copy in place.
+        MV_Vector_storage<TYPE>::release(s_);
+        s_ = new MV_Vector_storage<TYPE>(n);
+        p_ = s_->data;
         if (p_ == NULL)
         {
             cerr << "Error : NULL pointer in operator= " << endl;
@@ -306,7 +329,8 @@ MV_Vector<TYPE>& MV_Vector<TYPE>::operator=(const MV_Vector<TYPE> & m)
 }
 
 template <class TYPE>
-MV_Vector<TYPE>::MV_Vector(const MV_Vector<TYPE> & m) : p_(new TYPE[m.dim_]), 
+MV_Vector<TYPE>::MV_Vector(const MV_Vector<TYPE> & m) : 
+    s_(new MV_Vector_storage<TYPE>(m.dim_)), p_(s_->data), 
     dim_(m.dim_) , ref_(0)
 {
     if (p_ == NULL)
@@ -321,6 +345,54 @@ MV_Vector<TYPE>::MV_Vector(const MV_Vector<TYPE> & m) : p_(new TYPE[m.dim_]),
         p_[i] = m.p_[i];
 }
 
+template <class TYPE>
+struct MV_expr_operand< MV_Vector<TYPE> > :
+    public MV_expr_vector_operand<TYPE, MV_Vector<TYPE> > {};
+
+template <class TYPE>
+template <class E>
+MV_Vector<TYPE>::MV_Vector(const MV_Expr<E> &e) : 
+    s_(new MV_Vector_storage<TYPE>(e.dim(0))), p_(s_->data),
+    dim_(e.dim(0)), ref_(0)
+{
+    if (p_ == NULL)
+    {
+        cerr << "Error:  Null pointer in MV_Vector(const MV_Expr&); " << endl;
+        exit(1);
+    }
+
+    MV_expr_vec_eval<MV_expr_assign>(dim_, p_, e.expr());
+}
+
+template <class TYPE>
+template <class E>
+MV_Vector<TYPE>& MV_Vector<TYPE>::operator=(const MV_Expr<E> &e)
+{
+    unsigned int N = e.dim(0);
+
+    if (ref_ )                  // is this structure just a pointer?
+    {
+        if (dim_ != N)          // check conformance,
+        {
+            cerr << "MV_VectorRef::operator=  non-conformant assignment.\n";
+            exit(1);
+        }
+    }
+    else if (dim_ != N)
+    {
+        // e may refer to the elements that newsize() would delete
+        if (dim_ > 0)
+        {
+            MV_Vector<TYPE> tmp(e);
+            return operator=(tmp);
+        }
+        newsize(N);
+    }
+
+    MV_expr_vec_eval<MV_expr_assign>(dim_, p_, e.expr());
+    return *this;
+}
+
 // note that ref() is initalized with i rather than 1.
 // this is so compilers will not generate a warning that i was
 // not used in the construction.  (MV_Vector::ref_type is an enum that
@@ -328,10 +400,68 @@ MV_Vector<TYPE>::MV_Vector(const MV_Vector<TYPE> & m) : p_(new TYPE[m.dim_]),
 //
 template <class TYPE>
 MV_Vector<TYPE>::MV_Vector(TYPE* d, unsigned int n, MV_Vector_::ref_type i) : 
-        p_(d), dim_(n) , ref_(i) {}
+        s_(0), p_(d), dim_(n) , ref_(i) {}
+
+template <class TYPE>
+MV_Vector<TYPE>::MV_Vector(MV_Vector<TYPE> &x, const MV_VecIndex &I, 
+        MV_Vector_::ref_type i) : s_(MV_Vector_storage<TYPE>::share(x.s_)),
+        p_(x.p_), dim_(x.dim_), ref_(i)
+{
+    if (!I.all())
+    {
+    // check that index is not out of bounds
+    //
+        if ( I.end() >= x.dim_)
+        {
+            cerr << "MV_VecIndex: (" << I.start() << ":" << I.end() << 
+                ") too big for matrix (0:" << x.dim_ - 1 << ") " << endl;
+            exit(1);
+        }
+        p_ = x.p_ + I.start();
+        dim_ = I.end() - I.start() + 1;
+    }
+}
+
+#ifdef MV_MOVE_SEMANTICS
+
+// the elements of m, views included, are taken over; m is left empty.
+//
+template <class TYPE>
+MV_Vector<TYPE>::MV_Vector(MV_Vector<TYPE> && m) noexcept : 
+        s_(m.s_), p_(m.p_), dim_(m.dim_), ref_(m.ref_)
+{
+    m.s_ = 0;
+    m.p_ = 0;
+    m.dim_ = 0;
+    m.ref_ = 0;
+}
 
 template <class TYPE>
-MV_Vector<TYPE>::MV_Vector(TYPE* d, unsigned int n) : p_(new TYPE[n]), 
+MV_Vector<TYPE>& MV_Vector<TYPE>::operator=(MV_Vector<TYPE> && m)
+{
+    // a view is assigned into, and a view of other elements is copied,
+    // as by operator=(const MV_Vector<TYPE>&).
+    if (ref_ || m.ref_)
+        return operator=((const MV_Vector<TYPE>&) m);
+
+    if (this != &m)
+    {
+        MV_Vector_storage<TYPE>::release(s_);
+        s_ = m.s_;
+        p_ = m.p_;
+        dim_ = m.dim_;
+        m.s_ = 0;
+        m.p_ = 0;
+        m.dim_ = 0;
+    }
+    return *this;
+}
+
+#endif
+
+template <class TYPE>
+MV_Vector<TYPE>::MV_Vector(TYPE* d, unsigned int n) : 
+      s_(new MV_Vector_storage<TYPE>(n)), p_(s_->data), 
       dim_(n) , ref_(0)
 {
     if (p_ == NULL)
@@ -346,7 +476,8 @@ MV_Vector<TYPE>::MV_Vector(TYPE* d, unsigned int n) : p_(new TYPE[n]),
 
 
 template <class TYPE>
-MV_Vector<TYPE>::MV_Vector(const TYPE* d, unsigned int n) : p_(new TYPE[n]), 
+MV_Vector<TYPE>::MV_Vector(const TYPE* d, unsigned int n) : 
+      s_(new MV_Vector_storage<TYPE>(n)), p_(s_->data), 
       dim_(n) , ref_(0)
 {
     if (p_ == NULL)
@@ -359,58 +490,40 @@ MV_Vector<TYPE>::MV_Vector(const TYPE* d, unsigned int n) : p_(new TYPE[n]),
 
 }
 
+// The views below share the elements (and their count) with this
+// vector.  The const versions "cast away" constness to construct
+// them, and return them const.
+
 template <class TYPE>
 MV_Vector<TYPE> MV_Vector<TYPE>::operator()(void)
 {
-    return MV_Vector<TYPE>(p_, dim_, MV_Vector_::ref);
+    return MV_Vector<TYPE>(*this, MV_VecIndex(), MV_Vector_::ref);
 }
 
 template <class TYPE>
 const MV_Vector<TYPE> MV_Vector<TYPE>::operator()(void) const
 {
-    return MV_Vector<TYPE>(p_, dim_, MV_Vector_::ref);
+    MV_Vector<TYPE> *t = (MV_Vector<TYPE>*) this;
+    return MV_Vector<TYPE>(*t, MV_VecIndex(), MV_Vector_::ref);
 }
 
 template <class TYPE>
 MV_Vector<TYPE> MV_Vector<TYPE>::operator()(const MV_VecIndex &I) 
 {
-    // default parameters
-    if (I.all())
-        return MV_Vector<TYPE>(p_, dim_, MV_Vector_::ref);
-    else
-    {
-    // check that index is not out of bounds
-    //
-        if ( I.end() >= dim_)
-        {
-            cerr << "MV_VecIndex: (" << I.start() << ":" << I.end() << 
-                ") too big for matrix (0:" << dim_ - 1 << ") " << endl;
-            exit(1);
-        }
-        return MV_Vector<TYPE>(p_+ I.start(), I.end() - I.start() + 1,
-            MV_Vector_::ref);
-    }
+    return MV_Vector<TYPE>(*this, I, MV_Vector_::ref);
 }
 
 template <class TYPE>
 const MV_Vector<TYPE> MV_Vector<TYPE>::operator()(const MV_VecIndex &I) const
 {
-    // check that index is not out of bounds
-    //
-    if ( I.end() >= dim_)
-    {
-        cerr << "MV_VecIndex: (" << I.start() << ":" << I.end() << 
-                ") too big for matrix (0:" << dim_ - 1 << ") " << endl;
-        exit(1);
-    }
-    return MV_Vector<TYPE>(p_+ I.start(), I.end() - I.start() + 1,
-            MV_Vector_::ref);
+    MV_Vector<TYPE> *t = (MV_Vector<TYPE>*) this;
+    return MV_Vector<TYPE>(*t, I, MV_Vector_::ref);
 }
 
 template <class TYPE>
 MV_Vector<TYPE>::~MV_Vector()
 {
-        if (p_ && !ref_ ) delete [] p_;
+        MV_Vector_storage<TYPE>::release(s_);
 }
 
 template <class TYPE>
@@ -54,6 +54,11 @@
 //      array.  It will not destruct the memory space when the vector
 //      is destroyed or goes out of scope.
 //
+//      o  The views A(I) and A() share the elements of A, which are
+//      reference counted (see mv_vector_ref.h): they remain valid
+//      after A is resized or destroyed, and taking one is O(1).
+//      With C++11, vectors returned by value are moved, not copied.
+//
 
                                  
 
@@ -73,13 +78,15 @@
 // has only one possible value: one.)
 
 #include "mv_vector_ref.h"
+#include "mv_expr.h"
 
 class MV_Vector_double
 {                                                                      
     protected:                                                           
+           MV_Vector_storage<double> *s_;  // the elements, if counted
            double *p_;
            unsigned int dim_;
-           int ref_;  // 0 or 1; does this own its own memory space?
+           int ref_;  // 0 or 1; is this a view of other elements?
     public:                                                            
 
 
@@ -98,7 +105,16 @@ class MV_Vector_double
     // reference of an exisiting data structure
     //
     MV_Vector_double(double*, unsigned int, MV_Vector_::ref_type i);    
+
+    // view of x(I), sharing the elements of x
+    //
+    MV_Vector_double(MV_Vector_double &x, const MV_VecIndex &I, 
+        MV_Vector_::ref_type i);
     MV_Vector_double(const MV_Vector_double &); 
+#ifdef MV_MOVE_SEMANTICS
+    MV_Vector_double(MV_Vector_double &&) noexcept;
+#endif
+    template <class E> MV_Vector_double(const MV_Expr<E> &);   // evaluate e
     ~MV_Vector_double();                              
                                                                        
         /*::::::::::::::::::::::::::::::::*/                           
@@ -162,13 +178,63 @@ class MV_Vector_double
         /*::::::::::::::*/                                             
                                                                        
             MV_Vector_double & operator=(const MV_Vector_double&);
+#ifdef MV_MOVE_SEMANTICS
+            MV_Vector_double & operator=(MV_Vector_double&&);
+#endif
             MV_Vector_double & operator=(const double&);
+            template <class E> MV_Vector_double & operator=(const MV_Expr<E> &);
 
 
     friend ostream& operator<<(ostream &s, const MV_Vector_double &A);
 
 };                                                                     
 
+template <>
+struct MV_expr_operand<MV_Vector_double> :
+    public MV_expr_vector_operand<double, MV_Vector_double> {};
+
+template <class E>
+MV_Vector_double::MV_Vector_double(const MV_Expr<E> &e) : 
+    s_(new MV_Vector_storage<double>(e.dim(0))), p_(s_->data),
+    dim_(e.dim(0)), ref_(0)
+{
+    if (p_ == NULL)
+    {
+        cerr << "Error:  Null pointer in MV_Vector_double(const MV_Expr&); " << endl;
+        exit(1);
+    }
+
+    MV_expr_vec_eval<MV_expr_assign>(dim_, p_, e.expr());
+}
+
+template <class E>
+MV_Vector_double& MV_Vector_double::operator=(const MV_Expr<E> &e)
+{
+    unsigned int N = e.dim(0);
+
+    if (ref_ )                  // is this structure just a pointer?
+    {
+        if (dim_ != N)          // check conformance,
+        {
+            cerr << "MV_VectorRef::operator=  non-conformant assignment.\n";
+            exit(1);
+        }
+    }
+    else if (dim_ != N)
+    {
+        // e may refer to the elements that newsize() would delete
+        if (dim_ > 0)
+        {
+            MV_Vector_double tmp(e);
+            return operator=(tmp);
+        }
+        newsize(N);
+    }
+
+    MV_expr_vec_eval<MV_expr_assign>(dim_, p_, e.expr());
+    return *this;
+}
+
 #include "mv_blas1_double.h"
 
 #endif  
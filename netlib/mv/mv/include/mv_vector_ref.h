@@ -15,4 +15,45 @@ struct MV_Vector_
 {
     enum ref_type  { ref = 1};
 } ;
+
+
+// The elements of a vector and of the views taken from it, x(I), are
+// kept in one MV_Vector_storage, which counts the vectors that use it.
+// It is deleted with the last of them, so a view stays valid after the
+// vector it came from is resized or destroyed.  Vectors constructed
+// with MV_Vector_::ref on memory of their own (e.g. a C array) have no
+// storage: that memory must outlive them.
+//
+template <class TYPE>
+struct MV_Vector_storage
+{
+    TYPE *data;
+    int count;
+
+    MV_Vector_storage(unsigned int n) : data(new TYPE[n]), count(1) {}
+    ~MV_Vector_storage() { delete [] data; }
+
+    static MV_Vector_storage* share(MV_Vector_storage *s)
+    {
+        if (s) s->count++;
+        return s;
+    }
+
+    static void release(MV_Vector_storage *s)
+    {
+        if (s && --s->count == 0)
+            delete s;
+    }
+};
+
+
+// Compilers with rvalue references (C++11) also get move constructors
+// and move assignment, so that vectors and matrices returned by value,
+// views included, are passed on without copying their elements.
+//
+#if __cplusplus >= 201103L
+#   define MV_MOVE_SEMANTICS
+#   include <utility>
+#endif
+
 # endif
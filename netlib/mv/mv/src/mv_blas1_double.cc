@@ -3,6 +3,9 @@
 //      (c) 1994  Roldan Pozo
 //
 
+//      The loops are done by the kernels of mv_blas1_kernel.h, on the
+//      arrays &x(0) of the vectors.
+
 
 #include <math.h>
 #include <stdlib.h>
@@ -12,68 +15,11 @@
 MV_Vector_double& operator*=(MV_Vector_double &x, const double &a)
 {
       int N = x.size();
-      for (int i=0;i<N;i++)
-         x(i) *= a;
+      if (N > 0)
+         MV_blas1_scal(N, a, &x(0));
       return x;
 }
 
-MV_Vector_double operator*(const double &a, const MV_Vector_double &x)
-{
-      int N = x.size();
-      MV_Vector_double result(N);
-      for (int i=0;i<N;i++)
-         result(i) = x(i)*a;
-      return result;
-}
-
-MV_Vector_double operator*(const MV_Vector_double &x, const double &a)
-{
-    // This is the other commutative case of vector*scalar.
-    // It should be just defined to be
-    // "return operator*(a,x);"
-    // but some compilers (e.g. Turbo C++ v.3.0) have trouble
-    // determining the proper template match.  For the moment,
-    // we'll just duplicate the code in the scalar * vector 
-    // case above.
-
-      int N = x.size();
-      MV_Vector_double result(N);
-      for (int i=0;i<N;i++)
-         result(i) = x(i)*a;
-      return result;
-
-}
-
-MV_Vector_double operator+(const MV_Vector_double &x, const MV_Vector_double &y)
-{
-      int N = x.size();
-      if (N != y.size())
-      {
-         cout << "Incompatible vector lengths in +." << endl;
-         exit(1);
-      }
-      
-      MV_Vector_double result(N);
-      for (int i=0;i<N; i++)
-         result(i) = x(i) + y(i);
-      return result;
-}
-          
-MV_Vector_double operator-(const MV_Vector_double &x, const MV_Vector_double &y)
-{
-      int N = x.size();
-      if (N != y.size())
-      {
-         cout << "Incompatible vector lengths in -." << endl;
-         exit(1);
-      }
-      
-      MV_Vector_double result(N);
-      for (int i=0;i<N; i++)
-         result(i) = x(i) - y(i);
-      return result;
-}
-          
 
 MV_Vector_double& operator+=(MV_Vector_double &x, const MV_Vector_double &y)
 {
@@ -84,8 +30,8 @@ MV_Vector_double& operator+=(MV_Vector_double &x, const MV_Vector_double &y)
          exit(1);
       }
       
-      for (int i=0;i<N; i++)
-         x(i) += y(i);
+      if (N > 0)
+         MV_blas1_add(N, &x(0), &y(0), &x(0));
       return x;
 }
           
@@ -99,8 +45,8 @@ MV_Vector_double& operator-=(MV_Vector_double &x, const MV_Vector_double &y)
          exit(1);
       }
       
-      for (int i=0;i<N; i++)
-         x(i) -= y(i);
+      if (N > 0)
+         MV_blas1_sub(N, &x(0), &y(0), &x(0));
       return x;
 }
           
@@ -119,15 +65,56 @@ double dot(const MV_Vector_double &x, const MV_Vector_double &y)
          exit(1);
       }
 
-      double temp =  0;
-      for (int i=0; i<x.size();i++)
-           temp += x(i)*y(i);
-      return temp;
+      int N = x.size();
+      if (N == 0)
+         return 0;
+      return MV_blas1_dot(N, &x(0), &y(0));
 }
 
 double norm(const MV_Vector_double &x)
 {
-      double temp = dot(x,x);
-      return sqrt(temp);
+      return nrm2(x);
 }
 
+
+//  level 1 BLAS
+
+
+void axpy(const double &a, const MV_Vector_double &x, MV_Vector_double &y)
+{
+      int N = x.size();
+      if (N != y.size())
+      {
+         cout << "Incompatible vector lengths in axpy()." << endl;
+         exit(1);
+      }
+
+      if (N > 0)
+         MV_blas1_axpy(N, a, &x(0), &y(0));
+}
+
+void scal(const double &a, MV_Vector_double &x)
+{
+      x *= a;
+}
+
+void copy(const MV_Vector_double &x, MV_Vector_double &y)
+{
+      int N = x.size();
+      if (N != y.size())
+      {
+         cout << "Incompatible vector lengths in copy()." << endl;
+         exit(1);
+      }
+
+      if (N > 0)
+         MV_blas1_copy(N, &x(0), &y(0));
+}
+
+MV_blas1_traits<double>::real_type nrm2(const MV_Vector_double &x)
+{
+      int N = x.size();
+      if (N == 0)
+         return 0;
+      return MV_blas1_nrm2(N, &x(0));
+}
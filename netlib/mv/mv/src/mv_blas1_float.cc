@@ -3,6 +3,9 @@
 //      (c) 1994  Roldan Pozo
 //
 
+//      The loops are done by the kernels of mv_blas1_kernel.h, on the
+//      arrays &x(0) of the vectors.
+
 
 #include <math.h>
 #include <stdlib.h>
@@ -12,68 +15,11 @@
 MV_Vector_float& operator*=(MV_Vector_float &x, const float &a)
 {
       int N = x.size();
-      for (int i=0;i<N;i++)
-         x(i) *= a;
+      if (N > 0)
+         MV_blas1_scal(N, a, &x(0));
       return x;
 }
 
-MV_Vector_float operator*(const float &a, const MV_Vector_float &x)
-{
-      int N = x.size();
-      MV_Vector_float result(N);
-      for (int i=0;i<N;i++)
-         result(i) = x(i)*a;
-      return result;
-}
-
-MV_Vector_float operator*(const MV_Vector_float &x, const float &a)
-{
-    // This is the other commutative case of vector*scalar.
-    // It should be just defined to be
-    // "return operator*(a,x);"
-    // but some compilers (e.g. Turbo C++ v.3.0) have trouble
-    // determining the proper template match.  For the moment,
-    // we'll just duplicate the code in the scalar * vector 
-    // case above.
-
-      int N = x.size();
-      MV_Vector_float result(N);
-      for (int i=0;i<N;i++)
-         result(i) = x(i)*a;
-      return result;
-
-}
-
-MV_Vector_float operator+(const MV_Vector_float &x, const MV_Vector_float &y)
-{
-      int N = x.size();
-      if (N != y.size())
-      {
-         cout << "Incompatible vector lengths in +." << endl;
-         exit(1);
-      }
-      
-      MV_Vector_float result(N);
-      for (int i=0;i<N; i++)
-         result(i) = x(i) + y(i);
-      return result;
-}
-          
-MV_Vector_float operator-(const MV_Vector_float &x, const MV_Vector_float &y)
-{
-      int N = x.size();
-      if (N != y.size())
-      {
-         cout << "Incompatible vector lengths in -." << endl;
-         exit(1);
-      }
-      
-      MV_Vector_float result(N);
-      for (int i=0;i<N; i++)
-         result(i) = x(i) - y(i);
-      return result;
-}
-          
 
 MV_Vector_float& operator+=(MV_Vector_float &x, const MV_Vector_float &y)
 {
@@ -84,8 +30,8 @@ MV_Vector_float& operator+=(MV_Vector_float &x, const MV_Vector_float &y)
          exit(1);
       }
       
-      for (int i=0;i<N; i++)
-         x(i) += y(i);
+      if (N > 0)
+         MV_blas1_add(N, &x(0), &y(0), &x(0));
       return x;
 }
           
@@ -99,8 +45,8 @@ MV_Vector_float& operator-=(MV_Vector_float &x, const MV_Vector_float &y)
          exit(1);
       }
       
-      for (int i=0;i<N; i++)
-         x(i) -= y(i);
+      if (N > 0)
+         MV_blas1_sub(N, &x(0), &y(0), &x(0));
       return x;
 }
           
@@ -119,15 +65,56 @@ float dot(const MV_Vector_float &x, const MV_Vector_float &y)
          exit(1);
       }
 
-      float temp =  0;
-      for (int i=0; i<x.size();i++)
-           temp += x(i)*y(i);
-      return temp;
+      int N = x.size();
+      if (N == 0)
+         return 0;
+      return MV_blas1_dot(N, &x(0), &y(0));
 }
 
 float norm(const MV_Vector_float &x)
 {
-      float temp = dot(x,x);
-      return sqrt(temp);
+      return nrm2(x);
 }
 
+
+//  level 1 BLAS
+
+
+void axpy(const float &a, const MV_Vector_float &x, MV_Vector_float &y)
+{
+      int N = x.size();
+      if (N != y.size())
+      {
+         cout << "Incompatible vector lengths in axpy()." << endl;
+         exit(1);
+      }
+
+      if (N > 0)
+         MV_blas1_axpy(N, a, &x(0), &y(0));
+}
+
+void scal(const float &a, MV_Vector_float &x)
+{
+      x *= a;
+}
+
+void copy(const MV_Vector_float &x, MV_Vector_float &y)
+{
+      int N = x.size();
+      if (N != y.size())
+      {
+         cout << "Incompatible vector lengths in copy()." << endl;
+         exit(1);
+      }
+
+      if (N > 0)
+         MV_blas1_copy(N, &x(0), &y(0));
+}
+
+MV_blas1_traits<float>::real_type nrm2(const MV_Vector_float &x)
+{
+      int N = x.size();
+      if (N == 0)
+         return 0;
+      return MV_blas1_nrm2(N, &x(0));
+}
@@ -180,6 +180,48 @@ MV_ColMat_float::MV_ColMat_float(float* d, unsigned int m, unsigned int n,
 }
 
 
+MV_ColMat_float::MV_ColMat_float(MV_Vector_float &v, const MV_VecIndex &K,
+    unsigned int m, unsigned int n, unsigned int lda, MV_Matrix_::ref_type i) :
+    v_(v, K, MV_Vector_::ref), dim0_(m), dim1_(n), lda_(lda), ref_(i) {}
+
+
+#ifdef MV_MOVE_SEMANTICS
+
+// the elements of m, views included, are taken over; m is left empty.
+//
+MV_ColMat_float::MV_ColMat_float(MV_ColMat_float && m) noexcept : 
+        v_(std::move(m.v_)), dim0_(m.dim0_), dim1_(m.dim1_), lda_(m.lda_),
+        ref_(m.ref_)
+{
+    m.dim0_ = 0;
+    m.dim1_ = 0;
+    m.lda_ = 0;
+    m.ref_ = 0;
+}
+
+MV_ColMat_float& MV_ColMat_float::operator=(MV_ColMat_float && m)
+{
+    // a view is assigned into, and a view of other elements is copied,
+    // as by operator=(const MV_ColMat_float&).
+    if (ref_ || m.ref_)
+        return operator=((const MV_ColMat_float&) m);
+
+    if (this != &m)
+    {
+        v_ = std::move(m.v_);
+        dim0_ = m.dim0_;
+        dim1_ = m.dim1_;
+        lda_ = m.lda_;
+        m.dim0_ = 0;
+        m.dim1_ = 0;
+        m.lda_ = 0;
+    }
+    return *this;
+}
+
+#endif
+
+
 MV_ColMat_float MV_ColMat_float::operator()(const MV_VecIndex &I, const MV_VecIndex &J)
 {
     // check that index is not out of bounds
@@ -193,10 +235,11 @@ MV_ColMat_float MV_ColMat_float::operator()(const MV_VecIndex &I, const MV_VecIn
         exit(1);
     }
 
-    // this automatically returns a reference
+    // this automatically returns a reference, sharing the elements
+    // from (I.start(), J.start()) to (I.end(), J.end()).
     // 
-    return MV_ColMat_float(&v_[J.start()*lda_ + I.start()], 
-            I.end() - I.start() + 1, 
+    MV_VecIndex K(J.start()*lda_ + I.start(), J.end()*lda_ + I.end());
+    return MV_ColMat_float(v_, K, I.end() - I.start() + 1, 
             J.end() - J.start() + 1, lda_, MV_Matrix_::ref);
 }
 
@@ -218,12 +261,12 @@ const MV_ColMat_float MV_ColMat_float::operator()(const MV_VecIndex &I,
     }
 
     // this automatically returns a reference.  we need to 
-    // "cast away" constness here, so the &v_[] arg will
+    // "cast away" constness here, so the v_ arg will
     // not cause a compiler error.
     //
     MV_ColMat_float *t =  (MV_ColMat_float*) this;
-    return MV_ColMat_float(&(t->v_[J.start()*lda_ + I.start()]), 
-            I.end() - I.start() + 1, 
+    MV_VecIndex K(J.start()*lda_ + I.start(), J.end()*lda_ + I.end());
+    return MV_ColMat_float(t->v_, K, I.end() - I.start() + 1, 
             J.end() - J.start() + 1, lda_, MV_Matrix_::ref);
 }
 
@@ -14,9 +14,10 @@
 #include "mv_vector_complex.h"
 
 
-MV_Vector_complex::MV_Vector_complex()  : p_(0), dim_(0) , ref_(0){};
+MV_Vector_complex::MV_Vector_complex()  : s_(0), p_(0), dim_(0) , ref_(0){};
 
-MV_Vector_complex::MV_Vector_complex(unsigned int n) : p_(new complex[n]), dim_(n), 
+MV_Vector_complex::MV_Vector_complex(unsigned int n) : 
+            s_(new MV_Vector_storage<complex>(n)), p_(s_->data), dim_(n), 
             ref_(0)
 {
     if (p_ == NULL)
@@ -29,7 +30,7 @@ MV_Vector_complex::MV_Vector_complex(unsigned int n) : p_(new complex[n]), dim_(
 
 
 MV_Vector_complex::MV_Vector_complex(unsigned int n, const complex& v) : 
-        p_(new complex[n]), dim_(n), ref_(0)
+        s_(new MV_Vector_storage<complex>(n)), p_(s_->data), dim_(n), ref_(0)
 {
     if (p_ == NULL)
     {
@@ -88,10 +89,13 @@ MV_Vector_complex& MV_Vector_complex::newsize(unsigned int n)
         }
     }
     else
-    if (dim_ != n )                     // only delete and new if
+    if (dim_ != n )                     // only release and new if
     {                                   // the size of memory is really
-        if (p_) delete [] p_;           // changing, otherwise just
-        p_ = new complex[n];                // copy in place.
+                                        // changing, otherwise just
+                                        // copy in place.
+        MV_Vector_storage<complex>::release(s_);
+        s_ = new MV_Vector_storage<complex>(n);
+        p_ = s_->data;
         if (p_ == NULL)
         {
             cerr << "Error : NULL pointer in operator= " << endl;
@@ -151,7 +155,8 @@ MV_Vector_complex& MV_Vector_complex::operator=(const MV_Vector_complex & m)
 }
 
 
-MV_Vector_complex::MV_Vector_complex(const MV_Vector_complex & m) : p_(new complex[m.dim_]), 
+MV_Vector_complex::MV_Vector_complex(const MV_Vector_complex & m) : 
+    s_(new MV_Vector_storage<complex>(m.dim_)), p_(s_->data), 
     dim_(m.dim_) , ref_(0)
 {
     if (p_ == NULL)
@@ -173,10 +178,67 @@ MV_Vector_complex::MV_Vector_complex(const MV_Vector_complex & m) : p_(new compl
 //
 
 MV_Vector_complex::MV_Vector_complex(complex* d, unsigned int n, MV_Vector_::ref_type i) : 
-        p_(d), dim_(n) , ref_(i) {}
+        s_(0), p_(d), dim_(n) , ref_(i) {}
 
 
-MV_Vector_complex::MV_Vector_complex(complex* d, unsigned int n) : p_(new complex[n]), 
+MV_Vector_complex::MV_Vector_complex(MV_Vector_complex &x, const MV_VecIndex &I, 
+        MV_Vector_::ref_type i) : s_(MV_Vector_storage<complex>::share(x.s_)),
+        p_(x.p_), dim_(x.dim_), ref_(i)
+{
+    if (!I.all())
+    {
+    // check that index is not out of bounds
+    //
+        if ( I.end() >= x.dim_)
+        {
+            cerr << "MV_VecIndex: (" << I.start() << ":" << I.end() << 
+                ") too big for matrix (0:" << x.dim_ - 1 << ") " << endl;
+            exit(1);
+        }
+        p_ = x.p_ + I.start();
+        dim_ = I.end() - I.start() + 1;
+    }
+}
+
+
+#ifdef MV_MOVE_SEMANTICS
+
+// the elements of m, views included, are taken over; m is left empty.
+//
+MV_Vector_complex::MV_Vector_complex(MV_Vector_complex && m) noexcept : 
+        s_(m.s_), p_(m.p_), dim_(m.dim_), ref_(m.ref_)
+{
+    m.s_ = 0;
+    m.p_ = 0;
+    m.dim_ = 0;
+    m.ref_ = 0;
+}
+
+MV_Vector_complex& MV_Vector_complex::operator=(MV_Vector_complex && m)
+{
+    // a view is assigned into, and a view of other elements is copied,
+    // as by operator=(const MV_Vector_complex&).
+    if (ref_ || m.ref_)
+        return operator=((const MV_Vector_complex&) m);
+
+    if (this != &m)
+    {
+        MV_Vector_storage<complex>::release(s_);
+        s_ = m.s_;
+        p_ = m.p_;
+        dim_ = m.dim_;
+        m.s_ = 0;
+        m.p_ = 0;
+        m.dim_ = 0;
+    }
+    return *this;
+}
+
+#endif
+
+
+MV_Vector_complex::MV_Vector_complex(complex* d, unsigned int n) : 
+      s_(new MV_Vector_storage<complex>(n)), p_(s_->data), 
       dim_(n) , ref_(0)
 {
     if (p_ == NULL)
@@ -191,7 +253,8 @@ MV_Vector_complex::MV_Vector_complex(complex* d, unsigned int n) : p_(new comple
 
 
 
-MV_Vector_complex::MV_Vector_complex(const complex* d, unsigned int n) : p_(new complex[n]), 
+MV_Vector_complex::MV_Vector_complex(const complex* d, unsigned int n) : 
+      s_(new MV_Vector_storage<complex>(n)), p_(s_->data), 
       dim_(n) , ref_(0)
 {
     if (p_ == NULL)
@@ -205,57 +268,39 @@ MV_Vector_complex::MV_Vector_complex(const complex* d, unsigned int n) : p_(new
 }
 
 
+// The views below share the elements (and their count) with this
+// vector.  The const versions "cast away" constness to construct
+// them, and return them const.
+
 MV_Vector_complex MV_Vector_complex::operator()(void)
 {
-    return MV_Vector_complex(p_, dim_, MV_Vector_::ref);
+    return MV_Vector_complex(*this, MV_VecIndex(), MV_Vector_::ref);
 }
 
 
 const MV_Vector_complex MV_Vector_complex::operator()(void) const
 {
-    return MV_Vector_complex(p_, dim_, MV_Vector_::ref);
+    MV_Vector_complex *t = (MV_Vector_complex*) this;
+    return MV_Vector_complex(*t, MV_VecIndex(), MV_Vector_::ref);
 }
 
 
 MV_Vector_complex MV_Vector_complex::operator()(const MV_VecIndex &I) 
 {
-    // default parameters
-    if (I.all())
-        return MV_Vector_complex(p_, dim_, MV_Vector_::ref);
-    else
-    {
-    // check that index is not out of bounds
-    //
-        if ( I.end() >= dim_)
-        {
-            cerr << "MV_VecIndex: (" << I.start() << ":" << I.end() << 
-                ") too big for matrix (0:" << dim_ - 1 << ") " << endl;
-            exit(1);
-        }
-        return MV_Vector_complex(p_+ I.start(), I.end() - I.start() + 1,
-            MV_Vector_::ref);
-    }
+    return MV_Vector_complex(*this, I, MV_Vector_::ref);
 }
 
 
 const MV_Vector_complex MV_Vector_complex::operator()(const MV_VecIndex &I) const
 {
-    // check that index is not out of bounds
-    //
-    if ( I.end() >= dim_)
-    {
-        cerr << "MV_VecIndex: (" << I.start() << ":" << I.end() << 
-                ") too big for matrix (0:" << dim_ - 1 << ") " << endl;
-        exit(1);
-    }
-    return MV_Vector_complex(p_+ I.start(), I.end() - I.start() + 1,
-            MV_Vector_::ref);
+    MV_Vector_complex *t = (MV_Vector_complex*) this;
+    return MV_Vector_complex(*t, I, MV_Vector_::ref);
 }
 
 
 MV_Vector_complex::~MV_Vector_complex()
 {
-        if (p_ && !ref_ ) delete [] p_;
+        MV_Vector_storage<complex>::release(s_);
 }
 
 
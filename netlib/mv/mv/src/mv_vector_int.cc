@@ -14,9 +14,10 @@
 #include "mv_vector_int.h"
 
 
-MV_Vector_int::MV_Vector_int()  : p_(0), dim_(0) , ref_(0){};
+MV_Vector_int::MV_Vector_int()  : s_(0), p_(0), dim_(0) , ref_(0){};
 
-MV_Vector_int::MV_Vector_int(unsigned int n) : p_(new int[n]), dim_(n), 
+MV_Vector_int::MV_Vector_int(unsigned int n) : 
+            s_(new MV_Vector_storage<int>(n)), p_(s_->data), dim_(n), 
             ref_(0)
 {
     if (p_ == NULL)
@@ -29,7 +30,7 @@ MV_Vector_int::MV_Vector_int(unsigned int n) : p_(new int[n]), dim_(n),
 
 
 MV_Vector_int::MV_Vector_int(unsigned int n, const int& v) : 
-        p_(new int[n]), dim_(n), ref_(0)
+        s_(new MV_Vector_storage<int>(n)), p_(s_->data), dim_(n), ref_(0)
 {
     if (p_ == NULL)
     {
@@ -88,10 +89,13 @@ MV_Vector_int& MV_Vector_int::newsize(unsigned int n)
         }
     }
     else
-    if (dim_ != n )                     // only delete and new if
+    if (dim_ != n )                     // only release and new if
     {                                   // the size of memory is really
-        if (p_) delete [] p_;           // changing, otherwise just
-        p_ = new int[n];                // copy in place.
+                                        // changing, otherwise just
+                                        // copy in place.
+        MV_Vector_storage<int>::release(s_);
+        s_ = new MV_Vector_storage<int>(n);
+        p_ = s_->data;
         if (p_ == NULL)
         {
             cerr << "Error : NULL pointer in operator= " << endl;
@@ -151,7 +155,8 @@ MV_Vector_int& MV_Vector_int::operator=(const MV_Vector_int & m)
 }
 
 
-MV_Vector_int::MV_Vector_int(const MV_Vector_int & m) : p_(new int[m.dim_]), 
+MV_Vector_int::MV_Vector_int(const MV_Vector_int & m) : 
+    s_(new MV_Vector_storage<int>(m.dim_)), p_(s_->data), 
     dim_(m.dim_) , ref_(0)
 {
     if (p_ == NULL)
@@ -173,10 +178,67 @@ MV_Vector_int::MV_Vector_int(const MV_Vector_int & m) : p_(new int[m.dim_]),
 //
 
 MV_Vector_int::MV_Vector_int(int* d, unsigned int n, MV_Vector_::ref_type i) : 
-        p_(d), dim_(n) , ref_(i) {}
+        s_(0), p_(d), dim_(n) , ref_(i) {}
 
 
-MV_Vector_int::MV_Vector_int(int* d, unsigned int n) : p_(new int[n]), 
+MV_Vector_int::MV_Vector_int(MV_Vector_int &x, const MV_VecIndex &I, 
+        MV_Vector_::ref_type i) : s_(MV_Vector_storage<int>::share(x.s_)),
+        p_(x.p_), dim_(x.dim_), ref_(i)
+{
+    if (!I.all())
+    {
+    // check that index is not out of bounds
+    //
+        if ( I.end() >= x.dim_)
+        {
+            cerr << "MV_VecIndex: (" << I.start() << ":" << I.end() << 
+                ") too big for matrix (0:" << x.dim_ - 1 << ") " << endl;
+            exit(1);
+        }
+        p_ = x.p_ + I.start();
+        dim_ = I.end() - I.start() + 1;
+    }
+}
+
+
+#ifdef MV_MOVE_SEMANTICS
+
+// the elements of m, views included, are taken over; m is left empty.
+//
+MV_Vector_int::MV_Vector_int(MV_Vector_int && m) noexcept : 
+        s_(m.s_), p_(m.p_), dim_(m.dim_), ref_(m.ref_)
+{
+    m.s_ = 0;
+    m.p_ = 0;
+    m.dim_ = 0;
+    m.ref_ = 0;
+}
+
+MV_Vector_int& MV_Vector_int::operator=(MV_Vector_int && m)
+{
+    // a view is assigned into, and a view of other elements is copied,
+    // as by operator=(const MV_Vector_int&).
+    if (ref_ || m.ref_)
+        return operator=((const MV_Vector_int&) m);
+
+    if (this != &m)
+    {
+        MV_Vector_storage<int>::release(s_);
+        s_ = m.s_;
+        p_ = m.p_;
+        dim_ = m.dim_;
+        m.s_ = 0;
+        m.p_ = 0;
+        m.dim_ = 0;
+    }
+    return *this;
+}
+
+#endif
+
+
+MV_Vector_int::MV_Vector_int(int* d, unsigned int n) : 
+      s_(new MV_Vector_storage<int>(n)), p_(s_->data), 
       dim_(n) , ref_(0)
 {
     if (p_ == NULL)
@@ -191,7 +253,8 @@ MV_Vector_int::MV_Vector_int(int* d, unsigned int n) : p_(new int[n]),
 
 
 
-MV_Vector_int::MV_Vector_int(const int* d, unsigned int n) : p_(new int[n]), 
+MV_Vector_int::MV_Vector_int(const int* d, unsigned int n) : 
+      s_(new MV_Vector_storage<int>(n)), p_(s_->data), 
       dim_(n) , ref_(0)
 {
     if (p_ == NULL)
@@ -205,57 +268,39 @@ MV_Vector_int::MV_Vector_int(const int* d, unsigned int n) : p_(new int[n]),
 }
 
 
+// The views below share the elements (and their count) with this
+// vector.  The const versions "cast away" constness to construct
+// them, and return them const.
+
 MV_Vector_int MV_Vector_int::operator()(void)
 {
-    return MV_Vector_int(p_, dim_, MV_Vector_::ref);
+    return MV_Vector_int(*this, MV_VecIndex(), MV_Vector_::ref);
 }
 
 
 const MV_Vector_int MV_Vector_int::operator()(void) const
 {
-    return MV_Vector_int(p_, dim_, MV_Vector_::ref);
+    MV_Vector_int *t = (MV_Vector_int*) this;
+    return MV_Vector_int(*t, MV_VecIndex(), MV_Vector_::ref);
 }
 
 
 MV_Vector_int MV_Vector_int::operator()(const MV_VecIndex &I) 
 {
-    // default parameters
-    if (I.all())
-        return MV_Vector_int(p_, dim_, MV_Vector_::ref);
-    else
-    {
-    // check that index is not out of bounds
-    //
-        if ( I.end() >= dim_)
-        {
-            cerr << "MV_VecIndex: (" << I.start() << ":" << I.end() << 
-                ") too big for matrix (0:" << dim_ - 1 << ") " << endl;
-            exit(1);
-        }
-        return MV_Vector_int(p_+ I.start(), I.end() - I.start() + 1,
-            MV_Vector_::ref);
-    }
+    return MV_Vector_int(*this, I, MV_Vector_::ref);
 }
 
 
 const MV_Vector_int MV_Vector_int::operator()(const MV_VecIndex &I) const
 {
-    // check that index is not out of bounds
-    //
-    if ( I.end() >= dim_)
-    {
-        cerr << "MV_VecIndex: (" << I.start() << ":" << I.end() << 
-                ") too big for matrix (0:" << dim_ - 1 << ") " << endl;
-        exit(1);
-    }
-    return MV_Vector_int(p_+ I.start(), I.end() - I.start() + 1,
-            MV_Vector_::ref);
+    MV_Vector_int *t = (MV_Vector_int*) this;
+    return MV_Vector_int(*t, I, MV_Vector_::ref);
 }
 
 
 MV_Vector_int::~MV_Vector_int()
 {
-        if (p_ && !ref_ ) delete [] p_;
+        MV_Vector_storage<int>::release(s_);
 }
 
 
@@ -0,0 +1,234 @@
+//      MV++  (V. 1.2b Beta)
+//      Numerical Matrix/MV_Vector Class Library
+//      (c) 1994  Roldan Pozo
+//
+
+//
+//      bench_cg.cc     Memory traffic of the vector updates of CG
+//
+//      Usage:  bench_cg [n] [iterations]
+//
+//      Runs the iteration of IML++'s cg.h, as written with MV++ vector
+//      operators,
+//
+//          p = z + beta * p;   q = A*p;   x += alpha * p;   r -= alpha * q;
+//
+//      on the 5-point Laplacian of an n x n grid (default n = 1000, 50
+//      iterations), twice:
+//
+//          temporaries     every operator returns a new vector, as the
+//                          operators did before mv_expr.h: eager() below
+//                          evaluates each sub-expression into one.
+//          expressions     the same statements, evaluated by mv_expr.h.
+//
+//      For each it reports the heap allocations and the bytes of vector
+//      data read and written by the three updates per iteration, and
+//      their time.  The updates stream 17 vectors through memory with
+//      temporaries (p: 3 + 2 + 2 for beta*p, z + t and the copy into p;
+//      x and r: 2 + 3 each), and 9 as expressions (3 each), so on vectors
+//      larger than the caches their time drops at least in that ratio;
+//      more, where each large temporary is fresh memory from the system
+//      that has to be mapped in again.  The matrix-vector product, dot
+//      products and norm are the same statements in both and are timed
+//      separately.  Both runs compute the same iterates, to the last bit.
+//
+
+#include <iostream.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+
+#include "mv_vector_double.h"
+
+
+static long allocs = 0;
+
+void* operator new[](size_t n)
+{
+    allocs++;
+    void *p = malloc(n ? n : 1);
+    if (p == NULL)
+    {
+        cerr << "bench_cg: out of memory" << endl;
+        exit(1);
+    }
+    return p;
+}
+
+void operator delete[](void *p) noexcept { free(p); }
+
+
+static double seconds()
+{
+    struct timeval t;
+    gettimeofday(&t, NULL);
+    return t.tv_sec + 1e-6 * t.tv_usec;
+}
+
+
+//  The 5-point Laplacian on an n x n grid, with A*x as IML++ uses it.
+//
+class Laplacian
+{
+    int n_;
+  public:
+    Laplacian(int n) : n_(n) {}
+    MV_Vector_double operator*(const MV_Vector_double &x) const
+    {
+        int n = n_;
+        MV_Vector_double y(n * n);
+        for (int j=0; j<n; j++)
+            for (int i=0; i<n; i++)
+            {
+                int k = j*n + i;
+                double s = 4 * x(k);
+                if (i > 0)   s -= x(k-1);
+                if (i < n-1) s -= x(k+1);
+                if (j > 0)   s -= x(k-n);
+                if (j < n-1) s -= x(k+n);
+                y(k) = s;
+            }
+        return y;
+    }
+};
+
+//  Evaluate an expression into a new vector, as the operators that
+//  returned an MV_Vector_double did.
+//
+template <class E>
+MV_Vector_double eager(const MV_Expr<E> &e)
+{
+    return MV_Vector_double(e);
+}
+
+
+struct Result
+{
+    double update_time;     // the three vector updates
+    double other_time;      // A*p, the dot products and the norm
+    long allocs;            // in the updates, after the first iteration
+    double resid;
+    MV_Vector_double x;
+};
+
+//  iterations of cg.h (with the identity preconditioner, z = r)
+//
+static void cg(const Laplacian &A, const MV_Vector_double &b, int iters,
+    int temporaries, Result &res)
+{
+    int N = b.size();
+    MV_Vector_double x(N, 0.0), r(b), p(N), z(N), q(N);
+    double alpha, beta, rho, rho_1 = 0;
+    double t_update = 0, t_other = 0;
+    long n_allocs = 0;
+
+    for (int i = 1; i <= iters; i++)
+    {
+        double t0 = seconds();
+        z = r;
+        rho = dot(r, z);
+        double t1 = seconds();
+        long a0 = allocs;
+
+        if (i == 1)
+            p = z;
+        else
+        {
+            beta = rho / rho_1;
+            if (temporaries)
+                p = eager(z + eager(beta * p));
+            else
+                p = z + beta * p;
+        }
+
+        double t2 = seconds();
+        long a1 = allocs;
+        q = A*p;
+        alpha = rho / dot(p, q);
+        double t3 = seconds();
+        long a2 = allocs;
+
+        if (temporaries)
+        {
+            x += eager(alpha * p);
+            r -= eager(alpha * q);
+        }
+        else
+        {
+            x += alpha * p;
+            r -= alpha * q;
+        }
+
+        double t4 = seconds();
+        if (i > 1)
+            n_allocs += (a1 - a0) + (allocs - a2);
+        res.resid = norm(r);
+        double t5 = seconds();
+
+        t_update += (t2 - t1) + (t4 - t3);
+        t_other += (t1 - t0) + (t3 - t2) + (t5 - t4);
+        rho_1 = rho;
+    }
+
+    res.update_time = t_update;
+    res.other_time = t_other;
+    res.allocs = n_allocs;
+    res.x = x;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    int n = argc > 1 ? atoi(argv[1]) : 1000;
+    int iters = argc > 2 ? atoi(argv[2]) : 50;
+    int N = n * n;
+
+    if (n < 2 || iters < 2)
+    {
+        cout << "Usage: " << argv[0] << " [n >= 2] [iterations >= 2]" << endl;
+        exit(1);
+    }
+
+    Laplacian A(n);
+    MV_Vector_double b(N, 1.0);
+
+    printf("CG on the %d x %d Laplacian, N = %d, %d iterations\n\n",
+        n, n, N, iters);
+
+    Result res[2];
+    const char *name[2] = { "temporaries", "expressions" };
+    const int streams[2] = { 17, 9 };
+
+    // warm up the pages and the caches once before timing
+    cg(A, b, 2, 0, res[1]);
+
+    for (int t=0; t<2; t++)
+        cg(A, b, iters, t == 0, res[t]);
+
+    printf("               allocs/iter  MB moved/iter  update ms/iter   GB/s"
+           "  other ms/iter\n");
+    for (int t=0; t<2; t++)
+    {
+        double per_iter = res[t].update_time / iters;
+        double mb = streams[t] * 8.0 * N / 1e6;
+        printf("  %-11s %13.1f %14.1f %15.3f %6.2f %14.3f\n", name[t],
+            (double) res[t].allocs / (iters - 1), mb, 1e3 * per_iter,
+            mb / 1e3 / per_iter, 1e3 * res[t].other_time / iters);
+    }
+
+    double diff = 0;
+    for (int i=0; i<N; i++)
+    {
+        double d = res[0].x(i) - res[1].x(i);
+        if (d < 0) d = -d;
+        if (d > diff) diff = d;
+    }
+    printf("\n  update time, expressions / temporaries: %.2f  (traffic %.2f)\n",
+        res[1].update_time / res[0].update_time,
+        (double) streams[1] / streams[0]);
+    printf("  final |r|: %.6e and %.6e, max |x difference|: %g\n",
+        res[0].resid, res[1].resid, diff);
+
+    return diff != 0;
+}
@@ -23,6 +23,7 @@
 
 #include "vector_defs.h"
 #include VECTOR_H
+#include MATRIX_H
 
 
 int
@@ -80,5 +81,42 @@ main(int argc, char *argv[])
     cout << x << endl;
 
 
+    cout << "Testing axpy, scal and copy:  " << endl;
+    x = (complex) 2; 
+    y = (complex) 1;
+
+    cout << "x=2, y=1; axpy(3, x, y); scal(2, y); copy(y, z): " << endl;
+    axpy((complex) 3, x, y);
+    scal((complex) 2, y);
+    copy(y, z);
+    cout << z << endl;
+
+    cout << "Testing dot and nrm2:  " << endl;
+    cout << "x=2, y=1; dot(x, y) = " << dot(x, (y = (complex) 1))
+         << "  nrm2(x) = " << nrm2(x) << endl;
+
+    x = (complex) 1e200;
+    cout << "x=1e200; nrm2(x) / sqrt(N) = " << nrm2(x) / sqrt((double) N)
+         << endl;
+    x = (complex) 1e-170;
+    cout << "x=1e-170; nrm2(x) / sqrt(N) = " << nrm2(x) / sqrt((double) N)
+         << endl;
+
+    cout << "Testing expressions:  " << endl;
+    x = (complex) 2; 
+    y = (complex) 1;
+
+    cout << "x=2, y=1; y = x + 3 * y - y * 2; x += 2 * y: " << endl;
+    y = x + (complex) 3 * y - y * (complex) 2;
+    x += (complex) 2 * y;
+    cout << x << endl;
+    cout << "dot(x - y, y) = " << dot(x - y, y) << endl;
+
+    MATRIX_complex A(2, 3, (complex) 1), B(2, 3, (complex) 2);
+    cout << "A=1, B=2 (2 x 3); A = A + 3 * B; A -= B: " << endl;
+    A = A + (complex) 3 * B;
+    A -= B;
+    cout << A << endl;
+
     return 0;
 }
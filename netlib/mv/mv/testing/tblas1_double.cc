@@ -23,6 +23,7 @@
 
 #include "vector_defs.h"
 #include VECTOR_H
+#include MATRIX_H
 
 
 int
@@ -80,5 +81,42 @@ main(int argc, char *argv[])
     cout << x << endl;
 
 
+    cout << "Testing axpy, scal and copy:  " << endl;
+    x = (double) 2; 
+    y = (double) 1;
+
+    cout << "x=2, y=1; axpy(3, x, y); scal(2, y); copy(y, z): " << endl;
+    axpy((double) 3, x, y);
+    scal((double) 2, y);
+    copy(y, z);
+    cout << z << endl;
+
+    cout << "Testing dot and nrm2:  " << endl;
+    cout << "x=2, y=1; dot(x, y) = " << dot(x, (y = (double) 1))
+         << "  nrm2(x) = " << nrm2(x) << endl;
+
+    x = (double) 1e200;
+    cout << "x=1e200; nrm2(x) / sqrt(N) = " << nrm2(x) / sqrt((double) N)
+         << endl;
+    x = (double) 1e-170;
+    cout << "x=1e-170; nrm2(x) / sqrt(N) = " << nrm2(x) / sqrt((double) N)
+         << endl;
+
+    cout << "Testing expressions:  " << endl;
+    x = (double) 2; 
+    y = (double) 1;
+
+    cout << "x=2, y=1; y = x + 3 * y - y * 2; x += 2 * y: " << endl;
+    y = x + (double) 3 * y - y * (double) 2;
+    x += (double) 2 * y;
+    cout << x << endl;
+    cout << "dot(x - y, y) = " << dot(x - y, y) << endl;
+
+    MATRIX_double A(2, 3, (double) 1), B(2, 3, (double) 2);
+    cout << "A=1, B=2 (2 x 3); A = A + 3 * B; A -= B: " << endl;
+    A = A + (double) 3 * B;
+    A -= B;
+    cout << A << endl;
+
     return 0;
 }
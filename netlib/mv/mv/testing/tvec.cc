@@ -161,6 +161,15 @@ main(int argc, char *argv[])
     //
     cout << " A " << endl << A << endl;
 
+    J = MV_VecIndex(0, N-2);
+    cout << " J = MV_VecIndex(0, N-2); A(MV_VecIndex(0,N-1)) = B; "
+        << "A(J+1) = A(J) + A(J); " << endl;
+    //
+    A(MV_VecIndex(0, N-1)) = B; 
+    A(J+1) = A(J) + A(J);
+    //
+    cout << " A " << endl << A << endl;
+
 
 
     cout << "Testing MV_Vector<double> &c = C(I)" << endl;
@@ -163,6 +163,15 @@ main(int argc, char *argv[])
     //
     cout << " A " << endl << A << endl;
 
+    J = MV_VecIndex(0, N-2);
+    cout << " J = MV_VecIndex(0, N-2); A(MV_VecIndex(0,N-1)) = B; "
+        << "A(J+1) = A(J) + A(J); " << endl;
+    //
+    A(MV_VecIndex(0, N-1)) = B; 
+    A(J+1) = A(J) + A(J);
+    //
+    cout << " A " << endl << A << endl;
+
 
 
     cout << "Testing VECTOR_int &c = C(I)" << endl;
@@ -248,6 +257,13 @@ main(int argc, char *argv[])
     cout << "After Z=A(I); Z=0;, A should remian unchanged " << endl;
     cout << A << endl;
 
+    cout << "Test a view outliving its vector: W = (*P)(I); delete P " << endl;
+    VECTOR_int *P = new VECTOR_int(N, (int) 7);
+    VECTOR_int W = (*P)(I);
+    delete P;
+    cout << "W should be all 7 " << endl;
+    cout << W << endl;
+
     return 0;
 }
 